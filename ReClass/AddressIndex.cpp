@@ -0,0 +1,58 @@
+#include "stdafx.h"
+
+#include "AddressIndex.h"
+
+void CAddressIndex::BuildSections( CIntervalIndex& Index, const std::vector<MemMapInfo>& Sections, std::map<CString, UINT>& NameIds )
+{
+    std::vector<INTERVAL> Ranges( Sections.size( ) );
+
+    for (size_t i = 0; i < Sections.size( ); i++)
+    {
+        const MemMapInfo& Section = Sections[i];
+
+        auto Found = NameIds.find( Section.Name );
+        if (Found == NameIds.end( ))
+        {
+            Found = NameIds.insert( std::make_pair( Section.Name, (UINT)m_Names.size( ) ) ).first;
+            m_Names.push_back( Section.Name );
+        }
+
+        Ranges[i].Start = Section.Start;
+        Ranges[i].End = Section.End;
+        Ranges[i].Value = Found->second;
+    }
+
+    Index.Build( Ranges );
+}
+
+void CAddressIndex::Build( const std::vector<MemMapInfo>& Code, const std::vector<MemMapInfo>& Data,
+                           const std::vector<AddressName>& Exports, const std::vector<AddressName>& CustomNames )
+{
+    std::map<CString, UINT> NameIds;
+
+    Clear( );
+
+    BuildSections( m_Code, Code, NameIds );
+    BuildSections( m_Data, Data, NameIds );
+
+    // First entry wins like the old linear scans, custom names before exports
+    m_ExactNames.reserve( Exports.size( ) + CustomNames.size( ) );
+    for (const AddressName& Entry : CustomNames)
+        m_ExactNames.insert( std::make_pair( Entry.Address, Entry.Name ) );
+    for (const AddressName& Entry : Exports)
+        m_ExactNames.insert( std::make_pair( Entry.Address, Entry.Name ) );
+}
+
+void CAddressIndex::Clear( )
+{
+    m_Code.Clear( );
+    m_Data.Clear( );
+    m_Names.clear( );
+    m_ExactNames.clear( );
+}
+
+const CString* CAddressIndex::FindName( ULONG_PTR Address ) const
+{
+    auto Found = m_ExactNames.find( Address );
+    return (Found != m_ExactNames.end( )) ? &Found->second : NULL;
+}
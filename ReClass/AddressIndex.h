@@ -0,0 +1,37 @@
+#pragma once
+
+#include "IntervalIndex.h"
+
+#include <unordered_map>
+
+//
+// Address index
+//
+// Built once per memory map snapshot from its code and data sections, exports
+// and custom names, then only read. Sections go in interval indices so
+// IsCode/IsData/GetAddressName binary search them instead of walking the
+// vectors for every hex node on every paint. Exact address names (custom
+// names win over exports) go in a hash map.
+//
+class CAddressIndex {
+public:
+    void Build( const std::vector<MemMapInfo>& Code, const std::vector<MemMapInfo>& Data,
+                const std::vector<AddressName>& Exports, const std::vector<AddressName>& CustomNames );
+    void Clear( );
+
+    // Module name of the section containing Address, NULL if there is none
+    const CString* FindCode( ULONG_PTR Address ) const { return GetName( m_Code.Find( Address ) ); }
+    const CString* FindData( ULONG_PTR Address ) const { return GetName( m_Data.Find( Address ) ); }
+
+    // Custom name or export at exactly Address, NULL if there is none
+    const CString* FindName( ULONG_PTR Address ) const;
+
+private:
+    void BuildSections( CIntervalIndex& Index, const std::vector<MemMapInfo>& Sections, std::map<CString, UINT>& NameIds );
+    const CString* GetName( UINT NameId ) const { return (NameId != INTERVAL_NO_VALUE) ? &m_Names[NameId] : NULL; }
+
+    CIntervalIndex m_Code;      // Values are m_Names indices
+    CIntervalIndex m_Data;
+    std::vector<CString> m_Names;
+    std::unordered_map<ULONG_PTR, CString> m_ExactNames;
+};
@@ -0,0 +1,478 @@
+#include "stdafx.h"
+
+#include "Autosave.h"
+#include "ProjectFormat.h"
+
+#include <ShlObj.h>
+#include <algorithm>
+#include <iterator>
+
+CAutosaveJournal g_Autosave;
+
+CAutosaveJournal::CAutosaveJournal( )
+    : m_bSnapshot( FALSE )
+    , m_JournalSize( 0 )
+    , m_hFile( INVALID_HANDLE_VALUE )
+    , m_hLock( INVALID_HANDLE_VALUE )
+    , m_bStop( false )
+{
+}
+
+CAutosaveJournal::~CAutosaveJournal( )
+{
+    // Not stopped by ExitInstance, keep the journal for the next start
+    Stop( FALSE );
+}
+
+CString CAutosaveJournal::GetDirectory( )
+{
+    TCHAR AppData[MAX_PATH];
+    if (FAILED( SHGetFolderPath( NULL, CSIDL_LOCAL_APPDATA | CSIDL_FLAG_CREATE, NULL, SHGFP_TYPE_CURRENT, AppData ) ))
+        return CString( );
+
+    CString Directory = AppData;
+    Directory += _T( "\\ReClassEx" );
+    CreateDirectory( Directory, NULL );
+    Directory += _T( "\\Autosave" );
+    CreateDirectory( Directory, NULL );
+    return Directory;
+}
+
+uint32_t CAutosaveJournal::Checksum( const void* Data, size_t Size, uint32_t Hash )
+{
+    const uint8_t* Bytes = (const uint8_t*)Data;
+    for (size_t i = 0; i < Size; i++)
+    {
+        Hash ^= Bytes[i];
+        Hash *= 16777619u;
+    }
+    return Hash;
+}
+
+uint32_t CAutosaveJournal::RecordChecksum( const AUTOSAVE_RECORD& Record, const uint8_t* Image )
+{
+    AUTOSAVE_RECORD Header = Record;
+    Header.Checksum = 0;
+    return Checksum( Image, Record.Size, Checksum( &Header, sizeof( Header ) ) );
+}
+
+void CAutosaveJournal::Start( )
+{
+    if (m_Thread.joinable( ))
+        return;
+
+    CString Directory = GetDirectory( );
+    if (Directory.IsEmpty( ))
+    {
+        PrintOut( _T( "Autosave disabled, no local application data folder" ) );
+        return;
+    }
+
+    CString LockPath;
+    LockPath.Format( _T( "%s\\%u.lock" ), Directory.GetString( ), GetCurrentProcessId( ) );
+    m_Path.Format( _T( "%s\\%u.ntsj" ), Directory.GetString( ), GetCurrentProcessId( ) );
+
+    // Gone with the process however it ends, FindOrphan checks for it
+    m_hLock = CreateFile( LockPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE, NULL );
+    if (m_hLock == INVALID_HANDLE_VALUE)
+    {
+        PrintOut( _T( "Autosave disabled, can't create \"%s\"" ), LockPath.GetString( ) );
+        return;
+    }
+
+    m_bStop = false;
+    m_Thread = std::thread( &CAutosaveJournal::Run, this );
+
+    Snapshot( );
+}
+
+void CAutosaveJournal::Stop( BOOLEAN bDelete )
+{
+    if (!m_Thread.joinable( ))
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_bStop = true;
+    }
+    m_Wake.notify_one( );
+    m_Thread.join( );
+
+    if (m_hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle( m_hFile );
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+
+    if (bDelete)
+        DeleteFile( m_Path );
+
+    CloseHandle( m_hLock );
+    m_hLock = INVALID_HANDLE_VALUE;
+
+    m_Dirty.clear( );
+    m_Journaled.clear( );
+    m_Checksums.clear( );
+}
+
+void CAutosaveJournal::MarkDirty( CNodeBase* pNode )
+{
+    // A vtable's functions hang off the vtable, the vtable off its class
+    while (pNode != NULL && pNode->GetParent( ) != NULL)
+        pNode = pNode->GetParent( );
+
+    if (pNode != NULL && pNode->GetType( ) == nt_class)
+        m_Dirty.insert( static_cast<CNodeClass*>(pNode) );
+}
+
+void CAutosaveJournal::MarkProjectDirty( )
+{
+    m_bSnapshot = TRUE;
+}
+
+void CAutosaveJournal::Flush( )
+{
+    std::vector<CNodeClass*>& Classes = g_ReClassApp.m_Classes;
+
+    if (!m_Thread.joinable( ))
+        return;
+
+    // Class records can only add classes at the end
+    if (Classes.size( ) < m_Journaled.size( ) || !std::equal( m_Journaled.begin( ), m_Journaled.end( ), Classes.begin( ) ))
+        m_bSnapshot = TRUE;
+
+    if (m_bSnapshot || m_JournalSize > AUTOSAVE_COMPACT_BYTES)
+    {
+        Snapshot( );
+        return;
+    }
+
+    if (m_Dirty.empty( ) && Classes.size( ) == m_Journaled.size( ))
+        return;
+
+    ProjectClassIndices ClassIndices;
+    g_ReClassApp.GetClassIndices( ClassIndices );
+
+    for (UINT i = 0; i < Classes.size( ); i++)
+    {
+        CNodeClass* pClass = Classes[i];
+        BOOLEAN bNew = (i >= m_Journaled.size( ));
+
+        if (!bNew && m_Dirty.find( pClass ) == m_Dirty.end( ))
+            continue;
+
+        std::vector<uint8_t> Image;
+        g_ReClassApp.BuildClassImage( pClass, ClassIndices, Image );
+
+        uint32_t ImageChecksum = Checksum( Image.data( ), Image.size( ) );
+        auto Last = m_Checksums.find( pClass );
+        if (!bNew && Last != m_Checksums.end( ) && Last->second == ImageChecksum)
+            continue;
+
+        m_Checksums[pClass] = ImageChecksum;
+        QueueRecord( AUTOSAVE_CLASS, i, Image );
+    }
+
+    m_Journaled = Classes;
+    m_Dirty.clear( );
+}
+
+void CAutosaveJournal::Snapshot( )
+{
+    std::vector<uint8_t> Image;
+    g_ReClassApp.BuildProjectImage( Image );
+
+    m_JournalSize = 0;
+    QueueRecord( AUTOSAVE_SNAPSHOT, 0, Image );
+
+    m_Journaled = g_ReClassApp.m_Classes;
+    m_Dirty.clear( );
+    m_Checksums.clear( );
+    m_bSnapshot = FALSE;
+}
+
+void CAutosaveJournal::QueueRecord( uint32_t Type, uint32_t Class, const std::vector<uint8_t>& Image )
+{
+    AUTOSAVE_RECORD Record;
+    Record.Type = Type;
+    Record.Size = (uint32_t)Image.size( );
+    Record.Class = Class;
+    Record.ClassCount = (uint32_t)g_ReClassApp.m_Classes.size( );
+    Record.Checksum = RecordChecksum( Record, Image.data( ) );
+
+    WriteJob Job;
+    Job.bSnapshot = (Type == AUTOSAVE_SNAPSHOT);
+    Job.Data.resize( sizeof( Record ) + Image.size( ) );
+    memcpy( Job.Data.data( ), &Record, sizeof( Record ) );
+    if (!Image.empty( ))
+        memcpy( Job.Data.data( ) + sizeof( Record ), Image.data( ), Image.size( ) );
+
+    m_JournalSize += Job.Data.size( );
+
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_Jobs.push_back( std::move( Job ) );
+    }
+    m_Wake.notify_one( );
+}
+
+void CAutosaveJournal::Run( )
+{
+    std::unique_lock<std::mutex> Lock( m_Mutex );
+    std::deque<WriteJob> Retry;     // A snapshot that couldn't be written and the records after it
+
+    for (;;)
+    {
+        m_Wake.wait( Lock, [this] { return m_bStop || !m_Jobs.empty( ); } );
+
+        // Whatever was queued before Stop is still written
+        if (m_Jobs.empty( ) && Retry.empty( ))
+            break;
+
+        bool bLast = m_bStop;
+        std::deque<WriteJob> Jobs;
+        Jobs.swap( Retry );
+        std::move( m_Jobs.begin( ), m_Jobs.end( ), std::back_inserter( Jobs ) );
+        m_Jobs.clear( );
+        Lock.unlock( );
+
+        // Everything before the last snapshot is replaced by it anyway
+        size_t First = 0;
+        for (size_t i = 0; i < Jobs.size( ); i++)
+        {
+            if (Jobs[i].bSnapshot)
+                First = i;
+        }
+
+        for (size_t i = First; i < Jobs.size( ); i++)
+        {
+            if (Jobs[i].bSnapshot)
+            {
+                if (!WriteSnapshot( Jobs[i].Data ))
+                {
+                    // Tried again when the next batch comes in, a later snapshot replaces it
+                    Retry.assign( std::make_move_iterator( Jobs.begin( ) + i ), std::make_move_iterator( Jobs.end( ) ) );
+                    break;
+                }
+            }
+            else if (m_hFile != INVALID_HANDLE_VALUE)
+            {
+                DWORD Written;
+                WriteFile( m_hFile, Jobs[i].Data.data( ), (DWORD)Jobs[i].Data.size( ), &Written, NULL );
+            }
+        }
+
+        // One flush for the whole batch
+        if (m_hFile != INVALID_HANDLE_VALUE)
+            FlushFileBuffers( m_hFile );
+
+        Lock.lock( );
+        if (bLast)
+            break;
+    }
+}
+
+//
+// The snapshot goes to a new file that replaces the journal once it is on
+// disk, the old journal stays valid until then.
+//
+BOOLEAN CAutosaveJournal::WriteSnapshot( const std::vector<uint8_t>& Data )
+{
+    AUTOSAVE_FILE_HEADER Header = { AUTOSAVE_MAGIC, AUTOSAVE_VERSION };
+    CString TempPath = m_Path + _T( ".tmp" );
+    DWORD Written;
+
+    //
+    // Records queued after this snapshot belong to it, not to the old journal.
+    // If the new one can't be written Run keeps them with the snapshot and
+    // nothing is appended until it gets through.
+    //
+    if (m_hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle( m_hFile );
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+
+    HANDLE hTemp = CreateFile( TempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+    if (hTemp == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    BOOL bWritten = WriteFile( hTemp, &Header, sizeof( Header ), &Written, NULL ) &&
+        WriteFile( hTemp, Data.data( ), (DWORD)Data.size( ), &Written, NULL ) &&
+        FlushFileBuffers( hTemp );
+    CloseHandle( hTemp );
+
+    if (!bWritten || !MoveFileEx( TempPath, m_Path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ))
+    {
+        DeleteFile( TempPath );
+        return FALSE;
+    }
+
+    m_hFile = CreateFile( m_Path, FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    return (m_hFile != INVALID_HANDLE_VALUE);
+}
+
+BOOLEAN CAutosaveJournal::FindOrphan( CString& Path )
+{
+    CString Directory = GetDirectory( );
+    WIN32_FIND_DATA FindData;
+    FILETIME Newest = { 0, 0 };
+    BOOLEAN bFound = FALSE;
+
+    if (Directory.IsEmpty( ))
+        return FALSE;
+
+    HANDLE hFind = FindFirstFile( Directory + _T( "\\*.ntsj" ), &FindData );
+    if (hFind == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    do
+    {
+        CString Name = FindData.cFileName;
+        if (Name.GetLength( ) <= 5 || Name.Right( 5 ).CompareNoCase( _T( ".ntsj" ) ) != 0)
+            continue;
+
+        // A running instance holds its lock open, the lock can't be deleted
+        CString LockPath = Directory + _T( "\\" ) + Name.Left( Name.GetLength( ) - 5 ) + _T( ".lock" );
+        if (!DeleteFile( LockPath ) && GetLastError( ) != ERROR_FILE_NOT_FOUND)
+            continue;
+
+        if (!bFound || CompareFileTime( &FindData.ftLastWriteTime, &Newest ) > 0)
+        {
+            Newest = FindData.ftLastWriteTime;
+            Path = Directory + _T( "\\" ) + Name;
+            bFound = TRUE;
+        }
+    } while (FindNextFile( hFind, &FindData ));
+
+    FindClose( hFind );
+    return bFound;
+}
+
+BOOLEAN CAutosaveJournal::Recover( const CString& Path )
+{
+    std::vector<uint8_t> Data;
+    std::vector<CNodeClass*> Placeholders;  // Created for classes whose records haven't come yet
+    AUTOSAVE_FILE_HEADER Header;
+    size_t Position = sizeof( AUTOSAVE_FILE_HEADER );
+    UINT Records = 0;
+
+    HANDLE hFile = CreateFile( Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER Size;
+        DWORD Read = 0;
+
+        if (GetFileSizeEx( hFile, &Size ) && Size.QuadPart < MAXDWORD)
+        {
+            Data.resize( (size_t)Size.QuadPart );
+            if (!ReadFile( hFile, Data.data( ), (DWORD)Data.size( ), &Read, NULL ))
+                Read = 0;
+            Data.resize( Read );
+        }
+        CloseHandle( hFile );
+    }
+
+    if (Data.size( ) < sizeof( Header ))
+    {
+        PrintOut( _T( "Autosave \"%s\" is empty or unreadable" ), Path.GetString( ) );
+        Discard( Path );
+        return FALSE;
+    }
+
+    memcpy( &Header, Data.data( ), sizeof( Header ) );
+    if (Header.Magic != AUTOSAVE_MAGIC || Header.Version != AUTOSAVE_VERSION)
+    {
+        PrintOut( _T( "Autosave \"%s\" has an unknown format" ), Path.GetString( ) );
+        Discard( Path );
+        return FALSE;
+    }
+
+    while (Data.size( ) - Position >= sizeof( AUTOSAVE_RECORD ))
+    {
+        AUTOSAVE_RECORD Record;
+        memcpy( &Record, Data.data( ) + Position, sizeof( Record ) );
+        Position += sizeof( Record );
+
+        // The machine went down while this record was written
+        if (Record.Size > Data.size( ) - Position)
+            break;
+
+        // Copied out, CProjectImage reads its tables in place and wants them aligned
+        std::vector<uint8_t> Image( Data.begin( ) + Position, Data.begin( ) + Position + Record.Size );
+        Position += Record.Size;
+
+        if (RecordChecksum( Record, Image.data( ) ) != Record.Checksum)
+            break;
+
+        if (Records == 0)
+        {
+            CProjectImage Project;
+            if (Record.Type != AUTOSAVE_SNAPSHOT || !Project.Open( Image.data( ), Image.size( ) ))
+                break;
+
+            g_ReClassApp.CloseProject( );
+            g_ReClassApp.LoadProjectImage( Project );
+        }
+        else
+        {
+            std::vector<CNodeClass*>& Classes = g_ReClassApp.m_Classes;
+
+            //
+            // Classes only get added, and every added class has a record of
+            // its own further on. A count past what the rest of the file can
+            // hold is garbage, not a project.
+            //
+            size_t MaxClasses = Classes.size( ) + 1 + (Data.size( ) - Position) / sizeof( AUTOSAVE_RECORD );
+            if (Record.Type != AUTOSAVE_CLASS || Record.Class >= Record.ClassCount ||
+                Record.ClassCount < Classes.size( ) || Record.ClassCount > MaxClasses)
+                break;
+
+            // Classes added in one flush may link to each other, all of them exist before the first is filled
+            while (Classes.size( ) < Record.ClassCount)
+            {
+                Classes.push_back( new CNodeClass );
+                Placeholders.push_back( Classes.back( ) );
+            }
+
+            if (!g_ReClassApp.LoadClassImage( Record.Class, Image.data( ), Image.size( ) ))
+                break;
+
+            Placeholders.erase( std::remove( Placeholders.begin( ), Placeholders.end( ), Classes[Record.Class] ), Placeholders.end( ) );
+        }
+
+        Records++;
+    }
+
+    //
+    // The journal ended before these were filled. One a recovered class links
+    // to stays as an empty class, the link would dangle otherwise.
+    //
+    for (CNodeClass* pPlaceholder : Placeholders)
+    {
+        if (g_ReClassApp.IsNodeRef( pPlaceholder ) != NULL)
+            continue;
+
+        std::vector<CNodeClass*>& Classes = g_ReClassApp.m_Classes;
+        Classes.erase( std::find( Classes.begin( ), Classes.end( ), pPlaceholder ) );
+        delete pPlaceholder;
+    }
+
+    Discard( Path );
+
+    if (Records == 0)
+    {
+        PrintOut( _T( "Autosave \"%s\" holds no usable project" ), Path.GetString( ) );
+        return FALSE;
+    }
+
+    g_ReClassApp.CalcAllOffsets( );
+
+    PrintOut( _T( "Recovered %u classes from the autosave (%u edits after the snapshot)" ), (UINT)g_ReClassApp.m_Classes.size( ), Records - 1 );
+    return TRUE;
+}
+
+void CAutosaveJournal::Discard( const CString& Path )
+{
+    DeleteFile( Path );
+}
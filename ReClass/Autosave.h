@@ -0,0 +1,131 @@
+#pragma once
+
+//
+// Autosave journal
+//
+// Keeps a copy of the open project that survives the machine going down
+// without rewriting the whole project on every edit. The journal
+// (%LOCALAPPDATA%\ReClassEx\Autosave\<pid>.ntsj) holds records of two
+// kinds:
+//
+//  - a snapshot, the whole project as a binary image (ProjectFormat.h),
+//    always the first record
+//  - a class record, one class as it is after an edit, serialized alone with
+//    its links as indices into the project's classes
+//
+// Replaying the records in order over the snapshot gives the project as of
+// the last flush. A torn record at the end (the machine went down while it
+// was being written) is ignored. The checksum covers the record header as
+// well as the image, a header is never trusted before it checks out.
+//
+// Edits mark the class they touched (MarkDirty). Once every
+// AUTOSAVE_FLUSH_INTERVAL the main frame calls Flush, which serializes the
+// dirty classes on the UI thread (a class is small) and hands the records to
+// a writer thread that appends them and flushes the file. A class whose
+// record comes out the same as the last one it wrote (a value was written to
+// memory, nothing in the class changed) isn't journaled again.
+//
+// New classes at the end of the list are journaled like edits. Removed or
+// reordered classes, edits spanning the whole project (header, notes, show
+// all) and a journal that grew past AUTOSAVE_COMPACT_BYTES take a new
+// snapshot instead, which the writer puts in a new file that replaces the
+// journal. If that file can't be written the snapshot and the records after
+// it are kept and tried again with the next batch. The snapshot image itself
+// is built on the UI thread: the nodes belong to it and nothing else may
+// walk them while they can be edited.
+//
+// A clean exit deletes the journal. One left behind by a process that is gone
+// is offered for recovery at startup.
+//
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#define AUTOSAVE_MAGIC          0x4A53544E  // "NTSJ"
+#define AUTOSAVE_VERSION        2
+
+#define AUTOSAVE_FLUSH_INTERVAL 1000        // ms
+#define AUTOSAVE_COMPACT_BYTES  (4 * 1024 * 1024)
+
+#define AUTOSAVE_SNAPSHOT       1
+#define AUTOSAVE_CLASS          2
+
+#pragma pack(push, 1)
+struct AUTOSAVE_FILE_HEADER {
+    uint32_t Magic;
+    uint32_t Version;
+};
+
+struct AUTOSAVE_RECORD {
+    uint32_t Type;          // AUTOSAVE_*
+    uint32_t Size;          // Of the image that follows
+    uint32_t Checksum;      // FNV-1a of this record, Checksum taken as 0, and the image
+    uint32_t Class;         // Class records: index of the class
+    uint32_t ClassCount;    // Classes in the project when it was written
+};
+#pragma pack(pop)
+
+class CAutosaveJournal {
+public:
+    CAutosaveJournal( );
+    ~CAutosaveJournal( );
+
+    // Starts a journal with a snapshot of the current project
+    void Start( );
+
+    // Stops the writer; a clean exit deletes the journal
+    void Stop( BOOLEAN bDelete );
+
+    // pNode, or the class it belongs to, was edited
+    void MarkDirty( CNodeBase* pNode );
+
+    // Something outside the classes changed, the next flush takes a snapshot
+    void MarkProjectDirty( );
+
+    void Flush( );
+
+    // A journal left behind by a session that didn't exit cleanly. Recover
+    // replaces the open project with it; both delete it afterwards.
+    static BOOLEAN FindOrphan( CString& Path );
+    BOOLEAN Recover( const CString& Path );
+    static void Discard( const CString& Path );
+
+private:
+    struct WriteJob {
+        BOOLEAN bSnapshot;
+        std::vector<uint8_t> Data;
+    };
+
+    static CString GetDirectory( );
+    static uint32_t Checksum( const void* Data, size_t Size, uint32_t Hash = 2166136261u );
+    static uint32_t RecordChecksum( const AUTOSAVE_RECORD& Record, const uint8_t* Image );
+
+    void Snapshot( );
+    void QueueRecord( uint32_t Type, uint32_t Class, const std::vector<uint8_t>& Image );
+
+    void Run( );
+    BOOLEAN WriteSnapshot( const std::vector<uint8_t>& Data );
+
+    // UI thread
+    std::unordered_set<CNodeClass*> m_Dirty;
+    std::vector<CNodeClass*> m_Journaled;                   // Classes in the order the journal has them
+    std::unordered_map<CNodeClass*, uint32_t> m_Checksums;  // Of each class's last record
+    BOOLEAN m_bSnapshot;
+    uint64_t m_JournalSize;
+
+    // Writer thread
+    CString m_Path;
+    HANDLE m_hFile;
+    HANDLE m_hLock;         // Held while running, tells other instances the journal isn't orphaned
+
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::deque<WriteJob> m_Jobs;
+    bool m_bStop;
+};
+
+extern CAutosaveJournal g_Autosave;
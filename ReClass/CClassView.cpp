@@ -13,7 +13,9 @@
 // CChildView
 CClassView::CClassView( ) :
     m_pClass( NULL ),
-    m_bTracking( FALSE )
+    m_bTracking( FALSE ),
+    m_LayoutGeneration( 0 ),
+    m_ViewGeneration( 0 )
 {
 }
 
@@ -36,7 +38,7 @@ BEGIN_MESSAGE_MAP( CClassView, CWnd )
     ON_WM_MOUSEWHEEL( )
     ON_WM_MOUSEHOVER( )
     ON_WM_MOUSEMOVE( )
-    ON_WM_TIMER( )
+    ON_WM_DESTROY( )
 
     ON_COMMAND( ID_ADD_ADD4, &CClassView::OnAddAdd4 )
     ON_COMMAND( ID_ADD_ADD8, &CClassView::OnAddAdd8 )
@@ -200,23 +202,108 @@ int CClassView::OnCreate( LPCREATESTRUCT lpCreateStruct )
     SetWindowTheme(m_Scroll.GetSafeHwnd(), L"DarkMode_Explorer", nullptr);
     SetWindowTheme(m_HScroll.GetSafeHwnd(), L"DarkMode_Explorer", nullptr);
 
-    SetTimer( 1, 250, NULL );
+    g_RefreshScheduler.Register( this );
 
     return 0;
 }
 
-void CClassView::OnTimer( UINT_PTR nIDEvent )
+void CClassView::OnDestroy( )
 {
-    if (nIDEvent == 1)
+    g_RefreshScheduler.Unregister( this );
+
+    CWnd::OnDestroy( );
+}
+
+void CClassView::InvalidateChanged( )
+{
+    if (m_pClass == NULL || !IsWindowVisible( ))
+        return;
+
+    //
+    // Nodes, settings or symbols changed, or rows are still fading out of
+    // the change highlight: everything may look different
+    //
+    if (m_LayoutGeneration != g_LayoutGeneration || m_ViewGeneration != g_ViewGeneration ||
+        (g_bHighlightChanges && m_Changes.GetYoungestAge( ) < g_ChangeFadeFrames))
+    {
         CWnd::Invalidate( FALSE );
+        return;
+    }
+
+    //
+    // Otherwise only memory can change what's on screen. Read what the last
+    // paint read and repaint the rows whose bytes differ, the paint reuses
+    // the data just read.
+    //
+    double Start = CRefreshScheduler::Now( );
+    BOOLEAN bChanged = m_ReadPlanner.Refresh( ReClassGetMemorySource( ), m_Changed );
+    g_RefreshScheduler.AddCost( this, CRefreshScheduler::Now( ) - Start );
+    if (!bChanged)
+    {
+        // Nothing to paint, keep the achieved rate in the status bar current
+        UpdateReadStatus( );
+        return;
+    }
+
+    CRect ClientRect;
+    GetClientRect( &ClientRect );
+
+    for (const CReadPlanner::ReadRange& Range : m_Changed)
+    {
+        BOOLEAN bFound = FALSE;
+        for (const CHotspotList::Entry& Spot : m_Hotspots)
+        {
+            if (Spot.Type != HS_SELECT || Spot.Object == NULL)
+                continue;
 
-    CWnd::OnTimer( nIDEvent );
+            ULONG_PTR End = Spot.Address + Spot.Object->GetMemorySize( );
+            if (Spot.Address < Range.End && End > Range.Start)
+            {
+                CRect Row( ClientRect.left, Spot.Rect.top, ClientRect.right, Spot.Rect.bottom );
+                InvalidateRect( &Row, FALSE );
+                bFound = TRUE;
+            }
+        }
+
+        // Read for something without a row of its own (a comment's string preview)
+        if (!bFound)
+        {
+            CWnd::Invalidate( FALSE );
+            return;
+        }
+    }
+}
+
+void CClassView::UpdateReadStatus( )
+{
+    CString ReadStatus;
+    CRefreshScheduler::ViewStats Refresh;
+    CMFCStatusBar* StatusBar = g_ReClassApp.GetStatusBar( );
+
+    if (StatusBar == NULL || StatusBar->GetSafeHwnd( ) == NULL)
+        return;
+
+    // The pane belongs to the active view, tiled views painting behind it leave it alone
+    BOOLEAN bStats = g_RefreshScheduler.GetStats( this, Refresh );
+    if (bStats && Refresh.State == CRefreshScheduler::REFRESH_BACKGROUND)
+        return;
+
+    ReadStatus.Format( _T( "Reads: %u hit / %u miss (%u batched)" ),
+        m_ReadPlanner.GetHits( ), m_ReadPlanner.GetMisses( ), m_ReadPlanner.GetBatchedRanges( ) );
+
+    // Achieved refresh rate against what the view is allowed, the interval shows when it backed off
+    if (bStats && Refresh.Budget != 0)
+        ReadStatus.AppendFormat( _T( " | Refresh: %.1f/%.1f Hz (%u ms, %.1f ms each)" ),
+            Refresh.Rate, 1000.0 / Refresh.Budget, Refresh.Interval, Refresh.Cost );
+
+    if (ReadStatus != StatusBar->GetPaneText( 2 ))
+        StatusBar->SetPaneText( 2, ReadStatus );
 }
 
 void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
 {
     std::vector<HOTSPOT>::iterator FirstSelected;
-    std::vector<HOTSPOT>::iterator Found;
+    CHotspotList::const_iterator Found;
     CNodePtr* PtrNode;
     CNodeClass* ClassNode;
     CNodeBase* FindNode;
@@ -233,13 +320,13 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
                 FindNode = static_cast<CNodeBase*>(PtrNode->GetClass( ));
 
                 Found = std::find_if( m_Hotspots.begin( ), m_Hotspots.end( ),
-                    [FindNode]( const HOTSPOT hs ) { return (hs.Object == FindNode); } );
+                    [FindNode]( const CHotspotList::Entry& hs ) { return (hs.Object == FindNode); } );
                 if (Found != m_Hotspots.end( ))
                 {
                     // Select the found hotspot
                     ClearSelection( );
                     Found->Object->Select( );
-                    m_Selected.push_back( *Found );
+                    m_Selected.push_back( m_Hotspots.ToHotspot( *Found ) );
                 }
             }
             else if (FirstSelected->Object->GetType( ) == nt_class)
@@ -248,12 +335,12 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
                 FindNode = static_cast<CNodeBase*>(ClassNode->GetNode( 0 ));
 
                 Found = std::find_if( m_Hotspots.begin( ), m_Hotspots.end( ),
-                    [FindNode]( const HOTSPOT hs ) { return (hs.Object == FindNode); } );
+                    [FindNode]( const CHotspotList::Entry& hs ) { return (hs.Object == FindNode); } );
                 if (Found != m_Hotspots.end( ))
                 {
                     ClearSelection( );
                     Found->Object->Select( );
-                    m_Selected.push_back( *Found );
+                    m_Selected.push_back( m_Hotspots.ToHotspot( *Found ) );
                 }
             }
             else
@@ -263,7 +350,7 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
                     FindAddress = FirstSelected->Address + FirstSelected->Object->GetMemorySize( );
 
                     Found = std::find_if( m_Hotspots.begin( ), m_Hotspots.end( ),
-                        [FindAddress] ( const HOTSPOT hs ) { return (hs.Address == FindAddress); } );
+                        [FindAddress] ( const CHotspotList::Entry& hs ) { return (hs.Address == FindAddress); } );
                     if (Found != m_Hotspots.end( ))
                     {
                         if (Found->Address == m_Hotspots.back( ).Address)
@@ -274,7 +361,7 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
 
                         ClearSelection( );
                         Found->Object->Select( );
-                        m_Selected.push_back( *Found );
+                        m_Selected.push_back( m_Hotspots.ToHotspot( *Found ) );
                     }
                     //else // Not found
                     //{
@@ -314,7 +401,7 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
             FindAddress = FirstSelected->Address;
 
             Found = std::find_if( m_Hotspots.begin( ), m_Hotspots.end( ),
-                [FindAddress]( const HOTSPOT hs ) { return (hs.Address == FindAddress); } );
+                [FindAddress]( const CHotspotList::Entry& hs ) { return (hs.Address == FindAddress); } );
             if (Found != m_Hotspots.end( ))
             {
                 ClearSelection( );
@@ -324,7 +411,7 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
                     Found--;
 
                 Found->Object->Select( );
-                m_Selected.push_back( *Found );
+                m_Selected.push_back( m_Hotspots.ToHotspot( *Found ) );
             }
             //// Bring selected node into view
             //else
@@ -346,6 +433,7 @@ void CClassView::OnKeyDown( UINT nChar, UINT nRepCnt, UINT nFlags )
             UINT idx = FindNodeIndex( m_Selected[i].Object );
             if (idx != MAX_NODES)
             {
+                MarkClassEdited( ParentClass );
                 ParentClass->DeleteNode( idx );
                 g_ReClassApp.CalcAllOffsets( );
             }
@@ -361,7 +449,7 @@ void CClassView::OnLButtonDblClk( UINT nFlags, CPoint point )
 {
     CWnd::OnLButtonDblClk( nFlags, point );
 
-    for (UINT i = 0; i < m_Hotspots.size( ); i++)
+    for (UINT i : m_Hotspots.GetRow( point.y ))
     {
         if (m_Hotspots[i].Rect.PtInRect( point ))
         {
@@ -378,9 +466,9 @@ void CClassView::OnLButtonDblClk( UINT nFlags, CPoint point )
                     m_Hotspots[i].Rect.Height( ), 
                     SWP_NOZORDER );
 
-                m_Edit.m_Hotspot = m_Hotspots[i];
+                m_Edit.m_Hotspot = m_Hotspots.ToHotspot( m_Hotspots[i] );
                 m_Edit.m_MinWidth = m_Edit.m_Hotspot.Rect.Width( );
-                m_Edit.SetWindowText( m_Hotspots[i].Text );
+                m_Edit.SetWindowText( m_Hotspots.GetText( m_Hotspots[i] ) );
                 m_Edit.ShowWindow( SW_NORMAL );
                 m_Edit.SetFocus( );
                 //m_Edit.CreateSolidCaret(FontWidth,FontHeight);
@@ -471,12 +559,19 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
     CNodeBase* SelectedNode;
     CNodeClass* SelectedParentClassNode;
     UINT Idx1, Idx2;
-    size_t i, s, j, m;
+    size_t h, i, s, j, m;
+    std::vector<UINT> Hits;
 
     m_Edit.ShowWindow( SW_HIDE );
 
-    for (i = 0; i < m_Hotspots.size( ); i++)
+    //
+    // The menus below run a modal loop that can repaint and rebuild
+    // m_Hotspots, so walk a copy of the hits instead of the row itself
+    //
+    m_Hotspots.HitTest( point, Hits );
+    for (h = 0; h < Hits.size( ) && Hits[h] < m_Hotspots.size( ); h++)
     {
+        i = Hits[h];
         if (m_Hotspots[i].Rect.PtInRect( point ))
         {
             ObjectHit = static_cast<CNodeBase*>(m_Hotspots[i].Object);
@@ -488,7 +583,10 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
 
             if (m_Hotspots[i].Type == HS_CLICK)
             {
-                ObjectHit->Update( &m_Hotspots[i] );
+                HOTSPOT Clicked = m_Hotspots.ToHotspot( m_Hotspots[i] );
+                ObjectHit->Update( &Clicked );
+                MarkClassEdited( ObjectHit );
+                m_ReadPlanner.Invalidate( ); // Update may have written memory
             }
 
             if (m_Hotspots[i].Type == HS_SELECT)
@@ -501,7 +599,7 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
 
                     ObjectHit->Select( );
 
-                    m_Selected.push_back( m_Hotspots[i] );
+                    m_Selected.push_back( m_Hotspots.ToHotspot( m_Hotspots[i] ) );
                 }
                 if (nFlags == (MK_LBUTTON | MK_CONTROL))
                 {
@@ -509,7 +607,7 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
 
                     if (ObjectHit->IsSelected( ))
                     {
-                        m_Selected.push_back( m_Hotspots[i] );
+                        m_Selected.push_back( m_Hotspots.ToHotspot( m_Hotspots[i] ) );
                     }
                     else
                     {
@@ -586,6 +684,7 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
                     Idx1 = FindNodeIndex( m_Selected[s].Object );
                     if (Idx1 != MAX_NODES)
                     {
+                        MarkClassEdited( SelectedParentClassNode );
                         SelectedParentClassNode->DeleteNode( Idx1 );
                         g_ReClassApp.CalcAllOffsets( );
                     }
@@ -604,7 +703,7 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
                 CRect pos = { 0 };
                 CNodeBase* pNode = NULL;
 
-                ExchangeTarget = m_Hotspots[i];
+                ExchangeTarget = m_Hotspots.ToHotspot( m_Hotspots[i] );
 
                 pos = ExchangeTarget.Rect;
                 ClientToScreen( &pos );
@@ -653,8 +752,9 @@ void CClassView::OnLButtonDown( UINT nFlags, CPoint point )
 
 void CClassView::OnRButtonDown( UINT nFlags, CPoint point )
 {
-    size_t i;
+    size_t h, i;
     CNodeBase* ObjectHit;
+    std::vector<UINT> Hits;
 
     m_Edit.ShowWindow( SW_HIDE );
 
@@ -689,15 +789,21 @@ void CClassView::OnRButtonDown( UINT nFlags, CPoint point )
     //  }
     //}
 
-    for (i = 0; i < m_Hotspots.size( ); i++)
+    // Copied for the same reason as in OnLButtonDown
+    m_Hotspots.HitTest( point, Hits );
+    for (h = 0; h < Hits.size( ) && Hits[h] < m_Hotspots.size( ); h++)
     {
+        i = Hits[h];
         if (m_Hotspots[i].Rect.PtInRect( point ))
         {
             ObjectHit = m_Hotspots[i].Object;
 
             if (m_Hotspots[i].Type == HS_CLICK)
             {
-                ObjectHit->Update( &m_Hotspots[i] );
+                HOTSPOT Clicked = m_Hotspots.ToHotspot( m_Hotspots[i] );
+                ObjectHit->Update( &Clicked );
+                MarkClassEdited( ObjectHit );
+                m_ReadPlanner.Invalidate( ); // Update may have written memory
             }
             else if (m_Hotspots[i].Type == HS_SELECT)
             {
@@ -706,7 +812,7 @@ void CClassView::OnRButtonDown( UINT nFlags, CPoint point )
                     ClearSelection( );
 
                     ObjectHit->Select( );
-                    m_Selected.push_back( m_Hotspots[i] );
+                    m_Selected.push_back( m_Hotspots.ToHotspot( m_Hotspots[i] ) );
 
                     CRect ClientRect;
                     GetClientRect( &ClientRect );
@@ -733,6 +839,7 @@ void CClassView::OnPaint( )
     CMemDC MemDC( PaintDC, this );
     CDC *Dc = &MemDC.GetDC( );
        
+    CGdiRenderSink Renderer( Dc );
     VIEWINFO ViewInfo;
     ULONG ClassSize;
     int XPos, YPos;
@@ -748,11 +855,25 @@ void CClassView::OnPaint( )
     {
         Dc->SelectObject( &g_ViewFont );
 
-        m_Hotspots.clear( );
+        m_Hotspots.Clear( );
+        m_LayoutGeneration = g_LayoutGeneration;
+        m_ViewGeneration = g_ViewGeneration;
+
+        double PaintStart = CRefreshScheduler::Now( );
+
+        //
+        // Everything read from here on goes through the planner, which already
+        // fetched what the last frame needed in one batch
+        //
+        m_ReadPlanner.BeginFrame( ReClassGetMemorySource( ) );
 
         ClassSize = m_pClass->GetMemorySize( );
         m_Memory.SetSize( ClassSize );
         ReClassReadMemory( (LPVOID)m_pClass->GetOffset( ), m_Memory.Data( ), ClassSize );
+        if (g_bHighlightChanges)
+            m_Changes.Update( m_pClass->GetOffset( ), m_Memory.Data( ), ClassSize );
+        else
+            m_Changes.Reset( );
 
         #ifdef _DEBUG
         ViewInfo.pChildView = this; // For testing
@@ -761,9 +882,10 @@ void CClassView::OnPaint( )
         ViewInfo.Data = m_Memory.Data( );
         ViewInfo.Classes = &g_ReClassApp.m_Classes;
         ViewInfo.ClientRect = &ClientRect;
-        ViewInfo.Dc = Dc;
+        ViewInfo.Renderer = &Renderer;
         ViewInfo.Level = 0;
         ViewInfo.Hotspots = &m_Hotspots;
+        ViewInfo.Changes = g_bHighlightChanges ? &m_Changes : NULL;
         ViewInfo.MultiSelected = (BOOL)(m_Selected.size( ) > 1);
 
         if (m_Scroll.IsWindowVisible( ))
@@ -779,6 +901,11 @@ void CClassView::OnPaint( )
         // Do the draw!
         //
         DrawMax = m_pClass->Draw( &ViewInfo, 0 - XPos, -YPos );
+        m_Hotspots.Finish( g_FontHeight );
+
+        m_ReadPlanner.EndFrame( );
+        g_RefreshScheduler.AddCost( this, CRefreshScheduler::Now( ) - PaintStart );
+        UpdateReadStatus( );
 
         // Dirty hack, fix Draw methods
         DrawMax.x += XPos;
@@ -947,7 +1074,7 @@ void CClassView::OnMouseHover( UINT nFlags, CPoint point )
     else
     {
         BYTE data[16];
-        for (UINT i = 0; i < m_Hotspots.size( ); i++)
+        for (UINT i : m_Hotspots.GetRow( point.y ))
         {
             if (m_Hotspots[i].Rect.PtInRect( point ))
             {
@@ -1172,6 +1299,8 @@ void CClassView::ReplaceNode( CNodeClass* pClass, UINT Index, CNodeBase* pNewNod
     if (!pClass || Index == MAX_NODES)
         return;
 
+    MarkClassEdited( pClass );
+
     CNodeBase* pOldNode = pClass->GetNode( Index );
     pNewNode->SetName( pOldNode->GetName( ) );
     pNewNode->SetComment( pOldNode->GetComment( ) );
@@ -1216,11 +1345,14 @@ void CClassView::RemoveNodes( CNodeClass* pClass, UINT Index, DWORD Length )
     if (!pClass || Index == MAX_NODES)
         return;
 
+    MarkClassEdited( pClass );
+
+    const NodeRecords& Records = pClass->GetRecords( );
     UINT t = 0;
     DWORD totalSize = 0;
-    for (UINT i = Index; i < pClass->NodeCount( ); i++)
+    for (UINT i = Index; i < Records.Sizes.size( ); i++)
     {
-        totalSize += pClass->GetNode( i )->GetMemorySize( );
+        totalSize += Records.Sizes[i];
         t++;
         if (totalSize >= Length)
             break;
@@ -1313,6 +1445,8 @@ void CClassView::ResizeNode( CNodeClass* pClass, UINT Index, DWORD Before, DWORD
     if (!pClass || Index == MAX_NODES)
         return;
 
+    MarkClassEdited( pClass );
+
     if (Before != After)
     {
         if (After < Before)
@@ -1333,6 +1467,8 @@ void CClassView::AddBytes( CNodeClass* pClass, DWORD Length )
     if (!pClass)
         return;
 
+    MarkClassEdited( pClass );
+
     // Ghetto fix for adding 4 bytes in 64 bit
     if (Length == 4)
     {
@@ -1381,6 +1517,8 @@ void CClassView::InsertBytes( CNodeClass* pClass, UINT Index, DWORD Length )
     if (!pClass || Index == MAX_NODES)
         return;
 
+    MarkClassEdited( pClass );
+
     // Ghetto fix for adding 4 bytes in 64 bit
     if (Length == 4)
     {
@@ -2056,6 +2194,7 @@ void CClassView::OnModifyDelete( )
         UINT idx = FindNodeIndex( m_Selected[i].Object );
         if (idx != MAX_NODES)
         {
+            MarkClassEdited( pClass );
             pClass->DeleteNode( idx );
             g_ReClassApp.CalcAllOffsets( );
         }
@@ -2081,7 +2220,10 @@ void CClassView::OnUpdateModifyShow( CCmdUI *pCmdUI )
 void CClassView::OnModifyHide( )
 {
     for (UINT i = 0; i < m_Selected.size( ); i++)
+    {
         m_Selected[i].Object->Hide( );
+        MarkClassEdited( m_Selected[i].Object );
+    }
     Invalidate( FALSE );
 }
 
@@ -2097,6 +2239,7 @@ void CClassView::OnButtonEditCode( )
     EditDialog.Text = m_pClass->m_Code;
     EditDialog.DoModal( );
     m_pClass->m_Code = EditDialog.Text;
+    MarkClassEdited( m_pClass );
 }
 
 BOOL CClassView::OnCmdMsg( UINT nID, int nCode, void* pExtra, AFX_CMDHANDLERINFO* pHandlerInfo )
@@ -2134,6 +2277,7 @@ BOOL CClassView::OnCmdMsg( UINT nID, int nCode, void* pExtra, AFX_CMDHANDLERINFO
                 static_cast<CNodePtr*>(pNode)->SetClass( g_ReClassApp.m_Classes[nIdx] );
             }
 
+            MarkClassEdited( pNode );
             g_ReClassApp.CalcAllOffsets( );
 
             return TRUE;
@@ -2181,6 +2325,7 @@ void CClassView::OnButtonZero( )
         SecureZeroMemory( mem.Data( ), size );
         ReClassWriteMemory( (LPVOID)m_Selected[i].Address, mem.Data( ), size );
     }
+    m_ReadPlanner.Invalidate( );
 }
 
 void CClassView::OnUpdateButtonZero( CCmdUI *pCmdUI )
@@ -2198,6 +2343,7 @@ void CClassView::OnButtonOne( )
         memset( mem.Data( ), 1, size );
         ReClassWriteMemory( (LPVOID)m_Selected[i].Address, mem.Data( ), size );
     }
+    m_ReadPlanner.Invalidate( );
 }
 
 void CClassView::OnUpdateButtonOne( CCmdUI *pCmdUI )
@@ -2219,6 +2365,7 @@ void CClassView::OnButtonRandom( )
             pMemory[i] = rand( );
         ReClassWriteMemory( (LPVOID)m_Selected[i].Address, pMemory, size );
     }
+    m_ReadPlanner.Invalidate( );
 }
 
 void CClassView::OnUpdateButtonRandom( CCmdUI *pCmdUI )
@@ -2243,6 +2390,7 @@ void CClassView::OnButtonSwap( )
 
         ReClassWriteMemory( (LPVOID)m_Selected[i].Address, pMemory, size );
     }
+    m_ReadPlanner.Invalidate( );
 }
 
 void CClassView::OnUpdateButtonSwap( CCmdUI *pCmdUI )
@@ -3,6 +3,7 @@
 #define MAX_NODES 32768
 
 #include "CMemory.h"
+#include "ReadPlanner.h"
 
 #include "CCustomEdit.h"
 #include "CCustomToolTip.h"
@@ -36,6 +37,9 @@ public:
 
     void		StandardTypeUpdate( CCmdUI *pCmdUI );
 
+    void		UpdateReadStatus( );
+    void		InvalidateChanged( );     // Called by g_RefreshScheduler
+
     // Generated message map functions
 public:
     virtual BOOL OnCmdMsg( UINT nID, int nCode, void* pExtra, AFX_CMDHANDLERINFO* pHandlerInfo );
@@ -56,7 +60,7 @@ public:
     afx_msg BOOL OnMouseWheel( UINT nFlags, short zDelta, CPoint pt );
     afx_msg void OnMouseHover( UINT nFlags, CPoint point );
     afx_msg void OnMouseMove( UINT nFlags, CPoint point );
-    afx_msg void OnTimer( UINT_PTR nIDEvent );
+    afx_msg void OnDestroy( );
 
     afx_msg void OnAddAdd4( );
     afx_msg void OnUpdateAddAdd4( CCmdUI *pCmdUI );
@@ -218,8 +222,15 @@ private:
 
 public:
     CMemory m_Memory;
+    CChangeTracker m_Changes;
+    CReadPlanner m_ReadPlanner;
+
+    // What the last paint drew, InvalidateChanged only repaints what changed since
+    DWORD m_LayoutGeneration;
+    DWORD m_ViewGeneration;
+    std::vector<CReadPlanner::ReadRange> m_Changed;
 
-    std::vector<HOTSPOT> m_Hotspots;
+    CHotspotList m_Hotspots;
     std::vector<HOTSPOT> m_Selected;
     HOTSPOT ExchangeTarget;
 
@@ -40,6 +40,8 @@ void CCustomEdit::OnChar( UINT nChar, UINT nRepCnt, UINT nFlags )
 
         Before = HotspotNode->GetMemorySize( );
         HotspotNode->Update( &m_Hotspot );
+        MarkClassEdited( HotspotNode );
+        ClassView->m_ReadPlanner.Invalidate( ); // The value was written, don't paint what Refresh fetched before
         After = HotspotNode->GetMemorySize( );
 
         HotspotNodeIndex = ClassView->FindNodeIndex( HotspotNode );
@@ -11,9 +11,10 @@
 
 #include "DarkThemeManager.h"
 
-UINT BASED_CODE CMainFrame::s_StatusBarPanes[2] = { 
+UINT BASED_CODE CMainFrame::s_StatusBarPanes[3] = { 
     ID_STATUSBAR_PANE1,
-    ID_STATUSBAR_PANE2
+    ID_STATUSBAR_PANE2,
+    ID_STATUSBAR_PANE3
 };
 
 // CMainFrame
@@ -21,6 +22,10 @@ IMPLEMENT_DYNAMIC( CMainFrame, CMDIFrameWndEx )
 
 BEGIN_MESSAGE_MAP( CMainFrame, CMDIFrameWndEx )
     ON_WM_TIMER( )
+    ON_MESSAGE( WM_MODULEEVENT, &CMainFrame::OnModuleEvent )
+    ON_MESSAGE( WM_SYMBOLSLOADED, &CMainFrame::OnSymbolsLoaded )
+    ON_MESSAGE( WM_PRINTOUT, &CMainFrame::OnPrintOut )
+    ON_MESSAGE( WM_MEMORYMAP, &CMainFrame::OnMemoryMap )
     ON_WM_CREATE( )
     ON_WM_SIZE( )
     ON_WM_SETTINGCHANGE( )
@@ -105,11 +110,13 @@ int CMainFrame::OnCreate( LPCREATESTRUCT lpCreateStruct )
     // Create status bar
     //
     m_StatusBar.Create( this );
-    m_StatusBar.SetIndicators( s_StatusBarPanes, 2 );
+    m_StatusBar.SetIndicators( s_StatusBarPanes, 3 );
     m_StatusBar.SetPaneInfo( 0, ID_STATUSBAR_PANE1, SBPS_NORMAL, 0 );
     m_StatusBar.SetPaneInfo( 1, ID_STATUSBAR_PANE2, SBPS_STRETCH, 0 );
+    m_StatusBar.SetPaneInfo( 2, ID_STATUSBAR_PANE3, SBPS_NORMAL, 260 );
     m_StatusBar.SetPaneBackgroundColor(0, RGB(31, 31, 31));
     m_StatusBar.SetPaneBackgroundColor(1, RGB(31, 31, 31));
+    m_StatusBar.SetPaneBackgroundColor(2, RGB(31, 31, 31));
 
     //
     // Enable Visual Studio 2005 style docking window behavior
@@ -152,6 +159,10 @@ int CMainFrame::OnCreate( LPCREATESTRUCT lpCreateStruct )
     ModifyStyle( 0, FWS_PREFIXTITLE );
 
     SetTimer( TIMER_MEMORYMAP_UPDATE, 30, NULL );
+    SetTimer( TIMER_VIEW_REFRESH, REFRESH_TICK, NULL );
+    SetTimer( TIMER_AUTOSAVE, AUTOSAVE_FLUSH_INTERVAL, NULL );
+    g_MemoryMapScanner.Start( GetSafeHwnd( ), 250 );
+    g_hPrintOutWnd = GetSafeHwnd( );
 
     CMFCVisualManager::SetDefaultManager(RUNTIME_CLASS(CMFCDarkThemeManager));
 
@@ -164,8 +175,8 @@ void CMainFrame::OnSize( UINT nType, int cx, int cy )
 
     RepositionBars( AFX_IDW_CONTROLBAR_FIRST, AFX_IDW_CONTROLBAR_LAST, ID_STATUSBAR_PANE2 );
 
-    if (m_StatusBar.GetSafeHwnd( ) && cx > 250)
-        m_StatusBar.SetPaneInfo( 0, ID_STATUSBAR_PANE1, SBPS_NORMAL, cx - 250 );
+    if (m_StatusBar.GetSafeHwnd( ) && cx > 510)
+        m_StatusBar.SetPaneInfo( 0, ID_STATUSBAR_PANE1, SBPS_NORMAL, cx - 510 );
 }
 
 BOOL CMainFrame::PreCreateWindow( CREATESTRUCT& cs )
@@ -221,6 +232,10 @@ BOOL CMainFrame::OnCmdMsg( UINT nID, int nCode, void* pExtra, AFX_CMDHANDLERINFO
     CClassFrame *pChildClassFrame;
     CNodeClass *pClass;
 
+    // Toggles and edits change what the views draw, let them repaint
+    if (nCode == CN_COMMAND)
+        g_ViewGeneration++;
+
     if (nCode == CN_UPDATE_COMMAND_UI)
     {
         pCmdUi = (CCmdUI*)pExtra;
@@ -419,12 +434,93 @@ void CMainFrame::OnUpdateButtonDeleteClass( CCmdUI *pCmdUI )
 
 void CMainFrame::OnTimer( UINT_PTR nIDEvent )
 {
-    if (nIDEvent == TIMER_MEMORYMAP_UPDATE)
-        UpdateMemoryMap( );
+    //
+    // The map itself is rebuilt by g_MemoryMapScanner, the timer only notices
+    // the target going away so the UI drops the handle right away
+    //
+    if (nIDEvent == TIMER_MEMORYMAP_UPDATE && g_hProcess != NULL && !IsProcessHandleValid( g_hProcess ))
+    {
+        g_hProcess = NULL;
+        ReClassSelectMemorySource( );
+        g_RttiCache.Clear( );
+        g_MemoryMapScanner.Refresh( );
+    }
+
+    if (nIDEvent == TIMER_VIEW_REFRESH)
+        g_RefreshScheduler.Tick( );
+
+    if (nIDEvent == TIMER_AUTOSAVE)
+        g_Autosave.Flush( );
 
     CMDIFrameWndEx::OnTimer( nIDEvent );
 }
 
+LRESULT CMainFrame::OnModuleEvent( WPARAM wParam, LPARAM lParam )
+{
+    MemMapInfo* Module = (MemMapInfo*)lParam;
+
+    #ifdef _WIN64
+    PrintOut( _T( "Module %s: %s (0x%IX - 0x%IX)" ), (wParam == MODULE_EVENT_LOADED) ? _T( "loaded" ) : _T( "unloaded" ),
+              Module->Name.GetString( ), Module->Start, Module->End );
+    #else
+    PrintOut( _T( "Module %s: %s (0x%X - 0x%X)" ), (wParam == MODULE_EVENT_LOADED) ? _T( "loaded" ) : _T( "unloaded" ),
+              Module->Name.GetString( ), Module->Start, Module->End );
+    #endif
+
+    // Anything cached about the old image is stale, the next one may load at the same address
+    if (wParam == MODULE_EVENT_UNLOADED)
+    {
+        g_RttiCache.Invalidate( Module->Start, Module->End );
+        if (g_ReClassApp.m_pSymbolLoader != NULL)
+            g_ReClassApp.m_pSymbolLoader->DropModuleSymbols( Module->Start );
+    }
+
+    // Module names next to pointers
+    g_ViewGeneration++;
+
+    delete Module;
+    return 0;
+}
+
+LRESULT CMainFrame::OnSymbolsLoaded( WPARAM wParam, LPARAM lParam )
+{
+    ULONG Done, Total;
+    TCHAR ProgressText[256];
+
+    if (g_ReClassApp.m_pSymbolLoader == NULL)
+        return 0;
+
+    g_ReClassApp.m_pSymbolLoader->GetLoadProgress( &Done, &Total );
+    g_ViewGeneration++;
+    if (Done < Total)
+    {
+        _stprintf_s( ProgressText, _T( "Symbols loading: [%u/%u]" ), Done, Total );
+        m_StatusBar.SetPaneText( 1, ProgressText );
+    }
+    else
+    {
+        m_StatusBar.SetPaneText( 1, _T( "" ) );
+    }
+
+    return 0;
+}
+
+LRESULT CMainFrame::OnPrintOut( WPARAM wParam, LPARAM lParam )
+{
+    CString* Line = (CString*)lParam;
+
+    ReClassPrintText( Line->GetString( ) );
+
+    delete Line;
+    return 0;
+}
+
+LRESULT CMainFrame::OnMemoryMap( WPARAM wParam, LPARAM lParam )
+{
+    ApplyMemoryMap( );
+    return 0;
+}
+
 void CMainFrame::OnCheckTopmost( )
 {
     g_bTop = !g_bTop;
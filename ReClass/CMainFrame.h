@@ -5,6 +5,8 @@
 #include "CProgressBar.h"
 
 #define TIMER_MEMORYMAP_UPDATE 0xDEADF00D
+#define TIMER_VIEW_REFRESH 0xDEADF00E
+#define TIMER_AUTOSAVE 0xDEADF00F
 
 class CMainFrame : public CMDIFrameWndEx {
     DECLARE_DYNAMIC( CMainFrame )
@@ -35,7 +37,7 @@ public:  // control bar embedded members
     CMFCRibbonApplicationButton m_MainButton;
     CMFCToolBarImages m_PanelImages;
 
-    static UINT BASED_CODE s_StatusBarPanes[2];
+    static UINT BASED_CODE s_StatusBarPanes[3];
     CMFCStatusBar m_StatusBar;
 
 // Generated message map functions
@@ -69,6 +71,10 @@ public:
     afx_msg void OnButtonDeleteClass( );
     afx_msg void OnUpdateButtonDeleteClass( CCmdUI *pCmdUI );
     afx_msg void OnTimer( UINT_PTR nIDEvent );
+    afx_msg LRESULT OnModuleEvent( WPARAM wParam, LPARAM lParam );
+    afx_msg LRESULT OnSymbolsLoaded( WPARAM wParam, LPARAM lParam );
+    afx_msg LRESULT OnPrintOut( WPARAM wParam, LPARAM lParam );
+    afx_msg LRESULT OnMemoryMap( WPARAM wParam, LPARAM lParam );
     afx_msg void OnCheckTopmost( );
     afx_msg void OnUpdateCheckTopmost( CCmdUI *pCmdUI );
     afx_msg void OnCheckClassBrowser( );
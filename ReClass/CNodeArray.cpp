@@ -25,7 +25,7 @@ void CNodeArray::Update( const PHOTSPOT Spot )
     {
         if (UlongValue == 0)
             return;
-        m_ulTotal = UlongValue;
+        SetTotal( UlongValue );
     }
     else if (Spot->Id == 1)
     {
@@ -89,7 +89,7 @@ NODESIZE CNodeArray::Draw( const PVIEWINFO View, int x, int y )
     tx = AddComment( View, tx, y );
 
     y += g_FontHeight;
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         VIEWINFO NewView;
         memcpy( &NewView, View, sizeof( NewView ) );
@@ -10,10 +10,10 @@ public:
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
-    inline void SetTotal( ULONG total ) { m_ulTotal = total; }
+    inline void SetTotal( ULONG total ) { m_ulTotal = total; InvalidateSize( ); }
     inline ULONG GetTotal( void ) { return m_ulTotal; }
 
-    inline void SetClass( CNodeClass* pNode ) { m_pNode = pNode; }
+    inline void SetClass( CNodeClass* pNode ) { m_pNode = pNode; InvalidateSize( ); }
     inline CNodeClass* GetClass( void ) { return m_pNode; }
 
 protected:
@@ -3,37 +3,46 @@
 #include "CNodeBase.h"
 #include <regex>
 
+DWORD g_LayoutGeneration = 1;
+DWORD g_SizeGeneration = 1;
+DWORD g_EditGeneration = 0;
+DWORD g_WindowNodesDrawn = 0;
+
 CNodeBase::CNodeBase( ) :
     m_nodeType( nt_base ),
-    m_pParentNode( nullptr ),
-    m_Offset( 0 ),
-    m_strOffset( _T( "0" ) ),
     m_bHidden( false ),
-    m_bSelected( false )
+    m_bSelected( false ),
+    m_bPending( false ),
+    m_LevelsOpen( 1 ), // Only the top level starts open
+    m_Offset( 0 ),
+    m_strOffset( g_StringPool.Intern( _T( "0" ) ) ),
+    m_pParentNode( nullptr )
 {
-    // Optimized
-    m_LevelsOpen.resize( 32, false );
-    m_LevelsOpen[0] = true;
-
     // This is the class name
     m_strName.Format( _T( "N%0.8X" ), g_NodeCreateIndex++ );
 }
 
+bool CNodeBase::IsGeneratedName( LPCTSTR name )
+{
+    // What the constructor gives every node, "N" and eight hex digits
+    if (name == NULL || name[0] != _T( 'N' ))
+        return false;
+
+    for (int i = 1; i <= 8; i++)
+    {
+        if (!_istxdigit( name[i] ))
+            return false;
+    }
+    return name[9] == _T( '\0' );
+}
+
 // Incorrect view.address
-void CNodeBase::AddHotSpot( const PVIEWINFO View, const CRect& Spot, CString Text, int ID, int Type )
+void CNodeBase::AddHotSpot( const PVIEWINFO View, const CRect& Spot, LPCTSTR Text, int ID, int Type )
 {
     if (Spot.top > View->ClientRect->bottom || Spot.bottom < 0)
         return;
 
-    HOTSPOT Hotspot;
-    Hotspot.Rect = Spot;
-    Hotspot.Text = Text.GetString( );
-    Hotspot.Address = View->Address + m_Offset;
-    Hotspot.Id = ID;
-    Hotspot.Type = Type;
-    Hotspot.Object = this;
-    Hotspot.Level = View->Level;
-    View->Hotspots->push_back( Hotspot );
+    View->Hotspots->Add( Spot, Text, View->Address + m_Offset, ID, Type, View->Level, this );
 }
 
 int CNodeBase::AddText( const PVIEWINFO View, int x, int y, DWORD color, int HitID, const wchar_t* fmt, ... )
@@ -41,59 +50,52 @@ int CNodeBase::AddText( const PVIEWINFO View, int x, int y, DWORD color, int Hit
     if (fmt == NULL)
         return x;
 
-    wchar_t wcsbuf[1024] = { 0 };
+    // Labels and separators don't need formatting at all
+    if (wcschr( fmt, L'%' ) == NULL)
+        return AddString( View, x, y, color, HitID, fmt, (int)wcslen( fmt ) );
+
+    wchar_t wcsbuf[TEXT_FORMAT_MAX];
 
     va_list va_alist;
     va_start( va_alist, fmt );
-    _vsnwprintf_s( wcsbuf, ARRAYSIZE( wcsbuf ), fmt, va_alist );
+    int length = _vsnwprintf_s( wcsbuf, ARRAYSIZE( wcsbuf ), _TRUNCATE, fmt, va_alist );
     va_end( va_alist );
 
-    int width = (int)(wcslen( wcsbuf )) * g_FontWidth;
+    if (length < 0)
+        length = (int)wcslen( wcsbuf );
 
-    if ((y >= -(g_FontHeight)) && (y + g_FontHeight <= View->ClientRect->bottom + g_FontHeight))
-    {
-        CRect pos;
-        if (HitID != HS_NONE)
-        {
-            if (width >= g_FontWidth * 2)
-                pos.SetRect( x, y, x + width, y + g_FontHeight );
-            else
-                pos.SetRect( x, y, x + g_FontWidth * 2, y + g_FontHeight );
-
-            AddHotSpot( View, pos, wcsbuf, HitID, HS_EDIT );
-        }
-
-        pos.SetRect( x, y, 0, 0 );
-
-        View->Dc->SetTextColor( color );
-        View->Dc->SetBkMode( TRANSPARENT );
-        View->Dc->DrawText( wcsbuf, pos, DT_LEFT | DT_NOCLIP | DT_NOPREFIX );
-    }
-    
-    return x + width;
+    return AddString( View, x, y, color, HitID, wcsbuf, length );
 }
 
 int CNodeBase::AddText( const PVIEWINFO View, int x, int y, DWORD color, int HitID, const char* fmt, ... )
 {
-    char buffer[1024] = { 0 };
-    TCHAR finalBuffer[1024] = { 0 };
+    char buffer[TEXT_FORMAT_MAX];
+    TCHAR finalBuffer[TEXT_FORMAT_MAX];
 
     if (fmt == NULL)
         return x;
 
     va_list va_alist;
     va_start( va_alist, fmt );
-    _vsnprintf_s( buffer, 1024, fmt, va_alist );
+    int length = _vsnprintf_s( buffer, ARRAYSIZE( buffer ), _TRUNCATE, fmt, va_alist );
     va_end( va_alist );
 
-    #ifdef UNICODE
-    size_t converted = 0; 
-    mbstowcs_s( &converted, finalBuffer, buffer, 1024 );
-    #else
-    memcpy( &finalBuffer, buffer, 1024 );
-    #endif
+    if (length < 0)
+        length = (int)strlen( buffer );
+
+    //
+    // Byte for byte, which is what mbstowcs_s did in the "C" locale the
+    // program runs in, without taking the CRT's locale lock for every row
+    //
+    for (int i = 0; i <= length; i++)
+        finalBuffer[i] = (TCHAR)(UCHAR)buffer[i];
+
+    return AddString( View, x, y, color, HitID, finalBuffer, length );
+}
 
-    int width = static_cast<int>(strlen( buffer )) * g_FontWidth;
+int CNodeBase::AddString( const PVIEWINFO View, int x, int y, DWORD color, int HitID, LPCTSTR Text, int Length )
+{
+    int width = Length * g_FontWidth;
 
     if ((y >= -g_FontHeight) && (y + g_FontHeight <= View->ClientRect->bottom + g_FontHeight))
     {
@@ -105,19 +107,27 @@ int CNodeBase::AddText( const PVIEWINFO View, int x, int y, DWORD color, int Hit
             else
                 pos.SetRect( x, y, x + g_FontWidth * 2, y + g_FontHeight );
 
-            AddHotSpot( View, pos, finalBuffer, HitID, HS_EDIT );
+            AddHotSpot( View, pos, Text, HitID, HS_EDIT );
         }
 
-        pos.SetRect( x, y, 0, 0 );
-
-        View->Dc->SetTextColor( color );
-        View->Dc->SetBkMode( TRANSPARENT );
-        View->Dc->DrawText( finalBuffer, pos, DT_LEFT | DT_NOCLIP | DT_NOPREFIX );
+        View->Renderer->DrawString( x, y, color, Text, Length );
     }
 
     return x + width;
 }
 
+int CNodeBase::AddMemoryText( const PVIEWINFO View, int x, int y, const UCHAR* Data, int Length )
+{
+    TCHAR Text[10];
+    int Column = FormatPrintable( Text, (const char*)Data, Length );
+
+    while (Column < (int)ARRAYSIZE( Text ) - 1)
+        Text[Column++] = _T( ' ' );
+    Text[Column] = _T( '\0' );
+
+    return AddString( View, x, y, g_clrChar, HS_NONE, Text, Column );
+}
+
 int CNodeBase::AddAddressOffset( const PVIEWINFO View, int x, int y )
 {
     if (g_bOffset)
@@ -134,18 +144,18 @@ int CNodeBase::AddAddressOffset( const PVIEWINFO View, int x, int y )
         //if (numdigits > 8)
         //	x += ((numdigits - 8) * FontWidth);
 
-        x = AddText( View, x, y, g_clrOffset, HS_NONE, _T( "%0.4X" ), m_Offset ) + g_FontWidth;
+        x = AddHex<4>( View, x, y, g_clrOffset, HS_NONE, (ULONG)m_Offset ) + g_FontWidth;
         #else
-        x = AddText( View, x, y, g_clrOffset, HS_NONE, _T( "%0.4X" ), m_Offset ) + g_FontWidth;
+        x = AddHex<4>( View, x, y, g_clrOffset, HS_NONE, (ULONG)m_Offset ) + g_FontWidth;
         #endif
     }
 
     if (g_bAddress)
     {
         #ifdef _WIN64
-        x = AddText( View, x, y, g_clrAddress, HS_ADDRESS, _T( "%0.9I64X" ), View->Address + m_Offset ) + g_FontWidth;
+        x = AddHex<9>( View, x, y, g_clrAddress, HS_ADDRESS, View->Address + m_Offset ) + g_FontWidth;
         #else
-        x = AddText( View, x, y, g_clrAddress, HS_ADDRESS, _T( "%0.8X" ), View->Address + m_Offset ) + g_FontWidth;
+        x = AddHex<8>( View, x, y, g_clrAddress, HS_ADDRESS, View->Address + m_Offset ) + g_FontWidth;
         #endif
     }
 
@@ -158,10 +168,26 @@ void CNodeBase::AddSelection( const PVIEWINFO View, int x, int y, int Height )
         return;
 
     if (m_bSelected)
-        View->Dc->FillSolidRect( 0, y, View->ClientRect->right, Height, g_clrSelect );
+    {
+        View->Renderer->FillRect( 0, y, View->ClientRect->right, Height, g_clrSelect );
+    }
+    else if (View->Changes != NULL && m_nodeType != nt_class && m_nodeType != nt_instance && m_nodeType != nt_array)
+    {
+        // Recently changed values fade from g_clrChanged back to the background
+        UINT Age = View->Changes->GetAge( View->Address + m_Offset, GetMemorySize( ) );
+        if (Age < g_ChangeFadeFrames)
+        {
+            UINT Weight = g_ChangeFadeFrames - Age;
+            COLORREF Color = RGB(
+                (GetRValue( g_clrChanged ) * Weight + GetRValue( g_clrBackground ) * Age) / g_ChangeFadeFrames,
+                (GetGValue( g_clrChanged ) * Weight + GetGValue( g_clrBackground ) * Age) / g_ChangeFadeFrames,
+                (GetBValue( g_clrChanged ) * Weight + GetBValue( g_clrBackground ) * Age) / g_ChangeFadeFrames );
+            View->Renderer->FillRect( 0, y, View->ClientRect->right, Height, Color );
+        }
+    }
 
     CRect pos( 0, y, INT_MAX, y + Height );
-    AddHotSpot( View, pos, CString( ), 0, HS_SELECT );
+    AddHotSpot( View, pos, _T( "" ), 0, HS_SELECT );
 }
 
 int CNodeBase::AddIcon( const PVIEWINFO View, int x, int y, int idx, int ID, int Type )
@@ -169,12 +195,12 @@ int CNodeBase::AddIcon( const PVIEWINFO View, int x, int y, int idx, int ID, int
     if ((y > View->ClientRect->bottom) || (y + 16 < 0))
         return x + 16;
 
-    DrawIconEx( View->Dc->m_hDC, x, y, g_Icons[idx], 16, 16, 0, NULL, DI_NORMAL );
+    View->Renderer->DrawIcon( x, y, idx );
 
     if (ID != -1)
     {
         CRect pos( x, y, x + 16, y + 16 );
-        AddHotSpot( View, pos, CString( ), ID, Type );
+        AddHotSpot( View, pos, _T( "" ), ID, Type );
     }
 
     return x + 16;
@@ -184,7 +210,7 @@ int CNodeBase::AddOpenClose( const PVIEWINFO View, int x, int y )
 {
     if ((y > View->ClientRect->bottom) || (y + 16 < 0))
         return x + 16;
-    return m_LevelsOpen[View->Level] ? AddIcon( View, x, y, ICON_OPEN, 0, HS_OPENCLOSE ) : AddIcon( View, x, y, ICON_CLOSED, 0, HS_OPENCLOSE );
+    return IsLevelOpen( View->Level ) ? AddIcon( View, x, y, ICON_OPEN, 0, HS_OPENCLOSE ) : AddIcon( View, x, y, ICON_CLOSED, 0, HS_OPENCLOSE );
 }
 
 void CNodeBase::AddDelete( const PVIEWINFO View, int x, int y )
@@ -211,29 +237,12 @@ void CNodeBase::AddTypeDrop( const PVIEWINFO View, int x, int y )
         AddIcon( View, 0, y, ICON_DROPARROW, 0, HS_DROP );
 }
 
-static CString remangle(const CString& name) {
-	CString manglemore = "??_7" + name.Mid(3) + "6B@";
-    return manglemore;
-}
-
 int CNodeBase::ResolveRTTI( ULONG_PTR Address, int x, const PVIEWINFO View, int y )
 {
-#if defined(_M_AMD64)
     ULONG_PTR ModuleBase = 0;
-
-    ULONG_PTR RTTIObjectLocatorPtr = 0;
-    ULONG_PTR RTTIObjectLocator = 0;
-
-    ULONG ClassHierarchyDescriptorOffset = 0;
-    ULONG_PTR ClassHierarchyDescriptor = 0;
-
-    ULONG NumBaseClasses = 0;
-
-    DWORD BaseClassArrayOffset = 0;
-    ULONG_PTR BaseClassArray = 0;
-
     CString RttiString;
 
+#if defined(_M_AMD64)
     // Get module base that this address falls in
     int indirections = -1;
     while (++indirections < 8 && !((ModuleBase = GetModuleBaseFromAddress(Address)))) {
@@ -242,184 +251,20 @@ int CNodeBase::ResolveRTTI( ULONG_PTR Address, int x, const PVIEWINFO View, int
         Address = nextAddress;
     }
 
-    RTTIObjectLocatorPtr = Address - sizeof( ULONG64 ); // Address is Ptr to first VFunc, pRTTI is at -0x8
-    if (!IsValidPtr( RTTIObjectLocatorPtr ))
-        return x;
-
-    ReClassReadMemory( (LPVOID)RTTIObjectLocatorPtr, &RTTIObjectLocator, sizeof( ULONG_PTR ) );
-
-    ReClassReadMemory( (LPVOID)(RTTIObjectLocator + 0x10), &ClassHierarchyDescriptorOffset, sizeof( ULONG ) );
-
-    ClassHierarchyDescriptor = ModuleBase + ClassHierarchyDescriptorOffset;
-    if (!IsValidPtr( ClassHierarchyDescriptor ) || !ClassHierarchyDescriptorOffset)
-        return x;
-
-    ReClassReadMemory( (LPVOID)(ClassHierarchyDescriptor + 0x8), &NumBaseClasses, sizeof( ULONG ) );
-    if (NumBaseClasses < 0 || NumBaseClasses > 25)
-        NumBaseClasses = 0;
-
-    ReClassReadMemory( (LPVOID)(ClassHierarchyDescriptor + 0xC), &BaseClassArrayOffset, sizeof( ULONG ) );
-
-    BaseClassArray = ModuleBase + BaseClassArrayOffset;
-    if (!IsValidPtr( BaseClassArray ) || !BaseClassArrayOffset)
+    if (!ModuleBase)
         return x;
 
     if (!indirections)
         RttiString += "vtable for ";
 	else for (int i=0; i<indirections; ++i)
         RttiString += "pointer to ";
+#endif
 
-    for (ULONG i = 0; i < NumBaseClasses; i++)
-    {
-        ULONG BaseClassDescriptorOffset = 0;
-        ULONG_PTR BaseClassDescriptor = 0;
-
-        ULONG TypeDescriptorOffset = 0;
-        ULONG_PTR TypeDescriptor = 0;
-
-        if (i == 1)
-            RttiString += TEXT( ": " ); // Base class
-        else if (i > 1)
-            RttiString += TEXT( ", " ); // Parent classes
-
-
-        ReClassReadMemory( (LPVOID)(BaseClassArray + (sizeof( ULONG ) * i)), &BaseClassDescriptorOffset, sizeof( ULONG ) );
-
-        BaseClassDescriptor = ModuleBase + BaseClassDescriptorOffset;
-        if (!IsValidPtr( BaseClassDescriptor ) || !BaseClassDescriptorOffset)
-            continue;
-
-        ReClassReadMemory( (LPVOID)BaseClassDescriptor, &TypeDescriptorOffset, sizeof( ULONG ) );
-
-        TypeDescriptor = ModuleBase + TypeDescriptorOffset;
-        if (!IsValidPtr( TypeDescriptor ) || !TypeDescriptorOffset)
-            continue;
-
-        CString RTTIName;
-        BOOLEAN FoundEnd = FALSE;
-        //CHAR LastChar = ' ';
-        for (int j = 1; j < 512; j++)
-        {
-            CHAR RTTINameChar;
-            ReClassReadMemory( (LPVOID)(TypeDescriptor + 0x10 + j), &RTTINameChar, 1 );
-
-            if (!RTTINameChar) {
-                if (RTTIName.Right(2) == "@@") FoundEnd = TRUE;
-                break;
-            }
-
-            RTTIName += RTTINameChar;
-        }
-
-        // Did we find a valid RTTI name or did we just reach end of loop
-        if (FoundEnd == TRUE)
-        {
-            TCHAR Demangled[MAX_PATH] = { 0 };
-            if (_UnDecorateSymbolName(remangle(RTTIName), Demangled, MAX_PATH, UNDNAME_NAME_ONLY) != 0)
-            {
-                CString PostProcessing(Demangled);
-                PostProcessing.Replace(L"::`vftable'", L"");
-                RttiString += PostProcessing;
-            }
-            else
-            {
-                RttiString += RTTIName;
-            }
-        }
-    }
-#else   
-    ULONG_PTR RTTIObjectLocatorPtr = 0;
-    ULONG_PTR RTTIObjectLocator = 0;
-
-    ULONG_PTR ClassHierarchyDescriptorPtr = 0;
-    ULONG_PTR ClassHierarchyDescriptor = 0;
-
-    ULONG NumBaseClasses = 0;
-
-    ULONG_PTR BaseClassArrayPtr = 0;
-    ULONG_PTR BaseClassArray = 0;
-
-    CString RttiString;
-
-    RTTIObjectLocatorPtr = Address - sizeof( ULONG );
-    if (!IsValidPtr( RTTIObjectLocatorPtr ))
-        return x;
-
-    ReClassReadMemory( (LPVOID)RTTIObjectLocatorPtr, &RTTIObjectLocator, sizeof( ULONG_PTR ) );
-
-    ClassHierarchyDescriptorPtr = RTTIObjectLocator + 0x10;
-    if (!IsValidPtr( ClassHierarchyDescriptorPtr ))
-        return x;
-
-    ReClassReadMemory( (LPVOID)ClassHierarchyDescriptorPtr, &ClassHierarchyDescriptor, sizeof( ULONG_PTR ) );
-
-    ReClassReadMemory( (LPVOID)(ClassHierarchyDescriptor + 0x8), &NumBaseClasses, sizeof( ULONG ) );
-    if (NumBaseClasses < 0 || NumBaseClasses > 25)
-        NumBaseClasses = 0;
-
-    BaseClassArrayPtr = ClassHierarchyDescriptor + 0xC;
-    if (!IsValidPtr( BaseClassArrayPtr ))
+    // Address is the vtable, the hierarchy behind it is walked once per module load
+    const CString* Hierarchy = g_RttiCache.Find( Address, ModuleBase );
+    if (Hierarchy == NULL)
         return x;
-
-    ReClassReadMemory( (LPVOID)BaseClassArrayPtr, &BaseClassArray, sizeof( ULONG_PTR ) );
-    
-    for (ULONG i = 0; i < NumBaseClasses; i++)
-    {
-        ULONG_PTR BaseClassDescriptorPtr = 0;
-        ULONG_PTR BaseClassDescriptor = 0;
-
-        ULONG_PTR TypeDescriptor = 0; // Ptr at 0x00 in BaseClassDescriptor
-
-        if (i != 0 && i != NumBaseClasses)
-        {
-            RttiString += " : "; // Base class
-        }
-
-        BaseClassDescriptorPtr = BaseClassArray + (4 * i);
-        if (!IsValidPtr( BaseClassDescriptorPtr ))
-            continue;
-
-        ReClassReadMemory( (LPVOID)BaseClassDescriptorPtr, &BaseClassDescriptor, sizeof( ULONG_PTR ) );
-        if (!IsValidPtr( BaseClassDescriptor ))
-            continue;
-
-        ReClassReadMemory( (LPVOID)BaseClassDescriptor, &TypeDescriptor, sizeof( ULONG_PTR ) );
-
-        CString RTTIName;
-        BOOLEAN FoundEnd = FALSE;
-        CHAR LastChar = ' ';
-
-        for (int j = 1; j < 45; j++)
-        {
-            CHAR RTTINameChar;
-            ReClassReadMemory( (LPVOID)(TypeDescriptor + 0x08 + j), &RTTINameChar, 1 );
-            if (RTTINameChar == '@' && LastChar == '@') // Names seem to be ended with @@
-            {
-                FoundEnd = TRUE;
-                RTTIName += RTTINameChar;
-                break;
-            }
-
-            RTTIName += RTTINameChar;
-            LastChar = RTTINameChar;
-        }
-
-        // Did we find a valid RTTI name or did we just reach end of loop
-        if (FoundEnd == TRUE)
-        {
-            TCHAR Demangled[256] = { 0 };
-
-            if (_UnDecorateSymbolName( RTTIName.GetString( ), Demangled, 256, UNDNAME_NAME_ONLY ) == 0)
-            {
-                RttiString += RTTIName.GetString( );
-            }
-            else
-            {
-                RttiString += Demangled;
-            }
-        }
-    }
-#endif
+    RttiString += *Hierarchy;
 
     x = AddText( View, x, y, g_clrOffset, HS_RTTI, _T( "%s" ), RttiString.GetString( ) );
     
@@ -488,11 +333,10 @@ int CNodeBase::AddComment( const PVIEWINFO View, int x, int y )
 
                             if (pSymbols != NULL)
                             {
-                                CString SymbolOut;
-                                SymbolOut.Preallocate( 1024 );
-                                if (pSymbols->GetSymbolStringFromVA( uintVal, SymbolOut ))
+                                const CString* SymbolOut = pSymbols->FindSymbolName( uintVal );
+                                if (SymbolOut != NULL)
                                 {
-                                    x = AddText( View, x, y, g_clrOffset, HS_EDIT, _T( "%s " ), SymbolOut.GetString( ) );
+                                    x = AddText( View, x, y, g_clrOffset, HS_EDIT, _T( "%s " ), SymbolOut->GetString( ) );
                                 }
                             }
                         }
@@ -502,17 +346,10 @@ int CNodeBase::AddComment( const PVIEWINFO View, int x, int y )
 
             if (g_bString)
             {
-                bool bAddStr = true;
                 char txt[64];
                 ReClassReadMemory( (LPVOID)uintVal, txt, 64 );
 
-                for (int i = 0; i < 8; i++)
-                {
-                    if (!(txt[i] > 0x1F && txt[i] < 0xFF && txt[i] != 0x7F))
-                        bAddStr = false;
-                }
-
-                if (bAddStr)
+                if (CountPrintable( txt, 8 ) == 8)
                 {
                     txt[63] = '\0';
                     x = AddText( View, x, y, g_clrChar, HS_NONE, _T( "'%hs'" ), txt );
@@ -584,11 +421,10 @@ int CNodeBase::AddComment( const PVIEWINFO View, int x, int y )
 
                             if (pSymbols != NULL)
                             {
-                                CString SymbolOut;
-                                SymbolOut.Preallocate( 1024 );
-                                if (pSymbols->GetSymbolStringFromVA( uintVal, SymbolOut ))
+                                const CString* SymbolOut = pSymbols->FindSymbolName( uintVal );
+                                if (SymbolOut != NULL)
                                 {
-                                    x = AddText( View, x, y, g_clrOffset, HS_EDIT, _T( "%s " ), SymbolOut.GetString( ) );
+                                    x = AddText( View, x, y, g_clrOffset, HS_EDIT, _T( "%s " ), SymbolOut->GetString( ) );
                                 }
                             }
                         }
@@ -598,17 +434,10 @@ int CNodeBase::AddComment( const PVIEWINFO View, int x, int y )
 
             if (g_bString)
             {
-                bool bAddStr = true;
                 char txt[64] = { 0 };
                 ReClassReadMemory( (LPVOID)uintVal, txt, 64 );
 
-                for (int i = 0; i < 4; i++)
-                {
-                    if (!(txt[i] > 0x1F && txt[i] < 0xFF && txt[i] != 0x7F))
-                        bAddStr = false;
-                }
-
-                if (bAddStr)
+                if (CountPrintable( txt, 4 ) == 4)
                 {
                     txt[63] = '\0'; // null terminte (even though we prolly dont have to)
                     x = AddText( View, x, y, g_clrChar, HS_NONE, _T( "'%hs'" ), txt );
@@ -639,11 +468,11 @@ void CNodeBase::StandardUpdate( const PHOTSPOT Spot )
 {
     if (Spot->Id == HS_NAME)
     {
-        m_strName = Spot->Text;
+        SetName( Spot->Text );
     }	
     else if (Spot->Id == HS_COMMENT)
     {
-        m_strComment = Spot->Text;
+        SetComment( Spot->Text );
     }	
 }
 
@@ -651,7 +480,7 @@ NODESIZE CNodeBase::DrawHidden( const PVIEWINFO View, int x, int y )
 {
     NODESIZE DrawSize;
 
-    View->Dc->FillSolidRect( 0, y, View->ClientRect->right, 1, m_bSelected ? g_clrSelect : g_clrHidden );
+    View->Renderer->FillRect( 0, y, View->ClientRect->right, 1, m_bSelected ? g_clrSelect : g_clrHidden );
 
     DrawSize.x = 0;
     DrawSize.y = y;
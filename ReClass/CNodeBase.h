@@ -2,6 +2,9 @@
 
 #include "NodeType.h"
 #include "HotSpot.h"
+#include "TextFormat.h"
+#include "RenderSink.h"
+#include "ChangeTracker.h"
 
 #include "Debug.h"
 #include "Symbols.h"
@@ -9,8 +12,13 @@
 #include <afxwin.h>
 #include <vector>
 
+#include "StringPool.h"
+
 #define TXOFFSET 16
 
+// Levels a node remembers as open or closed, deeper ones always draw closed
+#define NODE_MAX_LEVELS 32
+
 // Global node index
 extern DWORD g_NodeCreateIndex;
 
@@ -19,9 +27,10 @@ typedef struct tagVIEWINFO {
     #ifdef _DEBUG
     class CClassView* pChildView;
     #endif
-    CDC* Dc;
+    IRenderSink* Renderer;
     CRect* ClientRect;
-    std::vector<HOTSPOT>* Hotspots;
+    CHotspotList* Hotspots;
+    const CChangeTracker* Changes;  // NULL when not highlighting
     std::vector<CNodeClass*>* Classes;
     ULONG_PTR Address;
     UCHAR* Data;
@@ -103,6 +112,46 @@ typedef struct _NODESIZE {
     INT y;
 } NODESIZE, *PNODESIZE;
 
+//
+// Layout generation
+//
+// Bumped by every edit that can change how many rows a node draws (adding,
+// removing or replacing nodes, hiding, opening and closing levels, pointing a
+// node at another class). CNodeClass only trusts its cached row layout while
+// the generation it was built with is current.
+//
+extern DWORD g_LayoutGeneration;
+inline void InvalidateLayout( ) { g_LayoutGeneration++; }
+
+//
+// Size generation
+//
+// Bumped by every edit that can change a node's memory size (adding, removing
+// or replacing nodes, array and pointer counts, text lengths, custom sizes).
+// CNodeClass only trusts its cached size while the generation it was summed
+// with is current. A new size always means a new layout too.
+//
+extern DWORD g_SizeGeneration;
+inline void InvalidateSize( ) { g_SizeGeneration++; InvalidateLayout( ); }
+
+//
+// Edit generation
+//
+// A class takes the next value whenever it or one of its nodes is edited
+// (MarkClassEdited). OnButtonGenerate only describes a class again once its
+// value moved. Values are never handed out twice, a class allocated where a
+// deleted one was doesn't pass for it.
+//
+extern DWORD g_EditGeneration;
+
+// Nodes that own a child window (the disassembly views) count themselves here
+// when drawn, rows containing them are never skipped so the windows follow the
+// scroll position
+extern DWORD g_WindowNodesDrawn;
+
+// Fills in a class opened from a .ntsb whose nodes weren't needed yet
+void MaterializeClass( CNodeBase* pClass );
+
 class CNodeBase {
 public:
     CNodeBase( );
@@ -118,37 +167,48 @@ public:
     inline void SetOffset( const size_t offset ) { m_Offset = offset; }
 
     inline const CString& GetOffsetString( ) const { return m_strOffset; }
-    inline void SetOffsetString( const CString& offsetStr ) { m_strOffset = offsetStr; }
-    inline void SetOffsetString( LPCTSTR offsetStr ) { m_strOffset = offsetStr; }
+    inline void SetOffsetString( const CString& offsetStr ) { m_strOffset = g_StringPool.Intern( offsetStr ); }
+    inline void SetOffsetString( LPCTSTR offsetStr ) { m_strOffset = g_StringPool.Intern( offsetStr ); }
 
+    // Generated names ("N" and the create index) are unique, pooling them would only grow the pool
     inline const CString& GetName( ) const { return m_strName; }
-    inline void SetName( const CString& name ) { m_strName = name; }
-    inline void SetName( LPCTSTR name ) { m_strName = name; }
+    inline void SetName( const CString& name ) { m_strName = IsGeneratedName( name ) ? name : g_StringPool.Intern( name ); }
+    inline void SetName( LPCTSTR name ) { m_strName = IsGeneratedName( name ) ? CString( name ) : g_StringPool.Intern( name ); }
+    static bool IsGeneratedName( LPCTSTR name );
 
     inline const CString& GetComment( ) const { return m_strComment; }
-    inline void SetComment( const CString& comment ) { m_strComment = comment; }
-    inline void SetComment( LPCTSTR comment ) { m_strComment = comment; }
+    inline void SetComment( const CString& comment ) { m_strComment = g_StringPool.Intern( comment ); }
+    inline void SetComment( LPCTSTR comment ) { m_strComment = g_StringPool.Intern( comment ); }
 
     inline CNodeBase* GetParent( ) const { return m_pParentNode; }
     inline void SetParent( CNodeBase* newParentNode ) { m_pParentNode = newParentNode; }
 
-    inline void AddNode( CNodeBase* newNode ) { m_ChildNodes.push_back( newNode ); }
-    inline void InsertNode( size_t idx, CNodeBase* newNode ) { m_ChildNodes.insert( m_ChildNodes.begin( ) + idx, newNode ); }
-    inline CNodeBase* GetNode( size_t idx ) { return m_ChildNodes[idx]; }
+    //
+    // The child accessors materialize a pending class first, so nothing that
+    // walks a class's nodes can see it before its nodes exist
+    //
+    inline void AddNode( CNodeBase* newNode ) { Materialize( ); m_ChildNodes.push_back( newNode ); InvalidateSize( ); }
+    inline void InsertNode( size_t idx, CNodeBase* newNode ) { Materialize( ); m_ChildNodes.insert( m_ChildNodes.begin( ) + idx, newNode ); InvalidateSize( ); }
+    inline CNodeBase* GetNode( size_t idx ) { Materialize( ); return m_ChildNodes[idx]; }
     inline int FindNode( CNodeBase* pNode ) {
+        Materialize( );
         auto found = std::find( m_ChildNodes.begin( ), m_ChildNodes.end( ), pNode );
         return (found != m_ChildNodes.end( )) ? (int)(found - m_ChildNodes.begin( )) : -1;
     }
-    inline void SetNode( size_t idx, CNodeBase* newNode ) { m_ChildNodes[idx] = newNode; }
-    inline void DeleteNode( size_t idx ) { if (m_ChildNodes[idx]) { delete(m_ChildNodes[idx]); RemoveNode( idx ); } }
-    inline void RemoveNode( size_t idx ) { m_ChildNodes.erase( m_ChildNodes.begin( ) + idx ); }
-    inline size_t NodeCount( ) const { return m_ChildNodes.size( ); }
+    inline void SetNode( size_t idx, CNodeBase* newNode ) { Materialize( ); m_ChildNodes[idx] = newNode; InvalidateSize( ); }
+    inline void DeleteNode( size_t idx ) { Materialize( ); if (m_ChildNodes[idx]) { delete(m_ChildNodes[idx]); RemoveNode( idx ); } }
+    inline void RemoveNode( size_t idx ) { Materialize( ); m_ChildNodes.erase( m_ChildNodes.begin( ) + idx ); InvalidateSize( ); }
+    inline size_t NodeCount( ) const { Materialize( ); return m_ChildNodes.size( ); }
+
+    // Only classes opened from a .ntsb are ever pending (CNodeClass::SetSource)
+    inline bool IsPending( ) const { return m_bPending; }
+    inline void Materialize( ) const { if (m_bPending) MaterializeClass( const_cast<CNodeBase*>(this) ); }
 
     inline bool IsHidden( ) { return m_bHidden; }
-    inline void Show( ) { m_bHidden = false; }
-    inline void Hide( ) { m_bHidden = true; }
-    inline void SetHidden( bool hidden ) { m_bHidden = hidden; }
-    inline void ToggleHidden( ) { m_bHidden = !m_bHidden; }
+    inline void Show( ) { m_bHidden = false; InvalidateLayout( ); }
+    inline void Hide( ) { m_bHidden = true; InvalidateLayout( ); }
+    inline void SetHidden( bool hidden ) { m_bHidden = hidden; InvalidateLayout( ); }
+    inline void ToggleHidden( ) { m_bHidden = !m_bHidden; InvalidateLayout( ); }
 
     inline bool IsSelected( ) { return m_bSelected; }
     inline void SetSelected( bool selected ) { m_bSelected = selected; }
@@ -156,16 +216,31 @@ public:
     inline void Unselect( ) { m_bSelected = false; }
     inline void ToggleSelected( ) { m_bSelected = !m_bSelected; }
 
-    inline bool IsLevelOpen( int idx ) { return m_LevelsOpen[idx]; }
-    inline void ToggleLevelOpen( int idx ) { m_LevelsOpen[idx] = !m_LevelsOpen[idx]; }
+    inline bool IsLevelOpen( UINT idx ) const { return idx < NODE_MAX_LEVELS && (m_LevelsOpen & (1UL << idx)) != 0; }
+    inline void ToggleLevelOpen( UINT idx ) { if (idx < NODE_MAX_LEVELS) { m_LevelsOpen ^= (1UL << idx); InvalidateLayout( ); } }
+    inline void OpenAllLevels( ) { m_LevelsOpen = ~0UL; InvalidateLayout( ); }
 
     // Incorrect view.address
-    void AddHotSpot( const PVIEWINFO View, const CRect& Spot, CString Text, int ID, int Type );
+    void AddHotSpot( const PVIEWINFO View, const CRect& Spot, LPCTSTR Text, int ID, int Type );
 
     int AddText( const PVIEWINFO View, int x, int y, DWORD color, int HitID, const wchar_t* fmt, ... );
 
     int AddText( const PVIEWINFO View, int x, int y, DWORD color, int HitID, const char* fmt, ... );
 
+    // Already formatted text, Text[Length] must be the terminating NUL
+    int AddString( const PVIEWINFO View, int x, int y, DWORD color, int HitID, LPCTSTR Text, int Length );
+
+    template<int MinDigits>
+    int AddHex( const PVIEWINFO View, int x, int y, DWORD color, int HitID, ULONGLONG Value )
+    {
+        TCHAR Text[17];
+        int Length = FormatHex<MinDigits>( Text, Value );
+        return AddString( View, x, y, color, HitID, Text, Length );
+    }
+
+    // The hex nodes' text column, Length bytes padded to the widest (8 bytes and a space)
+    int AddMemoryText( const PVIEWINFO View, int x, int y, const UCHAR* Data, int Length );
+
     int AddAddressOffset( const PVIEWINFO View, int x, int y );
 
     void AddSelection( const PVIEWINFO View, int x, int y, int Height );
@@ -189,7 +264,15 @@ public:
     NODESIZE DrawHidden( const PVIEWINFO View, int x, int y );
 
 protected:
+    //
+    // Every byte of a class is at least one node, keep them small: the flags
+    // share a word with the type, the strings come from g_StringPool.
+    //
     NodeType m_nodeType;
+    bool m_bHidden;
+    bool m_bSelected;
+    bool m_bPending;
+    ULONG m_LevelsOpen; // Bit per level, NODE_MAX_LEVELS
 
     size_t m_Offset; // Can also be an address
     CString m_strOffset;
@@ -199,19 +282,15 @@ protected:
 
     CNodeBase* m_pParentNode;
     std::vector<CNodeBase*> m_ChildNodes;
-
-    bool m_bHidden;
-    bool m_bSelected;
-
-    std::vector<bool> m_LevelsOpen;
 };
 
 FORCEINLINE CStringA GetStringFromMemoryA( const char* pMemory, int Length )
 {
     CStringA AsciiString;
-    for (int i = 0; i < Length; i++)
+    if (Length > 0)
     {
-        AsciiString += (pMemory[i] > 0x1F && pMemory[i] < 0xFF && pMemory[i] != 0x7F) ? (char)pMemory[i] : '.';
+        FormatPrintable( AsciiString.GetBufferSetLength( Length ), pMemory, Length );
+        AsciiString.ReleaseBuffer( Length );
     }
     return AsciiString;
 }
@@ -219,9 +298,10 @@ FORCEINLINE CStringA GetStringFromMemoryA( const char* pMemory, int Length )
 FORCEINLINE CStringW GetStringFromMemoryW( const wchar_t* pMemory, int Length )
 {
     CStringW WideCharString;
-    for (int i = 0; i < Length; i++)
+    if (Length > 0)
     {
-        WideCharString += (pMemory[i] > 0x1F && pMemory[i] < 0xFF && pMemory[i] != 0x7F) ? (wchar_t)pMemory[i] : (wchar_t)(L'.');
+        FormatPrintable( WideCharString.GetBufferSetLength( Length ), pMemory, Length );
+        WideCharString.ReleaseBuffer( Length );
     }
     return WideCharString;
 }
\ No newline at end of file
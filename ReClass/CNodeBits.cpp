@@ -41,7 +41,7 @@ NODESIZE CNodeBits::Draw( const PVIEWINFO View, int x, int y )
         tx = AddText( View, tx, y, g_clrChar, HS_EDIT, "%s ", bits.GetBitsReverseString( ) );
     }
 
-    tx = AddText( View, tx, y, g_clrHex, 0, _T( "%0.2X" ), Data[0] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 0, Data[0] ) + g_FontWidth;
     tx = AddComment( View, tx, y );
 
     DrawSize.x = tx;
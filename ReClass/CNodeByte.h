@@ -8,7 +8,7 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( ) { return sizeof( unsigned __int8 ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_uint8 ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 };
\ No newline at end of file
@@ -4,7 +4,7 @@
 CNodeCharPtr::CNodeCharPtr( )
 {
     m_nodeType = nt_pchar;
-    m_strName = "PChar";
+    SetName( _T( "PChar" ) );
 }
 
 void CNodeCharPtr::Update( const PHOTSPOT Spot )
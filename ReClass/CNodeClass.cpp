@@ -19,6 +19,25 @@ CNodeClass::CNodeClass( )
     m_RequestPosition = -1;
     m_Idx = 0;
     m_pChildClassFrame = NULL;
+
+    m_Size = 0;
+    m_RecordsGeneration = 0;
+    m_SourceIndex = 0;
+
+    MarkEdited( );
+}
+
+void MarkClassEdited( CNodeBase* pNode )
+{
+    // A vtable's functions hang off the vtable, the vtable off its class
+    CNodeBase* pClass = pNode;
+    while (pClass != NULL && pClass->GetParent( ) != NULL)
+        pClass = pClass->GetParent( );
+
+    if (pClass != NULL && pClass->GetType( ) == nt_class)
+        static_cast<CNodeClass*>(pClass)->MarkEdited( );
+
+    g_Autosave.MarkDirty( pNode );
 }
 
 void CNodeClass::Update( const PHOTSPOT Spot )
@@ -35,12 +54,41 @@ void CNodeClass::Update( const PHOTSPOT Spot )
     }
 }
 
+const NodeRecords& CNodeClass::GetRecords( )
+{
+    Materialize( );
+    if (m_RecordsGeneration != g_SizeGeneration)
+    {
+        size_t Count = m_ChildNodes.size( );
+        ULONG Offset = 0;
+
+        m_Records.Types.resize( Count );
+        m_Records.Offsets.resize( Count );
+        m_Records.Sizes.resize( Count );
+
+        for (size_t i = 0; i < Count; i++)
+        {
+            ULONG Size = m_ChildNodes[i]->GetMemorySize( );
+            m_Records.Types[i] = m_ChildNodes[i]->GetType( );
+            m_Records.Offsets[i] = Offset;
+            m_Records.Sizes[i] = Size;
+            Offset += Size;
+        }
+
+        m_Size = Offset;
+        m_RecordsGeneration = g_SizeGeneration;
+    }
+    return m_Records;
+}
+
 ULONG CNodeClass::GetMemorySize( )
 {
-    int size = 0;
-    for (UINT i = 0; i < m_ChildNodes.size( ); i++)
-        size += m_ChildNodes[i]->GetMemorySize( );
-    return size;
+    //
+    // Instances and arrays of this class ask for the size on every draw,
+    // hover and offset update, only sum the children again after an edit
+    //
+    GetRecords( );
+    return m_Size;
 }
 
 NODESIZE CNodeClass::Draw( const PVIEWINFO View, int x, int y )
@@ -77,41 +125,97 @@ NODESIZE CNodeClass::Draw( const PVIEWINFO View, int x, int y )
 
     DrawSize.x = x;
     y += g_FontHeight;
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         VIEWINFO ViewInfo;
         memcpy( &ViewInfo, View, sizeof( ViewInfo ) );
         ViewInfo.Level++;
 
-        for (UINT i = 0; i < m_ChildNodes.size( ); i++)
+        ChildLayout& Layout = m_Layouts[View->Level];
+        UINT Count = (UINT)m_ChildNodes.size( );
+        UINT Next = 0;
+        int Top = y;
+        bool bMoved = false;
+        bool bWindowMoved = false;
+
+        if (Layout.Generation == g_LayoutGeneration && Layout.FontHeight == g_FontHeight && Layout.Rows.size( ) == Count)
         {
-            CNodeBase* pNode = m_ChildNodes[i];
-            if (!pNode)
+            // First row that ends below the top of the client rect
+            UINT First = (UINT)(std::partition_point( Layout.Rows.begin( ), Layout.Rows.end( ), [&] ( const ChildRow& Row ) {
+                return Top + Row.Top + Row.Height <= View->ClientRect->top;
+            } ) - Layout.Rows.begin( ));
+
+            for (UINT Row : Layout.WindowRows)
             {
-                PrintOutDbg( _T( "Node %d is NULL in class %s!" ), i, m_strName.GetString( ) );
-                continue;
-            }          
-                      
-            if (pNode->GetType( ) == nt_vtable)
+                if (Row < First)
+                    bWindowMoved |= DrawWindowRow( &ViewInfo, Row, tx, Layout, Top );
+            }
+
+            Next = First;
+            y = Top + ((First < Count) ? Layout.Rows[First].Top : Layout.Height);
+            while (Next < Count && y <= View->ClientRect->bottom)
             {
-                CNodeVTable* VTableNode = static_cast<CNodeVTable*>(pNode);
-                if (!VTableNode->IsInitialized( ) && m_pChildClassFrame != NULL)
-                    VTableNode->Initialize( static_cast<CWnd*>(m_pChildClassFrame->GetChildView( )) );
+                int CachedHeight = Layout.Rows[Next].Height;
+
+                ChildDrawSize = DrawChild( &ViewInfo, Next++, tx, y, Layout, Top );
+                if (ChildDrawSize.x > DrawSize.x)
+                    DrawSize.x = ChildDrawSize.x;
+
+                // Everything below moved, lay the rest out again
+                bMoved |= (ChildDrawSize.y - y != CachedHeight);
+                y = ChildDrawSize.y;
+                if (bMoved)
+                    break;
             }
-            
-            if (pNode->GetType( ) == nt_function)
+
+            if (!bMoved)
             {
-                CNodeFunction* FunctionNode = static_cast<CNodeFunction*>(pNode);
-                if (!FunctionNode->IsInitialized( ) && m_pChildClassFrame != NULL)
-                    FunctionNode->Initialize( m_pChildClassFrame->GetChildView( ), m_Offset + FunctionNode->GetOffset( ) );
+                for (UINT Row : Layout.WindowRows)
+                {
+                    if (Row >= Next)
+                        bWindowMoved |= DrawWindowRow( &ViewInfo, Row, tx, Layout, Top );
+                }
+
+                Next = Count;
+                y = Top + Layout.Height;
+                if (Layout.Width > DrawSize.x)
+                    DrawSize.x = Layout.Width;
             }
-            
-            ChildDrawSize = pNode->Draw( &ViewInfo, tx, y );
-            
-            y = ChildDrawSize.y;
-            if (ChildDrawSize.x > DrawSize.x)
+
+            // A window row off screen changed height, lay everything out again next time
+            if (bWindowMoved)
+                Layout.Generation = 0;
+        }
+
+        //
+        // Layout pass: draw the remaining rows one after another and record
+        // where they ended up
+        //
+        if (Next < Count || bMoved)
+        {
+            Layout.Rows.resize( Count );
+
+            for (UINT i = Next; i < Count; i++)
             {
-                DrawSize.x = ChildDrawSize.x;
+                ChildDrawSize = DrawChild( &ViewInfo, i, tx, y, Layout, Top );
+
+                y = ChildDrawSize.y;
+                if (ChildDrawSize.x > DrawSize.x)
+                {
+                    DrawSize.x = ChildDrawSize.x;
+                }
+            }
+
+            Layout.Generation = bWindowMoved ? 0 : g_LayoutGeneration;
+            Layout.FontHeight = g_FontHeight;
+            Layout.Height = y - Top;
+            Layout.Width = 0;
+            Layout.WindowRows.clear( );
+            for (UINT i = 0; i < Count; i++)
+            {
+                Layout.Width = max( Layout.Width, Layout.Rows[i].Width );
+                if (Layout.Rows[i].bWindows)
+                    Layout.WindowRows.push_back( i );
             }
         }
     }
@@ -119,3 +223,53 @@ NODESIZE CNodeClass::Draw( const PVIEWINFO View, int x, int y )
     DrawSize.y = y;
     return DrawSize;
 }
+
+bool CNodeClass::DrawWindowRow( const PVIEWINFO View, UINT Index, int x, ChildLayout& Layout, int Top )
+{
+    int y = Top + Layout.Rows[Index].Top;
+    int CachedHeight = Layout.Rows[Index].Height;
+
+    return DrawChild( View, Index, x, y, Layout, Top ).y - y != CachedHeight;
+}
+
+NODESIZE CNodeClass::DrawChild( const PVIEWINFO View, UINT Index, int x, int y, ChildLayout& Layout, int Top )
+{
+    CNodeBase* pNode = m_ChildNodes[Index];
+    ChildRow& Row = Layout.Rows[Index];
+    NODESIZE DrawSize;
+
+    DrawSize.x = 0;
+    DrawSize.y = y;
+    Row.bWindows = false;
+
+    if (!pNode)
+    {
+        PrintOutDbg( _T( "Node %d is NULL in class %s!" ), Index, m_strName.GetString( ) );
+    }
+    else
+    {
+        if (pNode->GetType( ) == nt_vtable)
+        {
+            CNodeVTable* VTableNode = static_cast<CNodeVTable*>(pNode);
+            if (!VTableNode->IsInitialized( ) && m_pChildClassFrame != NULL)
+                VTableNode->Initialize( static_cast<CWnd*>(m_pChildClassFrame->GetChildView( )) );
+        }
+
+        if (pNode->GetType( ) == nt_function)
+        {
+            CNodeFunction* FunctionNode = static_cast<CNodeFunction*>(pNode);
+            if (!FunctionNode->IsInitialized( ) && m_pChildClassFrame != NULL)
+                FunctionNode->Initialize( m_pChildClassFrame->GetChildView( ), m_Offset + FunctionNode->GetOffset( ) );
+        }
+
+        DWORD WindowNodes = g_WindowNodesDrawn;
+        DrawSize = pNode->Draw( View, x, y );
+        Row.bWindows = (g_WindowNodesDrawn != WindowNodes);
+    }
+
+    Row.Top = y - Top;
+    Row.Height = DrawSize.y - y;
+    Row.Width = DrawSize.x;
+
+    return DrawSize;
+}
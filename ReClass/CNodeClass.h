@@ -2,6 +2,19 @@
 
 #include "CNodeBase.h"
 
+#include <memory>
+
+//
+// Flat copy of the children, one array per field: the size sum, the offset
+// pass and code generation walk these instead of calling through every node.
+// Index n is child n.
+//
+struct NodeRecords {
+    std::vector<NodeType> Types;
+    std::vector<size_t> Offsets;
+    std::vector<ULONG> Sizes;
+};
+
 class CNodeClass : public CNodeBase {
 public:
     CNodeClass( );
@@ -17,9 +30,73 @@ public:
 
     inline void SetCodeString( LPCTSTR CodeStr ) { m_Code.SetString( CodeStr ); }
 
+    inline DWORD GetEditGeneration( ) const { return m_EditGeneration; }
+
+    // Current as of the last edit, rebuilt on first use after one
+    const NodeRecords& GetRecords( );
+
+    //
+    // Classes opened from a .ntsb start out with only their own fields, the
+    // nodes stay in the mapped file until something first asks for them
+    // (MaterializeClass). The source stays mapped while any of its classes
+    // still points at it.
+    //
+    inline void SetSource( const std::shared_ptr<class CProjectSource>& pSource, uint32_t Index ) { m_pSource = pSource; m_SourceIndex = Index; m_bPending = true; }
+    inline const class CProjectSource* GetSource( uint32_t* Index ) const { *Index = m_SourceIndex; return m_pSource.get( ); }
+    inline std::shared_ptr<class CProjectSource> TakeSource( ) { m_bPending = false; return std::move( m_pSource ); }
+    inline void MarkEdited( ) { m_EditGeneration = ++g_EditGeneration; }
+
+private:
+    //
+    // Row layout of the children, per level since the same class can be drawn
+    // open at one level and closed at another. Draw binary searches it for the
+    // first row on screen, rows above and below the client rect are stepped
+    // over with their cached heights instead of being drawn.
+    //
+    struct ChildRow
+    {
+        int Top;        // Relative to the first child
+        int Height;
+        int Width;
+        bool bWindows;  // Contains a node with a child window, always drawn
+    };
+
+    struct ChildLayout
+    {
+        DWORD Generation = 0;
+        int FontHeight = 0;
+        int Height = 0;
+        int Width = 0;
+        std::vector<ChildRow> Rows;
+        std::vector<UINT> WindowRows;
+    };
+
+    NODESIZE DrawChild( const PVIEWINFO View, UINT Index, int x, int y, ChildLayout& Layout, int Top );
+    bool DrawWindowRow( const PVIEWINFO View, UINT Index, int x, ChildLayout& Layout, int Top ); // True if its height changed
+
+    std::map<int, ChildLayout> m_Layouts;
+
+    //
+    // Every edit that adds, removes, replaces or resizes a node bumps
+    // g_SizeGeneration, so the records only have to be compared against it
+    // to stay in sync with the children. m_Size is the sum of the sizes.
+    //
+    NodeRecords m_Records;
+    ULONG m_Size;
+    DWORD m_RecordsGeneration;
+
+    DWORD m_EditGeneration;
+
+    std::shared_ptr<class CProjectSource> m_pSource;
+    uint32_t m_SourceIndex;
+
 public:
     size_t m_Idx;
     size_t m_RequestPosition;
     CString m_Code;
     class CClassFrame* m_pChildClassFrame;
 };
+
+// pNode, or the class it belongs to, was edited: new edit generation for the
+// class, and the autosave journals it
+void MarkClassEdited( CNodeBase* pNode );
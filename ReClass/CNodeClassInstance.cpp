@@ -48,7 +48,7 @@ NODESIZE CNodeClassInstance::Draw( const PVIEWINFO View, int x, int y )
     tx = AddComment( View, tx, y );
 
     y += g_FontHeight;
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         VIEWINFO NewView;
         memcpy( &NewView, View, sizeof( NewView ) );
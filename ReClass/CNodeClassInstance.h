@@ -12,7 +12,7 @@ public:
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
-    inline void SetClass( CNodeClass* pNode ) { m_pNode = pNode; }
+    inline void SetClass( CNodeClass* pNode ) { m_pNode = pNode; InvalidateSize( ); }
     inline CNodeClass* GetClass( void ) { return m_pNode; }
 
 private:
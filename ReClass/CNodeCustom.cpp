@@ -4,7 +4,7 @@
 CNodeCustom::CNodeCustom( )
 {
     m_nodeType = nt_custom;
-    m_strName = _T( "Custom" );
+    SetName( _T( "Custom" ) );
     m_ulMemorySize = sizeof( void* );
 }
 
@@ -12,7 +12,7 @@ void CNodeCustom::Update( const PHOTSPOT Spot )
 {
     StandardUpdate( Spot );
     if (Spot->Id == 0)
-        m_ulMemorySize = _ttoi( Spot->Text.GetString( ) );
+        SetSize( _ttoi( Spot->Text.GetString( ) ) );
 }
 
 ULONG CNodeCustom::GetMemorySize( )
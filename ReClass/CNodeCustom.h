@@ -12,7 +12,7 @@ public:
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
-    inline void SetSize( ULONG size ) { m_ulMemorySize = size; }
+    inline void SetSize( ULONG size ) { m_ulMemorySize = size; InvalidateSize( ); }
     inline ULONG GetSize( void ) { return m_ulMemorySize; }
 
 private:
@@ -8,7 +8,7 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( void ) { return sizeof( double ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_double ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 };
\ No newline at end of file
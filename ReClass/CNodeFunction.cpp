@@ -21,7 +21,7 @@ CNodeFunction::CNodeFunction( ) :
     m_bRedrawNeeded( FALSE )
 {
     m_nodeType = nt_function;
-    m_strName = _T( "" );
+    SetName( _T( "" ) );
     m_dwMemorySize = sizeof( ULONG_PTR );
 }
 
@@ -52,6 +52,8 @@ NODESIZE CNodeFunction::Draw( const PVIEWINFO View, int x, int y )
 {
     NODESIZE DrawSize;
 
+    g_WindowNodesDrawn++;
+
     if (m_bHidden)
         return DrawHidden( View, x, y );
 
@@ -82,7 +84,7 @@ NODESIZE CNodeFunction::Draw( const PVIEWINFO View, int x, int y )
 
     tx = AddComment( View, tx, y );
 
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         y += g_FontHeight;
 
@@ -244,6 +246,9 @@ void CNodeFunction::DisassembleBytes( ULONG_PTR Address )
         m_dwMemorySize = sizeof( void* );
     }
 
+    // The node is as big as the code it shows
+    InvalidateSize( );
+
     // Clear any left over text
     m_pEdit->Clear( );
 
@@ -15,7 +15,7 @@ public:
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
-    inline void SetSize( ULONG Size ) { m_dwMemorySize = Size; }
+    inline void SetSize( ULONG Size ) { m_dwMemorySize = Size; InvalidateSize( ); }
 
     inline bool IsInitialized( ) { return (m_pEdit != NULL); }
     void Initialize( CClassView* pParentWindow, ULONG_PTR Address );
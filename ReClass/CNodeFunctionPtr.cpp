@@ -22,7 +22,7 @@ CNodeFunctionPtr::CNodeFunctionPtr( )
     , m_bRedrawNeeded( FALSE )
 {
     m_nodeType = nt_functionptr;
-    m_strName = _T( "" );
+    SetName( _T( "" ) );
 }
 
 CNodeFunctionPtr::CNodeFunctionPtr( CWnd* pParentWindow, ULONG_PTR Address )
@@ -59,6 +59,8 @@ NODESIZE CNodeFunctionPtr::Draw( const PVIEWINFO View, int x, int y )
     NODESIZE DrawSize;
     int tx, ax;
 
+    g_WindowNodesDrawn++;
+
     if (IsHidden( ))
         return DrawHidden( View, x, y );
 
@@ -101,7 +103,7 @@ NODESIZE CNodeFunctionPtr::Draw( const PVIEWINFO View, int x, int y )
     tx += g_FontWidth;
     tx = AddComment( View, tx, y );
 
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         //for (size_t i = 0; i < m_Assembly.size( ); i++)
         //{
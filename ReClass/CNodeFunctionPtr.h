@@ -11,7 +11,7 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( ) { return sizeof( void* ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_functionptr ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
@@ -36,13 +36,11 @@ NODESIZE CNodeHex16::Draw( const PVIEWINFO View, int x, int y )
 
     if (g_bText)
     {
-        CStringA str = GetStringFromMemoryA( (const char*)Data, 2 );
-        str += "       ";
-        tx = AddText( View, tx, y, g_clrChar, HS_NONE, "%s", str.GetBuffer( ) );
+        tx = AddMemoryText( View, tx, y, Data, 2 );
     }
 
-    tx = AddText( View, tx, y, g_clrHex, 0, _T( "%0.2X" ), Data[0] & 0xFF ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 1, _T( "%0.2X" ), Data[1] & 0xFF ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 0, Data[0] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 1, Data[1] ) + g_FontWidth;
     tx = AddComment( View, tx, y );
 
     DrawSize.x = tx;
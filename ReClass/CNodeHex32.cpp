@@ -34,16 +34,13 @@ NODESIZE CNodeHex32::Draw( const PVIEWINFO View, int x, int y )
 
     if (g_bText)
     {
-        // TODO these are the dots, do alignment instead of 4
-        CStringA str = GetStringFromMemoryA( (const char*)Data, 4 );
-        str += "     ";
-        tx = AddText( View, tx, y, g_clrChar, HS_NONE, "%s", str );
+        tx = AddMemoryText( View, tx, y, Data, 4 );
     }
 
-    tx = AddText( View, tx, y, g_clrHex, 0, _T( "%0.2X" ), Data[0] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 1, _T( "%0.2X" ), Data[1] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 2, _T( "%0.2X" ), Data[2] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 3, _T( "%0.2X" ), Data[3] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 0, Data[0] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 1, Data[1] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 2, Data[2] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 3, Data[3] ) + g_FontWidth;
     tx = AddComment( View, tx, y );
 
     DrawSize.x = tx;
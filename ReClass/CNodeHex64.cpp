@@ -34,18 +34,17 @@ NODESIZE CNodeHex64::Draw( const PVIEWINFO View, int x, int y )
 
     if (g_bText)
     {
-        CStringA AsciiMemory = GetStringFromMemoryA( (const char*)Data, 8 ) + " ";
-        tx = AddText( View, tx, y, g_clrChar, HS_NONE, "%s", AsciiMemory.GetBuffer( ) );
+        tx = AddMemoryText( View, tx, y, Data, 8 );
     }
 
-    tx = AddText( View, tx, y, g_clrHex, 0, _T( "%0.2X" ), Data[0] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 1, _T( "%0.2X" ), Data[1] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 2, _T( "%0.2X" ), Data[2] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 3, _T( "%0.2X" ), Data[3] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 4, _T( "%0.2X" ), Data[4] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 5, _T( "%0.2X" ), Data[5] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 6, _T( "%0.2X" ), Data[6] ) + g_FontWidth;
-    tx = AddText( View, tx, y, g_clrHex, 7, _T( "%0.2X" ), Data[7] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 0, Data[0] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 1, Data[1] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 2, Data[2] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 3, Data[3] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 4, Data[4] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 5, Data[5] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 6, Data[6] ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 7, Data[7] ) + g_FontWidth;
     tx = AddComment( View, tx, y );
 
     DrawSize.x = tx;
@@ -8,7 +8,7 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( ) { return sizeof( __int64 ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_hex64 ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 };
@@ -34,12 +34,10 @@ NODESIZE CNodeHex8::Draw( const PVIEWINFO View, int x, int y )
 
     if (g_bText)
     {
-        CStringA str = GetStringFromMemoryA( (const char*)Data, 1 );
-        str += "        ";
-        tx = AddText( View, tx, y, g_clrChar, HS_NONE, "%s", str.GetBuffer( ) );
+        tx = AddMemoryText( View, tx, y, Data, 1 );
     }
 
-    tx = AddText( View, tx, y, g_clrHex, 0, _T( "%0.2X" ), Data[0] & 0xFF ) + g_FontWidth;
+    tx = AddHex<2>( View, tx, y, g_clrHex, 0, Data[0] ) + g_FontWidth;
     tx = AddComment( View, tx, y );
 
     DrawSize.x = tx;
@@ -43,7 +43,7 @@ NODESIZE CNodeMatrix::Draw( const PVIEWINFO View, int x, int y )
     tx += g_FontWidth;
     tx = AddComment( View, tx, y );
 
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         y += g_FontHeight;
         tx = mx;
@@ -6,7 +6,7 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( ) { return 4 * 4 * sizeof( float ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_matrix ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 };
\ No newline at end of file
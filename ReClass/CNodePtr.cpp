@@ -44,7 +44,7 @@ NODESIZE CNodePtr::Draw( const PVIEWINFO View, int x, int y )
     y += g_FontHeight;
     DrawSize.x = tx;
 
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         DWORD NeededSize = m_pClassNode->GetMemorySize( );
         m_Memory.SetSize( NeededSize );
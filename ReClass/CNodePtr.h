@@ -9,11 +9,11 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( ) { return sizeof( void* ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_pointer ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
-    inline void SetClass( CNodeClass* pClassNode ) { m_pClassNode = pClassNode; }
+    inline void SetClass( CNodeClass* pClassNode ) { m_pClassNode = pClassNode; InvalidateLayout( ); }
     inline CNodeClass* GetClass( void ) { return m_pClassNode; }
 
     inline CMemory* Memory( ) { return &m_Memory; }
@@ -51,7 +51,7 @@ NODESIZE CNodePtrArray::Draw( const PVIEWINFO View, int x, int y )
     tx = AddComment( View, tx, y );
 
     y += g_FontHeight;
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         if (IsMemory( View->Address + m_Offset + (sizeof( ULONG_PTR ) * m_iCurrentIndex) ))
         {
@@ -99,7 +99,7 @@ void CNodePtrArray::Update( const PHOTSPOT Spot )
     {
         if (UlongValue == 0)
             return;
-        m_ulPtrCount = UlongValue;
+        SetCount( UlongValue );
     }
     else if (Spot->Id == 1)
     {
@@ -13,7 +13,7 @@ public:
     virtual void Update( const PHOTSPOT Spot );
 
     inline ULONG Count( void ) { return m_ulPtrCount; }
-    inline void SetCount( ULONG Count ) { m_ulPtrCount = Count; }
+    inline void SetCount( ULONG Count ) { m_ulPtrCount = Count; InvalidateSize( ); }
 
     void SetClass( CNodeClass* pNode ) { m_pNodePtr->SetClass( pNode ); }
     CNodeClass* GetClass( void ) { return m_pNodePtr->GetClass( ); }
@@ -4,7 +4,7 @@
 CNodeText::CNodeText( )
 {
     m_nodeType = nt_text;
-    m_strName = _T( "Text" );
+    SetName( _T( "Text" ) );
     m_dwMemorySize = 16;
 }
 
@@ -16,7 +16,7 @@ void CNodeText::Update( const PHOTSPOT Spot )
 
     if (Spot->Id == 0)
     {
-        m_dwMemorySize = _ttoi( Spot->Text.GetString( ) );
+        SetSize( _ttoi( Spot->Text.GetString( ) ) );
     }
     else if (Spot->Id == 1)
     {
@@ -53,9 +53,10 @@ NODESIZE CNodeText::Draw( const PVIEWINFO View, int x, int y )
 
     if (VALID( Data ))
     {
-        CStringA MemoryString( GetStringFromMemoryA( Data, GetMemorySize( ) ) );
+        TCHAR MemoryString[151];
+        int Length = FormatPrintable( MemoryString, Data, min( (int)GetMemorySize( ), 150 ) );
         tx = AddText( View, tx, y, g_clrChar, HS_NONE, _T( " = '" ) );
-        tx = AddText( View, tx, y, g_clrChar, 1, "%.150s", MemoryString.GetBuffer( ) );
+        tx = AddString( View, tx, y, g_clrChar, 1, MemoryString, Length );
         tx = AddText( View, tx, y, g_clrChar, HS_NONE, _T( "' " ) ) + g_FontWidth;
     }
 
@@ -12,7 +12,7 @@ public:
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
-    inline void SetSize( DWORD size ) { m_dwMemorySize = size; }
+    inline void SetSize( DWORD size ) { m_dwMemorySize = size; InvalidateSize( ); }
     inline DWORD GetSize( void ) { return m_dwMemorySize; }
 
 private:
@@ -4,7 +4,7 @@
 CNodeUnicode::CNodeUnicode( )
 {
     m_nodeType = nt_unicode;
-    m_strName = _T( "Unicode" );
+    SetName( _T( "Unicode" ) );
     m_dwMemorySize = 8 * sizeof( wchar_t );
 }
 
@@ -18,7 +18,7 @@ void CNodeUnicode::Update( const PHOTSPOT Spot )
 
     if (Spot->Id == 0)
     {
-        m_dwMemorySize = _ttoi( Spot->Text.GetString( ) ) * sizeof( wchar_t );
+        SetSize( _ttoi( Spot->Text.GetString( ) ) * sizeof( wchar_t ) );
     }
     else if (Spot->Id == 1)
     {
@@ -65,9 +65,10 @@ NODESIZE CNodeUnicode::Draw( const PVIEWINFO View, int x, int y )
 
     if (VALID( Data ))
     {
-        CStringW MemoryString( GetStringFromMemoryW( Data, m_dwMemorySize / sizeof( wchar_t ) ) );
+        TCHAR MemoryString[151];
+        int Length = FormatPrintable( MemoryString, Data, min( (int)(m_dwMemorySize / sizeof( wchar_t )), 150 ) );
         tx = AddText( View, tx, y, g_clrChar, HS_NONE, _T( " = '" ) );
-        tx = AddText( View, tx, y, g_clrChar, HS_OPENCLOSE, _T( "%.150ws" ), MemoryString.GetString( ) ); // ws cause its unicode
+        tx = AddString( View, tx, y, g_clrChar, HS_OPENCLOSE, MemoryString, Length );
         tx = AddText( View, tx, y, g_clrChar, HS_NONE, _T( "' " ) ) + g_FontWidth;
     }
 
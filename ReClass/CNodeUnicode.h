@@ -13,7 +13,7 @@ public:
     
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
     
-    inline void SetSize( ULONG Size ) { m_dwMemorySize = Size; }
+    inline void SetSize( ULONG Size ) { m_dwMemorySize = Size; InvalidateSize( ); }
     inline ULONG GetSize( void ) { return m_dwMemorySize; }
 
 private:
@@ -51,7 +51,7 @@ NODESIZE CNodeVTable::Draw( const PVIEWINFO View, int x, int y )
     DrawSize.x = x;
     DrawSize.y = y;
 
-    if (m_LevelsOpen[View->Level])
+    if (IsLevelOpen( View->Level ))
     {
         VIEWINFO NewView;
 
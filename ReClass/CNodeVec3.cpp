@@ -4,8 +4,7 @@
 CNodeVec3::CNodeVec3( )
 {
 	m_nodeType = nt_vec3;
-	for (size_t i = 0; i < m_LevelsOpen.size( ); i++)
-		m_LevelsOpen[i] = true;
+	OpenAllLevels( );
 }
 
 void CNodeVec3::Update( const PHOTSPOT Spot )
@@ -39,7 +38,7 @@ NODESIZE CNodeVec3::Draw( const PVIEWINFO View, int x, int y )
 	tx = AddText( View, tx, y, g_clrType, HS_NONE, _T( "Vec3 " ) );
 	tx = AddText( View, tx, y, g_clrName, HS_NAME, _T( "%s" ), m_strName );
 	tx = AddOpenClose( View, tx, y );
-	if (m_LevelsOpen[View->Level])
+	if (IsLevelOpen( View->Level ))
 	{
 		tx = AddText( View, tx, y, g_clrName, HS_NONE, _T( "(" ) );
 		tx = AddText( View, tx, y, g_clrValue, 0, _T( "%0.3f" ), Data[0] );
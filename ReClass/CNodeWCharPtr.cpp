@@ -4,7 +4,7 @@
 CNodeWCharPtr::CNodeWCharPtr( )
 {
     m_nodeType = nt_pwchar;
-    m_strName = "PWChar";
+    SetName( _T( "PWChar" ) );
 }
 
 void CNodeWCharPtr::Update( const PHOTSPOT Spot )
@@ -9,7 +9,7 @@ public:
 
     virtual void Update( const PHOTSPOT Spot );
 
-    virtual ULONG GetMemorySize( ) { return sizeof( void* ); }
+    virtual ULONG GetMemorySize( ) { return GetFixedNodeSize( nt_pwchar ); }
 
     virtual NODESIZE Draw( const PVIEWINFO View, int x, int y );
 
@@ -0,0 +1,82 @@
+#include "stdafx.h"
+
+#include "ChangeTracker.h"
+
+#if defined(_M_AMD64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
+void CChangeTracker::Update( ULONG_PTR Address, const UCHAR* Data, ULONG Size )
+{
+    if (Address != m_Address || Size != m_Previous.size( ))
+    {
+        m_Address = Address;
+        m_Previous.assign( Data, Data + Size );
+        m_Age.assign( Size, CHANGE_AGE_NONE );
+        m_Youngest = CHANGE_AGE_NONE;
+        return;
+    }
+
+    UCHAR* Previous = m_Previous.data( );
+    UCHAR* Age = m_Age.data( );
+    UCHAR Youngest = CHANGE_AGE_NONE;
+    ULONG i = 0;
+
+    //
+    // Age is 0 where the byte differs and one more (saturating) where it
+    // doesn't, and this paint becomes the previous one
+    //
+    #if defined(_M_AMD64) || defined(_M_IX86)
+    const __m128i One = _mm_set1_epi8( 1 );
+    __m128i YoungestAges = _mm_set1_epi8( (char)CHANGE_AGE_NONE );
+    for (; i + 16 <= Size; i += 16)
+    {
+        __m128i Current = _mm_loadu_si128( (const __m128i*)(Data + i) );
+        __m128i Same = _mm_cmpeq_epi8( Current, _mm_loadu_si128( (const __m128i*)(Previous + i) ) );
+        __m128i Older = _mm_adds_epu8( _mm_loadu_si128( (const __m128i*)(Age + i) ), One );
+        __m128i NewAge = _mm_and_si128( Same, Older );
+        YoungestAges = _mm_min_epu8( YoungestAges, NewAge );
+        _mm_storeu_si128( (__m128i*)(Age + i), NewAge );
+        _mm_storeu_si128( (__m128i*)(Previous + i), Current );
+    }
+
+    UCHAR Lanes[16];
+    _mm_storeu_si128( (__m128i*)Lanes, YoungestAges );
+    for (int Lane = 0; Lane < 16; Lane++)
+        Youngest = min( Youngest, Lanes[Lane] );
+    #endif
+
+    for (; i < Size; i++)
+    {
+        if (Data[i] != Previous[i])
+            Age[i] = 0;
+        else if (Age[i] != CHANGE_AGE_NONE)
+            Age[i]++;
+        Previous[i] = Data[i];
+        Youngest = min( Youngest, Age[i] );
+    }
+
+    m_Youngest = Youngest;
+}
+
+void CChangeTracker::Reset( )
+{
+    m_Address = 0;
+    m_Previous.clear( );
+    m_Age.clear( );
+    m_Youngest = CHANGE_AGE_NONE;
+}
+
+UCHAR CChangeTracker::GetAge( ULONG_PTR Address, ULONG Size ) const
+{
+    if (Address < m_Address || Address - m_Address >= m_Age.size( ))
+        return CHANGE_AGE_NONE;
+
+    size_t Start = Address - m_Address;
+    size_t End = min( Start + Size, m_Age.size( ) );
+
+    UCHAR Youngest = CHANGE_AGE_NONE;
+    for (size_t i = Start; i < End; i++)
+        Youngest = min( Youngest, m_Age[i] );
+    return Youngest;
+}
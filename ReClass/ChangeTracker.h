@@ -0,0 +1,36 @@
+#pragma once
+
+//
+// Change tracker
+//
+// Remembers what a view's class memory looked like on the last paint and,
+// per byte, how many paints ago it last changed. CClassView feeds it the
+// buffer it already reads every paint, so the diff is one SSE2 pass over
+// memory that is already in cache. Nodes look themselves up by address:
+// pointer children live elsewhere and simply never show up as changed.
+//
+#include <vector>
+
+#define CHANGE_AGE_NONE 0xFF    // Unchanged for as long as we can count
+
+class CChangeTracker {
+public:
+    CChangeTracker( ) : m_Address( 0 ), m_Youngest( CHANGE_AGE_NONE ) { }
+
+    // Data is this paint's copy of [Address, Address + Size). A different
+    // address or size starts over, nothing counts as changed on that paint.
+    void Update( ULONG_PTR Address, const UCHAR* Data, ULONG Size );
+    void Reset( );
+
+    // Paints since any byte of [Address, Address + Size) changed
+    UCHAR GetAge( ULONG_PTR Address, ULONG Size ) const;
+
+    // Age of the most recent change anywhere, as of the last Update
+    UCHAR GetYoungestAge( ) const { return m_Youngest; }
+
+private:
+    ULONG_PTR m_Address;
+    std::vector<UCHAR> m_Previous;
+    std::vector<UCHAR> m_Age;
+    UCHAR m_Youngest;
+};
@@ -1,81 +1,282 @@
 #pragma once
-#include "CNodeClass.h"
-
+//
+// Orders classes so every class is defined after the classes it instances and
+// forward declares the ones it only points to. ClassT is only ever used
+// through pointers, as the identity of a class: the application orders its
+// CNodeClass objects, the command line generator (ReClassGen) the class
+// records of a binary project. Free of MFC for the latter.
+//
 #include <assert.h>
-#include <atlbase.h>
-#include <fstream>
-#include <iostream>
 #include <map>
 #include <set>
 #include <string>
 #include <sstream>
 #include <vector>
 
-class DependencyNode;
+class CNodeClass;
 
 enum class DependencyType {
 	POINTER,
 	INSTANCE
 };
 
+template <class ClassT>
+class DependencyNode;
+
+template <class ClassT>
 struct DependencyEdge {
-	const DependencyNode* dependency;
+	const DependencyNode<ClassT>* dependency;
 	const DependencyType	edgeType;
 
-	DependencyEdge(const DependencyNode* dependency, const DependencyType edgeType) : dependency(dependency), edgeType(edgeType) {};
+	DependencyEdge(const DependencyNode<ClassT>* dependency, const DependencyType edgeType) : dependency(dependency), edgeType(edgeType) {};
 	bool operator==(const DependencyEdge& other) const {
 		return this->dependency == other.dependency && this->edgeType == other.edgeType;
 	}
 };
 
+template <class ClassT>
 class DependencyNode {
-	const CNodeClass* cClass = nullptr;
-	std::vector<DependencyEdge> dependencies;
-	std::vector<DependencyEdge> inEdges;
+	const ClassT* cClass = nullptr;
+	std::vector<DependencyEdge<ClassT>> dependencies;
+	std::vector<DependencyEdge<ClassT>> inEdges;
 public:
 	DependencyNode() {};
-	DependencyNode(const CNodeClass* cClass) : cClass(cClass) {};
-	const std::vector<DependencyEdge>* GetDependencies() const;
-	const std::vector<DependencyEdge>* GetInEdges() const { return &this->inEdges; }
-	const CNodeClass* GetCClass() const { return this->cClass; }
+	DependencyNode(const ClassT* cClass) : cClass(cClass) {};
+	const std::vector<DependencyEdge<ClassT>>* GetDependencies() const { return &this->dependencies; }
+	const std::vector<DependencyEdge<ClassT>>* GetInEdges() const { return &this->inEdges; }
+	const ClassT* GetCClass() const { return this->cClass; }
 	bool AddDependency(const DependencyNode* dep, const DependencyType edgeType);
 	bool AddInEdge(const DependencyNode* parent, const DependencyType edgeType);
 };
 
-class ClassDependencyGraph {
-	std::map<const CNodeClass*, DependencyNode> nodes;
-	
-	std::vector<DependencyNode*> GetLeafNodes();
-	std::vector<DependencyNode*> GetInstanceNodes();
+template <class ClassT>
+class ClassDependencyGraphT {
+	std::map<const ClassT*, DependencyNode<ClassT>> nodes;
+
+	std::vector<DependencyNode<ClassT>*> GetLeafNodes();
+	std::vector<DependencyNode<ClassT>*> GetInstanceNodes();
 	enum class NodeGenerationStatus {
 		UNPROCESSED,
 		PROCESSING,
 		PROCESSED,
 		INSTANCED
 	};
-	int ProcessDependencies(DependencyEdge *node, std::map<const DependencyNode*, NodeGenerationStatus> &nodeStatus, std::set<const CNodeClass*>& forwardDeclarations, std::vector<const CNodeClass*> &classDefinitions);
+	int ProcessDependencies(const DependencyEdge<ClassT>* edge, std::map<const DependencyNode<ClassT>*, NodeGenerationStatus>& nodeStatus, std::set<const ClassT*>& forwardDeclarations, std::vector<const ClassT*> &classDefinitions);
 
 
 public:
-	bool AddNode(const CNodeClass* node) {
+	bool AddNode(const ClassT* node) {
 		if (this->nodes.find(node) == this->nodes.end()) {
-			this->nodes[node] = DependencyNode(node);
+			this->nodes[node] = DependencyNode<ClassT>(node);
 			return true;
 		}
 		return false;
 	}
 
-	bool AddEdge(const CNodeClass *dependingClass, const CNodeClass* dependency, DependencyType depType) {
+	bool AddEdge(const ClassT *dependingClass, const ClassT* dependency, DependencyType depType) {
 		// Ignore simple recursion in the dependency graph.  It won't help in our analysis and will just muddy
 		// up the graph.
 		if (dependingClass == dependency) {
 			return false;
 		}
-		DependencyNode* dependingNode = &this->nodes[dependingClass];
-		DependencyNode* dependencyNode = &this->nodes[dependency];
+		DependencyNode<ClassT>* dependingNode = &this->nodes[dependingClass];
+		DependencyNode<ClassT>* dependencyNode = &this->nodes[dependency];
 		dependencyNode->AddInEdge(dependingNode, depType);
 		return dependingNode->AddDependency(dependencyNode, depType);
 	}
-	std::string ToDot(std::string graphLabel = "");
-	int OrderClassesForGeneration(std::set<const CNodeClass*>& forwardDeclarations, std::vector<const CNodeClass*> &classDefinitions);
-};
\ No newline at end of file
+	// GetName returns a class's name as a std::string
+	template <class NameFn>
+	std::string ToDot(NameFn GetName, std::string graphLabel = "");
+	int OrderClassesForGeneration(std::set<const ClassT*>& forwardDeclarations, std::vector<const ClassT*> &classDefinitions);
+};
+
+typedef ClassDependencyGraphT<CNodeClass> ClassDependencyGraph;
+
+
+template <class ClassT>
+bool DependencyNode<ClassT>::AddInEdge(const DependencyNode* parent, const DependencyType edgeType) {
+	DependencyEdge<ClassT> newEdge(parent, edgeType);
+	//
+	// We do not allow parallel edges, so we check to make sure this edge doesn't already exist.
+	// We COULD have used a map for the dependencies container.  But, most classes probably won't
+	// have a ton of dependencies, so a vector makes sense for our more average case.
+	//
+	for (auto edge : this->inEdges) {
+		if (edge == newEdge) {
+			return false;
+		}
+	}
+	this->inEdges.push_back(newEdge);
+	return true;
+}
+
+template <class ClassT>
+bool DependencyNode<ClassT>::AddDependency(const DependencyNode* dep, const DependencyType edgeType) {
+	DependencyEdge<ClassT> newEdge(dep, edgeType);
+	//
+	// We do not allow parallel edges, so we check to make sure this edge doesn't already exist.
+	// We COULD have used a map for the dependencies container.  But, most classes probably won't
+	// have a ton of dependencies, so a vector makes sense for our more average case.
+	//
+	for (auto edge : this->dependencies) {
+		if (edge == newEdge) {
+			return false;
+		}
+	}
+	this->dependencies.push_back(newEdge);
+	return true;
+}
+
+
+template <class ClassT>
+std::vector<DependencyNode<ClassT>*> ClassDependencyGraphT<ClassT>::GetLeafNodes() {
+	std::vector<DependencyNode<ClassT>*> result;
+	for (auto it = nodes.begin(); it != nodes.end(); it++) {
+		if (it->second.GetInEdges()->size() == 0) {
+			result.push_back(&it->second);
+		}
+	}
+	return result;
+}
+
+template <class ClassT>
+std::vector<DependencyNode<ClassT>*> ClassDependencyGraphT<ClassT>::GetInstanceNodes() {
+	std::vector<DependencyNode<ClassT>*> result;
+	for (auto it = nodes.begin(); it != nodes.end(); it++) {
+		bool hasOutInstanceEdge = false;
+
+		for (auto inEdge : *it->second.GetInEdges()) {
+			if (inEdge.edgeType == DependencyType::INSTANCE) {
+				hasOutInstanceEdge = true;
+				break;
+			}
+		}
+		if (hasOutInstanceEdge) {
+			result.push_back(&it->second);
+		}
+	}
+	return result;
+}
+
+template <class ClassT>
+int ClassDependencyGraphT<ClassT>::ProcessDependencies(const DependencyEdge<ClassT>* edge, std::map<const DependencyNode<ClassT>*, NodeGenerationStatus>& nodeStatus, std::set<const ClassT*>& forwardDeclarations, std::vector<const ClassT*> &classDefinitions) {
+	int classesAdded = 0;
+	NodeGenerationStatus nodeGenStatus;
+	const DependencyNode<ClassT>* node = edge->dependency;
+	if (nodeStatus.find(node) == nodeStatus.end()) {
+		nodeStatus[node] = NodeGenerationStatus::UNPROCESSED;
+	}
+	nodeGenStatus = nodeStatus[node];
+	// We have to treat instanced nodes differently, since they have 'hard' dependencies
+	// on their parent classes.  If we come across an instanced node through a pointer,
+	// we will forward declare it because if we try to process it like normal we may end
+	// up with a back edge to its parent that will break everything.
+	//
+	// If we come upon an instanced node througn an instance, we process it like normal.
+	if (nodeGenStatus == NodeGenerationStatus::INSTANCED) {
+		if (edge->edgeType == DependencyType::POINTER) {
+			forwardDeclarations.insert(node->GetCClass());
+			return 0;
+		}
+		else if (edge->edgeType == DependencyType::INSTANCE) {
+			// Change nodeGenStatys to trigger the actual processing of the node
+			nodeGenStatus = NodeGenerationStatus::UNPROCESSED;
+		}
+	}
+	if (nodeGenStatus == NodeGenerationStatus::PROCESSED) {
+		// The node is already written to the output, no further processing needed
+		return classesAdded;
+	}
+	else if (nodeGenStatus == NodeGenerationStatus::PROCESSING) {
+		// We've hit a back edge.  Since we start from leaf nodes, this dependency cannot
+		// possibly be an instance dependency, it must be a pointer dependency.  Thus, a
+		// forward declaration is enough to handle this case.
+		assert(edge->edgeType == DependencyType::POINTER);
+		forwardDeclarations.insert(node->GetCClass());
+		// While it isn't actually finished processing, if we leave it as PROCESSING we'll
+		// get a new forward declaration every time we hit this node.  If it's currently
+		// processing, somewhere up the call stack is the actual processing of this node
+		// so on return it'll get finished up.
+		nodeStatus[node] = NodeGenerationStatus::PROCESSED;
+	}
+	else {
+		// Case where processing has yet to begin.  We need to recursively process all dependencies,
+		// then add this class to the ordered list of definitions.
+		nodeStatus[node] = NodeGenerationStatus::PROCESSING;
+		for (auto dep : *node->GetDependencies()) {
+			if (dep.edgeType == DependencyType::INSTANCE)
+				classesAdded += ProcessDependencies(&dep, nodeStatus, forwardDeclarations, classDefinitions);
+		}
+		for (auto dep : *node->GetDependencies()) {
+			if (dep.edgeType == DependencyType::POINTER)
+				classesAdded += ProcessDependencies(&dep, nodeStatus, forwardDeclarations, classDefinitions);
+		}
+		classDefinitions.push_back(node->GetCClass());
+		nodeStatus[node] = NodeGenerationStatus::PROCESSED;
+		classesAdded += 1;
+	}
+	return classesAdded;
+}
+
+template <class ClassT>
+template <class NameFn>
+std::string ClassDependencyGraphT<ClassT>::ToDot(NameFn GetName, std::string graphLabel) {
+	std::stringstream stream;
+	stream << "digraph class_dependency {";
+	for (auto& node : this->nodes) {
+		for (auto edge : *node.second.GetDependencies()) {
+			stream << "\"";
+			stream << GetName(node.first);
+			stream << "\"";
+			stream << " -> ";
+			stream << "\"";
+			stream << GetName(edge.dependency->GetCClass());
+			stream << "\"";
+			if (edge.edgeType == DependencyType::POINTER) {
+				stream << " [style=dotted]";
+			}
+			stream << ";";
+			stream << "\n";
+		}
+	}
+	stream << "}";
+	return stream.str();
+}
+
+template <class ClassT>
+int ClassDependencyGraphT<ClassT>::OrderClassesForGeneration(std::set<const ClassT*>& forwardDeclarations, std::vector<const ClassT*>& classDefinitions) {
+	int classesAdded = 0;
+	std::map<const DependencyNode<ClassT>*, NodeGenerationStatus> nodeStatus;
+	std::vector<DependencyNode<ClassT>*> leafNodes			= this->GetLeafNodes();
+	std::vector<DependencyNode<ClassT>*> instancedNodes		= this->GetInstanceNodes();
+
+	for (auto node : instancedNodes) {
+		nodeStatus[node] = NodeGenerationStatus::INSTANCED;
+	}
+
+	for (auto leaf : leafNodes) {
+		for (auto dep : *leaf->GetDependencies()) {
+			classesAdded += ProcessDependencies(&dep, nodeStatus, forwardDeclarations, classDefinitions);
+		}
+		classDefinitions.push_back(leaf->GetCClass());
+		nodeStatus[leaf] = NodeGenerationStatus::PROCESSED;
+		classesAdded += 1;
+	}
+
+	// Classes that only sit on pointer cycles (a player pointing to its weapon,
+	// the weapon back to its owner) have no leaf above them. Start those from a
+	// class nothing instances first, like a leaf, then take whatever is left.
+	for (int pass = 0; pass < 2; pass++) {
+		for (auto& it : this->nodes) {
+			auto status = nodeStatus.find(&it.second);
+			if (status != nodeStatus.end() && status->second == NodeGenerationStatus::PROCESSED)
+				continue;
+			if (pass == 0 && status != nodeStatus.end() && status->second == NodeGenerationStatus::INSTANCED)
+				continue;
+			DependencyEdge<ClassT> root(&it.second, DependencyType::INSTANCE);
+			classesAdded += ProcessDependencies(&root, nodeStatus, forwardDeclarations, classDefinitions);
+		}
+	}
+
+	return classesAdded;
+}
@@ -0,0 +1,397 @@
+//
+// C++ code generator. Deliberately free of MFC and the precompiled header so
+// it builds on the Linux analysis hosts as well.
+//
+#include "CodeGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+// Below this many classes per thread starting threads costs more than it saves
+#define CODEGEN_CLASSES_PER_WORKER 32
+
+static void AppendHex( std::string& Text, uint32_t Value, int MinDigits )
+{
+    char Digits[8];
+    int Count = 0;
+
+    do
+    {
+        Digits[Count++] = "0123456789ABCDEF"[Value & 0xF];
+        Value >>= 4;
+    } while (Value != 0);
+
+    for (int i = Count; i < MinDigits; i++)
+        Text.push_back( '0' );
+    while (Count > 0)
+        Text.push_back( Digits[--Count] );
+}
+
+static void AppendDecimal( std::string& Text, uint32_t Value )
+{
+    Text += std::to_string( Value );
+}
+
+// "//0x0010 comment\r\n", the tail of every member line
+static void AppendOffsetComment( std::string& Text, const CODEGEN_MEMBER& Member )
+{
+    Text += "; //0x";
+    AppendHex( Text, Member.Offset, 4 );
+    Text.push_back( ' ' );
+    Text += Member.Comment;
+    Text += "\r\n";
+}
+
+static void AppendPadding( std::string& Text, const CODEGEN_OPTIONS& Options, uint32_t Start, uint32_t Size, bool bLast )
+{
+    if (Options.bPrivatePadding)
+        Text += "private:\r\n";
+
+    Text.push_back( '\t' );
+    Text += Options.HexType;
+    Text += " pad_0x";
+    AppendHex( Text, Start, 4 );
+    Text += "[0x";
+    AppendHex( Text, Size, 1 );
+    Text += "]; //0x";
+    AppendHex( Text, Start, 4 );
+    Text += "\r\n";
+
+    // The last pad leaves the class private, like it always has
+    if (Options.bPrivatePadding && !bLast)
+        Text += "public:\r\n";
+}
+
+//
+// Layout checks for the compiler. An empty class still has sizeof 1, padding,
+// declarations and base classes have no member name to take the offset of.
+//
+static void AppendStaticAsserts( std::string& Text, const CODEGEN_CLASS& Class )
+{
+    if (Class.Size != 0)
+    {
+        Text += "static_assert( sizeof( ";
+        Text += Class.Name;
+        Text += " ) == 0x";
+        AppendHex( Text, Class.Size, 1 );
+        Text += ", \"";
+        Text += Class.Name;
+        Text += " has the wrong size\" );\r\n";
+    }
+
+    for (const CODEGEN_MEMBER& Member : Class.Members)
+    {
+        if ((Member.Kind != CODEGEN_FIELD && Member.Kind != CODEGEN_ARRAY) || Member.Name.empty( ))
+            continue;
+
+        Text += "static_assert( offsetof( ";
+        Text += Class.Name;
+        Text += ", ";
+        Text += Member.Name;
+        Text += " ) == 0x";
+        AppendHex( Text, Member.Offset, 1 );
+        Text += ", \"";
+        Text += Class.Name;
+        Text += "::";
+        Text += Member.Name;
+        Text += " has the wrong offset\" );\r\n";
+    }
+}
+
+//
+// FNV-1a. Strings go in with their length so moving characters between two
+// neighbouring strings changes the hash.
+//
+struct CodeGenHash {
+    uint64_t Value = 14695981039346656037ULL;
+
+    void Add( const void* Data, size_t Size )
+    {
+        const uint8_t* Bytes = (const uint8_t*)Data;
+        for (size_t i = 0; i < Size; i++)
+        {
+            Value ^= Bytes[i];
+            Value *= 1099511628211ULL;
+        }
+    }
+
+    void Add( uint32_t Number ) { Add( &Number, sizeof( Number ) ); }
+
+    void Add( const std::string& String )
+    {
+        Add( (uint32_t)String.size( ) );
+        Add( String.data( ), String.size( ) );
+    }
+};
+
+CCodeGenerator::CCodeGenerator( )
+    : m_OptionsHash( 0 )
+    , m_LastFormatted( 0 )
+{
+}
+
+uint64_t CCodeGenerator::HashClass( const CODEGEN_CLASS& Class )
+{
+    CodeGenHash Hash;
+
+    Hash.Add( Class.Name );
+    Hash.Add( Class.Code );
+    Hash.Add( Class.Size );
+    Hash.Add( (uint32_t)Class.Members.size( ) );
+
+    for (const CODEGEN_MEMBER& Member : Class.Members)
+    {
+        Hash.Add( (uint32_t)Member.Kind );
+        Hash.Add( Member.Type );
+        Hash.Add( Member.Name );
+        Hash.Add( Member.Comment );
+        Hash.Add( Member.Offset );
+        Hash.Add( Member.Size );
+        Hash.Add( (uint32_t)Member.Functions.size( ) );
+
+        for (const CODEGEN_FUNCTION& Function : Member.Functions)
+        {
+            Hash.Add( Function.Name );
+            Hash.Add( Function.Comment );
+        }
+    }
+
+    return Hash.Value;
+}
+
+void CCodeGenerator::FormatClass( const CODEGEN_CLASS& Class, const CODEGEN_OPTIONS& Options, std::string& Text )
+{
+    std::string ClassLine = "class " + Class.Name;
+    std::string Functions;
+    std::string Variables;
+    uint32_t Fill = 0;
+    uint32_t FillStart = 0;
+
+    for (const CODEGEN_MEMBER& Member : Class.Members)
+    {
+        if (Member.Kind == CODEGEN_PADDING)
+        {
+            if (Fill == 0)
+                FillStart = Member.Offset;
+            Fill += Member.Size;
+            continue;
+        }
+
+        if (Fill > 0)
+            AppendPadding( Variables, Options, FillStart, Fill, false );
+        Fill = 0;
+
+        switch (Member.Kind)
+        {
+        case CODEGEN_VTABLE:
+            for (size_t f = 0; f < Member.Functions.size( ); f++)
+            {
+                Functions += "\tvirtual ";
+                if (Member.Functions[f].Name.empty( ))
+                {
+                    Functions += "void Function";
+                    AppendDecimal( Functions, (uint32_t)f );
+                    Functions += "()";
+                }
+                else
+                {
+                    Functions += Member.Functions[f].Name;
+                }
+                Functions += "; //";
+                Functions += Member.Functions[f].Comment;
+                Functions += "\r\n";
+            }
+            break;
+        case CODEGEN_FIELD:
+            Variables.push_back( '\t' );
+            Variables += Member.Type;
+            Variables.push_back( ' ' );
+            Variables += Member.Name;
+            AppendOffsetComment( Variables, Member );
+            break;
+        case CODEGEN_ARRAY:
+            Variables.push_back( '\t' );
+            Variables += Member.Type;
+            Variables.push_back( ' ' );
+            Variables += Member.Name;
+            Variables.push_back( '[' );
+            AppendDecimal( Variables, Member.Size );
+            Variables.push_back( ']' );
+            AppendOffsetComment( Variables, Member );
+            break;
+        case CODEGEN_DECLARATION:
+            Variables.push_back( '\t' );
+            Variables += Member.Name;
+            AppendOffsetComment( Variables, Member );
+            break;
+        case CODEGEN_BASE:
+            ClassLine += " : public ";
+            ClassLine += Member.Type;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (Fill > 0)
+        AppendPadding( Variables, Options, FillStart, Fill, true );
+
+    Text += ClassLine;
+    Text += "\r\n{\r\npublic:\r\n";
+
+    if (!Functions.empty( ))
+    {
+        Text += Functions;
+        Text += "\r\n";
+    }
+
+    if (!Variables.empty( ))
+    {
+        Text += Variables;
+        Text += "\r\n";
+    }
+
+    if (!Class.Code.empty( ))
+    {
+        Text += Class.Code;
+        Text += "\r\n";
+    }
+
+    Text += "}; //Size=0x";
+    AppendHex( Text, Class.Size, 4 );
+    Text += "\r\n";
+
+    if (Options.bStaticAsserts)
+        AppendStaticAsserts( Text, Class );
+
+    Text += "\r\n";
+}
+
+void CCodeGenerator::FormatParallel( const CODEGEN_PROJECT& Project, const std::vector<size_t>& Pending, std::vector<std::string>& Texts )
+{
+    std::atomic<size_t> Next( 0 );
+    std::vector<std::thread> Workers;
+    size_t WorkerCount = (std::min<size_t>)( (std::max)( std::thread::hardware_concurrency( ), 1u ), Pending.size( ) / CODEGEN_CLASSES_PER_WORKER );
+
+    Texts.clear( );
+    Texts.resize( Pending.size( ) );
+
+    auto Work = [&] ( ) {
+        for (;;)
+        {
+            size_t i = Next++;
+            if (i >= Pending.size( ))
+                break;
+            FormatClass( Project.Classes[Pending[i]], Project.Options, Texts[i] );
+        }
+    };
+
+    // The calling thread is one of the workers
+    for (size_t i = 1; i < WorkerCount; i++)
+        Workers.emplace_back( Work );
+    Work( );
+
+    for (std::thread& Worker : Workers)
+        Worker.join( );
+}
+
+void CCodeGenerator::FormatClasses( const CODEGEN_PROJECT& Project )
+{
+    std::vector<size_t> Pending;
+    std::vector<std::string> Formatted;
+    std::unordered_map<uint64_t, std::string> Used;
+    CodeGenHash OptionsHash;
+
+    // Padding and asserts are in every class's text
+    OptionsHash.Add( Project.Options.HexType );
+    OptionsHash.Add( (uint32_t)Project.Options.bPrivatePadding );
+    OptionsHash.Add( (uint32_t)Project.Options.bStaticAsserts );
+    if (OptionsHash.Value != m_OptionsHash)
+    {
+        m_Cache.clear( );
+        m_OptionsHash = OptionsHash.Value;
+    }
+
+    //
+    // Equal descriptions give equal text, whichever class they came from.
+    // Only what this export used stays cached.
+    //
+    m_Hashes.resize( Project.Classes.size( ) );
+    for (size_t i = 0; i < Project.Classes.size( ); i++)
+    {
+        m_Hashes[i] = (Project.Classes[i].Hash != 0) ? Project.Classes[i].Hash : HashClass( Project.Classes[i] );
+        if (Used.find( m_Hashes[i] ) != Used.end( ))
+            continue;
+
+        auto Cached = m_Cache.find( m_Hashes[i] );
+        if (Cached != m_Cache.end( ))
+        {
+            Used.emplace( m_Hashes[i], std::move( Cached->second ) );
+        }
+        else
+        {
+            Used.emplace( m_Hashes[i], std::string( ) );
+            Pending.push_back( i );
+        }
+    }
+
+    FormatParallel( Project, Pending, Formatted );
+    for (size_t i = 0; i < Pending.size( ); i++)
+        Used[m_Hashes[Pending[i]]] = std::move( Formatted[i] );
+
+    m_Cache.swap( Used );
+    m_LastFormatted = Pending.size( );
+}
+
+const char* CCodeGenerator::GetOptionIncludes( const CODEGEN_OPTIONS& Options )
+{
+    // offsetof
+    return Options.bStaticAsserts ? "#include <cstddef>\r\n\r\n" : "";
+}
+
+void CCodeGenerator::Generate( const CODEGEN_PROJECT& Project, std::string& Text )
+{
+    FormatClasses( Project );
+
+    //
+    // Assemble in one buffer
+    //
+    static const char Banner[] = "// Generated using ReClassEx\r\n\r\n";
+    const char* Includes = GetOptionIncludes( Project.Options );
+    size_t Length = sizeof( Banner ) + strlen( Includes ) + Project.Header.size( ) + Project.Footer.size( ) + 8;
+
+    for (const std::string& Name : Project.ForwardDeclarations)
+        Length += Name.size( ) + 9;
+    for (size_t i = 0; i < Project.Classes.size( ); i++)
+        Length += GetClassText( i ).size( );
+
+    Text.clear( );
+    Text.reserve( Length );
+
+    Text += Banner;
+    Text += Includes;
+    if (!Project.Header.empty( ))
+    {
+        Text += Project.Header;
+        Text += "\r\n\r\n";
+    }
+
+    for (const std::string& Name : Project.ForwardDeclarations)
+    {
+        Text += "class ";
+        Text += Name;
+        Text += ";\r\n";
+    }
+    Text += "\r\n";
+
+    for (size_t i = 0; i < Project.Classes.size( ); i++)
+        Text += GetClassText( i );
+
+    if (!Project.Footer.empty( ))
+    {
+        Text += Project.Footer;
+        Text += "\r\n";
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+//
+// C++ code generator
+//
+// Turns class descriptions into the header OnButtonGenerate shows. A
+// description (CODEGEN_CLASS) is everything the generated text of one class
+// depends on, already resolved to strings: member type names, linked class
+// names, offsets and sizes. The application fills them from its nodes on the
+// UI thread; formatting never touches the nodes, so it can run on any thread.
+//
+// CCodeGenerator keeps the text of every class it generated, keyed by a hash
+// of the description. Exporting a project again only formats classes whose
+// description changed, and those are spread over worker threads. Assembly is
+// a single pass into a buffer reserved to the final size.
+//
+// Portable like the project formats, no MFC and no precompiled header.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum CodeGenMemberKind {
+    CODEGEN_NONE,           // Nothing generated, still ends padding (bits)
+    CODEGEN_PADDING,        // Hex nodes, merged into one pad_ array
+    CODEGEN_FIELD,          // Type Name;
+    CODEGEN_ARRAY,          // Type Name[Count];
+    CODEGEN_DECLARATION,    // Name is the whole declaration (custom, function pointers)
+    CODEGEN_BASE,           // Instance at offset 0, Type is the base class
+    CODEGEN_VTABLE
+};
+
+struct CODEGEN_FUNCTION {
+    std::string Name;       // Declaration, "void FunctionN()" if empty
+    std::string Comment;
+};
+
+struct CODEGEN_MEMBER {
+    CodeGenMemberKind Kind;
+    std::string Type;
+    std::string Name;
+    std::string Comment;
+    uint32_t Offset;
+    uint32_t Size;          // Padding bytes, array element count
+    std::vector<CODEGEN_FUNCTION> Functions;
+};
+
+struct CODEGEN_CLASS {
+    std::string Name;
+    std::string Code;       // User code pasted into the class body
+    uint32_t Size;
+    std::vector<CODEGEN_MEMBER> Members;
+    uint64_t Hash = 0;      // HashClass of the above if the caller kept it, 0 to have it taken
+};
+
+struct CODEGEN_OPTIONS {
+    std::string HexType;            // Element type of padding arrays
+    bool bPrivatePadding;
+    bool bStaticAsserts;            // static_assert sizeof and offsetof after each class, includes <cstddef>
+};
+
+struct CODEGEN_PROJECT {
+    std::string Header;
+    std::string Footer;
+    std::vector<std::string> ForwardDeclarations;
+    std::vector<CODEGEN_CLASS> Classes;     // In definition order
+    CODEGEN_OPTIONS Options;
+};
+
+class CCodeGenerator {
+public:
+    CCodeGenerator( );
+
+    // The whole header, "\r\n" line endings like the rest of the output
+    void Generate( const CODEGEN_PROJECT& Project, std::string& Text );
+
+    // Only the class definitions, GetClassText( i ) is Project.Classes[i]'s
+    // until the next call
+    void FormatClasses( const CODEGEN_PROJECT& Project );
+    inline const std::string& GetClassText( size_t Index ) const { return m_Cache.find( m_Hashes[Index] )->second; }
+
+    // One class definition, appended to Text
+    static void FormatClass( const CODEGEN_CLASS& Class, const CODEGEN_OPTIONS& Options, std::string& Text );
+
+    static uint64_t HashClass( const CODEGEN_CLASS& Class );
+
+    // Includes the options need ahead of the project header, "" if none
+    static const char* GetOptionIncludes( const CODEGEN_OPTIONS& Options );
+
+    // Classes the last Generate formatted instead of taking from the cache
+    inline size_t GetLastFormatted( ) const { return m_LastFormatted; }
+
+private:
+    // Formats Pending on up to hardware_concurrency threads
+    static void FormatParallel( const CODEGEN_PROJECT& Project, const std::vector<size_t>& Pending, std::vector<std::string>& Texts );
+
+    uint64_t m_OptionsHash;
+    std::unordered_map<uint64_t, std::string> m_Cache;
+    std::vector<uint64_t> m_Hashes;     // Of the classes last formatted
+    size_t m_LastFormatted;
+};
@@ -64,9 +64,10 @@ END_MESSAGE_MAP( )
 void CDialogModules::BuildList( )
 {
     int idx = 0;
-    for (auto mi : g_MemMapModules)
+    MemoryMapPtr Map = GetMemoryMap( );
+    for (const auto& mi : Map->Modules)
     {
-        MemMapInfo& moduleInfo = mi.second;
+        const MemMapInfo& moduleInfo = mi.second;
         SHFILEINFO sfi = { 0 };
         SHGetFileInfo( moduleInfo.Path, FILE_ATTRIBUTE_NORMAL, &sfi, sizeof( SHFILEINFO ), SHGFI_ICON | SHGFI_USEFILEATTRIBUTES );
         m_ModuleIcons.Add( sfi.hIcon );
@@ -127,15 +128,19 @@ BOOL CDialogModules::OnInitDialog( )
     return TRUE;
 }
 
-inline int CDialogModules::FindModuleByName( const TCHAR* szName )
+inline BOOLEAN CDialogModules::FindModuleByName( const TCHAR* szName, MemMapInfo& Module )
 {
-    for (auto mi : g_MemMapModules)
+    MemoryMapPtr Map = GetMemoryMap( );
+    for (const auto& mi : Map->Modules)
     {
-        MemMapInfo& moduleInfo = mi.second;
+        const MemMapInfo& moduleInfo = mi.second;
         if (_tcsicmp( moduleInfo.Name, szName ) == 0)
-            return mi.first;
+        {
+            Module = moduleInfo;
+            return TRUE;
+        }
     }
-    return -1;
+    return FALSE;
 }
 
 inline CNodeClass* CDialogModules::GetClassByName( const TCHAR* szClassName )
@@ -151,9 +156,9 @@ void CDialogModules::SetSelected( )
     while (pos)
     {
         int nItem = m_ModuleList.GetNextSelectedItem( pos );
-        nItem = FindModuleByName( m_ModuleList.GetItemText( nItem, 0 ) );
-
-        MemMapInfo& mod = g_MemMapModules[nItem];
+        MemMapInfo mod;
+        if (!FindModuleByName( m_ModuleList.GetItemText( nItem, 0 ), mod ))
+            continue;
 
         if (g_bSymbolResolution && m_SymbolLoad.GetCheck( ) == BST_CHECKED)
             g_ReClassApp.m_pSymbolLoader->LoadSymbolsForModule( mod.Path, mod.Start, mod.Size );
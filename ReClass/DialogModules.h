@@ -32,7 +32,7 @@ private:
         NUM_OF_COLUMNS
     };
 
-    int FindModuleByName( const TCHAR* szName );
+    BOOLEAN FindModuleByName( const TCHAR* szName, MemMapInfo& Module );
     CNodeClass* GetClassByName( const TCHAR* szClassName );
 
     typedef struct _COMPARESTRUCT {
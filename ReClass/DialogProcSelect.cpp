@@ -278,6 +278,8 @@ void CDialogProcSelect::OnAttachButton( )
 
                 g_hProcess = ProcessHandle;
                 g_ProcessID = FoundProcessInfo->dwProcessId;
+                ReClassSetMemorySource( NULL ); // Drop an opened snapshot, the process is the target now
+                g_RttiCache.Clear( );
 
                 TCHAR tcsProcessPath[MAX_PATH] = { 0 };
                 GetModuleFileNameEx(ProcessHandle, NULL, tcsProcessPath, MAX_PATH);
@@ -291,50 +293,25 @@ void CDialogProcSelect::OnAttachButton( )
 
                 UpdateMemoryMap( );
 
-                if (g_bSymbolResolution && m_LoadAllSymbols.GetCheck( ) == BST_CHECKED)
-                {
-                    OnClose( );
-                
-                    MSG Msg;
-                    CMFCStatusBar* StatusBar = g_ReClassApp.GetStatusBar( );
-
-                    CProgressBar ProgressBar( _T( "Progress" ), 100, 100, TRUE, 0, StatusBar );
-                    ProgressBar.SetStep( 1 );
-                    ProgressBar.SetText( _T( "Symbols loading: " ) );
+                // Whatever was loaded or still loading belongs to the previous process
+                if (g_ReClassApp.m_pSymbolLoader != NULL)
+                    g_ReClassApp.m_pSymbolLoader->DropProcessSymbols( );
 
-                    int i = 0;
-                    for (auto mi : g_MemMapModules)
+                if (g_bSymbolResolution)
+                {
+                    //
+                    // Symbols load in the background, nodes pick them up as
+                    // each module finishes. Progress shows in the status bar.
+                    //
+                    if (m_LoadAllSymbols.GetCheck( ) == BST_CHECKED)
                     {
-                        TCHAR ProgressText[256];
-                        MemMapInfo* CurrentModule = &mi.second;
-
-                        ProgressBar.SetRange32( 0, (int)g_MemMapModules.size( ) );
-
-                        _stprintf_s( ProgressText, _T( "[%d/%d] %s" ), (UINT)i + 1, (UINT)g_MemMapModules.size( ), CurrentModule->Name.GetString( ) );
-                        StatusBar->SetPaneText( 1, ProgressText );
-
-                        //MemMapInfo* pCurrentModule = new MemMapInfo( CurrentModule );
-                        //Utils::NtCreateThread( LoadModuleSymbolsThread, pCurrentModule, 0 );
-
-                        if (!g_ReClassApp.m_pSymbolLoader->LoadSymbolsForModule( CurrentModule->Path, CurrentModule->Start, CurrentModule->Size ))
+                        MemoryMapPtr Map = GetMemoryMap( );
+                        for (const auto& mi : Map->Modules)
                         {
-                            PrintOut( _T( "Failed to load symbols for %s" ), CurrentModule->Name.GetString( ) );
+                            const MemMapInfo& CurrentModule = mi.second;
+                            g_ReClassApp.m_pSymbolLoader->QueueSymbolsForModule( CurrentModule.Path, CurrentModule.Start, CurrentModule.Size );
                         }
-
-                        ProgressBar.StepIt( );
-
-                        // Peek and pump through messages to stop reclass from hanging
-                        while (::PeekMessage( &Msg, NULL, 0, 0, PM_NOREMOVE ))
-                        {
-                            if (!AfxGetApp( )->PumpMessage( ))
-                                ::PostQuitMessage( 0 );
-                        }
-                        i += 1;
                     }
-
-                    StatusBar->SetPaneText( 1, _T( "" ) );
-
-                    return;
                 }
 
                 OnClose( );
@@ -0,0 +1,118 @@
+#include "stdafx.h"
+
+#include "HotSpot.h"
+
+void CHotspotList::Clear( )
+{
+    m_Entries.clear( );
+    m_Text.clear( );
+    m_RowStarts.clear( );
+    m_RowIndices.clear( );
+    m_Top = 0;
+}
+
+void CHotspotList::Add( const CRect& Rect, LPCTSTR Text, ULONG_PTR Address, INT Id, INT Type, UINT Level, CNodeBase* Object )
+{
+    Entry Spot;
+    Spot.Rect = Rect;
+    Spot.Address = Address;
+    Spot.Id = Id;
+    Spot.Type = Type;
+    Spot.Level = Level;
+    Spot.Object = Object;
+    Spot.TextOffset = (UINT)m_Text.size( );
+
+    if (Text != NULL)
+        m_Text.insert( m_Text.end( ), Text, Text + _tcslen( Text ) );
+    m_Text.push_back( _T( '\0' ) );
+
+    m_Entries.push_back( Spot );
+}
+
+void CHotspotList::Finish( int RowHeight )
+{
+    m_RowHeight = max( RowHeight, 1 );
+    m_RowStarts.clear( );
+    m_RowIndices.clear( );
+    if (m_Entries.empty( ))
+        return;
+
+    int Top = INT_MAX;
+    int Bottom = INT_MIN;
+    for (const Entry& Spot : m_Entries)
+    {
+        Top = min( Top, (int)Spot.Rect.top );
+        Bottom = max( Bottom, (int)Spot.Rect.bottom );
+    }
+    m_Top = Top;
+
+    auto FirstRow = [this] ( const Entry& Spot ) { return (UINT)((Spot.Rect.top - m_Top) / m_RowHeight); };
+    auto LastRow = [this] ( const Entry& Spot ) {
+        // Icons are taller than small fonts, a spot lands in every row it touches
+        if (Spot.Rect.bottom <= Spot.Rect.top)
+            return (UINT)((Spot.Rect.top - m_Top) / m_RowHeight);
+        return (UINT)((Spot.Rect.bottom - 1 - m_Top) / m_RowHeight);
+    };
+
+    // Counting sort by row, stable so every row keeps the draw order
+    UINT Rows = (UINT)((Bottom - m_Top) / m_RowHeight) + 1;
+    m_RowStarts.assign( Rows + 1, 0 );
+    for (const Entry& Spot : m_Entries)
+    {
+        for (UINT r = FirstRow( Spot ), Last = LastRow( Spot ); r <= Last; r++)
+            m_RowStarts[r + 1]++;
+    }
+
+    for (UINT r = 0; r < Rows; r++)
+        m_RowStarts[r + 1] += m_RowStarts[r];
+
+    m_RowIndices.resize( m_RowStarts[Rows] );
+    for (UINT i = 0; i < (UINT)m_Entries.size( ); i++)
+    {
+        for (UINT r = FirstRow( m_Entries[i] ), Last = LastRow( m_Entries[i] ); r <= Last; r++)
+            m_RowIndices[m_RowStarts[r]++] = i;
+    }
+
+    // The fill advanced every start to the next row's, shift them back
+    for (UINT r = Rows; r > 0; r--)
+        m_RowStarts[r] = m_RowStarts[r - 1];
+    m_RowStarts[0] = 0;
+}
+
+CHotspotList::Row CHotspotList::GetRow( int y ) const
+{
+    Row Spots = { NULL, NULL };
+    if (m_RowStarts.empty( ) || y < m_Top)
+        return Spots;
+
+    UINT r = (UINT)((y - m_Top) / m_RowHeight);
+    if (r + 1 >= m_RowStarts.size( ))
+        return Spots;
+
+    Spots.Begin = m_RowIndices.data( ) + m_RowStarts[r];
+    Spots.End = m_RowIndices.data( ) + m_RowStarts[r + 1];
+    return Spots;
+}
+
+HOTSPOT CHotspotList::ToHotspot( const Entry& Spot ) const
+{
+    HOTSPOT Hotspot;
+    Hotspot.Rect = Spot.Rect;
+    Hotspot.Text = GetText( Spot );
+    Hotspot.Address = Spot.Address;
+    Hotspot.Id = Spot.Id;
+    Hotspot.Type = Spot.Type;
+    Hotspot.Level = Spot.Level;
+    Hotspot.Object = Spot.Object;
+    return Hotspot;
+}
+
+void CHotspotList::HitTest( const CPoint& Point, std::vector<UINT>& Hits ) const
+{
+    Hits.clear( );
+    for (UINT i : GetRow( Point.y ))
+    {
+        if (m_Entries[i].Rect.PtInRect( Point ))
+            Hits.push_back( i );
+    }
+}
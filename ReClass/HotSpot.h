@@ -2,6 +2,7 @@
 
 #include <atltypes.h>
 #include <tchar.h>
+#include <vector>
 
 #define	NONE -1
 
@@ -29,4 +30,68 @@ typedef struct tagHOTSPOT {
     INT Type;
     UINT Level;
     class CNodeBase* Object;
-} HOTSPOT, *PHOTSPOT;
\ No newline at end of file
+} HOTSPOT, *PHOTSPOT;
+
+//
+// Hotspot list
+//
+// Filled by the nodes while a view paints and hit tested by the view's mouse
+// handlers until the next paint. Spots are kept in draw order with their text
+// in one per frame buffer; Finish buckets them by row so a hit test only looks
+// at the spots on the row under the cursor. Clear keeps the capacity, so once
+// the buffers have grown to the view's size a repaint doesn't allocate.
+//
+// A HOTSPOT with its own copy of the text is only made (ToHotspot) when a
+// handler keeps the spot around, for the edit box or the selection.
+//
+class CHotspotList {
+public:
+    struct Entry {
+        CRect Rect;
+        ULONG_PTR Address;
+        INT Id;
+        INT Type;
+        UINT Level;
+        class CNodeBase* Object;
+        UINT TextOffset;
+    };
+
+    // Indices of the spots on one row, in draw order
+    struct Row {
+        const UINT* Begin;
+        const UINT* End;
+        const UINT* begin( ) const { return Begin; }
+        const UINT* end( ) const { return End; }
+    };
+
+    typedef std::vector<Entry>::const_iterator const_iterator;
+
+    CHotspotList( ) : m_Top( 0 ), m_RowHeight( 1 ) { }
+
+    void Clear( );
+    void Add( const CRect& Rect, LPCTSTR Text, ULONG_PTR Address, INT Id, INT Type, UINT Level, class CNodeBase* Object );
+    void Finish( int RowHeight );
+
+    Row GetRow( int y ) const;
+
+    // Indices of the spots containing Point, in draw order
+    void HitTest( const CPoint& Point, std::vector<UINT>& Hits ) const;
+
+    inline size_t size( ) const { return m_Entries.size( ); }
+    inline bool empty( ) const { return m_Entries.empty( ); }
+    inline const Entry& operator[]( size_t Index ) const { return m_Entries[Index]; }
+    inline const Entry& back( ) const { return m_Entries.back( ); }
+    inline const_iterator begin( ) const { return m_Entries.begin( ); }
+    inline const_iterator end( ) const { return m_Entries.end( ); }
+
+    inline LPCTSTR GetText( const Entry& Spot ) const { return &m_Text[Spot.TextOffset]; }
+    HOTSPOT ToHotspot( const Entry& Spot ) const;
+
+private:
+    std::vector<Entry> m_Entries;
+    std::vector<TCHAR> m_Text;          // NUL terminated strings, Entry::TextOffset indexes in
+    std::vector<UINT> m_RowStarts;      // Row r's indices are m_RowIndices[m_RowStarts[r], m_RowStarts[r + 1])
+    std::vector<UINT> m_RowIndices;
+    int m_Top;                          // y of row 0
+    int m_RowHeight;
+};
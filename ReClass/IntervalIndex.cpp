@@ -0,0 +1,66 @@
+#include "IntervalIndex.h"
+
+#include <algorithm>
+
+void CIntervalIndex::Build( const std::vector<INTERVAL>& Ranges )
+{
+    std::vector<size_t> Order( Ranges.size( ) );
+    for (size_t i = 0; i < Order.size( ); i++)
+        Order[i] = i;
+    std::stable_sort( Order.begin( ), Order.end( ),
+                      [&Ranges] ( size_t a, size_t b ) { return Ranges[a].Start < Ranges[b].Start; } );
+
+    Clear( );
+    m_Starts.reserve( Ranges.size( ) );
+    m_Ends.reserve( Ranges.size( ) );
+    m_MaxEnds.reserve( Ranges.size( ) );
+    m_Values.reserve( Ranges.size( ) );
+
+    uintptr_t MaxEnd = 0;
+    for (size_t i : Order)
+    {
+        const INTERVAL& Range = Ranges[i];
+
+        MaxEnd = (std::max)( MaxEnd, Range.End );
+        m_Starts.push_back( Range.Start );
+        m_Ends.push_back( Range.End );
+        m_MaxEnds.push_back( MaxEnd );
+        m_Values.push_back( Range.Value );
+    }
+}
+
+void CIntervalIndex::Clear( )
+{
+    m_Starts.clear( );
+    m_Ends.clear( );
+    m_MaxEnds.clear( );
+    m_Values.clear( );
+}
+
+uint32_t CIntervalIndex::Find( uintptr_t Address ) const
+{
+    size_t Count = m_Starts.size( );
+    if (Count == 0 || Address < m_Starts[0])
+        return INTERVAL_NO_VALUE;
+
+    //
+    // Last start <= Address. The loop body compiles to a cmov, the trip count
+    // only depends on Count so there is nothing for the branch predictor to miss.
+    //
+    const uintptr_t* Base = m_Starts.data( );
+    while (Count > 1)
+    {
+        size_t Half = Count / 2;
+        Base = (Base[Half] <= Address) ? Base + Half : Base;
+        Count -= Half;
+    }
+
+    // Sections don't overlap in practice, so this almost always checks one range
+    for (ptrdiff_t i = Base - m_Starts.data( ); i >= 0 && m_MaxEnds[i] >= Address; i--)
+    {
+        if (Address <= m_Ends[i])
+            return m_Values[i];
+    }
+
+    return INTERVAL_NO_VALUE;
+}
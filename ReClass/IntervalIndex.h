@@ -0,0 +1,40 @@
+#pragma once
+
+//
+// Interval index
+//
+// Read only lookup of the range containing an address. Ranges are kept as
+// sorted arrays of starts and ends so a lookup is a binary search instead of
+// a walk over every range. Ranges may overlap, an address in more than one
+// gets the value of the one that starts last.
+//
+// Portable like the memory sources, no precompiled header.
+//
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define INTERVAL_NO_VALUE 0xFFFFFFFF
+
+struct INTERVAL {
+    uintptr_t Start;
+    uintptr_t End;      // Inclusive
+    uint32_t Value;
+};
+
+class CIntervalIndex {
+public:
+    void Build( const std::vector<INTERVAL>& Ranges );
+    void Clear( );
+
+    // Value of the range containing Address, INTERVAL_NO_VALUE if there is none
+    uint32_t Find( uintptr_t Address ) const;
+
+    size_t GetCount( ) const { return m_Starts.size( ); }
+
+private:
+    std::vector<uintptr_t> m_Starts;    // Sorted
+    std::vector<uintptr_t> m_Ends;
+    std::vector<uintptr_t> m_MaxEnds;   // Running max of m_Ends, bounds the walk back over overlapping ranges
+    std::vector<uint32_t> m_Values;
+};
@@ -0,0 +1,581 @@
+#include "stdafx.h"
+
+#include "MemoryMap.h"
+
+#include <Psapi.h>
+#include <chrono>
+
+/*
+    Memory and module map info
+        
+    ReClass makes it easy to tell at a glance whether a value could be a pointer.
+    When a node is drawn and it hasn't been assigned a type, it will show an extra
+    tag at the end ( e.g. '-> 0x0BADF00D') in red if the data can be interpreted 
+    as a pointer to a mapped portion of memory.  
+
+    To know whether a value is a valid address in the target process' memory space,
+    we maintain a copy of the meta data of the target process' memory map.  This is
+    represented by a map keyed on the last byte of each memory region, with the value
+    at each key being a MemMapInfo class containing the start, end, and size of the 
+    memory region.  The regions are keyed by last byte so that map->lower_bound(addr)
+    will return an iterator to the region thst starts *BEFORE* addr, and then the
+    addr need only be checked to come before the regions last byte to confirm that the
+    addr is within the region.
+
+    We use a map because we have to find what region things are in a *LOT*, and we 
+    typically have a *LOT* of regions.  In my testing, I ended up with ~280,000 regions
+    in our MemMap.  If we had to iterate through that list to find the region containing
+    an address every time we drew a default node, ReClass's performance would slow to a
+    crawl.
+
+    The map is rebuilt on a background thread (CMemoryMapScanner) into a fresh
+    MemoryMapSnapshot, which is then published with an atomic pointer swap. Readers
+    take a reference to the current snapshot, so they never see a half built map
+    and the UI thread never waits on VirtualQueryEx.
+*/
+static MemoryMapPtr g_pMemoryMap = std::make_shared<const MemoryMapSnapshot>( );
+
+CMemoryMapScanner g_MemoryMapScanner;
+
+MemoryMapPtr GetMemoryMap( )
+{
+    return std::atomic_load( &g_pMemoryMap );
+}
+
+void PublishMemoryMap( const MemoryMapPtr& Map )
+{
+    std::atomic_store( &g_pMemoryMap, Map );
+}
+
+static void ScanRegions( HANDLE hProcess, MemoryMapSnapshot& Map )
+{
+    SYSTEM_INFO SysInfo;
+    MEMORY_BASIC_INFORMATION MemInfo;
+
+    GetSystemInfo( &SysInfo );
+
+    ULONG_PTR pMemory = (ULONG_PTR)SysInfo.lpMinimumApplicationAddress;
+    while (pMemory < (ULONG_PTR)SysInfo.lpMaximumApplicationAddress &&
+           VirtualQueryEx( hProcess, (LPCVOID)pMemory, &MemInfo, sizeof( MEMORY_BASIC_INFORMATION ) ) > 0)
+    {
+        if (MemInfo.State == MEM_COMMIT /*&& MemInfo.Type == MEM_PRIVATE*/)
+        {
+            MemMapInfo Mem;
+            Mem.Start = (ULONG_PTR)pMemory;
+            Mem.End = (ULONG_PTR)pMemory + MemInfo.RegionSize - 1;
+            Mem.Size = (DWORD)MemInfo.RegionSize;
+            const MemMapInfo* containingModule = GetModule( Map, Mem.Start );
+            if (containingModule != nullptr)
+                Mem.Name = containingModule->Name;
+            // Regions come back in address order, always append at the end
+            Map.Regions.emplace_hint( Map.Regions.end( ), Mem.End, Mem );
+        }
+        pMemory = (ULONG_PTR)MemInfo.BaseAddress + MemInfo.RegionSize;
+    }
+}
+
+//
+// Reads the name and code/data sections of one loaded module. Only called for
+// modules that weren't in the previous snapshot, the rest are shared with it.
+//
+static ModuleImagePtr ReadModuleImage( IMemorySource* Source, const LDR_DATA_TABLE_ENTRY& Entry )
+{
+    std::shared_ptr<ModuleImage> Image = std::make_shared<ModuleImage>( );
+    UCHAR* ModuleBase = (UCHAR*)Entry.DllBase;
+    DWORD ModuleSize = Entry.SizeOfImage;
+
+    WCHAR wcsModulePath[MAX_PATH] = { 0 };
+    WCHAR* wcsModuleName = wcsModulePath;
+
+    if (Entry.FullDllName.Length > 0)
+    {
+        SIZE_T Length = min( (SIZE_T)Entry.FullDllName.Length, sizeof( wcsModulePath ) - sizeof( WCHAR ) );
+        if (Source->Read( (ULONG_PTR)Entry.FullDllName.Buffer, &wcsModulePath, Length, NULL ))
+        {
+            WCHAR* wcsSlash = wcsrchr( wcsModulePath, L'\\' );
+            if (!wcsSlash)
+                wcsSlash = wcsrchr( wcsModulePath, L'/' );
+            if (wcsSlash)
+                wcsModuleName = wcsSlash + 1;
+        }
+    }
+
+    Image->Base = (ULONG_PTR)ModuleBase;
+    Image->Size = ModuleSize;
+    Image->TimeDateStamp = Entry.TimeDateStamp;
+
+    // module info
+    MemMapInfo& Mem = Image->Module;
+    Mem.Start = (ULONG_PTR)ModuleBase;
+    Mem.End = Mem.Start + ModuleSize;
+    Mem.Size = ModuleSize;
+    #ifdef UNICODE
+    Mem.Name = wcsModuleName;
+    Mem.Path = wcsModulePath;
+    #else
+    Mem.Name = CW2A( wcsModuleName );
+    Mem.Path = CW2A( wcsModulePath );
+    #endif
+
+    // module code
+    IMAGE_DOS_HEADER DosHdr;
+    IMAGE_NT_HEADERS NtHdr;
+
+    Source->Read( (ULONG_PTR)ModuleBase, &DosHdr, sizeof( IMAGE_DOS_HEADER ), NULL );
+    Source->Read( (ULONG_PTR)(ModuleBase + DosHdr.e_lfanew), &NtHdr, sizeof( IMAGE_NT_HEADERS ), NULL );
+    DWORD sectionsSize = (DWORD)NtHdr.FileHeader.NumberOfSections * sizeof( IMAGE_SECTION_HEADER );
+    PIMAGE_SECTION_HEADER sections = (PIMAGE_SECTION_HEADER)malloc( sectionsSize );
+    Source->Read( (ULONG_PTR)(ModuleBase + DosHdr.e_lfanew + sizeof( IMAGE_NT_HEADERS )), sections, sectionsSize, NULL );
+    for (int i = 0; i < NtHdr.FileHeader.NumberOfSections; i++)
+    {
+        CString txt;
+        MemMapInfo Section;
+        txt.Format( _T( "%.8s" ), sections[i].Name ); txt.MakeLower( );
+        if (txt == ".text" || txt == "code")
+        {
+            Section.Start = (ULONG_PTR)ModuleBase + sections[i].VirtualAddress;
+            Section.End = Section.Start + sections[i].Misc.VirtualSize;
+            Section.Name = Mem.Name;
+            Image->Code.push_back( Section );
+        }
+        else if (txt == ".data" || txt == "data" || txt == ".rdata" || txt == ".idata")
+        {
+            Section.Start = (ULONG_PTR)ModuleBase + sections[i].VirtualAddress;
+            Section.End = Section.Start + sections[i].Misc.VirtualSize;
+            Section.Name = Mem.Name;
+            Image->Data.push_back( Section );
+        }
+    }
+    // Free sections
+    free( sections );
+
+    return Image;
+}
+
+static BOOLEAN ScanModules( HANDLE hProcess, IMemorySource* Source, const MemoryMapSnapshot* Previous, MemoryMapSnapshot& Map )
+{
+    PPROCESS_BASIC_INFORMATION ProcessInfo = NULL;
+    PEB Peb;
+    PEB_LDR_DATA LdrData;
+
+    // Try to allocate buffer 
+    DWORD dwSize = sizeof( PROCESS_BASIC_INFORMATION );
+    ProcessInfo = (PPROCESS_BASIC_INFORMATION)malloc( dwSize );
+    if (!ProcessInfo)
+    {
+        #ifdef _DEBUG
+        PrintOut( _T( "[UpdateMemoryMap]: Couldn't allocate process info buffer!" ) );
+        #endif
+        return FALSE;
+    }
+
+    ULONG dwSizeNeeded = 0;
+    NTSTATUS status = ntdll::NtQueryInformationProcess( hProcess, ProcessBasicInformation, ProcessInfo, dwSize, &dwSizeNeeded );
+    if (status >= 0 && dwSize < dwSizeNeeded)
+    {
+        if (ProcessInfo)
+            free( ProcessInfo );
+
+        ProcessInfo = (PPROCESS_BASIC_INFORMATION)malloc( dwSizeNeeded );
+        if (!ProcessInfo)
+        {
+            #ifdef _DEBUG
+            PrintOut( _T( "[UpdateMemoryMap]: Couldn't allocate process info buffer!" ) );
+            #endif
+            return FALSE;
+        }
+
+        status = ntdll::NtQueryInformationProcess( hProcess, ProcessBasicInformation, ProcessInfo, dwSizeNeeded, &dwSizeNeeded );
+    }
+
+    // Did we successfully get basic info on process
+    if (NT_SUCCESS( status ))
+    {
+        // Check for PEB
+        if (!ProcessInfo->PebBaseAddress)
+        {
+            #ifdef _DEBUG
+            PrintOut( _T( "[UpdateMemoryMap]: PEB is null! Aborting UpdateExports!" ) );
+            #endif
+            if (ProcessInfo)
+                free( ProcessInfo );
+            return false;
+        }
+
+        // Read Process Environment Block (PEB)
+        size_t dwBytesRead = 0;
+        if (!Source->Read( (ULONG_PTR)ProcessInfo->PebBaseAddress, &Peb, sizeof( PEB ), &dwBytesRead ))
+        {
+            #ifdef _DEBUG
+            PrintOut( _T( "[UpdateMemoryMap]: Failed to read PEB! Aborting UpdateExports!" ) );
+            #endif
+            if (ProcessInfo)
+                free( ProcessInfo );
+            return false;
+        }
+
+        // Get Ldr
+        dwBytesRead = 0;
+        if (!Source->Read( (ULONG_PTR)Peb.Ldr, &LdrData, sizeof( LdrData ), &dwBytesRead ))
+        {
+            #ifdef _DEBUG
+            PrintOut( _T( "[UpdateMemoryMap]: Failed to read PEB Ldr Data! Aborting UpdateExports!" ) );
+            #endif
+            if (ProcessInfo)
+                free( ProcessInfo );
+            return false;
+        }
+
+        // The main module's base carries over from the previous snapshot
+        TCHAR tcsProcessPath[MAX_PATH] = { 0 };
+        if (Map.ProcessBase == 0)
+            GetModuleFileNameEx( hProcess, NULL, tcsProcessPath, MAX_PATH );
+
+        LIST_ENTRY *pLdrListHead = (LIST_ENTRY *)LdrData.InLoadOrderModuleList.Flink;
+        LIST_ENTRY *pLdrCurrentNode = LdrData.InLoadOrderModuleList.Flink;
+        do
+        {
+            LDR_DATA_TABLE_ENTRY lstEntry = { 0 };
+            dwBytesRead = 0;
+            if (!Source->Read( (ULONG_PTR)pLdrCurrentNode, &lstEntry, sizeof( LDR_DATA_TABLE_ENTRY ), &dwBytesRead ))
+            {
+                #ifdef _DEBUG
+                PrintOut( _T( "[UpdateMemoryMap]: Could not read list entry from LDR list. Error = %s" ), Utils::GetLastErrorString( ).GetString( ) );
+                #endif
+                if (ProcessInfo)
+                    free( ProcessInfo );
+                return false;
+            }
+
+            pLdrCurrentNode = lstEntry.InLoadOrderLinks.Flink;
+
+            if (lstEntry.DllBase != NULL /*&& lstEntry.SizeOfImage != 0*/)
+            {
+                ULONG_PTR ModuleBase = (ULONG_PTR)lstEntry.DllBase;
+                ModuleImagePtr Image;
+
+                // Same base, size and link timestamp, it's the image we already parsed
+                if (Previous != NULL)
+                {
+                    auto Found = Previous->Images.find( ModuleBase );
+                    if (Found != Previous->Images.end( )
+                        && Found->second->Size == lstEntry.SizeOfImage
+                        && Found->second->TimeDateStamp == lstEntry.TimeDateStamp)
+                    {
+                        Image = Found->second;
+                    }
+                }
+
+                if (!Image)
+                {
+                    Image = ReadModuleImage( Source, lstEntry );
+                    if (Previous != NULL)
+                        Map.Loaded.push_back( Image );
+                }
+
+                if (Map.ProcessBase == 0 && tcsProcessPath[0] != 0 && _tcsicmp( tcsProcessPath, Image->Module.Path ) == 0)
+                {
+                    Map.ProcessBase = Image->Base;
+                    Map.ProcessSize = Image->Size;
+                }
+
+                Map.Images[ModuleBase] = Image;
+            }
+
+        } while (pLdrListHead != pLdrCurrentNode);
+    }
+    else
+    {
+        PrintOutDbg( _T( "[UpdateExports]: NtQueryInformationProcess failed! Aborting..." ) );
+        if (ProcessInfo)
+            free( ProcessInfo );
+        return 0;
+    }
+
+    if (ProcessInfo)
+        free( ProcessInfo );
+
+    return true;
+}
+
+const MemMapInfo* GetModule( const MemoryMapSnapshot& Map, ULONG_PTR Address )
+{
+    auto containingModule = Map.Modules.lower_bound( Address );
+    if (containingModule != Map.Modules.end( )
+        && containingModule->second.Start <= Address) {
+        return &containingModule->second;
+    }
+    return nullptr;
+}
+
+BOOLEAN BuildMemoryMap( HANDLE hProcess, ULONG Target, IMemorySource* Source, MemoryMapSnapshot& Map )
+{
+    //
+    // Module images, exports and custom names carry over from the current
+    // snapshot while it's the same target, only the differences get read
+    //
+    MemoryMapPtr Current = GetMemoryMap( );
+    const MemoryMapSnapshot* Previous = (Current->Target == Target && !Current->bFromSource) ? Current.get( ) : NULL;
+    if (Previous != NULL)
+    {
+        Map.Exports = Previous->Exports;
+        Map.CustomNames = Previous->CustomNames;
+        Map.ProcessBase = Previous->ProcessBase;
+        Map.ProcessSize = Previous->ProcessSize;
+    }
+
+    Map.Target = Target;
+
+    // Modules first, the regions are named after the module they fall in
+    BOOLEAN bResult = ScanModules( hProcess, Source, Previous, Map );
+    if (Previous != NULL && !bResult)
+    {
+        // The loader list can be mid update, keep the old module set rather than report it unloaded
+        Map.Images = Previous->Images;
+        Map.Loaded.clear( );
+    }
+    else if (Previous != NULL)
+    {
+        for (const auto& Entry : Previous->Images)
+        {
+            auto Found = Map.Images.find( Entry.first );
+            if (Found == Map.Images.end( ) || Found->second != Entry.second)
+                Map.Unloaded.push_back( Entry.second );
+        }
+    }
+
+    for (const auto& Entry : Map.Images)
+    {
+        const ModuleImage& Image = *Entry.second;
+        Map.Modules[Image.Module.End] = Image.Module;
+        Map.Code.insert( Map.Code.end( ), Image.Code.begin( ), Image.Code.end( ) );
+        Map.Data.insert( Map.Data.end( ), Image.Data.begin( ), Image.Data.end( ) );
+    }
+
+    ScanRegions( hProcess, Map );
+    Map.Index.Build( Map.Code, Map.Data, Map.Exports, Map.CustomNames );
+    return bResult;
+}
+
+BOOLEAN BuildMemoryMap( IMemorySource* Source, MemoryMapSnapshot& Map )
+{
+    std::vector<MemoryRegion> Regions;
+    std::vector<MemoryModule> Modules;
+
+    Map.bFromSource = true;
+
+    if (!Source->QueryRegions( Regions ) || !Source->EnumerateModules( Modules ))
+        return FALSE;
+
+    for (const MemoryModule& Module : Modules)
+    {
+        MemMapInfo Mem;
+        Mem.Start = (ULONG_PTR)Module.Base;
+        Mem.End = Mem.Start + (ULONG_PTR)Module.Size;
+        Mem.Size = (DWORD)Module.Size;
+        Mem.Name = CW2T( Module.Name.c_str( ) );
+        Mem.Path = CW2T( Module.Path.c_str( ) );
+        Map.Modules[Mem.End] = Mem;
+    }
+
+    //
+    // There are no section headers to read, the region protection of a
+    // module's pages stands in for its code and data sections
+    //
+    for (const MemoryRegion& Region : Regions)
+    {
+        MemMapInfo Mem;
+        Mem.Start = (ULONG_PTR)Region.Start;
+        Mem.End = Mem.Start + (ULONG_PTR)Region.Size - 1;
+        Mem.Size = (DWORD)Region.Size;
+        const MemMapInfo* containingModule = GetModule( Map, Mem.Start );
+        if (containingModule != nullptr)
+        {
+            Mem.Name = containingModule->Name;
+            if (Region.Flags & MEMORY_REGION_EXECUTE)
+                Map.Code.push_back( Mem );
+            else
+                Map.Data.push_back( Mem );
+        }
+        Map.Regions.emplace_hint( Map.Regions.end( ), Mem.End, Mem );
+    }
+
+    Map.Index.Build( Map.Code, Map.Data, Map.Exports, Map.CustomNames );
+    return TRUE;
+}
+
+BOOLEAN UpdateMemoryMap( void )
+{
+    std::shared_ptr<MemoryMapSnapshot> Map = std::make_shared<MemoryMapSnapshot>( );
+    BOOLEAN bResult = FALSE;
+
+    if (g_hProcess != NULL)
+    {
+        if (!IsProcessHandleValid( g_hProcess ))
+        {
+            g_hProcess = NULL;
+            ReClassSelectMemorySource( );
+        }
+        else
+        {
+            bResult = BuildMemoryMap( g_hProcess, g_MemoryMapScanner.GetTarget( ), ReClassGetMemorySource( ), *Map );
+        }
+    }
+
+    Map->Target = g_MemoryMapScanner.GetTarget( );
+    PublishMemoryMap( Map );
+    ApplyMemoryMap( );
+    return bResult;
+}
+
+void ApplyMemoryMap( )
+{
+    MemoryMapPtr Map = GetMemoryMap( );
+    if (Map->Target == g_MemoryMapScanner.GetTarget( ) && Map->ProcessBase != 0)
+    {
+        g_AttachedProcessAddress = Map->ProcessBase;
+        g_AttachedProcessSize = Map->ProcessSize;
+    }
+}
+
+CMemoryMapScanner::CMemoryMapScanner( )
+    : m_hNotifyWnd( NULL )
+    , m_Interval( 250 )
+    , m_bStop( false )
+    , m_bRefresh( false )
+    , m_Target( 0 )
+    , m_PostedTarget( 0 )
+    , m_PostedBase( 0 )
+{
+}
+
+CMemoryMapScanner::~CMemoryMapScanner( )
+{
+    Stop( );
+}
+
+void CMemoryMapScanner::Start( HWND hNotifyWnd, ULONG Interval )
+{
+    if (m_Thread.joinable( ))
+        return;
+
+    m_hNotifyWnd = hNotifyWnd;
+    m_Interval = Interval;
+    m_bStop = false;
+    m_bRefresh = true;
+    m_Thread = std::thread( &CMemoryMapScanner::Run, this );
+}
+
+void CMemoryMapScanner::Stop( )
+{
+    if (!m_Thread.joinable( ))
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_bStop = true;
+    }
+    m_Wake.notify_one( );
+    m_Thread.join( );
+}
+
+void CMemoryMapScanner::Refresh( )
+{
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_bRefresh = true;
+    }
+    m_Wake.notify_one( );
+}
+
+void CMemoryMapScanner::SetProcess( HANDLE hProcess )
+{
+    std::shared_ptr<void> pProcess;
+
+    HANDLE hDuplicate = NULL;
+    if (hProcess != NULL && DuplicateHandle( GetCurrentProcess( ), hProcess, GetCurrentProcess( ), &hDuplicate, 0, FALSE, DUPLICATE_SAME_ACCESS ))
+        pProcess = std::shared_ptr<void>( hDuplicate, CloseHandle );
+
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_pProcess = pProcess;
+        m_Target++;
+        m_bRefresh = true;
+    }
+    m_Wake.notify_one( );
+}
+
+ULONG CMemoryMapScanner::GetTarget( )
+{
+    std::lock_guard<std::mutex> Lock( m_Mutex );
+    return m_Target;
+}
+
+void CMemoryMapScanner::Run( )
+{
+    std::unique_lock<std::mutex> Lock( m_Mutex );
+
+    while (!m_bStop)
+    {
+        m_bRefresh = false;
+
+        // One handle and one source for the whole scan, the UI may switch
+        // targets meanwhile
+        std::shared_ptr<void> pProcess = m_pProcess;
+        ULONG Target = m_Target;
+        Lock.unlock( );
+
+        MemorySourcePtr Source = ReClassAcquireMemorySource( );
+        if (pProcess != NULL && Source != NULL && IsProcessHandleValid( (HANDLE)pProcess.get( ) ))
+        {
+            std::shared_ptr<MemoryMapSnapshot> Map = std::make_shared<MemoryMapSnapshot>( );
+            BuildMemoryMap( (HANDLE)pProcess.get( ), Target, Source.get( ), *Map );
+
+            // Don't publish a map of a process we got detached from while
+            // scanning, SetProcess can't slip in between under the lock
+            Lock.lock( );
+            if (Target == m_Target)
+            {
+                PublishMemoryMap( Map );
+                PostModuleEvents( *Map );
+                if ((Target != m_PostedTarget || Map->ProcessBase != m_PostedBase) && m_hNotifyWnd != NULL)
+                {
+                    ::PostMessage( m_hNotifyWnd, WM_MEMORYMAP, 0, 0 );
+                    m_PostedTarget = Target;
+                    m_PostedBase = Map->ProcessBase;
+                }
+            }
+            Lock.unlock( );
+        }
+        else
+        {
+            // A map built from an opened snapshot stays until a process is attached
+            MemoryMapPtr Current = GetMemoryMap( );
+            if (!Current->bFromSource && (!Current->Regions.empty( ) || !Current->Modules.empty( )))
+                PublishMemoryMap( std::make_shared<const MemoryMapSnapshot>( ) );
+        }
+
+        Lock.lock( );
+        m_Wake.wait_for( Lock, std::chrono::milliseconds( m_Interval ), [this] { return m_bStop || m_bRefresh; } );
+    }
+}
+
+void CMemoryMapScanner::PostModuleEvents( const MemoryMapSnapshot& Map )
+{
+    if (m_hNotifyWnd == NULL)
+        return;
+
+    for (const ModuleImagePtr& Image : Map.Unloaded)
+    {
+        MemMapInfo* Module = new MemMapInfo( Image->Module );
+        if (!::PostMessage( m_hNotifyWnd, WM_MODULEEVENT, MODULE_EVENT_UNLOADED, (LPARAM)Module ))
+            delete Module;
+    }
+
+    for (const ModuleImagePtr& Image : Map.Loaded)
+    {
+        MemMapInfo* Module = new MemMapInfo( Image->Module );
+        if (!::PostMessage( m_hNotifyWnd, WM_MODULEEVENT, MODULE_EVENT_LOADED, (LPARAM)Module ))
+            delete Module;
+    }
+}
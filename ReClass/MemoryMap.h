@@ -0,0 +1,119 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//
+// Module image
+//
+// What we parsed out of one loaded module. Images are shared between
+// snapshots for as long as the module stays loaded; a module counts as the
+// same image while its base, SizeOfImage and TimeDateStamp don't change.
+//
+struct ModuleImage
+{
+    ULONG_PTR Base;
+    DWORD Size;
+    ULONG TimeDateStamp;
+    MemMapInfo Module;
+    std::vector<MemMapInfo> Code;
+    std::vector<MemMapInfo> Data;
+};
+
+typedef std::shared_ptr<const ModuleImage> ModuleImagePtr;
+
+//
+// Memory map snapshot
+//
+// Everything ReClass knows about the target's address space. A snapshot is
+// never modified once published: the scanner thread builds a complete new one
+// and swaps the pointer, readers grab the current pointer and keep it for as
+// long as they look at the data.
+//
+struct MemoryMapSnapshot
+{
+    ULONG Target = 0;                           // CMemoryMapScanner::GetTarget when the snapshot was taken
+    bool bFromSource = false;                   // Built from a memory source instead (an opened snapshot file)
+    ULONG_PTR ProcessBase = 0;                  // Main module of the process, 0 until the loader list has it
+    DWORD ProcessSize = 0;
+    std::map<ULONG_PTR, ModuleImagePtr> Images; // Keyed by DllBase
+    std::vector<ModuleImagePtr> Loaded;         // Changes since the snapshot this one replaced
+    std::vector<ModuleImagePtr> Unloaded;
+    std::map<ULONG_PTR, MemMapInfo> Regions;    // Committed regions keyed by last byte
+    std::map<ULONG_PTR, MemMapInfo> Modules;    // Keyed by MemMapInfo::End
+    std::vector<MemMapInfo> Code;
+    std::vector<MemMapInfo> Data;
+    std::vector<AddressName> Exports;
+    std::vector<AddressName> CustomNames;
+    CAddressIndex Index;
+};
+
+typedef std::shared_ptr<const MemoryMapSnapshot> MemoryMapPtr;
+
+// Never returns NULL, there is always at least an empty snapshot
+MemoryMapPtr GetMemoryMap( );
+void PublishMemoryMap( const MemoryMapPtr& Map );
+
+// Scans hProcess into Map reading its memory through Source, returns FALSE if
+// the loader data could not be read. Target is the scanner's id for hProcess,
+// what a snapshot shares with the current one is only reused for the same id.
+BOOLEAN BuildMemoryMap( HANDLE hProcess, ULONG Target, IMemorySource* Source, MemoryMapSnapshot& Map );
+
+// Regions and modules of Source, for targets that aren't a process
+BOOLEAN BuildMemoryMap( IMemorySource* Source, MemoryMapSnapshot& Map );
+
+const MemMapInfo* GetModule( const MemoryMapSnapshot& Map, ULONG_PTR Address );
+
+// UI thread, takes the process base and size from the current snapshot into
+// g_AttachedProcessAddress/Size if it was taken of the current target
+void ApplyMemoryMap( );
+
+//
+// Memory map scanner
+//
+// Rebuilds the snapshot off the UI thread every Interval milliseconds, or right
+// away after Refresh. Module loads and unloads are posted to hNotifyWnd as
+// WM_MODULEEVENT, wParam is MODULE_EVENT_LOADED/UNLOADED and lParam a
+// MemMapInfo* the receiver deletes. WM_MEMORYMAP tells it a snapshot with a
+// new process base was published, see ApplyMemoryMap.
+//
+// The scanner never touches g_hProcess. SetProcess gives it a duplicate of
+// the handle and a new target id; a scan keeps its own reference to the
+// duplicate, so a detach on the UI thread can't close it mid-scan.
+//
+#define MODULE_EVENT_LOADED     0
+#define MODULE_EVENT_UNLOADED   1
+
+class CMemoryMapScanner {
+public:
+    CMemoryMapScanner( );
+    ~CMemoryMapScanner( );
+
+    void Start( HWND hNotifyWnd, ULONG Interval );
+    void Stop( );
+    void Refresh( );
+
+    // UI thread, hProcess may be NULL. The caller keeps its own handle.
+    void SetProcess( HANDLE hProcess );
+    ULONG GetTarget( );
+
+private:
+    void Run( );
+    void PostModuleEvents( const MemoryMapSnapshot& Map );
+
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    HWND m_hNotifyWnd;
+    ULONG m_Interval;
+    bool m_bStop;
+    bool m_bRefresh;
+    std::shared_ptr<void> m_pProcess;  // Duplicate handle, closed by its last reference
+    ULONG m_Target;
+    ULONG m_PostedTarget;               // What WM_MEMORYMAP last announced
+    ULONG_PTR m_PostedBase;
+};
+
+extern CMemoryMapScanner g_MemoryMapScanner;
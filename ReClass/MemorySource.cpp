@@ -0,0 +1,222 @@
+#include "stdafx.h"
+
+#include "MemorySource.h"
+
+#include <Psapi.h>
+#include <mutex>
+
+//
+// The current source is picked on the UI thread only, whenever the target
+// changes. Workers take a reference with ReClassAcquireMemorySource and keep
+// reading through it for the rest of their job, a source replaced meanwhile
+// is deleted when the last of them lets go.
+//
+static std::mutex      g_MemorySourceMutex;
+static MemorySourcePtr g_pMemorySource;            // Guarded by g_MemorySourceMutex
+static MemorySourcePtr g_pAttachedMemorySource;    // UI thread only
+
+CPageCache g_ReadCache;
+
+IMemorySource* ReClassGetMemorySource( )
+{
+    return &g_ReadCache;
+}
+
+MemorySourcePtr ReClassAcquireMemorySource( )
+{
+    std::lock_guard<std::mutex> Lock( g_MemorySourceMutex );
+    return g_pMemorySource;
+}
+
+void ReClassSelectMemorySource( )
+{
+    MemorySourcePtr Source;
+
+    if (g_pAttachedMemorySource)
+        Source = g_pAttachedMemorySource;
+    else if (g_hProcess != NULL)
+        Source = std::make_shared<CPluginMemorySource>( g_hProcess );
+
+    {
+        std::lock_guard<std::mutex> Lock( g_MemorySourceMutex );
+        g_pMemorySource = Source;
+    }
+
+    // Everything goes through the page cache, start over with the new target
+    g_ReadCache.SetSource( Source );
+
+    // The memory map follows the same target, the main module's base comes
+    // with its first snapshot
+    g_AttachedProcessAddress = NULL;
+    g_AttachedProcessSize = 0;
+    g_MemoryMapScanner.SetProcess( g_hProcess );
+}
+
+void ReClassSetMemorySource( IMemorySource* Source )
+{
+    g_pAttachedMemorySource.reset( Source );
+    ReClassSelectMemorySource( );
+}
+
+CProcessMemorySource::CProcessMemorySource( void* hProcess )
+    : m_hProcess( hProcess )
+    , m_bOwnsHandle( false )
+{
+    // Plugins that override OpenProcess may hand back a value that isn't a
+    // real handle, that one is used as is
+    HANDLE hDuplicate = NULL;
+    if (hProcess != NULL && DuplicateHandle( GetCurrentProcess( ), (HANDLE)hProcess, GetCurrentProcess( ), &hDuplicate, 0, FALSE, DUPLICATE_SAME_ACCESS ))
+    {
+        m_hProcess = hDuplicate;
+        m_bOwnsHandle = true;
+    }
+}
+
+CProcessMemorySource::~CProcessMemorySource( )
+{
+    if (m_bOwnsHandle)
+        CloseHandle( (HANDLE)m_hProcess );
+}
+
+bool CProcessMemorySource::Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead )
+{
+    SIZE_T Read = 0;
+
+    SecureZeroMemory( Buffer, Size );
+
+    BOOL bResult = ReadProcessMemory( (HANDLE)m_hProcess, (LPCVOID)Address, Buffer, Size, &Read );
+    if (!bResult && Size > MEMORY_PAGE_SIZE && m_hProcess != NULL)
+    {
+        // ReadProcessMemory fails the whole request if any page in it is bad.
+        // Go page by page so the readable part of a large class still shows up.
+        Read = 0;
+        for (SIZE_T Offset = 0; Offset < Size; )
+        {
+            SIZE_T Chunk = min( Size - Offset, MEMORY_PAGE_SIZE - (SIZE_T)((Address + Offset) & (MEMORY_PAGE_SIZE - 1)) );
+            SIZE_T ChunkRead = 0;
+            if (ReadProcessMemory( (HANDLE)m_hProcess, (LPCVOID)(Address + Offset), (UCHAR*)Buffer + Offset, Chunk, &ChunkRead ))
+                Read += ChunkRead;
+            Offset += Chunk;
+        }
+    }
+
+    if (BytesRead)
+        *BytesRead = Read;
+
+    return bResult != FALSE;
+}
+
+bool CProcessMemorySource::Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten )
+{
+    DWORD OldProtect;
+    SIZE_T Written = 0;
+
+    VirtualProtectEx( (HANDLE)m_hProcess, (LPVOID)Address, Size, PAGE_EXECUTE_READWRITE, &OldProtect );
+    BOOL bResult = WriteProcessMemory( (HANDLE)m_hProcess, (LPVOID)Address, Buffer, Size, &Written );
+    VirtualProtectEx( (HANDLE)m_hProcess, (LPVOID)Address, Size, OldProtect, &OldProtect );
+
+    if (BytesWritten)
+        *BytesWritten = Written;
+
+    return bResult != FALSE;
+}
+
+bool CProcessMemorySource::QueryRegions( std::vector<MemoryRegion>& Regions )
+{
+    SYSTEM_INFO SysInfo;
+    MEMORY_BASIC_INFORMATION MemInfo;
+
+    Regions.clear( );
+    if (m_hProcess == NULL)
+        return false;
+
+    GetSystemInfo( &SysInfo );
+
+    ULONG_PTR pMemory = (ULONG_PTR)SysInfo.lpMinimumApplicationAddress;
+    while (pMemory < (ULONG_PTR)SysInfo.lpMaximumApplicationAddress &&
+           VirtualQueryEx( (HANDLE)m_hProcess, (LPCVOID)pMemory, &MemInfo, sizeof( MEMORY_BASIC_INFORMATION ) ) > 0)
+    {
+        if (MemInfo.State == MEM_COMMIT)
+        {
+            MemoryRegion Region;
+            Region.Start = (ULONG_PTR)MemInfo.BaseAddress;
+            Region.Size = MemInfo.RegionSize;
+            Region.Flags = 0;
+
+            DWORD Protect = MemInfo.Protect & 0xFF;
+            if (!(Protect & PAGE_NOACCESS) && !(MemInfo.Protect & PAGE_GUARD))
+                Region.Flags |= MEMORY_REGION_READ;
+            if (Protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY))
+                Region.Flags |= MEMORY_REGION_WRITE;
+            if (Protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY))
+                Region.Flags |= MEMORY_REGION_EXECUTE;
+            if (MemInfo.Type == MEM_IMAGE)
+                Region.Flags |= MEMORY_REGION_IMAGE;
+            else if (MemInfo.Type == MEM_PRIVATE)
+                Region.Flags |= MEMORY_REGION_PRIVATE;
+
+            Regions.push_back( Region );
+        }
+        pMemory = (ULONG_PTR)MemInfo.BaseAddress + MemInfo.RegionSize;
+    }
+
+    return true;
+}
+
+bool CProcessMemorySource::EnumerateModules( std::vector<MemoryModule>& Modules )
+{
+    DWORD Needed = 0;
+
+    Modules.clear( );
+    if (m_hProcess == NULL)
+        return false;
+
+    if (!EnumProcessModulesEx( (HANDLE)m_hProcess, NULL, 0, &Needed, LIST_MODULES_ALL ) || Needed == 0)
+        return false;
+
+    std::vector<HMODULE> Handles( Needed / sizeof( HMODULE ) );
+    if (!EnumProcessModulesEx( (HANDLE)m_hProcess, Handles.data( ), (DWORD)(Handles.size( ) * sizeof( HMODULE )), &Needed, LIST_MODULES_ALL ))
+        return false;
+    Handles.resize( min( Handles.size( ), Needed / sizeof( HMODULE ) ) );
+
+    for (HMODULE hModule : Handles)
+    {
+        MODULEINFO Info;
+        WCHAR wcsPath[MAX_PATH] = { 0 };
+
+        if (!GetModuleInformation( (HANDLE)m_hProcess, hModule, &Info, sizeof( MODULEINFO ) ))
+            continue;
+        GetModuleFileNameExW( (HANDLE)m_hProcess, hModule, wcsPath, MAX_PATH );
+
+        MemoryModule Module;
+        Module.Base = (ULONG_PTR)Info.lpBaseOfDll;
+        Module.Size = Info.SizeOfImage;
+        Module.Path = wcsPath;
+        const WCHAR* wcsName = wcsrchr( wcsPath, L'\\' );
+        Module.Name = wcsName ? wcsName + 1 : wcsPath;
+        Modules.push_back( Module );
+    }
+
+    return true;
+}
+
+const wchar_t* CPluginMemorySource::GetName( ) const
+{
+    if (g_PluginOverrideReadMemoryOperation == NULL && g_PluginOverrideWriteMemoryOperation == NULL)
+        return CProcessMemorySource::GetName( );
+    return L"Plugin";
+}
+
+bool CPluginMemorySource::Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead )
+{
+    if (g_PluginOverrideReadMemoryOperation == NULL)
+        return CProcessMemorySource::Read( Address, Buffer, Size, BytesRead );
+    return g_PluginOverrideReadMemoryOperation( (LPVOID)Address, Buffer, Size, (PSIZE_T)BytesRead ) != FALSE;
+}
+
+bool CPluginMemorySource::Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten )
+{
+    if (g_PluginOverrideWriteMemoryOperation == NULL)
+        return CProcessMemorySource::Write( Address, Buffer, Size, BytesWritten );
+    return g_PluginOverrideWriteMemoryOperation( (LPVOID)Address, (LPVOID)Buffer, Size, (PSIZE_T)BytesWritten ) != FALSE;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+//
+// Memory sources
+//
+// Everything ReClass knows about the target comes through one of these. The
+// live Windows process and plugin overrides are the usual sources, but the
+// interface only uses standard types so the Linux /proc backend and the file
+// backed snapshot source can be built and used without MFC or the Windows SDK.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define MEMORY_PAGE_SIZE        0x1000
+
+#define MEMORY_REGION_READ      0x1
+#define MEMORY_REGION_WRITE     0x2
+#define MEMORY_REGION_EXECUTE   0x4
+#define MEMORY_REGION_IMAGE     0x8
+#define MEMORY_REGION_PRIVATE   0x10
+
+struct MemoryRegion {
+    uint64_t Start;
+    uint64_t Size;
+    uint32_t Flags;         // MEMORY_REGION_*
+};
+
+struct MemoryReadRequest {
+    uint64_t Address;
+    void* Buffer;
+    size_t Size;
+    size_t BytesRead;       // Filled in by ReadBatch
+    bool Success;           // Filled in by ReadBatch
+};
+
+struct MemoryModule {
+    uint64_t Base;
+    uint64_t Size;
+    std::wstring Name;
+    std::wstring Path;
+};
+
+class IMemorySource {
+public:
+    virtual ~IMemorySource( ) { }
+
+    virtual const wchar_t* GetName( ) const = 0;
+    virtual bool IsValid( ) const = 0;
+
+    // Reads zero fill whatever could not be read. BytesRead may be NULL.
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead ) = 0;
+    virtual bool Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten ) = 0;
+
+    // Vectored read, returns true only if every request succeeded. Sources that
+    // pay per round trip (remote, plugins) should override this; the default
+    // just walks the list.
+    virtual bool ReadBatch( MemoryReadRequest* Requests, size_t Count )
+    {
+        bool bAllRead = true;
+        for (size_t i = 0; i < Count; i++)
+        {
+            Requests[i].BytesRead = 0;
+            Requests[i].Success = Read( Requests[i].Address, Requests[i].Buffer, Requests[i].Size, &Requests[i].BytesRead );
+            bAllRead &= Requests[i].Success;
+        }
+        return bAllRead;
+    }
+
+    // Committed regions sorted by start address.
+    virtual bool QueryRegions( std::vector<MemoryRegion>& Regions ) = 0;
+    virtual bool EnumerateModules( std::vector<MemoryModule>& Modules ) = 0;
+};
+
+// Sources are shared between the UI and the worker threads reading through
+// them, the last reference deletes the source
+typedef std::shared_ptr<IMemorySource> MemorySourcePtr;
+
+//
+// File backed snapshot (MemorySourceSnapshot.cpp)
+//
+// Layout is a MEMORY_SNAPSHOT_HEADER followed by the region table, the module
+// table and finally the raw bytes of every region. All integers are little endian.
+//
+#define MEMORY_SNAPSHOT_MAGIC   0x50414E53534C4352ULL // "RCLSSNAP"
+#define MEMORY_SNAPSHOT_VERSION 1
+
+class CSnapshotMemorySource : public IMemorySource {
+public:
+    CSnapshotMemorySource( );
+    virtual ~CSnapshotMemorySource( );
+
+    bool Open( const char* FilePath );
+    void Close( );
+
+    virtual const wchar_t* GetName( ) const { return L"Snapshot"; }
+    virtual bool IsValid( ) const { return m_File != NULL; }
+
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead );
+    virtual bool Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten );
+    virtual bool QueryRegions( std::vector<MemoryRegion>& Regions );
+    virtual bool EnumerateModules( std::vector<MemoryModule>& Modules );
+
+    // Dumps every readable region of Source into a snapshot file.
+    static bool Capture( IMemorySource* Source, const char* FilePath );
+
+private:
+    struct SnapshotRegion {
+        MemoryRegion Region;
+        uint64_t FileOffset;
+    };
+
+    FILE* m_File;
+    std::vector<SnapshotRegion> m_Regions;
+    std::vector<MemoryModule> m_Modules;
+};
+
+#if defined(__linux__)
+//
+// Linux target through /proc/<pid>/mem and /proc/<pid>/maps (MemorySourceProc.cpp)
+//
+class CProcMemorySource : public IMemorySource {
+public:
+    CProcMemorySource( );
+    virtual ~CProcMemorySource( );
+
+    bool Attach( int Pid );
+    void Detach( );
+
+    virtual const wchar_t* GetName( ) const { return L"Linux /proc"; }
+    virtual bool IsValid( ) const { return m_MemFd != -1; }
+
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead );
+    virtual bool Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten );
+    virtual bool QueryRegions( std::vector<MemoryRegion>& Regions );
+    virtual bool EnumerateModules( std::vector<MemoryModule>& Modules );
+
+private:
+    struct MapsEntry {
+        MemoryRegion Region;
+        std::string Path;
+    };
+
+    bool ReadMaps( std::vector<MapsEntry>& Entries );
+
+    int m_Pid;
+    int m_MemFd;
+};
+#endif
+
+#if defined(_WIN32)
+//
+// Live Windows process through Read/WriteProcessMemory (MemorySource.cpp).
+// The source reads through its own duplicate of the handle, so closing the
+// handle it was made from doesn't pull it out from under a reader.
+//
+class CProcessMemorySource : public IMemorySource {
+public:
+    CProcessMemorySource( void* hProcess );
+    virtual ~CProcessMemorySource( );
+
+    inline void* GetProcess( ) const { return m_hProcess; }
+
+    virtual const wchar_t* GetName( ) const { return L"Process"; }
+    virtual bool IsValid( ) const { return m_hProcess != NULL; }
+
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead );
+    virtual bool Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten );
+    virtual bool QueryRegions( std::vector<MemoryRegion>& Regions );
+    virtual bool EnumerateModules( std::vector<MemoryModule>& Modules );
+
+private:
+    void* m_hProcess;
+    bool m_bOwnsHandle;
+};
+
+//
+// Forwards reads and writes to the plugin memory overrides, everything else
+// still goes to the process handle the plugin handed back from OpenProcess.
+// Without overrides it reads the process like its base class. The overrides
+// are checked on every call, plugins install and remove them at any time.
+//
+class CPluginMemorySource : public CProcessMemorySource {
+public:
+    CPluginMemorySource( void* hProcess ) : CProcessMemorySource( hProcess ) { }
+
+    virtual const wchar_t* GetName( ) const;
+
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead );
+    virtual bool Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten );
+};
+#endif
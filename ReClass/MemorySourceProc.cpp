@@ -0,0 +1,207 @@
+//
+// Linux target backend. Reads go straight to /proc/<pid>/mem with pread, the
+// region and module lists come from /proc/<pid>/maps. Like the snapshot source
+// this file does not use the precompiled header.
+//
+#include "MemorySource.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <map>
+
+static std::wstring WidenPath( const std::string& Path )
+{
+    std::wstring Wide( Path.size( ), L'\0' );
+    size_t Length = mbstowcs( &Wide[0], Path.c_str( ), Wide.size( ) );
+    if (Length == (size_t)-1)
+        return std::wstring( Path.begin( ), Path.end( ) );
+    Wide.resize( Length );
+    return Wide;
+}
+
+CProcMemorySource::CProcMemorySource( )
+    : m_Pid( 0 )
+    , m_MemFd( -1 )
+{
+}
+
+CProcMemorySource::~CProcMemorySource( )
+{
+    Detach( );
+}
+
+bool CProcMemorySource::Attach( int Pid )
+{
+    char MemPath[64];
+
+    Detach( );
+
+    snprintf( MemPath, sizeof( MemPath ), "/proc/%d/mem", Pid );
+    m_MemFd = open( MemPath, O_RDWR | O_CLOEXEC );
+    if (m_MemFd == -1)
+        m_MemFd = open( MemPath, O_RDONLY | O_CLOEXEC );
+    if (m_MemFd == -1)
+        return false;
+
+    m_Pid = Pid;
+    return true;
+}
+
+void CProcMemorySource::Detach( )
+{
+    if (m_MemFd != -1)
+        close( m_MemFd );
+    m_MemFd = -1;
+    m_Pid = 0;
+}
+
+bool CProcMemorySource::Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead )
+{
+    uint8_t* Out = (uint8_t*)Buffer;
+    size_t Cursor = 0;
+    size_t Total = 0;
+
+    memset( Buffer, 0, Size );
+
+    // pread stops at the first unmapped page, so step over holes a page at a
+    // time to match the zero fill behaviour of the other sources.
+    while (m_MemFd != -1 && Cursor < Size)
+    {
+        ssize_t Result = pread( m_MemFd, Out + Cursor, Size - Cursor, (off_t)(Address + Cursor) );
+        if (Result > 0)
+        {
+            Cursor += (size_t)Result;
+            Total += (size_t)Result;
+        }
+        else
+        {
+            uint64_t NextPage = ((Address + Cursor) | (MEMORY_PAGE_SIZE - 1)) + 1;
+            Cursor = (size_t)(NextPage - Address);
+        }
+    }
+
+    if (BytesRead)
+        *BytesRead = Total;
+
+    return Total == Size;
+}
+
+bool CProcMemorySource::Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten )
+{
+    ssize_t Result = (m_MemFd != -1) ? pwrite( m_MemFd, Buffer, Size, (off_t)Address ) : -1;
+
+    if (BytesWritten)
+        *BytesWritten = (Result > 0) ? (size_t)Result : 0;
+
+    return Result == (ssize_t)Size;
+}
+
+bool CProcMemorySource::ReadMaps( std::vector<MapsEntry>& Entries )
+{
+    char MapsPath[64];
+    char Line[4096];
+
+    Entries.clear( );
+
+    snprintf( MapsPath, sizeof( MapsPath ), "/proc/%d/maps", m_Pid );
+    FILE* Maps = fopen( MapsPath, "r" );
+    if (!Maps)
+        return false;
+
+    while (fgets( Line, sizeof( Line ), Maps ))
+    {
+        uint64_t Start, End, Offset, Inode;
+        char Perms[8] = { 0 };
+        char Device[32] = { 0 };
+        int PathStart = 0;
+
+        if (sscanf( Line, "%" SCNx64 "-%" SCNx64 " %7s %" SCNx64 " %31s %" SCNu64 " %n",
+                    &Start, &End, Perms, &Offset, Device, &Inode, &PathStart ) < 6)
+            continue;
+
+        MapsEntry Entry;
+        Entry.Region.Start = Start;
+        Entry.Region.Size = End - Start;
+        Entry.Region.Flags = 0;
+        if (Perms[0] == 'r') Entry.Region.Flags |= MEMORY_REGION_READ;
+        if (Perms[1] == 'w') Entry.Region.Flags |= MEMORY_REGION_WRITE;
+        if (Perms[2] == 'x') Entry.Region.Flags |= MEMORY_REGION_EXECUTE;
+        if (Perms[3] == 'p') Entry.Region.Flags |= MEMORY_REGION_PRIVATE;
+        if (Inode != 0) Entry.Region.Flags |= MEMORY_REGION_IMAGE;
+
+        if (PathStart > 0)
+        {
+            Entry.Path = Line + PathStart;
+            while (!Entry.Path.empty( ) && (Entry.Path.back( ) == '\n' || Entry.Path.back( ) == ' '))
+                Entry.Path.pop_back( );
+        }
+
+        Entries.push_back( Entry );
+    }
+
+    fclose( Maps );
+    return true;
+}
+
+bool CProcMemorySource::QueryRegions( std::vector<MemoryRegion>& Regions )
+{
+    std::vector<MapsEntry> Entries;
+
+    Regions.clear( );
+    if (!ReadMaps( Entries ))
+        return false;
+
+    Regions.reserve( Entries.size( ) );
+    for (const MapsEntry& Entry : Entries)
+        Regions.push_back( Entry.Region );
+
+    return true;
+}
+
+bool CProcMemorySource::EnumerateModules( std::vector<MemoryModule>& Modules )
+{
+    std::vector<MapsEntry> Entries;
+
+    Modules.clear( );
+    if (!ReadMaps( Entries ))
+        return false;
+
+    // A shared object is mapped as several consecutive segments of the same
+    // file. Collapse them into one module spanning all of its segments.
+    std::map<std::string, size_t> Seen;
+    for (const MapsEntry& Entry : Entries)
+    {
+        if (!(Entry.Region.Flags & MEMORY_REGION_IMAGE) || Entry.Path.empty( ) || Entry.Path[0] != '/')
+            continue;
+
+        auto Found = Seen.find( Entry.Path );
+        if (Found == Seen.end( ))
+        {
+            MemoryModule Module;
+            Module.Base = Entry.Region.Start;
+            Module.Size = Entry.Region.Size;
+            Module.Path = WidenPath( Entry.Path );
+            size_t Slash = Module.Path.find_last_of( L'/' );
+            Module.Name = (Slash != std::wstring::npos) ? Module.Path.substr( Slash + 1 ) : Module.Path;
+
+            Seen[Entry.Path] = Modules.size( );
+            Modules.push_back( Module );
+        }
+        else
+        {
+            MemoryModule& Module = Modules[Found->second];
+            uint64_t End = Entry.Region.Start + Entry.Region.Size;
+            if (End > Module.Base + Module.Size)
+                Module.Size = End - Module.Base;
+        }
+    }
+
+    return true;
+}
+
+#endif // __linux__
@@ -0,0 +1,292 @@
+//
+// File backed memory snapshots. Deliberately free of MFC and the precompiled
+// header so it builds on the Linux analysis hosts as well.
+//
+#include "MemorySource.h"
+
+#include <string.h>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define SnapshotSeek _fseeki64
+#define SnapshotTell _ftelli64
+#else
+#define SnapshotSeek fseeko
+#define SnapshotTell ftello
+#endif
+
+#pragma pack(push, 1)
+struct MEMORY_SNAPSHOT_HEADER {
+    uint64_t Magic;
+    uint32_t Version;
+    uint32_t RegionCount;
+    uint32_t ModuleCount;
+    uint32_t Reserved;
+};
+
+struct MEMORY_SNAPSHOT_REGION {
+    uint64_t Start;
+    uint64_t Size;
+    uint32_t Flags;
+    uint32_t Reserved;
+    uint64_t FileOffset;
+};
+
+struct MEMORY_SNAPSHOT_MODULE {
+    uint64_t Base;
+    uint64_t Size;
+    uint32_t NameLength;    // UTF-16 code units following this record
+    uint32_t PathLength;    // UTF-16 code units following the name
+};
+#pragma pack(pop)
+
+static bool ReadString16( FILE* File, uint32_t Length, std::wstring& Out )
+{
+    std::vector<uint16_t> Units( Length );
+    if (Length && fread( Units.data( ), sizeof( uint16_t ), Length, File ) != Length)
+        return false;
+    Out.assign( Units.begin( ), Units.end( ) );
+    return true;
+}
+
+static bool WriteString16( FILE* File, const std::wstring& String )
+{
+    std::vector<uint16_t> Units( String.begin( ), String.end( ) );
+    return Units.empty( ) || fwrite( Units.data( ), sizeof( uint16_t ), Units.size( ), File ) == Units.size( );
+}
+
+CSnapshotMemorySource::CSnapshotMemorySource( )
+    : m_File( NULL )
+{
+}
+
+CSnapshotMemorySource::~CSnapshotMemorySource( )
+{
+    Close( );
+}
+
+bool CSnapshotMemorySource::Open( const char* FilePath )
+{
+    MEMORY_SNAPSHOT_HEADER Header;
+    uint64_t FileSize;
+
+    Close( );
+
+    m_File = fopen( FilePath, "rb" );
+    if (!m_File)
+        return false;
+
+    int64_t End = -1;
+    if (SnapshotSeek( m_File, 0, SEEK_END ) == 0)
+        End = (int64_t)SnapshotTell( m_File );
+    if (End < 0 || SnapshotSeek( m_File, 0, SEEK_SET ) != 0)
+    {
+        Close( );
+        return false;
+    }
+    FileSize = (uint64_t)End;
+
+    //
+    // Every count and length is checked against what is left of the file
+    // before anything is sized by it, a damaged header can't make us allocate
+    // more than the file holds
+    //
+    if (fread( &Header, sizeof( Header ), 1, m_File ) != 1 ||
+        Header.Magic != MEMORY_SNAPSHOT_MAGIC ||
+        Header.Version != MEMORY_SNAPSHOT_VERSION ||
+        (uint64_t)Header.RegionCount * sizeof( MEMORY_SNAPSHOT_REGION ) +
+        (uint64_t)Header.ModuleCount * sizeof( MEMORY_SNAPSHOT_MODULE ) > FileSize - sizeof( Header ))
+    {
+        Close( );
+        return false;
+    }
+
+    uint64_t TablesEnd = sizeof( Header ) + (uint64_t)Header.RegionCount * sizeof( MEMORY_SNAPSHOT_REGION );
+
+    m_Regions.resize( Header.RegionCount );
+    for (uint32_t i = 0; i < Header.RegionCount; i++)
+    {
+        MEMORY_SNAPSHOT_REGION Entry;
+        if (fread( &Entry, sizeof( Entry ), 1, m_File ) != 1 ||
+            Entry.FileOffset > FileSize || Entry.Size > FileSize - Entry.FileOffset ||
+            Entry.Start + Entry.Size < Entry.Start)
+        {
+            Close( );
+            return false;
+        }
+        m_Regions[i].Region.Start = Entry.Start;
+        m_Regions[i].Region.Size = Entry.Size;
+        m_Regions[i].Region.Flags = Entry.Flags;
+        m_Regions[i].FileOffset = Entry.FileOffset;
+    }
+
+    m_Modules.resize( Header.ModuleCount );
+    for (uint32_t i = 0; i < Header.ModuleCount; i++)
+    {
+        MEMORY_SNAPSHOT_MODULE Entry;
+        if (fread( &Entry, sizeof( Entry ), 1, m_File ) != 1)
+        {
+            Close( );
+            return false;
+        }
+
+        TablesEnd += sizeof( Entry ) + ((uint64_t)Entry.NameLength + Entry.PathLength) * sizeof( uint16_t );
+        if (TablesEnd > FileSize ||
+            !ReadString16( m_File, Entry.NameLength, m_Modules[i].Name ) ||
+            !ReadString16( m_File, Entry.PathLength, m_Modules[i].Path ))
+        {
+            Close( );
+            return false;
+        }
+        m_Modules[i].Base = Entry.Base;
+        m_Modules[i].Size = Entry.Size;
+    }
+
+    std::sort( m_Regions.begin( ), m_Regions.end( ),
+               [] ( const SnapshotRegion& a, const SnapshotRegion& b ) { return a.Region.Start < b.Region.Start; } );
+
+    return true;
+}
+
+void CSnapshotMemorySource::Close( )
+{
+    if (m_File)
+        fclose( m_File );
+    m_File = NULL;
+    m_Regions.clear( );
+    m_Modules.clear( );
+}
+
+bool CSnapshotMemorySource::Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead )
+{
+    uint8_t* Out = (uint8_t*)Buffer;
+    size_t Total = 0;
+
+    memset( Buffer, 0, Size );
+
+    if (m_File)
+    {
+        // First region that ends after Address
+        auto it = std::upper_bound( m_Regions.begin( ), m_Regions.end( ), Address,
+                                    [] ( uint64_t a, const SnapshotRegion& r ) { return a < r.Region.Start + r.Region.Size; } );
+
+        uint64_t Cursor = Address;
+        const uint64_t End = Address + Size;
+        for (; it != m_Regions.end( ) && Cursor < End; ++it)
+        {
+            const uint64_t RegionStart = it->Region.Start;
+            const uint64_t RegionEnd = RegionStart + it->Region.Size;
+            if (RegionStart >= End)
+                break;
+
+            uint64_t CopyStart = std::max( Cursor, RegionStart );
+            uint64_t CopyEnd = std::min( End, RegionEnd );
+
+            if (SnapshotSeek( m_File, (int64_t)(it->FileOffset + (CopyStart - RegionStart)), SEEK_SET ) != 0)
+                break;
+
+            size_t Copied = fread( Out + (CopyStart - Address), 1, (size_t)(CopyEnd - CopyStart), m_File );
+            Total += Copied;
+            Cursor = CopyEnd;
+        }
+    }
+
+    if (BytesRead)
+        *BytesRead = Total;
+
+    return Total == Size;
+}
+
+bool CSnapshotMemorySource::Write( uint64_t /*Address*/, const void* /*Buffer*/, size_t /*Size*/, size_t* BytesWritten )
+{
+    // Snapshots are immutable
+    if (BytesWritten)
+        *BytesWritten = 0;
+    return false;
+}
+
+bool CSnapshotMemorySource::QueryRegions( std::vector<MemoryRegion>& Regions )
+{
+    Regions.clear( );
+    Regions.reserve( m_Regions.size( ) );
+    for (const SnapshotRegion& Entry : m_Regions)
+        Regions.push_back( Entry.Region );
+    return m_File != NULL;
+}
+
+bool CSnapshotMemorySource::EnumerateModules( std::vector<MemoryModule>& Modules )
+{
+    Modules = m_Modules;
+    return m_File != NULL;
+}
+
+bool CSnapshotMemorySource::Capture( IMemorySource* Source, const char* FilePath )
+{
+    std::vector<MemoryRegion> Regions;
+    std::vector<MemoryModule> Modules;
+
+    if (!Source || !Source->QueryRegions( Regions ))
+        return false;
+    Source->EnumerateModules( Modules );
+
+    // Only keep what we can actually read
+    Regions.erase( std::remove_if( Regions.begin( ), Regions.end( ),
+                                   [] ( const MemoryRegion& r ) { return !(r.Flags & MEMORY_REGION_READ); } ), Regions.end( ) );
+
+    FILE* File = fopen( FilePath, "wb" );
+    if (!File)
+        return false;
+
+    MEMORY_SNAPSHOT_HEADER Header;
+    Header.Magic = MEMORY_SNAPSHOT_MAGIC;
+    Header.Version = MEMORY_SNAPSHOT_VERSION;
+    Header.RegionCount = (uint32_t)Regions.size( );
+    Header.ModuleCount = (uint32_t)Modules.size( );
+    Header.Reserved = 0;
+
+    bool bSuccess = fwrite( &Header, sizeof( Header ), 1, File ) == 1;
+
+    uint64_t ModuleTableSize = 0;
+    for (const MemoryModule& Module : Modules)
+        ModuleTableSize += sizeof( MEMORY_SNAPSHOT_MODULE ) + (Module.Name.size( ) + Module.Path.size( )) * sizeof( uint16_t );
+
+    uint64_t DataOffset = sizeof( Header ) + Regions.size( ) * sizeof( MEMORY_SNAPSHOT_REGION ) + ModuleTableSize;
+    for (size_t i = 0; bSuccess && i < Regions.size( ); i++)
+    {
+        MEMORY_SNAPSHOT_REGION Entry;
+        Entry.Start = Regions[i].Start;
+        Entry.Size = Regions[i].Size;
+        Entry.Flags = Regions[i].Flags;
+        Entry.Reserved = 0;
+        Entry.FileOffset = DataOffset;
+        DataOffset += Regions[i].Size;
+        bSuccess = fwrite( &Entry, sizeof( Entry ), 1, File ) == 1;
+    }
+
+    for (size_t i = 0; bSuccess && i < Modules.size( ); i++)
+    {
+        MEMORY_SNAPSHOT_MODULE Entry;
+        Entry.Base = Modules[i].Base;
+        Entry.Size = Modules[i].Size;
+        Entry.NameLength = (uint32_t)Modules[i].Name.size( );
+        Entry.PathLength = (uint32_t)Modules[i].Path.size( );
+        bSuccess = fwrite( &Entry, sizeof( Entry ), 1, File ) == 1 &&
+            WriteString16( File, Modules[i].Name ) &&
+            WriteString16( File, Modules[i].Path );
+    }
+
+    // Region data, a page at a time so unreadable pages become zeros instead of failing the capture
+    std::vector<uint8_t> Page( MEMORY_PAGE_SIZE );
+    for (size_t i = 0; bSuccess && i < Regions.size( ); i++)
+    {
+        for (uint64_t Offset = 0; bSuccess && Offset < Regions[i].Size; Offset += Page.size( ))
+        {
+            size_t Chunk = (size_t)std::min<uint64_t>( Page.size( ), Regions[i].Size - Offset );
+            Source->Read( Regions[i].Start + Offset, Page.data( ), Chunk, NULL );
+            bSuccess = fwrite( Page.data( ), 1, Chunk, File ) == Chunk;
+        }
+    }
+
+    fclose( File );
+    return bSuccess;
+}
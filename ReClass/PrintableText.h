@@ -0,0 +1,26 @@
+#pragma once
+
+//
+// Printable text
+//
+// The printable test every memory preview uses: a byte is shown when it is
+// 0x20 - 0x7E, a UTF-16 unit when it is 0x20 - 0xFE but not 0x7F, anything
+// else becomes '.'. These replace the per character loops that did the same
+// test against signed char and wchar_t, and work 16 bytes at a time with
+// SSE2 where the compiler has it. The scalar loop handles the tail and
+// every other target, and char to char copies outside MSVC, where the
+// compiler vectorizes the loop better than the kernel does.
+//
+// Portable like the memory sources, no precompiled header.
+//
+#include <stddef.h>
+
+// Copy Length units of In to Out with anything unprintable replaced by '.'.
+// Out may be In. Nothing is terminated.
+void SanitizePrintable( char* Out, const char* In, size_t Length );
+void SanitizePrintable( wchar_t* Out, const char* In, size_t Length );
+void SanitizePrintable( wchar_t* Out, const wchar_t* In, size_t Length );
+
+// Length of the printable run at the start of In, at most Length. A preview
+// looks like a string when the run covers the first few bytes.
+size_t CountPrintable( const char* In, size_t Length );
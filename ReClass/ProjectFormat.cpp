@@ -0,0 +1,235 @@
+//
+// Binary project format. Deliberately free of MFC and the precompiled header
+// so it builds on the Linux analysis hosts as well.
+//
+#include "ProjectFormat.h"
+
+#include <string.h>
+
+// Table [Offset, Offset + Count * Size) lies inside a file of FileSize bytes
+static bool TableFits( uint64_t Offset, uint64_t Count, uint64_t Size, uint64_t FileSize )
+{
+    if (Offset > FileSize)
+        return false;
+    return Count <= (FileSize - Offset) / Size;
+}
+
+// [First, First + Count) inside a table of Total entries
+static bool RunFits( uint32_t First, uint32_t Count, uint32_t Total )
+{
+    return First <= Total && Count <= Total - First;
+}
+
+CProjectImage::CProjectImage( )
+    : m_Data( NULL )
+    , m_Header( NULL )
+    , m_Strings( NULL )
+    , m_StringData( NULL )
+    , m_Classes( NULL )
+    , m_Nodes( NULL )
+    , m_Lines( NULL )
+{
+}
+
+bool CProjectImage::Open( const void* Data, uint64_t Size, uint32_t ClassLimit )
+{
+    const PROJECT_BINARY_HEADER* Header = (const PROJECT_BINARY_HEADER*)Data;
+
+    m_Data = NULL;
+    m_Header = NULL;
+
+    if (Data == NULL || Size < sizeof( PROJECT_BINARY_HEADER ) ||
+        Header->Magic != PROJECT_BINARY_MAGIC ||
+        Header->Version != PROJECT_BINARY_VERSION ||
+        Header->HeaderSize < sizeof( PROJECT_BINARY_HEADER ) || Header->HeaderSize > Size)
+        return false;
+
+    // Finish aligns every table, records are read in place
+    if (((Header->StringTable | Header->ClassTable | Header->NodeTable | Header->LineTable) & 7) != 0)
+        return false;
+
+    if (!TableFits( Header->StringTable, Header->StringCount, sizeof( PROJECT_BINARY_STRING ), Size ) ||
+        !TableFits( Header->StringData, Header->StringDataSize, 1, Size ) ||
+        !TableFits( Header->ClassTable, Header->ClassCount, sizeof( PROJECT_BINARY_CLASS ), Size ) ||
+        !TableFits( Header->NodeTable, Header->NodeCount, sizeof( PROJECT_BINARY_NODE ), Size ) ||
+        !TableFits( Header->LineTable, Header->LineCount, sizeof( uint32_t ), Size ))
+        return false;
+
+    const uint8_t* Bytes = (const uint8_t*)Data;
+    const PROJECT_BINARY_STRING* Strings = (const PROJECT_BINARY_STRING*)(Bytes + Header->StringTable);
+    const char* StringData = (const char*)(Bytes + Header->StringData);
+    const PROJECT_BINARY_CLASS* Classes = (const PROJECT_BINARY_CLASS*)(Bytes + Header->ClassTable);
+    const PROJECT_BINARY_NODE* Nodes = (const PROJECT_BINARY_NODE*)(Bytes + Header->NodeTable);
+    const uint32_t* Lines = (const uint32_t*)(Bytes + Header->LineTable);
+
+    //
+    // Check every reference once here, lookups afterwards don't
+    //
+    auto StringValid = [&] ( uint32_t Id ) { return Id == PROJECT_NO_STRING || Id < Header->StringCount; };
+
+    for (uint32_t i = 0; i < Header->StringCount; i++)
+    {
+        if ((uint64_t)Strings[i].Offset + Strings[i].Length >= Header->StringDataSize ||
+            StringData[Strings[i].Offset + Strings[i].Length] != '\0')
+            return false;
+    }
+
+    if (ClassLimit == PROJECT_NO_CLASS)
+        ClassLimit = Header->ClassCount;
+
+    if (!StringValid( Header->Header ) || !StringValid( Header->Footer ) || !StringValid( Header->Notes ))
+        return false;
+    for (uint32_t i = 0; i < PROJECT_TYPEDEF_COUNT; i++)
+    {
+        if (!StringValid( Header->Typedefs[i] ))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < Header->ClassCount; i++)
+    {
+        const PROJECT_BINARY_CLASS& Class = Classes[i];
+        if (!StringValid( Class.Name ) || !StringValid( Class.Comment ) || !StringValid( Class.OffsetString ) || !StringValid( Class.Code ) ||
+            !RunFits( Class.FirstNode, Class.NodeCount, Header->NodeCount ))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < Header->NodeCount; i++)
+    {
+        const PROJECT_BINARY_NODE& Node = Nodes[i];
+        if (!StringValid( Node.Name ) || !StringValid( Node.Comment ) ||
+            (Node.Class != PROJECT_NO_CLASS && Node.Class >= ClassLimit) ||
+            !RunFits( Node.FirstChild, Node.ChildCount, Header->NodeCount ) ||
+            !RunFits( Node.FirstLine, Node.LineCount, Header->LineCount ))
+            return false;
+
+        // Children come after their parent, a file can't make a node its own child
+        if (Node.ChildCount != 0 && Node.FirstChild <= i)
+            return false;
+    }
+
+    for (uint32_t i = 0; i < Header->LineCount; i++)
+    {
+        if (!StringValid( Lines[i] ))
+            return false;
+    }
+
+    m_Data = Bytes;
+    m_Header = Header;
+    m_Strings = Strings;
+    m_StringData = StringData;
+    m_Classes = Classes;
+    m_Nodes = Nodes;
+    m_Lines = Lines;
+    return true;
+}
+
+const char* CProjectImage::GetString( uint32_t Id, uint32_t* Length ) const
+{
+    if (Id == PROJECT_NO_STRING)
+    {
+        if (Length)
+            *Length = 0;
+        return "";
+    }
+
+    if (Length)
+        *Length = m_Strings[Id].Length;
+    return m_StringData + m_Strings[Id].Offset;
+}
+
+CProjectWriter::CProjectWriter( )
+{
+    memset( &m_Header, 0, sizeof( m_Header ) );
+    m_Header.Magic = PROJECT_BINARY_MAGIC;
+    m_Header.Version = PROJECT_BINARY_VERSION;
+    m_Header.HeaderSize = sizeof( PROJECT_BINARY_HEADER );
+    m_Header.Header = PROJECT_NO_STRING;
+    m_Header.Footer = PROJECT_NO_STRING;
+    m_Header.Notes = PROJECT_NO_STRING;
+    for (uint32_t i = 0; i < PROJECT_TYPEDEF_COUNT; i++)
+        m_Header.Typedefs[i] = PROJECT_NO_STRING;
+}
+
+uint32_t CProjectWriter::AddString( const char* String, size_t Length )
+{
+    if (Length == 0)
+        return PROJECT_NO_STRING;
+
+    std::string Key( String, Length );
+    auto Found = m_StringIds.find( Key );
+    if (Found != m_StringIds.end( ))
+        return Found->second;
+
+    PROJECT_BINARY_STRING Entry;
+    Entry.Offset = (uint32_t)m_StringData.size( );
+    Entry.Length = (uint32_t)Length;
+    m_StringData.append( String, Length );
+    m_StringData.push_back( '\0' );
+
+    uint32_t Id = (uint32_t)m_Strings.size( );
+    m_Strings.push_back( Entry );
+    m_StringIds.emplace( std::move( Key ), Id );
+    return Id;
+}
+
+uint32_t CProjectWriter::AddString( const char* String )
+{
+    return (String != NULL) ? AddString( String, strlen( String ) ) : PROJECT_NO_STRING;
+}
+
+uint32_t CProjectWriter::ReserveNodes( uint32_t Count )
+{
+    PROJECT_BINARY_NODE Empty;
+    memset( &Empty, 0, sizeof( Empty ) );
+    Empty.Name = PROJECT_NO_STRING;
+    Empty.Comment = PROJECT_NO_STRING;
+    Empty.Class = PROJECT_NO_CLASS;
+
+    uint32_t First = (uint32_t)m_Nodes.size( );
+    m_Nodes.resize( m_Nodes.size( ) + Count, Empty );
+    return First;
+}
+
+uint32_t CProjectWriter::AddLine( uint32_t String )
+{
+    m_Lines.push_back( String );
+    return (uint32_t)m_Lines.size( ) - 1;
+}
+
+void CProjectWriter::AddClass( const PROJECT_BINARY_CLASS& Class )
+{
+    m_Classes.push_back( Class );
+}
+
+void CProjectWriter::Finish( std::vector<uint8_t>& Image )
+{
+    // Tables start 8 byte aligned
+    auto Align = [] ( uint64_t Offset ) { return (Offset + 7) & ~(uint64_t)7; };
+
+    PROJECT_BINARY_HEADER Header = m_Header;
+    Header.StringCount = (uint32_t)m_Strings.size( );
+    Header.ClassCount = (uint32_t)m_Classes.size( );
+    Header.NodeCount = (uint32_t)m_Nodes.size( );
+    Header.LineCount = (uint32_t)m_Lines.size( );
+
+    Header.StringTable = Align( sizeof( Header ) );
+    Header.StringData = Align( Header.StringTable + m_Strings.size( ) * sizeof( PROJECT_BINARY_STRING ) );
+    Header.StringDataSize = m_StringData.size( );
+    Header.ClassTable = Align( Header.StringData + Header.StringDataSize );
+    Header.NodeTable = Align( Header.ClassTable + m_Classes.size( ) * sizeof( PROJECT_BINARY_CLASS ) );
+    Header.LineTable = Align( Header.NodeTable + m_Nodes.size( ) * sizeof( PROJECT_BINARY_NODE ) );
+
+    Image.assign( (size_t)(Header.LineTable + m_Lines.size( ) * sizeof( uint32_t )), 0 );
+
+    memcpy( Image.data( ), &Header, sizeof( Header ) );
+    if (!m_Strings.empty( ))
+        memcpy( Image.data( ) + Header.StringTable, m_Strings.data( ), m_Strings.size( ) * sizeof( PROJECT_BINARY_STRING ) );
+    if (!m_StringData.empty( ))
+        memcpy( Image.data( ) + Header.StringData, m_StringData.data( ), m_StringData.size( ) );
+    if (!m_Classes.empty( ))
+        memcpy( Image.data( ) + Header.ClassTable, m_Classes.data( ), m_Classes.size( ) * sizeof( PROJECT_BINARY_CLASS ) );
+    if (!m_Nodes.empty( ))
+        memcpy( Image.data( ) + Header.NodeTable, m_Nodes.data( ), m_Nodes.size( ) * sizeof( PROJECT_BINARY_NODE ) );
+    if (!m_Lines.empty( ))
+        memcpy( Image.data( ) + Header.LineTable, m_Lines.data( ), m_Lines.size( ) * sizeof( uint32_t ) );
+}
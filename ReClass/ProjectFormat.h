@@ -0,0 +1,154 @@
+#pragma once
+
+//
+// Binary project format (.ntsb)
+//
+// The same project the .nts XML holds, laid out so opening it is a few table
+// lookups instead of a DOM walk and string matching:
+//
+//   PROJECT_BINARY_HEADER
+//   string table    PROJECT_BINARY_STRING[StringCount], into the string data
+//   string data     UTF-8, every string NUL terminated
+//   class table     PROJECT_BINARY_CLASS[ClassCount]
+//   node table      PROJECT_BINARY_NODE[NodeCount]
+//   line table      uint32_t[LineCount], string ids of disassembly lines
+//
+// A class owns a contiguous run of the node table, nodes with children (the
+// vtable's functions) own another run after it. Pointers, instances and arrays
+// name the class they use by its index in the class table. Strings are stored
+// once and referenced by id everywhere else. All integers are little endian,
+// offsets are from the start of the file.
+//
+// CProjectImage reads a file that is already in memory (mapped) without
+// copying it: Open validates the tables once, after that every class, node
+// and string is a lookup. Portable like the memory sources, no precompiled
+// header.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define PROJECT_BINARY_MAGIC    0x4A4F52504253544EULL // "NTSBPROJ"
+#define PROJECT_BINARY_VERSION  1
+
+#define PROJECT_NO_STRING       0xFFFFFFFF
+#define PROJECT_NO_CLASS        0xFFFFFFFF
+
+#define PROJECT_NODE_HIDDEN     0x1
+
+// g_Typedefs in .nts order: Hex, Int64, Int32, Int16, Int8, Qword, Dword, Word,
+// Byte, Float, Double, Vec2, Vec3, Quat, Matrix, PChar, PWChar
+#define PROJECT_TYPEDEF_COUNT   17
+
+#pragma pack(push, 1)
+struct PROJECT_BINARY_HEADER {
+    uint64_t Magic;
+    uint32_t Version;
+    uint32_t HeaderSize;        // sizeof( PROJECT_BINARY_HEADER ), later versions append fields
+    uint32_t StringCount;
+    uint32_t ClassCount;
+    uint32_t NodeCount;
+    uint32_t LineCount;
+    uint64_t StringTable;
+    uint64_t StringData;
+    uint64_t StringDataSize;
+    uint64_t ClassTable;
+    uint64_t NodeTable;
+    uint64_t LineTable;
+    uint32_t Header;            // String ids of the project's header, footer and notes
+    uint32_t Footer;
+    uint32_t Notes;
+    uint32_t Typedefs[PROJECT_TYPEDEF_COUNT];
+};
+
+struct PROJECT_BINARY_STRING {
+    uint32_t Offset;            // Into the string data
+    uint32_t Length;            // Bytes, without the NUL
+};
+
+struct PROJECT_BINARY_CLASS {
+    uint32_t Name;
+    uint32_t Comment;
+    uint32_t OffsetString;
+    uint32_t Code;
+    uint64_t Offset;
+    uint32_t FirstNode;
+    uint32_t NodeCount;
+};
+
+struct PROJECT_BINARY_NODE {
+    int32_t Type;               // NodeType
+    uint32_t Flags;             // PROJECT_NODE_*
+    uint32_t Name;
+    uint32_t Comment;
+    uint32_t Size;              // Custom, text, unicode and function nodes
+    uint32_t Count;             // Array total, pointer array count
+    uint32_t Class;             // Pointers, instances and arrays, PROJECT_NO_CLASS if unset
+    uint32_t FirstChild;
+    uint32_t ChildCount;
+    uint32_t FirstLine;         // Function pointers' disassembly
+    uint32_t LineCount;
+};
+#pragma pack(pop)
+
+class CProjectImage {
+public:
+    CProjectImage( );
+
+    // Data has to stay valid while the image is used. Links may name classes
+    // below ClassLimit, by default the image's own; an autosaved class
+    // (Autosave.h) is stored alone and links into the whole project.
+    bool Open( const void* Data, uint64_t Size, uint32_t ClassLimit = PROJECT_NO_CLASS );
+
+    inline const PROJECT_BINARY_HEADER& GetHeader( ) const { return *m_Header; }
+
+    inline uint32_t GetClassCount( ) const { return m_Header->ClassCount; }
+    inline const PROJECT_BINARY_CLASS& GetClass( uint32_t Index ) const { return m_Classes[Index]; }
+    inline const PROJECT_BINARY_NODE& GetNode( uint32_t Index ) const { return m_Nodes[Index]; }
+    inline uint32_t GetLine( uint32_t Index ) const { return m_Lines[Index]; }
+
+    // "" for PROJECT_NO_STRING
+    const char* GetString( uint32_t Id, uint32_t* Length = NULL ) const;
+
+private:
+    const uint8_t* m_Data;
+    const PROJECT_BINARY_HEADER* m_Header;
+    const PROJECT_BINARY_STRING* m_Strings;
+    const char* m_StringData;
+    const PROJECT_BINARY_CLASS* m_Classes;
+    const PROJECT_BINARY_NODE* m_Nodes;
+    const uint32_t* m_Lines;
+};
+
+class CProjectWriter {
+public:
+    CProjectWriter( );
+
+    // Equal strings share one id
+    uint32_t AddString( const char* String, size_t Length );
+    uint32_t AddString( const char* String );
+
+    // Nodes are reserved per run (a class's nodes, a node's children) and
+    // filled in afterwards
+    uint32_t ReserveNodes( uint32_t Count );
+    inline PROJECT_BINARY_NODE& GetNode( uint32_t Index ) { return m_Nodes[Index]; }
+
+    uint32_t AddLine( uint32_t String );
+    void AddClass( const PROJECT_BINARY_CLASS& Class );
+
+    // Header, footer, notes and typedefs
+    inline PROJECT_BINARY_HEADER& GetHeader( ) { return m_Header; }
+
+    void Finish( std::vector<uint8_t>& Image );
+
+private:
+    PROJECT_BINARY_HEADER m_Header;
+    std::vector<PROJECT_BINARY_STRING> m_Strings;
+    std::string m_StringData;
+    std::unordered_map<std::string, uint32_t> m_StringIds;
+    std::vector<PROJECT_BINARY_CLASS> m_Classes;
+    std::vector<PROJECT_BINARY_NODE> m_Nodes;
+    std::vector<uint32_t> m_Lines;
+};
@@ -16,6 +16,8 @@
 #include "DialogPlugins.h"
 #include "DialogAbout.h"
 #include "DarkThemeManager.h"
+#include "ProjectFormat.h"
+#include "XmlPullReader.h"
 
 #pragma comment(lib, "dwmapi.lib")
 
@@ -48,6 +50,9 @@ BEGIN_MESSAGE_MAP( CReClassExApp, CWinAppEx )
     ON_UPDATE_COMMAND_UI( ID_BUTTON_PAUSE, &CReClassExApp::OnUpdateButtonPause )
     ON_UPDATE_COMMAND_UI( ID_BUTTON_RESUME, &CReClassExApp::OnUpdateButtonResume )
     ON_UPDATE_COMMAND_UI( ID_BUTTON_KILL, &CReClassExApp::OnUpdateButtonKill )
+    ON_COMMAND( ID_BUTTON_CAPTURE_SNAPSHOT, &CReClassExApp::OnButtonCaptureSnapshot )
+    ON_UPDATE_COMMAND_UI( ID_BUTTON_CAPTURE_SNAPSHOT, &CReClassExApp::OnUpdateButtonCaptureSnapshot )
+    ON_COMMAND( ID_BUTTON_OPEN_SNAPSHOT, &CReClassExApp::OnButtonOpenSnapshot )
     ON_UPDATE_COMMAND_UI( ID_BUTTON_SEARCH, &CReClassExApp::OnUpdateButtonSearch )
     ON_UPDATE_COMMAND_UI( ID_BUTTON_MODULES, &CReClassExApp::OnUpdateButtonModules )
     ON_UPDATE_COMMAND_UI( ID_RECLASS_PLUGINS, &CReClassExApp::OnUpdateButtonPlugins )
@@ -175,6 +180,8 @@ BOOL CReClassExApp::InitInstance( )
     g_bPointers         = GetProfileInt( _T( "Display" ), _T( "Pointers" ), g_bPointers ) > 0 ? true : false;
     g_bClassBrowser     = GetProfileInt( _T( "Display" ), _T( "ClassBrowser" ), g_bClassBrowser ) > 0 ? true : false;
     g_bFilterProcesses  = GetProfileInt( _T( "Display" ), _T( "FilterProcesses" ), g_bFilterProcesses ) > 0 ? true : false;
+    g_bHighlightChanges = GetProfileInt( _T( "Display" ), _T( "HighlightChanges" ), g_bHighlightChanges ) > 0 ? true : false;
+    g_ChangeFadeFrames  = min( max( GetProfileInt( _T( "Display" ), _T( "ChangeFadeFrames" ), g_ChangeFadeFrames ), 1 ), CHANGE_AGE_NONE );
 
     g_bRTTI             = GetProfileInt( _T( "Misc" ), _T( "RTTI" ), g_bRTTI ) > 0 ? true : false;
     g_bRandomName       = GetProfileInt( _T( "Misc" ), _T( "RandomName" ), g_bRandomName ) > 0 ? true : false;
@@ -185,6 +192,15 @@ BOOL CReClassExApp::InitInstance( )
     g_bPrivatePadding   = GetProfileInt( _T( "Class Generation" ), _T( "PrivatePadding" ), g_bPrivatePadding ) > 0 ? true : false;
     g_bClipboardCopy    = GetProfileInt( _T( "Class Generation" ), _T( "ClipboardCopy" ), g_bClipboardCopy ) > 0 ? true : false;
 
+    g_ReadCacheBudget   = GetProfileInt( _T( "Read Cache" ), _T( "Budget" ), g_ReadCacheBudget );
+    g_ReadCacheCodeTtl  = GetProfileInt( _T( "Read Cache" ), _T( "CodeTTL" ), g_ReadCacheCodeTtl );
+    g_ReadCacheDataTtl  = GetProfileInt( _T( "Read Cache" ), _T( "DataTTL" ), g_ReadCacheDataTtl );
+    g_ReadCache.SetBudget( g_ReadCacheBudget );
+    g_ReadCache.SetTtl( g_ReadCacheCodeTtl, g_ReadCacheDataTtl );
+
+    g_RefreshFocused    = min( max( GetProfileInt( _T( "Refresh" ), _T( "Focused" ), g_RefreshFocused ), REFRESH_TICK ), REFRESH_MAX_INTERVAL );
+    g_RefreshBackground = min( max( GetProfileInt( _T( "Refresh" ), _T( "Background" ), g_RefreshBackground ), REFRESH_TICK ), REFRESH_MAX_INTERVAL );
+
     g_bTop = false; //GetProfileInt("Display", "g_bTop", g_bTop) > 0 ? true : false;
 
     g_ViewFontName = _T( "Terminal" );
@@ -257,6 +273,7 @@ BOOL CReClassExApp::InitInstance( )
     m_pSymbolLoader = new (std::nothrow) Symbols;
     if (m_pSymbolLoader)
     {
+        m_pSymbolLoader->SetNotifyWindow( pMainFrame->GetSafeHwnd( ) );
         PrintOut( _T( "Symbol resolution enabled" ) );
         g_bSymbolResolution = true;
     }
@@ -272,11 +289,44 @@ BOOL CReClassExApp::InitInstance( )
 
     CReattachButton::UpdateIcon();
 
+    //
+    // A journal left behind means the last session didn't exit cleanly
+    //
+    CString AutosavePath;
+    if (CAutosaveJournal::FindOrphan( AutosavePath ))
+    {
+        if (AfxMessageBox( _T( "ReClassEx didn't exit cleanly last time. Recover the autosaved project?" ), MB_YESNO | MB_ICONQUESTION ) == IDYES)
+            g_Autosave.Recover( AutosavePath );
+        else
+            CAutosaveJournal::Discard( AutosavePath );
+    }
+
+    g_Autosave.Start( );
+
     return TRUE;
 }
 
 int CReClassExApp::ExitInstance( )
 {
+    //
+    // Stop the memory map scanner before its memory source goes away
+    //
+    g_MemoryMapScanner.Stop( );
+
+    //
+    // Symbol workers print to the console, join them before it goes away
+    //
+    if (m_pSymbolLoader)
+    {
+        delete m_pSymbolLoader;
+        m_pSymbolLoader = NULL;
+    }
+
+    //
+    // A clean exit leaves nothing to recover
+    //
+    g_Autosave.Stop( TRUE );
+
     //
     // Unload any loaded plugins
     //
@@ -303,12 +353,6 @@ int CReClassExApp::ExitInstance( )
         m_pConsole = NULL;
     }
 
-    if (m_pSymbolLoader) 
-    { 
-        delete m_pSymbolLoader;
-        m_pSymbolLoader = NULL;
-    }
-
     AfxOleTerm( FALSE );
 
     //
@@ -347,6 +391,8 @@ int CReClassExApp::ExitInstance( )
     WriteProfileInt( _T( "Display" ),   _T( "Top" ),        g_bTop );
     WriteProfileInt( _T( "Display" ),   _T( "ClassBrowser" ), g_bClassBrowser );
     WriteProfileInt( _T( "Display" ),   _T( "FilterProcesses" ), g_bFilterProcesses );
+    WriteProfileInt( _T( "Display" ),   _T( "HighlightChanges" ), g_bHighlightChanges );
+    WriteProfileInt( _T( "Display" ),   _T( "ChangeFadeFrames" ), g_ChangeFadeFrames );
 
     WriteProfileInt( _T( "Misc" ),  _T( "RTTI" ),           g_bRTTI );
     WriteProfileInt( _T( "Misc" ),  _T( "RandomName" ),     g_bRandomName );
@@ -354,6 +400,13 @@ int CReClassExApp::ExitInstance( )
 
     WriteProfileInt( _T( "Class Generation" ), _T( "PrivatePadding" ), g_bPrivatePadding );
     WriteProfileInt( _T( "Class Generation" ), _T( "ClipboardCopy" ), g_bClipboardCopy );
+
+    WriteProfileInt( _T( "Read Cache" ), _T( "Budget" ),     g_ReadCacheBudget );
+    WriteProfileInt( _T( "Read Cache" ), _T( "CodeTTL" ),    g_ReadCacheCodeTtl );
+    WriteProfileInt( _T( "Read Cache" ), _T( "DataTTL" ),    g_ReadCacheDataTtl );
+
+    WriteProfileInt( _T( "Refresh" ),    _T( "Focused" ),    g_RefreshFocused );
+    WriteProfileInt( _T( "Refresh" ),    _T( "Background" ), g_RefreshBackground );
     
     //
     // Exit application instance.
@@ -381,6 +434,10 @@ void CReClassExApp::OnButtonReattachProc()
 
                     g_hProcess = ReClassOpenProcess(PROCESS_ALL_ACCESS, FALSE, entry.th32ProcessID);
                     g_ProcessID = entry.th32ProcessID;
+                    ReClassSetMemorySource(NULL);
+                    g_RttiCache.Clear();
+                    if (m_pSymbolLoader != NULL)
+                        m_pSymbolLoader->DropProcessSymbols();
                     TCHAR tcsProcessPath[MAX_PATH] = { 0 };
                     GetModuleFileNameEx(g_hProcess, NULL, tcsProcessPath, MAX_PATH);
                     g_ProcessPath = tcsProcessPath;
@@ -407,8 +464,18 @@ void CReClassExApp::OnButtonReset( )
 
     g_hProcess = NULL;
     g_ProcessID = 0;
-    g_AttachedProcessAddress = NULL;
+    ReClassSetMemorySource( NULL );
+    g_RttiCache.Clear( );
+    UpdateMemoryMap( );
+
+    CloseProject( );
+    g_NodeCreateIndex = 0;
+
+    OnButtonNewClass();
+}
 
+void CReClassExApp::CloseProject( )
+{
     CMDIFrameWnd* pFrame = STATIC_DOWNCAST( CMDIFrameWnd, m_pMainWnd );
     CMDIChildWnd* pChildWnd = pFrame->MDIGetActive( );
 
@@ -418,15 +485,17 @@ void CReClassExApp::OnButtonReset( )
         pChildWnd = pFrame->MDIGetActive( );
     }
 
+    // Classes that never needed their nodes let go of the file they came from
+    for (CNodeClass* pClass : m_Classes)
+        pClass->TakeSource( );
+
     m_Classes.clear( );
-    g_NodeCreateIndex = 0;
+    g_StringPool.Clear( );
 
     m_strHeader = _T( "" );
     m_strFooter = _T( "" );
     m_strNotes = _T( "" );
-    m_strCurrentFilePath = _T("");
-
-    OnButtonNewClass();
+    m_strCurrentFilePath = _T( "" );
 }
 
 void CReClassExApp::OnButtonPause( )
@@ -453,6 +522,8 @@ void CReClassExApp::OnButtonKill( )
 {
     TerminateProcess( g_hProcess, 0 );
     g_hProcess = NULL;
+    ReClassSelectMemorySource( );
+    g_RttiCache.Clear( );
 }
 
 void CReClassExApp::OnUpdateButtonKill( CCmdUI* pCmdUI )
@@ -460,20 +531,78 @@ void CReClassExApp::OnUpdateButtonKill( CCmdUI* pCmdUI )
     pCmdUI->Enable( g_hProcess != NULL );
 }
 
-void CReClassExApp::CalcOffsets( CNodeClass* pClass )
+void CReClassExApp::OnButtonCaptureSnapshot( )
 {
-    size_t offset = 0;
-    for (UINT i = 0; i < pClass->NodeCount( ); i++)
+    TCHAR Filters[] = _T( "ReClass Snapshot (*.rcsnap)|*.rcsnap|All Files (*.*)|*.*||" );
+    CFileDialog fileDlg( FALSE, _T( "rcsnap" ), g_ProcessName, OFN_OVERWRITEPROMPT | OFN_HIDEREADONLY, Filters, NULL );
+    if (fileDlg.DoModal( ) != IDOK)
+        return;
+
+    CWaitCursor Wait;
+
+    // Straight from the source behind the page cache, a whole process would
+    // only evict what the views have cached
+    MemorySourcePtr Source = ReClassAcquireMemorySource( );
+    if (Source == NULL || !CSnapshotMemorySource::Capture( Source.get( ), CT2A( fileDlg.GetPathName( ) ) ))
     {
-        pClass->GetNode( i )->SetOffset( offset );
-        offset += pClass->GetNode( i )->GetMemorySize( );
+        GetMainWnd( )->MessageBox( _T( "Failed to write the snapshot" ), g_ReClassApp.m_pszAppName, MB_OK | MB_ICONERROR );
+        return;
     }
+
+    PrintOut( _T( "Captured snapshot %s" ), fileDlg.GetPathName( ).GetString( ) );
+}
+
+void CReClassExApp::OnUpdateButtonCaptureSnapshot( CCmdUI* pCmdUI )
+{
+    pCmdUI->Enable( g_hProcess != NULL );
+}
+
+void CReClassExApp::OnButtonOpenSnapshot( )
+{
+    TCHAR Filters[] = _T( "ReClass Snapshot (*.rcsnap)|*.rcsnap|All Files (*.*)|*.*||" );
+    CFileDialog fileDlg( TRUE, _T( "rcsnap" ), _T( "" ), OFN_FILEMUSTEXIST | OFN_HIDEREADONLY, Filters, NULL );
+    if (fileDlg.DoModal( ) != IDOK)
+        return;
+
+    CSnapshotMemorySource* pSnapshot = new CSnapshotMemorySource;
+    if (!pSnapshot->Open( CT2A( fileDlg.GetPathName( ) ) ))
+    {
+        delete pSnapshot;
+        GetMainWnd( )->MessageBox( _T( "Not a ReClass snapshot, or the file is damaged" ), g_ReClassApp.m_pszAppName, MB_OK | MB_ICONERROR );
+        return;
+    }
+
+    // The snapshot is the target now, views read it instead of the process
+    if (g_hProcess != NULL)
+        CloseHandle( g_hProcess );
+    g_hProcess = NULL;
+    g_ProcessID = 0;
+
+    ReClassSetMemorySource( pSnapshot );
+    g_RttiCache.Clear( );
+
+    std::shared_ptr<MemoryMapSnapshot> Map = std::make_shared<MemoryMapSnapshot>( );
+    BuildMemoryMap( pSnapshot, *Map );
+    PublishMemoryMap( Map );
+
+    PrintOut( _T( "Opened snapshot %s" ), fileDlg.GetPathName( ).GetString( ) );
+}
+
+void CReClassExApp::CalcOffsets( CNodeClass* pClass )
+{
+    const NodeRecords& Records = pClass->GetRecords( );
+    for (UINT i = 0; i < Records.Offsets.size( ); i++)
+        pClass->GetNode( i )->SetOffset( Records.Offsets[i] );
 }
 
 void CReClassExApp::CalcAllOffsets( )
 {
+    // Pending classes get theirs when they materialize
     for (UINT i = 0; i < m_Classes.size( ); i++)
-        CalcOffsets( m_Classes[i] );
+    {
+        if (!m_Classes[i]->IsPending( ))
+            CalcOffsets( m_Classes[i] );
+    }
 }
 
 void CReClassExApp::OnFileNew( )
@@ -565,6 +694,8 @@ void CReClassExApp::ClearSelection( )
 
 void CReClassExApp::ClearHidden( )
 {
+    g_Autosave.MarkProjectDirty( );
+
     for (size_t c = 0; c < m_Classes.size( ); c++)
     {
         m_Classes[c]->Show( );
@@ -689,6 +820,8 @@ void CReClassExApp::OnButtonNotes( )
     dlg.Title = _T( "Notes" );
     dlg.Text = m_strNotes;
     dlg.DoModal( );
+    if (m_strNotes != dlg.Text)
+        g_Autosave.MarkProjectDirty( );
     m_strNotes = dlg.Text;
 }
 
@@ -704,6 +837,8 @@ void CReClassExApp::OnButtonHeader( )
     dlg.Title = _T( "Header" );
     dlg.Text = m_strHeader;
     dlg.DoModal( );
+    if (m_strHeader != dlg.Text)
+        g_Autosave.MarkProjectDirty( );
     m_strHeader = dlg.Text;
 }
 
@@ -713,6 +848,8 @@ void CReClassExApp::OnButtonFooter( )
     dlg.Title = _T( "Footer" );
     dlg.Text = m_strFooter;
     dlg.DoModal( );
+    if (m_strFooter != dlg.Text)
+        g_Autosave.MarkProjectDirty( );
     m_strFooter = dlg.Text;
 }
 
@@ -1018,6 +1155,44 @@ void CReClassExApp::SaveXML( TCHAR* FileName )
     PrintOut( _T( "NothinToSee files saved successfully to \"%s\"" ), FileName ); 
 }
 
+#define PROJECT_BINARY_EXTENSION _T( ".ntsb" )
+
+static BOOLEAN IsBinaryProjectPath( const CString& FileName )
+{
+    int Dot = FileName.ReverseFind( _T( '.' ) );
+    return (Dot != -1 && FileName.Mid( Dot ).CompareNoCase( PROJECT_BINARY_EXTENSION ) == 0) ? TRUE : FALSE;
+}
+
+static BOOLEAN IsBinaryProjectFile( LPCTSTR FileName )
+{
+    ULONGLONG Magic = 0;
+    FILE* fp = NULL;
+
+    _tfopen_s( &fp, FileName, _T( "rb" ) );
+    if (fp == NULL)
+        return FALSE;
+    size_t Read = fread( &Magic, sizeof( Magic ), 1, fp );
+    fclose( fp );
+
+    return (Read == 1 && Magic == PROJECT_BINARY_MAGIC) ? TRUE : FALSE;
+}
+
+static double ElapsedMilliseconds( const LARGE_INTEGER& Start )
+{
+    LARGE_INTEGER Now, Frequency;
+    QueryPerformanceCounter( &Now );
+    QueryPerformanceFrequency( &Frequency );
+    return (double)(Now.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+}
+
+void CReClassExApp::SaveProject( LPCTSTR FileName )
+{
+    if (IsBinaryProjectPath( FileName ))
+        SaveBinary( FileName );
+    else
+        SaveXML( (TCHAR*)FileName );
+}
+
 void CReClassExApp::OnFileSave( )
 {
     if (m_strCurrentFilePath.IsEmpty( ))
@@ -1026,25 +1201,35 @@ void CReClassExApp::OnFileSave( )
     }
     else
     {
-        SaveXML( m_strCurrentFilePath.GetBuffer( ) );
+        SaveProject( m_strCurrentFilePath );
     }
 }
 
 void CReClassExApp::OnFileSaveAs( )
 {
-    TCHAR Filters[] = _T( "NothinToSee (*.nts)|*.nts|All Files (*.*)|*.*||" );
+    TCHAR Filters[] = _T( "NothinToSee (*.nts)|*.nts|NothinToSee binary (*.ntsb)|*.ntsb|All Files (*.*)|*.*||" );
     CFileDialog fileDlg( FALSE, _T( "reclass" ), _T( "" ), OFN_HIDEREADONLY, Filters, NULL );
     if (fileDlg.DoModal( ) != IDOK)
         return;
 
     CString pathName = fileDlg.GetPathName( );
+
+    // The format follows the extension, Save keeps using the one picked here
+    if (fileDlg.GetOFN( ).nFilterIndex == 2 && !IsBinaryProjectPath( pathName ))
+    {
+        int Dot = pathName.ReverseFind( _T( '.' ) );
+        if (Dot > pathName.ReverseFind( _T( '\\' ) ))
+            pathName.Truncate( Dot );
+        pathName += PROJECT_BINARY_EXTENSION;
+    }
+
     m_strCurrentFilePath = pathName;
-    SaveXML( pathName.GetBuffer( ) );
+    SaveProject( pathName );
 }
 
 void CReClassExApp::OnFileOpen( )
 {
-    TCHAR Filters[] = _T( "NothinToSee (*.nts)|*.nts|All Files (*.*)|*.*||" );
+    TCHAR Filters[] = _T( "NothinToSee (*.nts;*.ntsb)|*.nts;*.ntsb|All Files (*.*)|*.*||" );
     
     CFileDialog fileDlg( TRUE, _T( "nts" ), _T( "" ), OFN_FILEMUSTEXIST | OFN_HIDEREADONLY, Filters );
     if (fileDlg.DoModal( ) != IDOK)
@@ -1052,563 +1237,1052 @@ void CReClassExApp::OnFileOpen( )
 
     CString pathName = fileDlg.GetPathName( );
 
-    CMDIFrameWnd* pFrame = STATIC_DOWNCAST( CMDIFrameWnd, m_pMainWnd );
-    CMDIChildWnd* pChildWnd = pFrame->MDIGetActive( );
+    CloseProject( );
 
-    while (pChildWnd)
+    LARGE_INTEGER LoadStart;
+    QueryPerformanceCounter( &LoadStart );
+
+    if (IsBinaryProjectFile( pathName ))
     {
-        pChildWnd->SendMessage( WM_CLOSE, 0, 0 );
-        pChildWnd = pFrame->MDIGetActive( );
+        if (LoadBinary( pathName ))
+            PrintOut( _T( "Loaded %u classes from \"%s\" in %.1f ms" ), (UINT)m_Classes.size( ), pathName.GetString( ), ElapsedMilliseconds( LoadStart ) );
+        else
+            PrintOut( _T( "Failed to load \"%s\", not a valid binary project" ), pathName.GetString( ) );
+        return;
     }
 
-    m_Classes.clear( );
+    if (LoadXML( pathName ))
+        PrintOut( _T( "Loaded %u classes from \"%s\" in %.1f ms" ), (UINT)m_Classes.size( ), pathName.GetString( ), ElapsedMilliseconds( LoadStart ) );
+}
 
-    m_strHeader = _T( "" );
-    m_strFooter = _T( "" );
-    m_strNotes = _T( "" );
-    m_strCurrentFilePath = _T( "" );
+// Read-only view of a whole project file for the loaders
+class CMappedProjectFile {
+public:
+    CMappedProjectFile( ) : m_hFile( INVALID_HANDLE_VALUE ), m_hMapping( NULL ), m_View( NULL ), m_Size( 0 ) { }
 
-    tinyxml2::XMLDocument XmlDoc;
+    ~CMappedProjectFile( )
+    {
+        if (m_View != NULL)
+            UnmapViewOfFile( m_View );
+        if (m_hMapping != NULL)
+            CloseHandle( m_hMapping );
+        if (m_hFile != INVALID_HANDLE_VALUE)
+            CloseHandle( m_hFile );
+    }
+
+    BOOLEAN Open( LPCTSTR FileName )
+    {
+        LARGE_INTEGER FileSize;
+
+        m_hFile = CreateFile( FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+        if (m_hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( m_hFile, &FileSize ) || FileSize.QuadPart <= 0)
+            return FALSE;
+
+        m_hMapping = CreateFileMapping( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+        if (m_hMapping == NULL)
+            return FALSE;
+
+        m_View = MapViewOfFile( m_hMapping, FILE_MAP_READ, 0, 0, 0 );
+        m_Size = (size_t)FileSize.QuadPart;
+        return (m_View != NULL) ? TRUE : FALSE;
+    }
+
+    inline const void* Data( ) const { return m_View; }
+    inline size_t Size( ) const { return m_Size; }
+
+private:
+    HANDLE m_hFile;
+    HANDLE m_hMapping;
+    LPVOID m_View;
+    size_t m_Size;
+};
+
+//
+// A .ntsb opened by LoadBinary. Its classes are created with only their own
+// fields and hold on to it until their nodes are first needed; Classes are
+// the classes the image's links resolve to.
+//
+class CProjectSource {
+public:
+    CMappedProjectFile File;
+    CProjectImage Image;
+    std::vector<CNodeClass*> Classes;
+};
+
+static void DeleteClassNodes( CNodeClass* pClass )
+{
+    while (pClass->NodeCount( ) != 0)
+    {
+        CNodeBase* pNode = pClass->GetNode( pClass->NodeCount( ) - 1 );
+        for (UINT f = 0; f < pNode->NodeCount( ); f++)
+            delete pNode->GetNode( f );
+        pClass->DeleteNode( pClass->NodeCount( ) - 1 );
+    }
+}
+
+// Classes a failed load created, with their nodes
+static void DeleteLoadedClasses( std::vector<CNodeClass*>& Classes )
+{
+    for (CNodeClass* pClass : Classes)
+    {
+        DeleteClassNodes( pClass );
+        delete pClass;
+    }
+    Classes.clear( );
+}
 
+BOOLEAN CReClassExApp::LoadXML( LPCTSTR FileName )
+{
     #ifdef UNICODE
     #define _CA2W(psz) CA2W(psz)
     #else
     #define _CA2W(psz) (psz)
     #endif
 
-    FILE* fp = NULL;
-    #ifdef UNICODE
-    _wfopen_s( &fp, pathName, L"rb" );
-    #else
-    fopen_s( &fp, pathName, "rb" );
-    #endif
-    XMLError ret = XmlDoc.LoadFile( fp );
-    fclose( fp );
+    CMappedProjectFile File;
+    if (!File.Open( FileName ))
+        return FALSE;
 
-    if (ret != XML_SUCCESS)
-        return;
+    //
+    // Read tag by tag straight out of the mapping instead of through a
+    // tinyxml2 DOM, which held the file several times over. Nodes are created
+    // as their tags come by. Links can name classes further down the file, so
+    // they are resolved at the end against a name lookup.
+    //
+    //  <Nothin>                                    depth 1
+    //    <Header/Footer/Notes Text=""/>            2
+    //    <Class Name="">                           2
+    //      <Node Type="">                          3
+    //        <Array Type="" Name=""/>              4, first child of an array
+    //        <Function>                            4, vtable entries
+    //          <Code Assembly=""/>                 5
+    //
+    CXmlPullReader Reader( (const char*)File.Data( ), File.Size( ) );
+    CXmlPullReader::Token Token;
+
+    std::vector<CNodeClass*> Classes;
+    std::unordered_map<std::string, CNodeClass*> ClassNames;
+    std::vector<std::pair<std::string, CNodeBase*>> Links;
+
+    CNodeClass* pClass = NULL;
+    CNodeBase* pNode = NULL;
+    CNodeFunctionPtr* pFunctionPtr = NULL;
+    BOOLEAN bRoot = FALSE;
+    BOOLEAN bArrayElement = FALSE;
+    BOOLEAN bHeader = FALSE, bFooter = FALSE, bNotes = FALSE;
+
+    auto Attribute = [&Reader] ( const char* Name ) {
+        const char* Value = Reader.GetAttribute( Name );
+        return (Value != NULL) ? Value : "";
+    };
+
+    // Like tinyxml2's QueryIntAttribute, Default if missing or not a number
+    auto IntAttribute = [&Reader] ( const char* Name, int Default ) {
+        const char* Value = Reader.GetAttribute( Name );
+        int Result = Default;
+        if (Value != NULL)
+            sscanf_s( Value, "%d", &Result );
+        return Result;
+    };
+
+    while ((Token = Reader.Next( )) == CXmlPullReader::XML_START || Token == CXmlPullReader::XML_END)
+    {
+        uint32_t Depth = Reader.GetDepth( );
+        const char* Name = Reader.GetName( );
 
-    m_strCurrentFilePath = pathName;
+        if (Token == CXmlPullReader::XML_END)
+        {
+            if (Depth == 2)
+                pClass = NULL;
+            else if (Depth == 3)
+                pNode = NULL;
+            else if (Depth == 4)
+                pFunctionPtr = NULL;
+            continue;
+        }
 
-    XMLHandle hDoc( &XmlDoc );
-    XMLHandle hRoot( 0 );
-    XMLElement* XmlCurrentElement;
-    typedef std::pair<CString, CNodeBase*> Link;
-    std::vector<Link> links;
+        if (Depth == 1)
+        {
+            if (_stricmp( Name, "Nothin" ) != 0) // The root element value is 'Nothin'
+                break; // Not a Reclass file
+            bRoot = TRUE;
+        }
+        else if (Depth == 2)
+        {
+            if (!bHeader && strcmp( Name, "Header" ) == 0)
+            {
+                m_strHeader.SetString( _CA2W( Attribute( "Text" ) ) );
+                bHeader = TRUE;
+            }
+            else if (!bFooter && strcmp( Name, "Footer" ) == 0)
+            {
+                m_strFooter.SetString( _CA2W( Attribute( "Text" ) ) );
+                bFooter = TRUE;
+            }
+            else if (!bNotes && strcmp( Name, "Notes" ) == 0)
+            {
+                m_strNotes.SetString( _CA2W( Attribute( "Text" ) ) );
+                bNotes = TRUE;
+            }
+            else if (strcmp( Name, "Class" ) == 0)
+            {
+                pClass = new CNodeClass;
+                pClass->SetName( _CA2W( Attribute( "Name" ) ) );
+                pClass->SetComment( _CA2W( Attribute( "Comment" ) ) );
+                pClass->SetOffset( atoi( Attribute( "Offset" ) ) );
+                pClass->SetOffsetString( _CA2W( Attribute( "strOffset" ) ) );
+                pClass->SetCodeString( _CA2W( Attribute( "Code" ) ) );
+
+                if (pClass->GetOffsetString( ) == "")
+                    pClass->SetOffsetString( _CA2W( Attribute( "Offset" ) ) );
+
+                // A later class with the same name takes over its links
+                ClassNames[Attribute( "Name" )] = pClass;
+                Classes.push_back( pClass );
+            }
+        }
+        else if (Depth == 3 && pClass != NULL)
+        {
+            int Type = IntAttribute( "Type", nt_none );
 
-    XmlCurrentElement = hDoc.FirstChildElement( ).ToElement( );
-    if (!XmlCurrentElement)
-        return;
+            pNode = (Type != nt_none) ? CreateNewNode( (NodeType)Type ) : NULL;
+            bArrayElement = FALSE;
+            if (pNode == NULL)
+                continue;
 
-    const char* v = XmlCurrentElement->Value( );
+            pNode->SetName( _CA2W( Attribute( "Name" ) ) );
+            pNode->SetComment( _CA2W( Attribute( "Comment" ) ) );
+            pNode->SetHidden( atoi( Attribute( "bHidden" ) ) > 0 ? true : false );
+            pNode->SetParent( pClass );
+            pClass->AddNode( pNode );
 
-    if (_stricmp( v, "Nothin" ) != 0) // The root element value is 'Nothin'
-        return; // Not a Reclass file
+            int Size = IntAttribute( "Size", -1 );
 
-    hRoot = XMLHandle( XmlCurrentElement );
+            if (Type == nt_custom)
+            {
+                static_cast<CNodeCustom*>(pNode)->SetSize( Size );
+            }
+            else if (Type == nt_text)
+            {
+                static_cast<CNodeText*>(pNode)->SetSize( Size );
+            }
+            else if (Type == nt_unicode)
+            {
+                static_cast<CNodeUnicode*>(pNode)->SetSize( Size );
+            }
+            else if (Type == nt_function)
+            {
+                static_cast<CNodeFunction*>(pNode)->SetSize( Size );
+            }
+            else if (Type == nt_array)
+            {
+                static_cast<CNodeArray*>(pNode)->SetTotal( (DWORD)atoi( Attribute( "Total" ) ) );
+            }
+            else if (Type == nt_ptrarray)
+            {
+                static_cast<CNodePtrArray*>(pNode)->SetCount( (size_t)atoi( Attribute( "Count" ) ) );
+            }
+            else if (Type == nt_pointer)
+            {
+                Links.emplace_back( Attribute( "Pointer" ), pNode );
+            }
+            else if (Type == nt_instance)
+            {
+                Links.emplace_back( Attribute( "Instance" ), pNode );
+            }
+        }
+        else if (Depth == 4 && pNode != NULL)
+        {
+            NodeType Type = pNode->GetType( );
 
-    XmlCurrentElement = hRoot.FirstChildElement( "Header" ).ToElement( );
-    if (XmlCurrentElement)
-    {
-        m_strHeader.SetString( _CA2W( XmlCurrentElement->Attribute( "Text" ) ) );
-    }
+            if (Type == nt_vtable)
+            {
+                CNodeVTable* VMTNode = static_cast<CNodeVTable*>(pNode);
 
-    XmlCurrentElement = hRoot.FirstChildElement( "Footer" ).ToElement( );
-    if (XmlCurrentElement)
-    {
-        m_strFooter.SetString( _CA2W( XmlCurrentElement->Attribute( "Text" ) ) );
+                VMTNode->Initialize( GetMainFrame( ) );
+
+                pFunctionPtr = new CNodeFunctionPtr;
+                pFunctionPtr->SetName( _CA2W( Attribute( "Name" ) ) );
+                pFunctionPtr->SetComment( _CA2W( Attribute( "Comment" ) ) );
+                pFunctionPtr->SetHidden( atoi( Attribute( "bHidden" ) ) > 0 ? true : false );
+                pFunctionPtr->SetParent( VMTNode );
+
+                VMTNode->AddNode( pFunctionPtr );
+            }
+            else if ((Type == nt_array || Type == nt_ptrarray) && !bArrayElement)
+            {
+                //<Node Name="N4823" Type="23" Size="64" bHidden="0" Comment="" Total="1">
+                //<Array Name="N12DB" Type="24" Size="64" Comment="" />
+                bArrayElement = TRUE;
+                if (IntAttribute( "Type", nt_none ) == nt_class)
+                    Links.emplace_back( Attribute( "Name" ), pNode );
+                // TODO: Handle other type of arrays....
+            }
+        }
+        else if (Depth == 5 && pFunctionPtr != NULL)
+        {
+            pFunctionPtr->m_Assembly.push_back( CStringA( Attribute( "Assembly" ) ) );
+        }
     }
 
-    XmlCurrentElement = hRoot.FirstChildElement( "Notes" ).ToElement( );
-    if (XmlCurrentElement)
+    if (Token != CXmlPullReader::XML_DONE || !bRoot)
     {
-        m_strNotes.SetString( _CA2W( XmlCurrentElement->Attribute( "Text" ) ) );
+        if (Token == CXmlPullReader::XML_ERROR)
+            PrintOut( _T( "Failed to load \"%s\", XML error on line %u" ), FileName, Reader.GetErrorLine( ) );
+
+        DeleteLoadedClasses( Classes );
+        m_strHeader = _T( "" );
+        m_strFooter = _T( "" );
+        m_strNotes = _T( "" );
+        return FALSE;
     }
 
-    XmlCurrentElement = hRoot.FirstChildElement( "Class" ).ToElement( );
-    while (XmlCurrentElement)
+    for (auto& Link : Links)
     {
-        CNodeClass* pClass = new CNodeClass;
-        pClass->SetName( _CA2W( XmlCurrentElement->Attribute( "Name" ) ) );
-        pClass->SetComment( _CA2W( XmlCurrentElement->Attribute( "Comment" ) ) );
-        pClass->SetOffset( atoi( XmlCurrentElement->Attribute( "Offset" ) ) );
-        pClass->SetOffsetString( _CA2W( XmlCurrentElement->Attribute( "strOffset" ) ) );
-        pClass->SetCodeString( _CA2W( XmlCurrentElement->Attribute( "Code" ) ) );
-
-        if (pClass->GetOffsetString( ) == "")
-            pClass->SetOffsetString( _CA2W( XmlCurrentElement->Attribute( "Offset" ) ) );
-
-        XMLElement* XmlClassElement = XmlCurrentElement->FirstChildElement( );
-        while (XmlClassElement)
+        auto Found = ClassNames.find( Link.first );
+        if (Found == ClassNames.end( ))
+            continue;
+
+        NodeType Type = Link.second->GetType( );
+        if (Type == nt_pointer)
+        {
+            static_cast<CNodePtr*>(Link.second)->SetClass( Found->second );
+        }
+        else if (Type == nt_instance)
+        {
+            static_cast<CNodeClassInstance*>(Link.second)->SetClass( Found->second );
+        }
+        else if (Type == nt_array)
+        {
+            static_cast<CNodeArray*>(Link.second)->SetClass( Found->second );
+        }
+        else if (Type == nt_ptrarray)
         {
-            int Type = nt_none;
-            XmlClassElement->QueryIntAttribute( "Type", &Type );
+            static_cast<CNodePtrArray*>(Link.second)->SetClass( Found->second );
+        }
+    }
 
-            if (Type != nt_none)
-            {
-                CNodeBase* pNode = CreateNewNode( (NodeType)Type );
-                int Size = -1;
-                
-                pNode->SetName( _CA2W( XmlClassElement->Attribute( "Name" ) ) );
-                pNode->SetComment( _CA2W( XmlClassElement->Attribute( "Comment" ) ) );
-                pNode->SetHidden( atoi( XmlClassElement->Attribute( "bHidden" ) ) > 0 ? true : false );
-                pNode->SetParent( pClass );
-                pClass->AddNode( pNode );
-
-                XmlClassElement->QueryIntAttribute( "Size", &Size );
-
-                if (Type == nt_custom)
-                {
-                    static_cast<CNodeCustom*>(pNode)->SetSize( Size );
-                }
-                else if (Type == nt_text)
-                {
-                    static_cast<CNodeText*>(pNode)->SetSize( Size );
-                }
-                else if (Type == nt_unicode)
-                {
-                    static_cast<CNodeUnicode*>(pNode)->SetSize( Size );
-                }
-                else if (Type == nt_function)
-                {
-                    static_cast<CNodeFunction*>(pNode)->SetSize( Size );
-                }
-                else if (Type == nt_vtable)
-                {
-                    XMLElement* XmlVTableFunctionPtrElement = XmlClassElement->FirstChildElement( );
-                    while (XmlVTableFunctionPtrElement)
-                    {
-                        CNodeVTable* VMTNode = static_cast<CNodeVTable*>(pNode);
-                        CNodeFunctionPtr* FunctionPtrNode;
+    m_Classes.insert( m_Classes.end( ), Classes.begin( ), Classes.end( ) );
+    m_strCurrentFilePath = FileName;
 
-                        VMTNode->Initialize( GetMainFrame( ) );
+    CalcAllOffsets( );
+    return TRUE;
+}
 
-                        FunctionPtrNode = new CNodeFunctionPtr;
-                        FunctionPtrNode->SetName( _CA2W( XmlVTableFunctionPtrElement->Attribute( "Name" ) ) );
-                        FunctionPtrNode->SetComment( _CA2W( XmlVTableFunctionPtrElement->Attribute( "Comment" ) ) );
-                        FunctionPtrNode->SetHidden( atoi( XmlVTableFunctionPtrElement->Attribute( "bHidden" ) ) > 0 ? true : false );
-                        FunctionPtrNode->SetParent( VMTNode );
+static uint32_t AddProjectString( CProjectWriter& Writer, const CString& String )
+{
+    if (String.IsEmpty( ))
+        return PROJECT_NO_STRING;
 
-                        VMTNode->AddNode( FunctionPtrNode );
+    CW2A Utf8( CT2W( String ), CP_UTF8 );
+    return Writer.AddString( Utf8 );
+}
 
-                        XMLElement* XmlCodeElement = XmlVTableFunctionPtrElement->FirstChildElement( );
-                        while (XmlCodeElement)
-                        {
-                            CStringA AssemblyString = XmlCodeElement->Attribute( "Assembly" );
-                            FunctionPtrNode->m_Assembly.push_back( AssemblyString );
-                            XmlCodeElement = XmlCodeElement->NextSiblingElement( );
-                        }
+static CString GetProjectString( const CProjectImage& Image, uint32_t Id )
+{
+    return CString( CA2W( Image.GetString( Id ), CP_UTF8 ) );
+}
 
-                        XmlVTableFunctionPtrElement = XmlVTableFunctionPtrElement->NextSiblingElement( );
-                    }
-                }
-                else if (Type == nt_array)
-                {
-                    //<Node Name="N4823" Type="23" Size="64" bHidden="0" Comment="" Total="1">
-                    //<Array Name="N12DB" Type="24" Size="64" Comment="" />
-                    CNodeArray* pArray = (CNodeArray*)pNode;
-                    pArray->SetTotal( (DWORD)atoi( XmlClassElement->Attribute( "Total" ) ) );
 
-                    XMLElement* XmlArrayElement = XmlClassElement->FirstChildElement( );
-                    if (XmlArrayElement)
-                    {
-                        CString Name = _CA2W( XmlArrayElement->Attribute( "Name" ) );
-                        CString Comment = _CA2W( XmlArrayElement->Attribute( "Comment" ) );
-                        int ArrayType = nt_none;
-                        int ArraySize = 0;
-
-                        XmlArrayElement->QueryIntAttribute( "Type", &ArrayType );
-                        XmlClassElement->QueryIntAttribute( "Size", &ArraySize );
-
-                        if (ArrayType == nt_class)
-                        {
-                            links.push_back( Link( Name, pNode ) );
-                        }
-                        // TODO: Handle other type of arrays....
-                    }
-                }
-                else if ( Type == nt_ptrarray )
-                {
-                    CNodePtrArray* pArray = (CNodePtrArray*) pNode;
-                    pArray->SetCount( (size_t)atoi( XmlClassElement->Attribute( "Count" ) ) );
+static uint32_t ProjectClassIndex( const ProjectClassIndices& ClassIndices, const CNodeBase* pClass )
+{
+    auto Found = ClassIndices.find( pClass );
+    return (Found != ClassIndices.end( )) ? Found->second : PROJECT_NO_CLASS;
+}
 
-                    XMLElement* XmlArrayElement = XmlClassElement->FirstChildElement( );
-                    if (XmlArrayElement)
-                    {
-                        CString Name = _CA2W( XmlArrayElement->Attribute( "Name" ) );
-                        CString Comment = _CA2W( XmlArrayElement->Attribute( "Comment" ) );
-                        int ArrayType = nt_none;
-                        int ArraySize = 0;
-
-                        XmlArrayElement->QueryIntAttribute( "Type", &ArrayType );
-                        XmlClassElement->QueryIntAttribute( "Size", &ArraySize );
-
-                        if (ArrayType == nt_class) 
-                        {
-                            links.push_back( Link( Name, pNode ) );
-                        }
-                    }
-                }
-                else if (Type == nt_pointer)
-                {
-                    CString PointerString = _CA2W( XmlClassElement->Attribute( "Pointer" ) );
-                    links.push_back( Link( PointerString, pNode ) );
-                }
-                else if (Type == nt_instance)
-                {
-                    CString strInstance = _CA2W( XmlClassElement->Attribute( "Instance" ) );
-                    links.push_back( Link( strInstance, pNode ) );
-                }
-            }
+static uint32_t CopyProjectString( CProjectWriter& Writer, const CProjectImage& Image, uint32_t Id )
+{
+    uint32_t Length;
+    if (Id == PROJECT_NO_STRING)
+        return PROJECT_NO_STRING;
 
-            XmlClassElement = XmlClassElement->NextSiblingElement( );
-        }
+    const char* String = Image.GetString( Id, &Length );
+    return Writer.AddString( String, Length );
+}
 
-        m_Classes.push_back( pClass );
+//
+// The nodes of a class that is still pending, copied record for record from
+// the file it was opened from instead of materializing it. Strings and links
+// are renumbered for the project being written.
+//
+static void CopyPendingNodes( CProjectWriter& Writer, const CProjectSource& Source, uint32_t Index, PROJECT_BINARY_CLASS& Class, const ProjectClassIndices& ClassIndices )
+{
+    const CProjectImage& Image = Source.Image;
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Index );
 
-        XmlCurrentElement = XmlCurrentElement->NextSiblingElement( "Class" );
-    }
+    auto LinkedClass = [&] ( uint32_t ClassIndex ) {
+        return (ClassIndex != PROJECT_NO_CLASS) ? ProjectClassIndex( ClassIndices, Source.Classes[ClassIndex] ) : PROJECT_NO_CLASS;
+    };
 
-    //Fix Links... very ghetto this whole thing is just fucked
-    for (auto it = links.begin( ); it != links.end( ); it++)
+    Class.NodeCount = Record.NodeCount;
+    Class.FirstNode = Writer.ReserveNodes( Class.NodeCount );
+
+    for (uint32_t n = 0; n < Record.NodeCount; n++)
     {
-        for (size_t i = 0; i < m_Classes.size( ); i++)
+        PROJECT_BINARY_NODE Node = Image.GetNode( Record.FirstNode + n );
+        uint32_t FirstFunction = Node.FirstChild;
+
+        Node.Name = CopyProjectString( Writer, Image, Node.Name );
+        Node.Comment = CopyProjectString( Writer, Image, Node.Comment );
+        Node.Class = LinkedClass( Node.Class );
+
+        // Reserving children moves the node table, only hold on to the index
+        if (Node.ChildCount != 0)
+            Node.FirstChild = Writer.ReserveNodes( Node.ChildCount );
+        Writer.GetNode( Class.FirstNode + n ) = Node;
+
+        for (uint32_t f = 0; f < Node.ChildCount; f++)
         {
-            if (it->first == m_Classes[i]->GetName( ))
+            PROJECT_BINARY_NODE Function = Image.GetNode( FirstFunction + f );
+            uint32_t FirstLine = Function.FirstLine;
+
+            Function.Name = CopyProjectString( Writer, Image, Function.Name );
+            Function.Comment = CopyProjectString( Writer, Image, Function.Comment );
+            for (uint32_t l = 0; l < Function.LineCount; l++)
             {
-                NodeType Type = it->second->GetType( );
-                if (Type == nt_pointer)
-                {
-                    static_cast<CNodePtr*>(it->second)->SetClass( m_Classes[i] );
-                }
-                else if (Type == nt_instance)
-                {
-                    static_cast<CNodeClassInstance*>(it->second)->SetClass( m_Classes[i] );
-                }
-                else if (Type == nt_array)
-                {
-                    static_cast<CNodeArray*>(it->second)->SetClass( m_Classes[i] );
-                }
-                else if ( Type == nt_ptrarray )
-                {
-                    static_cast<CNodePtrArray*>(it->second)->SetClass( m_Classes[i] );
-                }
+                uint32_t LineIndex = Writer.AddLine( CopyProjectString( Writer, Image, Image.GetLine( FirstLine + l ) ) );
+                if (l == 0)
+                    Function.FirstLine = LineIndex;
             }
+            Writer.GetNode( Node.FirstChild + f ) = Function;
         }
     }
-
-    CalcAllOffsets( );
 }
 
-void CReClassExApp::OnButtonGenerate( )
+// pClass and its nodes, links as indices into the project's classes
+static void AddProjectClass( CProjectWriter& Writer, CNodeClass* pClass, const ProjectClassIndices& ClassIndices )
 {
-    CString strGeneratedText, t;
-    strGeneratedText += _T( "// Generated using ReClassEx\r\n\r\n" );
-
-    if (!m_strHeader.IsEmpty( ))
-        strGeneratedText += m_strHeader + _T( "\r\n\r\n" );
-    std::set<const CNodeClass*>  forwardDeclarations; 
-    std::vector<const CNodeClass*>  orderedClassDefinitions;
-    ClassDependencyGraph            depGraph;
-    // Add each class as a node to the graph before adding dependency edges
-    for (auto cNode : this->m_Classes) {
-        depGraph.AddNode(cNode);
+    PROJECT_BINARY_CLASS Class;
+    uint32_t SourceIndex;
+
+    Class.Name = AddProjectString( Writer, pClass->GetName( ) );
+    Class.Comment = AddProjectString( Writer, pClass->GetComment( ) );
+    Class.OffsetString = AddProjectString( Writer, pClass->GetOffsetString( ) );
+    Class.Code = AddProjectString( Writer, pClass->m_Code );
+    Class.Offset = pClass->GetOffset( );
+
+    // Saving and the autosave snapshot don't materialize what nobody looked at
+    if (pClass->IsPending( ))
+    {
+        const CProjectSource* pSource = pClass->GetSource( &SourceIndex );
+        CopyPendingNodes( Writer, *pSource, SourceIndex, Class, ClassIndices );
+        Writer.AddClass( Class );
+        return;
     }
-    for (auto cNode : this->m_Classes) {
-        for (size_t n = 0; n < cNode->NodeCount(); n++)
+
+    Class.NodeCount = (uint32_t)pClass->NodeCount( );
+    Class.FirstNode = Writer.ReserveNodes( Class.NodeCount );
+
+    for (UINT n = 0; n < pClass->NodeCount( ); n++)
+    {
+        CNodeBase* pNode = pClass->GetNode( n );
+        uint32_t Index = Class.FirstNode + n;
+
+        if (!pNode)
         {
-            CNodeBase* pNode = (CNodeBase*)cNode->GetNode(n);
-            NodeType Type = pNode->GetType();
-            switch (Type) {
-            case(nt_pointer):
-            {
-                CNodePtr* pPointer = (CNodePtr*)pNode;
-                CNodeClass* pointerClass = pPointer->GetClass();
-                depGraph.AddEdge(cNode, pointerClass, DependencyType::POINTER);
-                break;
-            }
-            case(nt_instance):
-            {
-                CNodeClassInstance* pClassInstance = (CNodeClassInstance*)pNode;
-                CNodeClass* instanceClass = pClassInstance->GetClass();
-                depGraph.AddEdge(cNode, instanceClass, DependencyType::INSTANCE);
-                break;
-            }
+            Writer.GetNode( Index ).Type = nt_none;
+            continue;
+        }
 
-            case(nt_array):
-            {
-                CNodeArray* pArray = (CNodeArray*)pNode;
-                CNodeClass* instanceClass = pArray->GetClass();
-                depGraph.AddEdge(cNode, instanceClass, DependencyType::INSTANCE);
-                break;
-            }
+        // Reserving children moves the node table, only hold on to the index
+        Writer.GetNode( Index ).Type = pNode->GetType( );
+        Writer.GetNode( Index ).Flags = pNode->IsHidden( ) ? PROJECT_NODE_HIDDEN : 0;
+        Writer.GetNode( Index ).Name = AddProjectString( Writer, pNode->GetName( ) );
+        Writer.GetNode( Index ).Comment = AddProjectString( Writer, pNode->GetComment( ) );
+        Writer.GetNode( Index ).Size = pNode->GetMemorySize( );
 
-            case(nt_ptrarray):
+        switch (pNode->GetType( ))
+        {
+        case nt_array:
+            Writer.GetNode( Index ).Count = ((CNodeArray*)pNode)->GetTotal( );
+            Writer.GetNode( Index ).Class = ProjectClassIndex( ClassIndices, ((CNodeArray*)pNode)->GetClass( ) );
+            break;
+        case nt_ptrarray:
+            Writer.GetNode( Index ).Count = (uint32_t)((CNodePtrArray*)pNode)->Count( );
+            Writer.GetNode( Index ).Class = ProjectClassIndex( ClassIndices, ((CNodePtrArray*)pNode)->GetClass( ) );
+            break;
+        case nt_pointer:
+            Writer.GetNode( Index ).Class = ProjectClassIndex( ClassIndices, ((CNodePtr*)pNode)->GetClass( ) );
+            break;
+        case nt_instance:
+            Writer.GetNode( Index ).Class = ProjectClassIndex( ClassIndices, ((CNodeClassInstance*)pNode)->GetClass( ) );
+            break;
+        case nt_vtable:
+        {
+            uint32_t FirstChild = Writer.ReserveNodes( (uint32_t)pNode->NodeCount( ) );
+            Writer.GetNode( Index ).FirstChild = FirstChild;
+            Writer.GetNode( Index ).ChildCount = (uint32_t)pNode->NodeCount( );
+
+            for (UINT f = 0; f < pNode->NodeCount( ); f++)
             {
-                CNodePtrArray* pArray = (CNodePtrArray*)pNode;
-                CNodeClass* pointerClass = pArray->GetClass();
-                depGraph.AddEdge(cNode, pointerClass, DependencyType::POINTER);
-                break;
-            }
+                CNodeFunctionPtr* pFunctionPtr = (CNodeFunctionPtr*)pNode->GetNode( f );
+                PROJECT_BINARY_NODE& Function = Writer.GetNode( FirstChild + f );
+
+                Function.Type = pFunctionPtr->GetType( );
+                Function.Flags = pFunctionPtr->IsHidden( ) ? PROJECT_NODE_HIDDEN : 0;
+                Function.Name = AddProjectString( Writer, pFunctionPtr->GetName( ) );
+                Function.Comment = AddProjectString( Writer, pFunctionPtr->GetComment( ) );
+                Function.LineCount = (uint32_t)pFunctionPtr->m_Assembly.size( );
+                for (UINT as = 0; as < pFunctionPtr->m_Assembly.size( ); as++)
+                {
+                    const CStringA& Line = pFunctionPtr->m_Assembly[as];
+                    uint32_t LineIndex = Writer.AddLine( Writer.AddString( Line.GetString( ), Line.GetLength( ) ) );
+                    if (as == 0)
+                        Function.FirstLine = LineIndex;
+                }
             }
+            break;
+        }
+        default:
+            break;
         }
     }
 
-    depGraph.OrderClassesForGeneration(forwardDeclarations, orderedClassDefinitions);
-    ASSERT(orderedClassDefinitions.size() == m_Classes.size());
-    for (auto forwardDeclared : forwardDeclarations)
-    {
-        CNodeClass* pClass = (CNodeClass*)forwardDeclared;
-        t.Format( _T( "class %s;\r\n" ), pClass->GetName( ) );
-        strGeneratedText += t;
-    }
+    Writer.AddClass( Class );
+}
+
+void CReClassExApp::GetClassIndices( ProjectClassIndices& ClassIndices )
+{
+    ClassIndices.clear( );
+    for (UINT i = 0; i < m_Classes.size( ); i++)
+        ClassIndices[m_Classes[i]] = i;
+}
+
+void CReClassExApp::BuildProjectImage( std::vector<uint8_t>& Image )
+{
+    CProjectWriter Writer;
+    ProjectClassIndices ClassIndices;
+    const CString* Typedefs[PROJECT_TYPEDEF_COUNT] = {
+        &g_Typedefs.Hex, &g_Typedefs.Int64, &g_Typedefs.Int32, &g_Typedefs.Int16, &g_Typedefs.Int8,
+        &g_Typedefs.Qword, &g_Typedefs.Dword, &g_Typedefs.Word, &g_Typedefs.Byte,
+        &g_Typedefs.Float, &g_Typedefs.Double, &g_Typedefs.Vec2, &g_Typedefs.Vec3, &g_Typedefs.Quat,
+        &g_Typedefs.Matrix, &g_Typedefs.PChar, &g_Typedefs.PWChar
+    };
+
+    GetClassIndices( ClassIndices );
+
+    PROJECT_BINARY_HEADER& Header = Writer.GetHeader( );
+    Header.Header = AddProjectString( Writer, m_strHeader );
+    Header.Footer = AddProjectString( Writer, m_strFooter );
+    Header.Notes = AddProjectString( Writer, m_strNotes );
+
+    // Stored like the .nts TypeDef element, opening a project doesn't apply them
+    for (UINT i = 0; i < PROJECT_TYPEDEF_COUNT; i++)
+        Header.Typedefs[i] = AddProjectString( Writer, *Typedefs[i] );
 
-    strGeneratedText += _T( "\r\n" );
+    for (UINT i = 0; i < m_Classes.size( ); i++)
+        AddProjectClass( Writer, m_Classes[i], ClassIndices );
+
+    Writer.Finish( Image );
+}
+
+void CReClassExApp::BuildClassImage( CNodeClass* pClass, const ProjectClassIndices& ClassIndices, std::vector<uint8_t>& Image )
+{
+    CProjectWriter Writer;
+    AddProjectClass( Writer, pClass, ClassIndices );
+    Writer.Finish( Image );
+}
+
+BOOLEAN CReClassExApp::SaveBinary( LPCTSTR FileName )
+{
+    std::vector<uint8_t> Image;
 
-    std::vector<CString> vfun;
-    std::vector<CString> var;
+    PrintOutDbg( _T( "SaveBinary(\"%s\") called" ), FileName );
 
-    CString ClassName;
+    BuildProjectImage( Image );
 
-    for (auto constantClass : orderedClassDefinitions)
+    FILE* fp = NULL;
+    _tfopen_s( &fp, FileName, _T( "wb" ) );
+    size_t Written = (fp != NULL) ? fwrite( Image.data( ), 1, Image.size( ), fp ) : 0;
+    if (fp != NULL)
+        fclose( fp );
+
+    if (Written != Image.size( ))
     {
-        CNodeClass* pClass = (CNodeClass*)constantClass;
+        PrintOut( _T( "Failed to save file to \"%s\"" ), FileName );
+        return FALSE;
+    }
 
-        CalcOffsets( pClass );
+    PrintOut( _T( "NothinToSee binary project saved successfully to \"%s\"" ), FileName );
+    return TRUE;
+}
 
-        vfun.clear( );
-        var.clear( );
+// The class's own fields from the image's class Index
+static void LoadProjectClassFields( const CProjectImage& Image, uint32_t Index, CNodeClass* pClass )
+{
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Index );
 
-        ClassName.Format( _T( "class %s" ), pClass->GetName( ) );
+    pClass->SetName( GetProjectString( Image, Record.Name ) );
+    pClass->SetComment( GetProjectString( Image, Record.Comment ) );
+    pClass->SetOffset( (size_t)Record.Offset );
+    pClass->SetOffsetString( GetProjectString( Image, Record.OffsetString ) );
+    pClass->SetCodeString( GetProjectString( Image, Record.Code ) );
+}
+
+// Adds the nodes of the image's class Index to pClass, links resolve into Classes
+static void LoadProjectNodes( const CProjectImage& Image, uint32_t Index, CNodeClass* pClass, const std::vector<CNodeClass*>& Classes )
+{
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Index );
 
-        int fill = 0;
-        int fillStart = 0;
+    auto LinkedClass = [&Classes] ( uint32_t ClassIndex ) { return (ClassIndex != PROJECT_NO_CLASS) ? Classes[ClassIndex] : NULL; };
 
-        for (size_t n = 0; n < pClass->NodeCount( ); n++)
+    for (uint32_t n = Record.FirstNode; n < Record.FirstNode + Record.NodeCount; n++)
+    {
+        const PROJECT_BINARY_NODE& NodeRecord = Image.GetNode( n );
+        CNodeBase* pNode = (NodeRecord.Type != nt_none) ? g_ReClassApp.CreateNewNode( (NodeType)NodeRecord.Type ) : NULL;
+        if (pNode == NULL)
+            continue;
+
+        pNode->SetName( GetProjectString( Image, NodeRecord.Name ) );
+        pNode->SetComment( GetProjectString( Image, NodeRecord.Comment ) );
+        pNode->SetHidden( (NodeRecord.Flags & PROJECT_NODE_HIDDEN) != 0 );
+        pNode->SetParent( pClass );
+        pClass->AddNode( pNode );
+
+        switch (NodeRecord.Type)
         {
-            CNodeBase* pNode = (CNodeBase*)pClass->GetNode( n );
-            NodeType Type = pNode->GetType( );
+        case nt_custom:
+            static_cast<CNodeCustom*>(pNode)->SetSize( NodeRecord.Size );
+            break;
+        case nt_text:
+            static_cast<CNodeText*>(pNode)->SetSize( NodeRecord.Size );
+            break;
+        case nt_unicode:
+            static_cast<CNodeUnicode*>(pNode)->SetSize( NodeRecord.Size );
+            break;
+        case nt_function:
+            static_cast<CNodeFunction*>(pNode)->SetSize( NodeRecord.Size );
+            break;
+        case nt_array:
+            static_cast<CNodeArray*>(pNode)->SetTotal( NodeRecord.Count );
+            if (NodeRecord.Class != PROJECT_NO_CLASS)
+                static_cast<CNodeArray*>(pNode)->SetClass( LinkedClass( NodeRecord.Class ) );
+            break;
+        case nt_ptrarray:
+            static_cast<CNodePtrArray*>(pNode)->SetCount( NodeRecord.Count );
+            if (NodeRecord.Class != PROJECT_NO_CLASS)
+                static_cast<CNodePtrArray*>(pNode)->SetClass( LinkedClass( NodeRecord.Class ) );
+            break;
+        case nt_pointer:
+            if (NodeRecord.Class != PROJECT_NO_CLASS)
+                static_cast<CNodePtr*>(pNode)->SetClass( LinkedClass( NodeRecord.Class ) );
+            break;
+        case nt_instance:
+            if (NodeRecord.Class != PROJECT_NO_CLASS)
+                static_cast<CNodeClassInstance*>(pNode)->SetClass( LinkedClass( NodeRecord.Class ) );
+            break;
+        case nt_vtable:
+        {
+            CNodeVTable* VMTNode = static_cast<CNodeVTable*>(pNode);
+            if (NodeRecord.ChildCount != 0)
+                VMTNode->Initialize( g_ReClassApp.GetMainFrame( ) );
 
-            if ((Type == nt_hex64) || (Type == nt_hex32) || (Type == nt_hex16) || (Type == nt_hex8))
+            for (uint32_t f = NodeRecord.FirstChild; f < NodeRecord.FirstChild + NodeRecord.ChildCount; f++)
             {
-                if (fill == 0)
-                    fillStart = (int)pNode->GetOffset( );
-                fill += pNode->GetMemorySize( );
+                const PROJECT_BINARY_NODE& FunctionRecord = Image.GetNode( f );
+                CNodeFunctionPtr* FunctionPtrNode = new CNodeFunctionPtr;
+
+                FunctionPtrNode->SetName( GetProjectString( Image, FunctionRecord.Name ) );
+                FunctionPtrNode->SetComment( GetProjectString( Image, FunctionRecord.Comment ) );
+                FunctionPtrNode->SetHidden( (FunctionRecord.Flags & PROJECT_NODE_HIDDEN) != 0 );
+                FunctionPtrNode->SetParent( VMTNode );
+                VMTNode->AddNode( FunctionPtrNode );
+
+                for (uint32_t l = FunctionRecord.FirstLine; l < FunctionRecord.FirstLine + FunctionRecord.LineCount; l++)
+                    FunctionPtrNode->m_Assembly.push_back( CStringA( Image.GetString( Image.GetLine( l ) ) ) );
             }
-            else
-            {
-                if (fill > 0)
-                {
-                    if (g_bPrivatePadding)
-                        t.Format( _T( "private:\r\n\t%s pad_0x%0.4X[0x%X]; //0x%0.4X\r\npublic:\r\n" ), g_Typedefs.Hex, fillStart, fill, fillStart );
-                    else
-                        t.Format( _T( "\t%s pad_0x%0.4X[0x%X]; //0x%0.4X\r\n" ), g_Typedefs.Hex, fillStart, fill, fillStart );
-                    var.push_back( t );
-                }
-                fill = 0;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
 
-                if (Type == nt_vtable)
-                {
-                    CNodeVTable* pVTable = (CNodeVTable*)pNode;
-                    for (size_t f = 0; f < pVTable->NodeCount( ); f++)
-                    {
-                        CString fn( pVTable->GetNode( f )->GetName( ) );
-                        if (fn.GetLength( ) == 0)
-                            fn.Format( _T( "void Function%i()" ), f );
-                        t.Format( _T( "\tvirtual %s; //%s\r\n" ), fn, pVTable->GetNode( f )->GetComment( ) );
-                        vfun.push_back( t );
-                    }
-                }
-                else if (Type == nt_int64)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Int64, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_int32)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Int32, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_int16)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Int16, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_int8)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Int8, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_uint64)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Qword, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_uint32)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Dword, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_uint16)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Word, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_uint8)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Byte, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
+// Fills pClass from the image's class Index, links resolve into Classes
+static void LoadProjectClass( const CProjectImage& Image, uint32_t Index, CNodeClass* pClass, const std::vector<CNodeClass*>& Classes )
+{
+    LoadProjectClassFields( Image, Index, pClass );
+    LoadProjectNodes( Image, Index, pClass, Classes );
+}
 
-                else if (Type == nt_vec2)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Vec2, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_vec3)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Vec3, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_quat)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Quat, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_matrix)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Matrix, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
+void MaterializeClass( CNodeBase* pNode )
+{
+    CNodeClass* pClass = static_cast<CNodeClass*>(pNode);
+    uint32_t Index;
+    pClass->GetSource( &Index );
+
+    // Not pending any more before the nodes go in, adding them would land here again
+    std::shared_ptr<CProjectSource> pSource = pClass->TakeSource( );
+    LoadProjectNodes( pSource->Image, Index, pClass, pSource->Classes );
+    g_ReClassApp.CalcOffsets( pClass );
+}
 
-                else if (Type == nt_pchar)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.PChar, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_pwchar)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.PWChar, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_text)
-                {
-                    CNodeText* pText = (CNodeText*)pNode;
-                    t.Format( _T( "\tchar %s[%i]; //0x%0.4X %s\r\n" ), pText->GetName( ), pText->GetMemorySize( ), pText->GetComment( ), pText->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_unicode)
-                {
-                    CNodeUnicode* pText = (CNodeUnicode*)pNode;
-                    t.Format( _T( "\twchar_t %s[%i]; //0x%0.4X %s\r\n" ), pText->GetName( ), pText->GetMemorySize( ) / sizeof( wchar_t ), pText->GetOffset( ), pText->GetComment( ) );
-                    var.push_back( t );
-                }
+void CReClassExApp::LoadProjectImage( const CProjectImage& Image, const std::shared_ptr<CProjectSource>& pSource )
+{
+    const PROJECT_BINARY_HEADER& Header = Image.GetHeader( );
+    std::vector<CNodeClass*> Classes( Image.GetClassCount( ) );
 
-                else if (Type == nt_float)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Float, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
-                else if (Type == nt_double)
-                {
-                    t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), g_Typedefs.Double, pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
+    m_strHeader = GetProjectString( Image, Header.Header );
+    m_strFooter = GetProjectString( Image, Header.Footer );
+    m_strNotes = GetProjectString( Image, Header.Notes );
 
-                else if (Type == nt_custom)
-                {
-                    t.Format( _T( "\t%s; //0x%0.4X %s\r\n" ), pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
+    // Every class exists before the nodes linking to them, links are plain indices
+    for (uint32_t i = 0; i < Image.GetClassCount( ); i++)
+        Classes[i] = new CNodeClass;
 
-                else if (Type == nt_functionptr)
-                {
-                    t.Format( _T( "\t%s; //0x%0.4X %s\r\n" ), pNode->GetName( ), pNode->GetOffset( ), pNode->GetComment( ) );
-                    var.push_back( t );
-                }
+    if (pSource)
+    {
+        // Nodes come in per class when first needed (MaterializeClass)
+        pSource->Classes = Classes;
+        for (uint32_t i = 0; i < Image.GetClassCount( ); i++)
+        {
+            LoadProjectClassFields( Image, i, Classes[i] );
+            Classes[i]->SetSource( pSource, i );
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < Image.GetClassCount( ); i++)
+            LoadProjectClass( Image, i, Classes[i], Classes );
+    }
 
-                else if (Type == nt_pointer)
-                {
-                    CNodePtr* pPointer = (CNodePtr*)pNode;
-                    t.Format( _T( "\t%s* %s; //0x%0.4X %s\r\n" ), pPointer->GetClass( )->GetName( ), pPointer->GetName( ), pPointer->GetOffset( ), pPointer->GetComment( ) );
-                    var.push_back( t );
-                }
+    m_Classes.insert( m_Classes.end( ), Classes.begin( ), Classes.end( ) );
+    CalcAllOffsets( );
+}
 
-                else if (Type == nt_instance)
-                {
-                    CNodeClassInstance* pClassInstance = (CNodeClassInstance*)pNode;
-                    if (pClassInstance->GetOffset( ) == 0)
-                    {
-                        t.Format( _T( " : public %s" ), pClassInstance->GetClass( )->GetName( ) ); // Inheritance
-                        ClassName += t;
-                    }
-                    else
-                    {
-                        t.Format( _T( "\t%s %s; //0x%0.4X %s\r\n" ), pClassInstance->GetClass( )->GetName( ), pClassInstance->GetName( ), pClassInstance->GetOffset( ), pClassInstance->GetComment( ) );
-                        var.push_back( t );
-                    }
-                }
+BOOLEAN CReClassExApp::LoadClassImage( UINT Index, const void* Data, size_t Size )
+{
+    CProjectImage Image;
 
-                else if (Type == nt_array)
-                {
-                    CNodeArray* pArray = (CNodeArray*)pNode;
-                    t.Format( _T( "\t%s %s[%i]; //0x%0.4X %s\r\n" ), pArray->GetClass( )->GetName( ), pArray->GetName( ), pArray->GetTotal( ), pArray->GetOffset( ), pArray->GetComment( ) );
-                    var.push_back( t );
-                }
+    //
+    // A class saved alone by BuildClassImage. The class is refilled in place,
+    // other classes' nodes keep pointing at it.
+    //
+    if (Index >= m_Classes.size( ) ||
+        !Image.Open( Data, Size, (uint32_t)m_Classes.size( ) ) ||
+        Image.GetClassCount( ) != 1)
+        return FALSE;
 
-                else if (Type == nt_ptrarray)
-                {
-                    CNodePtrArray* pArray = (CNodePtrArray*)pNode;
-                    t.Format( _T( "\t%s* %s[%i]; //0x%0.4X %s\r\n" ), pArray->GetClass( )->GetName( ), pArray->GetName( ), pArray->Count( ), pArray->GetOffset( ), pArray->GetComment( ) );
-                    var.push_back( t );
-                }
-            }
+    DeleteClassNodes( m_Classes[Index] );
+    LoadProjectClass( Image, 0, m_Classes[Index], m_Classes );
+    m_Classes[Index]->MarkEdited( );
+    return TRUE;
+}
+
+BOOLEAN CReClassExApp::LoadBinary( LPCTSTR FileName )
+{
+    std::shared_ptr<CProjectSource> pSource = std::make_shared<CProjectSource>( );
+
+    //
+    // Mapped instead of read: the records are used in place, only the pages
+    // the classes and strings live on are ever touched. The classes keep the
+    // mapping until they have all materialized.
+    //
+    if (!pSource->File.Open( FileName ) || !pSource->Image.Open( pSource->File.Data( ), pSource->File.Size( ) ))
+        return FALSE;
+
+    LoadProjectImage( pSource->Image, pSource );
+    m_strCurrentFilePath = FileName;
+    return TRUE;
+}
+
+static std::string GetGeneratedString( const CString& String )
+{
+    return std::string( CW2A( CT2W( String ), CP_UTF8 ) );
+}
+
+// Typedef a plain value node is generated with, NULL for everything else
+static const CString* GetGeneratedTypedef( NodeType Type )
+{
+    switch (Type)
+    {
+    case nt_int64:  return &g_Typedefs.Int64;
+    case nt_int32:  return &g_Typedefs.Int32;
+    case nt_int16:  return &g_Typedefs.Int16;
+    case nt_int8:   return &g_Typedefs.Int8;
+    case nt_uint64: return &g_Typedefs.Qword;
+    case nt_uint32: return &g_Typedefs.Dword;
+    case nt_uint16: return &g_Typedefs.Word;
+    case nt_uint8:  return &g_Typedefs.Byte;
+    case nt_vec2:   return &g_Typedefs.Vec2;
+    case nt_vec3:   return &g_Typedefs.Vec3;
+    case nt_quat:   return &g_Typedefs.Quat;
+    case nt_matrix: return &g_Typedefs.Matrix;
+    case nt_pchar:  return &g_Typedefs.PChar;
+    case nt_pwchar: return &g_Typedefs.PWChar;
+    case nt_float:  return &g_Typedefs.Float;
+    case nt_double: return &g_Typedefs.Double;
+    default:        return NULL;
+    }
+}
+
+//
+// Everything the generated text of pClass depends on. Types, offsets and
+// sizes come from the class's records, the nodes are only visited for
+// names and the classes they link to.
+//
+static void DescribeClass( CNodeClass* pClass, CODEGEN_CLASS& Class )
+{
+    const NodeRecords& Records = pClass->GetRecords( );
+
+    Class.Name = GetGeneratedString( pClass->GetName( ) );
+    Class.Code = GetGeneratedString( pClass->m_Code );
+    Class.Size = pClass->GetMemorySize( );
+    Class.Members.resize( Records.Types.size( ) );
+
+    for (size_t n = 0; n < Records.Types.size( ); n++)
+    {
+        CNodeBase* pNode = pClass->GetNode( n );
+        CODEGEN_MEMBER& Member = Class.Members[n];
+        NodeType Type = Records.Types[n];
+        const CString* Typedef = GetGeneratedTypedef( Type );
+
+        Member.Kind = CODEGEN_FIELD;
+        Member.Name = GetGeneratedString( pNode->GetName( ) );
+        Member.Comment = GetGeneratedString( pNode->GetComment( ) );
+        Member.Offset = (uint32_t)Records.Offsets[n];
+        Member.Size = 0;
+
+        if (Typedef != NULL)
+        {
+            Member.Type = GetGeneratedString( *Typedef );
+            continue;
         }
 
-        if (fill > 0)
+        switch (Type)
         {
-            if (g_bPrivatePadding)
+        case nt_hex64:
+        case nt_hex32:
+        case nt_hex16:
+        case nt_hex8:
+            Member.Kind = CODEGEN_PADDING;
+            Member.Size = Records.Sizes[n];
+            break;
+        case nt_vtable:
+            Member.Kind = CODEGEN_VTABLE;
+            Member.Functions.resize( pNode->NodeCount( ) );
+            for (size_t f = 0; f < pNode->NodeCount( ); f++)
             {
-                t.Format( _T( "private:\r\n\t%s pad_0x%0.4X[0x%X]; //0x%0.4X\r\n" ), g_Typedefs.Hex, fillStart, fill, fillStart );
-                // TODO: Maybe add public at the end for user impl of class inline functions?: public:\r\n
+                Member.Functions[f].Name = GetGeneratedString( pNode->GetNode( f )->GetName( ) );
+                Member.Functions[f].Comment = GetGeneratedString( pNode->GetNode( f )->GetComment( ) );
             }
-            else
+            break;
+        case nt_text:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = "char";
+            Member.Size = Records.Sizes[n];
+            break;
+        case nt_unicode:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = "wchar_t";
+            Member.Size = Records.Sizes[n] / sizeof( wchar_t );
+            break;
+        case nt_custom:
+        case nt_functionptr:
+            Member.Kind = CODEGEN_DECLARATION;
+            break;
+        case nt_pointer:
+            Member.Type = GetGeneratedString( static_cast<CNodePtr*>(pNode)->GetClass( )->GetName( ) ) + "*";
+            break;
+        case nt_instance:
+            // At offset 0 it is generated as the base class
+            Member.Kind = (Member.Offset == 0) ? CODEGEN_BASE : CODEGEN_FIELD;
+            Member.Type = GetGeneratedString( static_cast<CNodeClassInstance*>(pNode)->GetClass( )->GetName( ) );
+            break;
+        case nt_array:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = GetGeneratedString( static_cast<CNodeArray*>(pNode)->GetClass( )->GetName( ) );
+            Member.Size = static_cast<CNodeArray*>(pNode)->GetTotal( );
+            break;
+        case nt_ptrarray:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = GetGeneratedString( static_cast<CNodePtrArray*>(pNode)->GetClass( )->GetName( ) ) + "*";
+            Member.Size = static_cast<CNodePtrArray*>(pNode)->Count( );
+            break;
+        default:
+            Member.Kind = CODEGEN_NONE;
+            break;
+        }
+    }
+}
+
+// The classes pClass's description names, with their edit generations
+static void GetDescribedLinks( CNodeClass* pClass, std::vector<std::pair<const CNodeClass*, DWORD>>& Links )
+{
+    Links.clear( );
+    for (size_t n = 0; n < pClass->NodeCount( ); n++)
+    {
+        CNodeBase* pNode = pClass->GetNode( n );
+        const CNodeClass* pLinked;
+
+        switch (pNode->GetType( ))
+        {
+        case nt_pointer:    pLinked = static_cast<CNodePtr*>(pNode)->GetClass( ); break;
+        case nt_instance:   pLinked = static_cast<CNodeClassInstance*>(pNode)->GetClass( ); break;
+        case nt_array:      pLinked = static_cast<CNodeArray*>(pNode)->GetClass( ); break;
+        case nt_ptrarray:   pLinked = static_cast<CNodePtrArray*>(pNode)->GetClass( ); break;
+        default:            continue;
+        }
+
+        Links.emplace_back( pLinked, pLinked->GetEditGeneration( ) );
+    }
+}
+
+//
+// The links are only looked at while the class's own generation is current:
+// relinking a node is an edit of the class, so the classes it names then are
+// still the ones it named when it was described, and alive.
+//
+static bool IsDescriptionCurrent( CNodeClass* pClass, const CReClassExApp::GeneratedClass& Generated )
+{
+    if (Generated.EditGeneration != pClass->GetEditGeneration( ) || Generated.Size != pClass->GetMemorySize( ))
+        return false;
+
+    for (const auto& Link : Generated.Links)
+    {
+        if (Link.first->GetEditGeneration( ) != Link.second)
+            return false;
+    }
+    return true;
+}
+
+//
+// Forward declarations and definition order from the class dependency graph.
+// The graph is only rebuilt when the links between classes changed since the
+// last export.
+//
+void CReClassExApp::GetGenerationOrder( std::vector<const CNodeClass*>& ForwardDeclarations, std::vector<const CNodeClass*>& ClassDefinitions )
+{
+    std::vector<GenerationLink> Links;
+
+    for (CNodeClass* pClass : m_Classes)
+    {
+        for (size_t n = 0; n < pClass->NodeCount( ); n++)
+        {
+            CNodeBase* pNode = pClass->GetNode( n );
+            switch (pNode->GetType( ))
             {
-                t.Format( _T( "\t%s pad_0x%0.4X[0x%X]; //0x%0.4X\r\n" ), g_Typedefs.Hex, fillStart, fill, fillStart );
+            case nt_pointer:
+                Links.emplace_back( pClass, static_cast<CNodePtr*>(pNode)->GetClass( ), DependencyType::POINTER );
+                break;
+            case nt_instance:
+                Links.emplace_back( pClass, static_cast<CNodeClassInstance*>(pNode)->GetClass( ), DependencyType::INSTANCE );
+                break;
+            case nt_array:
+                Links.emplace_back( pClass, static_cast<CNodeArray*>(pNode)->GetClass( ), DependencyType::INSTANCE );
+                break;
+            case nt_ptrarray:
+                Links.emplace_back( pClass, static_cast<CNodePtrArray*>(pNode)->GetClass( ), DependencyType::POINTER );
+                break;
+            default:
+                break;
             }
-
-            var.push_back( t );
         }
+    }
 
-        t.Format( _T( "%s\r\n{\r\npublic:\r\n" ), ClassName );
-        strGeneratedText += t;
+    if (m_GenerationClasses != m_Classes || m_GenerationLinks != Links)
+    {
+        std::set<const CNodeClass*> Forward;
+        ClassDependencyGraph DependencyGraph;
+
+        // Add each class as a node to the graph before adding dependency edges
+        for (CNodeClass* pClass : m_Classes)
+            DependencyGraph.AddNode( pClass );
+        for (const GenerationLink& Link : Links)
+            DependencyGraph.AddEdge( std::get<0>( Link ), std::get<1>( Link ), std::get<2>( Link ) );
+
+        m_GenerationOrder.clear( );
+        DependencyGraph.OrderClassesForGeneration( Forward, m_GenerationOrder );
+        ASSERT( m_GenerationOrder.size( ) == m_Classes.size( ) );
+
+        m_GenerationForward.assign( Forward.begin( ), Forward.end( ) );
+        m_GenerationClasses = m_Classes;
+        m_GenerationLinks.swap( Links );
+    }
 
-        for (size_t i = 0; i < vfun.size( ); i++)
-            strGeneratedText += vfun[i];
+    ForwardDeclarations = m_GenerationForward;
+    ClassDefinitions = m_GenerationOrder;
+}
 
-        if (vfun.size( ) > 0)
-            strGeneratedText += _T( "\r\n" );
+void CReClassExApp::OnButtonGenerate( )
+{
+    CODEGEN_PROJECT Project;
+    std::vector<const CNodeClass*> ForwardDeclarations;
+    std::vector<const CNodeClass*> ClassDefinitions;
+    std::string Text;
+    std::unordered_map<const CNodeClass*, GeneratedClass> Generated;
+    LARGE_INTEGER GenerateStart;
+    UINT Described = 0;
+
+    QueryPerformanceCounter( &GenerateStart );
+
+    // Every description with a typedef'd member has the old names in it
+    CString Typedefs;
+    Typedefs.Format( _T( "%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s" ),
+        g_Typedefs.Int64.GetString( ), g_Typedefs.Int32.GetString( ), g_Typedefs.Int16.GetString( ), g_Typedefs.Int8.GetString( ),
+        g_Typedefs.Qword.GetString( ), g_Typedefs.Dword.GetString( ), g_Typedefs.Word.GetString( ), g_Typedefs.Byte.GetString( ),
+        g_Typedefs.Float.GetString( ), g_Typedefs.Double.GetString( ), g_Typedefs.Vec2.GetString( ), g_Typedefs.Vec3.GetString( ),
+        g_Typedefs.Quat.GetString( ), g_Typedefs.Matrix.GetString( ), g_Typedefs.PChar.GetString( ), g_Typedefs.PWChar.GetString( ) );
+    if (Typedefs != m_GeneratedTypedefs)
+    {
+        m_GeneratedClasses.clear( );
+        m_GeneratedTypedefs = Typedefs;
+    }
 
-        for (size_t i = 0; i < var.size( ); i++)
-            strGeneratedText += var[i];
+    GetGenerationOrder( ForwardDeclarations, ClassDefinitions );
 
-        if (var.size( ) > 0)
-            strGeneratedText += _T( "\r\n" );
+    Project.Header = GetGeneratedString( m_strHeader );
+    Project.Footer = GetGeneratedString( m_strFooter );
+    Project.Options.HexType = GetGeneratedString( g_Typedefs.Hex );
+    Project.Options.bPrivatePadding = g_bPrivatePadding;
+    Project.Options.bStaticAsserts = false;
 
-        if (pClass->m_Code.GetLength( ) > 0)
+    for (const CNodeClass* pClass : ForwardDeclarations)
+        Project.ForwardDeclarations.push_back( GetGeneratedString( pClass->GetName( ) ) );
+
+    //
+    // Descriptions are taken here on the UI thread, the generator formats
+    // them on its own threads without touching the nodes. Unchanged classes
+    // aren't walked at all, their kept description and its hash are lent to
+    // the project and taken back after.
+    //
+    Project.Classes.resize( ClassDefinitions.size( ) );
+    for (size_t i = 0; i < ClassDefinitions.size( ); i++)
+    {
+        CNodeClass* pClass = (CNodeClass*)ClassDefinitions[i];
+        GeneratedClass& Class = m_GeneratedClasses[pClass];
+
+        if (Class.Description.Hash == 0 || !IsDescriptionCurrent( pClass, Class ))
         {
-            strGeneratedText += pClass->m_Code;
-            strGeneratedText += _T( "\r\n" );
+            CalcOffsets( pClass );
+            Class.Description = CODEGEN_CLASS( );
+            DescribeClass( pClass, Class.Description );
+            Class.Description.Hash = CCodeGenerator::HashClass( Class.Description );
+            Class.EditGeneration = pClass->GetEditGeneration( );
+            Class.Size = pClass->GetMemorySize( );
+            GetDescribedLinks( pClass, Class.Links );
+            Described++;
         }
 
-        t.Format( _T( "}; //Size=0x%0.4X\r\n\r\n" ), pClass->GetMemorySize( ) );
-        strGeneratedText += t;
+        Project.Classes[i] = std::move( Class.Description );
     }
 
-    if (!m_strFooter.IsEmpty( ))
+    m_CodeGenerator.Generate( Project, Text );
+
+    // Only classes still in the project are kept
+    for (size_t i = 0; i < ClassDefinitions.size( ); i++)
     {
-        strGeneratedText += (m_strFooter + _T( "\r\n" ));
+        GeneratedClass& Class = m_GeneratedClasses[ClassDefinitions[i]];
+        Class.Description = std::move( Project.Classes[i] );
+        Generated[ClassDefinitions[i]] = std::move( Class );
     }
+    m_GeneratedClasses.swap( Generated );
+
+    CString strGeneratedText( CA2W( Text.c_str( ), CP_UTF8 ) );
+
+    PrintOutDbg( _T( "Generated %u classes (%u described, %u formatted) in %.1f ms" ), (UINT)Project.Classes.size( ),
+        Described, (UINT)m_CodeGenerator.GetLastFormatted( ), ElapsedMilliseconds( GenerateStart ) );
 
     if (g_bClipboardCopy)
     {
@@ -1727,6 +2401,11 @@ CNodeBase* CReClassExApp::IsNodeRef( CNodeBase* pTestNode )
                 if (static_cast<CNodePtr*>(pNode)->GetClass( ) == pTestNode)
                     return pNode;
             }
+            else if (nodeType == nt_ptrarray)
+            {
+                if (static_cast<CNodePtrArray*>(pNode)->GetClass( ) == pTestNode)
+                    return pNode;
+            }
         }
     }
     return NULL;
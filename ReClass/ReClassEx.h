@@ -12,6 +12,17 @@
 #include "Symbols.h"
 // Class dependency graph
 #include "ClassDependencyGraph.h"
+// Header generation
+#include "CodeGenerator.h"
+
+#include <tuple>
+#include <unordered_map>
+
+// Depending class, the class it uses and how, for ordering generated classes
+typedef std::tuple<const CNodeClass*, const CNodeClass*, DependencyType> GenerationLink;
+
+// Class -> index in m_Classes, for serializing links
+typedef std::unordered_map<const CNodeBase*, uint32_t> ProjectClassIndices;
 
 class CReClassExApp : public CWinAppEx {
 public:
@@ -52,6 +63,50 @@ public:
     void ClearHidden( );
 
     void SaveXML( TCHAR* FileName );
+    BOOLEAN LoadXML( LPCTSTR FileName );
+
+    // Binary projects (ProjectFormat.h), picked by the .ntsb extension when saving
+    // and by the file's magic when opening
+    void SaveProject( LPCTSTR FileName );
+    BOOLEAN SaveBinary( LPCTSTR FileName );
+    BOOLEAN LoadBinary( LPCTSTR FileName );
+
+    // Binary images of the whole project or of one class, shared by the
+    // binary projects and the autosave journal (Autosave.h)
+    void GetClassIndices( ProjectClassIndices& ClassIndices );
+    void BuildProjectImage( std::vector<uint8_t>& Image );
+    void BuildClassImage( CNodeClass* pClass, const ProjectClassIndices& ClassIndices, std::vector<uint8_t>& Image );
+    // With a source the classes materialize from it lazily (LoadBinary)
+    void LoadProjectImage( const class CProjectImage& Image, const std::shared_ptr<class CProjectSource>& pSource = nullptr );
+    BOOLEAN LoadClassImage( UINT Index, const void* Data, size_t Size );
+
+    // Closes every class window and empties the project
+    void CloseProject( );
+
+    // Classes in the order OnButtonGenerate defines them
+    void GetGenerationOrder( std::vector<const CNodeClass*>& ForwardDeclarations, std::vector<const CNodeClass*>& ClassDefinitions );
+
+    CCodeGenerator m_CodeGenerator;
+
+    // Classes and links the last generation order was computed from
+    std::vector<CNodeClass*> m_GenerationClasses;
+    std::vector<GenerationLink> m_GenerationLinks;
+    std::vector<const CNodeClass*> m_GenerationForward;
+    std::vector<const CNodeClass*> m_GenerationOrder;
+
+    //
+    // Each class's description as of the last export. It is taken again
+    // only when the class's edit generation or size moved (an instanced
+    // class grew), a class it names was edited or the typedefs changed.
+    //
+    struct GeneratedClass {
+        DWORD EditGeneration;
+        ULONG Size;
+        std::vector<std::pair<const CNodeClass*, DWORD>> Links;    // Named classes and their edit generation
+        CODEGEN_CLASS Description;
+    };
+    std::unordered_map<const CNodeClass*, GeneratedClass> m_GeneratedClasses;
+    CString m_GeneratedTypedefs;
 
     HMENU  m_hMdiMenu;
     HACCEL m_hMdiAccel;
@@ -89,6 +144,9 @@ public:
     afx_msg void OnUpdateButtonResume( CCmdUI *pCmdUI );
     afx_msg void OnButtonKill( );
     afx_msg void OnUpdateButtonKill( CCmdUI *pCmdUI );
+    afx_msg void OnButtonCaptureSnapshot( );
+    afx_msg void OnUpdateButtonCaptureSnapshot( CCmdUI *pCmdUI );
+    afx_msg void OnButtonOpenSnapshot( );
     afx_msg void OnButtonSearch( );
     afx_msg void OnUpdateButtonSearch( CCmdUI *pCmdUI );
     afx_msg void OnButtonClean( );
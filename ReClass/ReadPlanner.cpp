@@ -0,0 +1,266 @@
+#include "stdafx.h"
+
+#include "ReadPlanner.h"
+
+#include <algorithm>
+
+// Paint happens on the UI thread, but symbol loading and the module scanner
+// call ReClassReadMemory from their own threads and must not see the planner.
+static thread_local CReadPlanner* s_pActivePlanner = NULL;
+
+CReadPlanner::CReadPlanner( )
+    : m_pSource( NULL )
+    , m_pPrevious( NULL )
+    , m_Hits( 0 )
+    , m_Misses( 0 )
+    , m_bPrefetched( FALSE )
+{
+}
+
+CReadPlanner::~CReadPlanner( )
+{
+    if (s_pActivePlanner == this)
+        EndFrame( );
+}
+
+CReadPlanner* CReadPlanner::GetActive( )
+{
+    return s_pActivePlanner;
+}
+
+void CReadPlanner::BeginFrame( IMemorySource* Source )
+{
+    m_pSource = Source;
+    m_Hits = 0;
+    m_Misses = 0;
+
+    //
+    // A Refresh that found changes already fetched this frame's data, the
+    // view repaints right after it
+    //
+    if (!m_bPrefetched || !m_Requested.empty( ))
+    {
+        PlanBlocks( m_Blocks );
+        Fetch( Source, m_Blocks, m_Data );
+    }
+    m_bPrefetched = FALSE;
+
+    if (s_pActivePlanner != this)
+    {
+        m_pPrevious = s_pActivePlanner;
+        s_pActivePlanner = this;
+    }
+}
+
+void CReadPlanner::EndFrame( )
+{
+    if (s_pActivePlanner == this)
+        s_pActivePlanner = m_pPrevious;
+    m_pPrevious = NULL;
+    m_pSource = NULL;
+}
+
+void CReadPlanner::Invalidate( )
+{
+    // Keep the layout, the next frame or Refresh reads the same blocks again
+    for (ReadBlock& Block : m_Blocks)
+        Block.bValid = FALSE;
+    m_bPrefetched = FALSE;
+}
+
+BOOLEAN CReadPlanner::Refresh( IMemorySource* Source, std::vector<ReadRange>& Changed )
+{
+    std::vector<ReadBlock> Blocks;
+
+    Changed.clear( );
+    PlanBlocks( Blocks );
+    Fetch( Source, Blocks, m_Fresh );
+
+    //
+    // Walk the new blocks against the old ones, both are sorted and don't
+    // overlap among themselves. Bytes the last frame didn't have (misses,
+    // unreadable blocks) count as changed.
+    //
+    size_t Old = 0;
+    for (const ReadBlock& Block : Blocks)
+    {
+        ULONG_PTR First = Block.End;
+        ULONG_PTR Last = Block.Start;
+        ULONG_PTR Covered = Block.Start;
+
+        while (Old < m_Blocks.size( ) && m_Blocks[Old].End <= Block.Start)
+            Old++;
+
+        for (size_t i = Old; i < m_Blocks.size( ) && m_Blocks[i].Start < Block.End; i++)
+        {
+            const ReadBlock& Previous = m_Blocks[i];
+            ULONG_PTR Start = max( Block.Start, Previous.Start );
+            ULONG_PTR End = min( Block.End, Previous.End );
+
+            if (Start > Covered)
+            {
+                First = min( First, Covered );
+                Last = max( Last, Start );
+            }
+
+            if (!Block.bValid || !Previous.bValid)
+            {
+                First = min( First, Start );
+                Last = max( Last, End );
+            }
+            else
+            {
+                const UCHAR* Now = m_Fresh.data( ) + Block.Offset + (Start - Block.Start);
+                const UCHAR* Then = m_Data.data( ) + Previous.Offset + (Start - Previous.Start);
+                SIZE_T Size = End - Start;
+
+                SIZE_T Head = std::mismatch( Now, Now + Size, Then ).first - Now;
+                if (Head != Size)
+                {
+                    SIZE_T Tail = Size;
+                    while (Tail > Head && Now[Tail - 1] == Then[Tail - 1])
+                        Tail--;
+                    First = min( First, Start + Head );
+                    Last = max( Last, Start + Tail );
+                }
+            }
+
+            Covered = max( Covered, End );
+        }
+
+        if (Covered < Block.End)
+        {
+            First = min( First, Covered );
+            Last = Block.End;
+        }
+
+        if (First < Last)
+        {
+            ReadRange Range = { First, Last };
+            Changed.push_back( Range );
+        }
+    }
+
+    m_Blocks.swap( Blocks );
+    m_Data.swap( m_Fresh );
+    m_bPrefetched = Changed.empty( ) ? FALSE : TRUE;
+
+    return Changed.empty( ) ? FALSE : TRUE;
+}
+
+void CReadPlanner::PlanBlocks( std::vector<ReadBlock>& Blocks )
+{
+    //
+    // Nothing new was recorded (no frame since the last plan), read the same
+    // blocks again
+    //
+    if (m_Requested.empty( ))
+    {
+        if (&Blocks != &m_Blocks)
+            Blocks = m_Blocks;
+        return;
+    }
+
+    Blocks.clear( );
+
+    std::sort( m_Requested.begin( ), m_Requested.end( ),
+               [] ( const ReadRange& a, const ReadRange& b ) { return a.Start < b.Start; } );
+
+    //
+    // Coalesce overlapping and nearby ranges
+    //
+    SIZE_T TotalSize = 0;
+    ReadBlock Current = { m_Requested[0].Start, m_Requested[0].End, 0, FALSE };
+    for (size_t i = 1; i < m_Requested.size( ); i++)
+    {
+        const ReadRange& Range = m_Requested[i];
+        ULONG_PTR MergedEnd = max( Current.End, Range.End );
+        if (Range.Start <= Current.End + MergeGap && MergedEnd - Current.Start <= MaxBlockSize)
+        {
+            Current.End = MergedEnd;
+        }
+        else
+        {
+            Current.Offset = TotalSize;
+            TotalSize += Current.End - Current.Start;
+            Blocks.push_back( Current );
+            Current.Start = Range.Start;
+            Current.End = Range.End;
+        }
+    }
+    Current.Offset = TotalSize;
+    Blocks.push_back( Current );
+
+    m_Requested.clear( );
+}
+
+void CReadPlanner::Fetch( IMemorySource* Source, std::vector<ReadBlock>& Blocks, std::vector<UCHAR>& Data )
+{
+    if (Blocks.empty( ))
+        return;
+
+    //
+    // One batch for the whole frame
+    //
+    Data.resize( Blocks.back( ).Offset + (Blocks.back( ).End - Blocks.back( ).Start) );
+
+    m_Requests.resize( Blocks.size( ) );
+    for (size_t i = 0; i < Blocks.size( ); i++)
+    {
+        m_Requests[i].Address = Blocks[i].Start;
+        m_Requests[i].Buffer = Data.data( ) + Blocks[i].Offset;
+        m_Requests[i].Size = Blocks[i].End - Blocks[i].Start;
+        m_Requests[i].BytesRead = 0;
+        m_Requests[i].Success = false;
+    }
+
+    if (Source != NULL)
+        Source->ReadBatch( m_Requests.data( ), m_Requests.size( ) );
+
+    for (size_t i = 0; i < Blocks.size( ); i++)
+        Blocks[i].bValid = (m_Requests[i].Success && m_Requests[i].BytesRead == m_Requests[i].Size) ? TRUE : FALSE;
+}
+
+void CReadPlanner::Record( ULONG_PTR Address, SIZE_T Size )
+{
+    ULONG_PTR End = Address + Size;
+    if (Size == 0 || Size > MaxBlockSize || End < Address)
+        return;
+
+    ReadRange Range = { Address, End };
+    m_Requested.push_back( Range );
+}
+
+BOOL CReadPlanner::Read( ULONG_PTR Address, LPVOID Buffer, SIZE_T Size, PSIZE_T BytesRead )
+{
+    Record( Address, Size );
+
+    // Last block starting at or before Address
+    auto it = std::upper_bound( m_Blocks.begin( ), m_Blocks.end( ), Address,
+                                [] ( ULONG_PTR a, const ReadBlock& b ) { return a < b.Start; } );
+    if (it != m_Blocks.begin( ))
+    {
+        --it;
+        if (it->bValid && Address + Size <= it->End && Address + Size >= Address)
+        {
+            memcpy( Buffer, m_Data.data( ) + it->Offset + (Address - it->Start), Size );
+            if (BytesRead)
+                *BytesRead = Size;
+            m_Hits++;
+            return TRUE;
+        }
+    }
+
+    m_Misses++;
+
+    SIZE_T Read = 0;
+    BOOL bResult = FALSE;
+    if (m_pSource != NULL)
+        bResult = m_pSource->Read( Address, Buffer, Size, &Read ) ? TRUE : FALSE;
+    else
+        SecureZeroMemory( Buffer, Size );
+
+    if (BytesRead)
+        *BytesRead = Read;
+    return bResult;
+}
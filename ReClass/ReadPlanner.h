@@ -0,0 +1,81 @@
+#pragma once
+
+#include "MemorySource.h"
+
+//
+// Frame coherent read planner
+//
+// A class view reads the same ranges every paint: the class itself, every
+// expanded pointer/vtable/pointer array target and the string previews in the
+// comments. Reads issued while a planner is active on the current thread are
+// recorded, and at the start of the next frame the recorded ranges are merged
+// and fetched in one ReadBatch call. Reads that fall inside a fetched block are
+// served from it (hit), anything else goes to the source directly (miss) and is
+// picked up for the next frame.
+//
+class CReadPlanner {
+public:
+    struct ReadRange {
+        ULONG_PTR Start;
+        ULONG_PTR End;
+    };
+
+    CReadPlanner( );
+    ~CReadPlanner( );
+
+    // Fetches everything the previous frame asked for and makes this planner
+    // the active one for the calling thread until EndFrame.
+    void BeginFrame( IMemorySource* Source );
+    void EndFrame( );
+
+    // Called by ReClassReadMemory while this planner is active
+    BOOL Read( ULONG_PTR Address, LPVOID Buffer, SIZE_T Size, PSIZE_T BytesRead );
+
+    // Drops the fetched blocks. The view calls it after its edits write memory,
+    // the next frame would show the bytes from before the write otherwise.
+    void Invalidate( );
+
+    //
+    // Re-reads what the last frame read, outside of a frame, and compares it
+    // with what that frame saw. Returns FALSE if nothing changed. Otherwise
+    // Changed holds one range per block that differs (first to last changed
+    // byte) and the next BeginFrame uses the data just read.
+    //
+    BOOLEAN Refresh( IMemorySource* Source, std::vector<ReadRange>& Changed );
+
+    inline ULONG GetHits( ) const { return m_Hits; }
+    inline ULONG GetMisses( ) const { return m_Misses; }
+    inline ULONG GetBatchedRanges( ) const { return (ULONG)m_Blocks.size( ); }
+
+    static CReadPlanner* GetActive( );
+
+private:
+    struct ReadBlock {
+        ULONG_PTR Start;
+        ULONG_PTR End;
+        SIZE_T Offset;      // Into m_Data
+        BOOLEAN bValid;     // The whole block was read
+    };
+
+    // Ranges closer than this are fetched as one block
+    static const SIZE_T MergeGap = 256;
+    // Blocks are not grown past this, a bad pointer should not turn into a huge read
+    static const SIZE_T MaxBlockSize = 0x100000;
+
+    void Record( ULONG_PTR Address, SIZE_T Size );
+    void PlanBlocks( std::vector<ReadBlock>& Blocks );
+    void Fetch( IMemorySource* Source, std::vector<ReadBlock>& Blocks, std::vector<UCHAR>& Data );
+
+    IMemorySource* m_pSource;
+    CReadPlanner* m_pPrevious;
+
+    std::vector<ReadRange> m_Requested;
+    std::vector<ReadBlock> m_Blocks;
+    std::vector<UCHAR> m_Data;
+    std::vector<UCHAR> m_Fresh;     // Refresh reads here, then swaps with m_Data
+    std::vector<MemoryReadRequest> m_Requests;
+    BOOLEAN m_bPrefetched;
+
+    ULONG m_Hits;
+    ULONG m_Misses;
+};
@@ -0,0 +1,170 @@
+#include "stdafx.h"
+
+#include "RefreshScheduler.h"
+#include "CClassView.h"
+
+#include <algorithm>
+
+CRefreshScheduler g_RefreshScheduler;
+
+CRefreshScheduler::CRefreshScheduler( )
+{
+}
+
+double CRefreshScheduler::Now( )
+{
+    static LARGE_INTEGER Frequency = { 0 };
+    LARGE_INTEGER Counter;
+
+    if (Frequency.QuadPart == 0)
+        QueryPerformanceFrequency( &Frequency );
+    QueryPerformanceCounter( &Counter );
+
+    return (double)Counter.QuadPart * 1000.0 / (double)Frequency.QuadPart;
+}
+
+void CRefreshScheduler::Register( CClassView* View )
+{
+    if (Find( View ) != NULL)
+        return;
+
+    ViewEntry Entry;
+    Entry.View = View;
+    Entry.State = REFRESH_PAUSED;
+    Entry.Backoff = 0;
+    Entry.NextDue = 0.0;
+    Entry.Cost = 0.0;
+    Entry.AverageCost = 0.0;
+    Entry.WindowStart = Now( );
+    Entry.WindowCount = 0;
+    Entry.Rate = 0.0;
+    m_Views.push_back( Entry );
+}
+
+void CRefreshScheduler::Unregister( CClassView* View )
+{
+    m_Views.erase( std::remove_if( m_Views.begin( ), m_Views.end( ),
+                                   [View] ( const ViewEntry& Entry ) { return Entry.View == View; } ), m_Views.end( ) );
+}
+
+CRefreshScheduler::ViewEntry* CRefreshScheduler::Find( const CClassView* View )
+{
+    for (ViewEntry& Entry : m_Views)
+    {
+        if (Entry.View == View)
+            return &Entry;
+    }
+    return NULL;
+}
+
+const CRefreshScheduler::ViewEntry* CRefreshScheduler::Find( const CClassView* View ) const
+{
+    return const_cast<CRefreshScheduler*>(this)->Find( View );
+}
+
+CRefreshScheduler::RefreshState CRefreshScheduler::GetState( CClassView* View, CWnd* ActiveFrame, BOOLEAN bMinimized )
+{
+    CWnd* Frame = View->GetParentFrame( );
+
+    // Tabs in the background are hidden windows
+    if (bMinimized || Frame == NULL || Frame->IsIconic( ) || !View->IsWindowVisible( ))
+        return REFRESH_PAUSED;
+
+    return (Frame == ActiveFrame) ? REFRESH_FOCUSED : REFRESH_BACKGROUND;
+}
+
+DWORD CRefreshScheduler::GetBudget( RefreshState State )
+{
+    switch (State)
+    {
+    case REFRESH_FOCUSED:
+        return g_RefreshFocused;
+    case REFRESH_BACKGROUND:
+        return g_RefreshBackground;
+    default:
+        return 0;
+    }
+}
+
+DWORD CRefreshScheduler::GetInterval( const ViewEntry& Entry )
+{
+    DWORD Budget = GetBudget( Entry.State );
+    if (Budget == 0)
+        return 0;
+
+    ULONGLONG Interval = (ULONGLONG)Budget << Entry.Backoff;
+    return (DWORD)max( (ULONGLONG)Budget, min( Interval, (ULONGLONG)REFRESH_MAX_INTERVAL ) );
+}
+
+void CRefreshScheduler::Tick( )
+{
+    CMDIFrameWnd* MainFrame = DYNAMIC_DOWNCAST( CMDIFrameWnd, AfxGetMainWnd( ) );
+    if (MainFrame == NULL)
+        return;
+
+    CWnd* ActiveFrame = MainFrame->MDIGetActive( );
+    BOOLEAN bMinimized = MainFrame->IsIconic( ) ? TRUE : FALSE;
+    double Time = Now( );
+
+    for (ViewEntry& Entry : m_Views)
+    {
+        RefreshState State = GetState( Entry.View, ActiveFrame, bMinimized );
+        if (State != Entry.State)
+        {
+            // Coming to the front shouldn't wait out the background interval
+            if (State < Entry.State)
+                Entry.NextDue = Time;
+            Entry.State = State;
+        }
+
+        if (Time - Entry.WindowStart >= 1000.0)
+        {
+            Entry.Rate = Entry.WindowCount * 1000.0 / (Time - Entry.WindowStart);
+            Entry.WindowStart = Time;
+            Entry.WindowCount = 0;
+        }
+
+        if (State == REFRESH_PAUSED || Time < Entry.NextDue)
+            continue;
+
+        //
+        // What the last refresh and its paints took, against the interval
+        // they had. Backing off needs the average over a few refreshes, a
+        // single slow one (a page fault, a symbol lookup) shouldn't count.
+        //
+        Entry.AverageCost = Entry.AverageCost * 0.75 + Entry.Cost * 0.25;
+        Entry.Cost = 0.0;
+
+        DWORD Interval = GetInterval( Entry );
+        if (Entry.AverageCost * 4.0 > Interval && Interval < REFRESH_MAX_INTERVAL)
+            Entry.Backoff++;
+        else if (Entry.Backoff > 0 && Entry.AverageCost * 16.0 < Interval)
+            Entry.Backoff--;
+
+        Entry.NextDue = Time + GetInterval( Entry );
+        Entry.WindowCount++;
+
+        Entry.View->InvalidateChanged( );
+    }
+}
+
+void CRefreshScheduler::AddCost( const CClassView* View, double Milliseconds )
+{
+    ViewEntry* Entry = Find( View );
+    if (Entry != NULL)
+        Entry->Cost += Milliseconds;
+}
+
+BOOLEAN CRefreshScheduler::GetStats( const CClassView* View, ViewStats& Stats ) const
+{
+    const ViewEntry* Entry = Find( View );
+    if (Entry == NULL)
+        return FALSE;
+
+    Stats.State = Entry->State;
+    Stats.Budget = GetBudget( Entry->State );
+    Stats.Interval = GetInterval( *Entry );
+    Stats.Rate = Entry->Rate;
+    Stats.Cost = Entry->AverageCost;
+    return TRUE;
+}
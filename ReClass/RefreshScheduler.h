@@ -0,0 +1,82 @@
+#pragma once
+
+//
+// Refresh scheduler
+//
+// Decides how often each class view looks for changes in the target. One
+// timer on the main frame ticks the scheduler, which calls
+// CClassView::InvalidateChanged on the views that are due:
+//
+//  - the active MDI child every g_RefreshFocused ms
+//  - other children that are on screen (tiled, cascaded) every g_RefreshBackground ms
+//  - children behind another tab or minimized, and everything while the main
+//    window is minimized, not at all. Windows sends them a WM_PAINT when
+//    they show up again.
+//
+// A view whose refreshes (the change check and the paints since the last one)
+// cost more than a quarter of its interval backs off, doubling the interval up
+// to REFRESH_MAX_INTERVAL, and steps back down once they are cheap again. A
+// slow source (a remote plugin) then gets fewer reads instead of a backlog.
+//
+// Only used from the UI thread.
+//
+#define REFRESH_TICK            25      // ms between scheduler ticks
+#define REFRESH_MAX_INTERVAL    5000
+
+class CClassView;
+
+class CRefreshScheduler {
+public:
+    enum RefreshState {
+        REFRESH_FOCUSED,
+        REFRESH_BACKGROUND,
+        REFRESH_PAUSED
+    };
+
+    struct ViewStats {
+        RefreshState State;
+        DWORD Budget;       // Interval the state asks for, 0 if paused
+        DWORD Interval;     // After backing off
+        double Rate;        // Refreshes per second over the last second
+        double Cost;        // Average ms per refresh
+    };
+
+    CRefreshScheduler( );
+
+    void Register( CClassView* View );
+    void Unregister( CClassView* View );
+
+    void Tick( );
+
+    // Time View spent on refresh work, from Now( ) deltas
+    void AddCost( const CClassView* View, double Milliseconds );
+
+    BOOLEAN GetStats( const CClassView* View, ViewStats& Stats ) const;
+
+    // Milliseconds on the performance counter
+    static double Now( );
+
+private:
+    struct ViewEntry {
+        CClassView* View;
+        RefreshState State;
+        UINT Backoff;       // Interval is Budget << Backoff
+        double NextDue;
+        double Cost;        // Since the last refresh
+        double AverageCost;
+        double WindowStart;
+        UINT WindowCount;
+        double Rate;
+    };
+
+    static RefreshState GetState( CClassView* View, CWnd* ActiveFrame, BOOLEAN bMinimized );
+    static DWORD GetBudget( RefreshState State );
+    static DWORD GetInterval( const ViewEntry& Entry );
+
+    ViewEntry* Find( const CClassView* View );
+    const ViewEntry* Find( const CClassView* View ) const;
+
+    std::vector<ViewEntry> m_Views;
+};
+
+extern CRefreshScheduler g_RefreshScheduler;
@@ -0,0 +1,33 @@
+#include "stdafx.h"
+
+#include "RenderSink.h"
+
+CGdiRenderSink::CGdiRenderSink( CDC* Dc )
+    : m_Dc( Dc )
+    , m_TextColor( Dc->GetTextColor( ) )
+{
+    m_Dc->SetBkMode( TRANSPARENT );
+}
+
+void CGdiRenderSink::DrawString( int x, int y, uint32_t Color, const RenderChar* Text, int Length )
+{
+    CRect pos( x, y, 0, 0 );
+
+    if (Color != m_TextColor)
+    {
+        m_Dc->SetTextColor( Color );
+        m_TextColor = Color;
+    }
+
+    m_Dc->DrawText( Text, Length, pos, DT_LEFT | DT_NOCLIP | DT_NOPREFIX );
+}
+
+void CGdiRenderSink::FillRect( int x, int y, int Width, int Height, uint32_t Color )
+{
+    m_Dc->FillSolidRect( x, y, Width, Height, Color );
+}
+
+void CGdiRenderSink::DrawIcon( int x, int y, int Index )
+{
+    DrawIconEx( m_Dc->m_hDC, x, y, g_Icons[Index], 16, 16, 0, NULL, DI_NORMAL );
+}
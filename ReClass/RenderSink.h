@@ -0,0 +1,89 @@
+#pragma once
+
+//
+// Render sinks
+//
+// Where the nodes' Draw methods put their output. CClassView paints through
+// CGdiRenderSink into its memory DC; CRecordingRenderSink keeps every text
+// run, fill and icon in a list instead, so a frame can be laid out, timed
+// and compared against a known good one without a window. Hotspots don't go
+// through the sink, they are already collected in VIEWINFO::Hotspots.
+//
+// The interface and the recording sink only use standard types, so the tests
+// build them on Linux.
+//
+#ifdef _WIN32
+#include <tchar.h>
+#endif
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+typedef TCHAR RenderChar;
+#else
+typedef char RenderChar;
+#endif
+
+class CDC;
+
+class IRenderSink {
+public:
+    virtual ~IRenderSink( ) { }
+
+    // Text[Length] is the terminating NUL
+    virtual void DrawString( int x, int y, uint32_t Color, const RenderChar* Text, int Length ) = 0;
+    virtual void FillRect( int x, int y, int Width, int Height, uint32_t Color ) = 0;
+    // Index into g_Icons, always 16x16
+    virtual void DrawIcon( int x, int y, int Index ) = 0;
+};
+
+class CGdiRenderSink : public IRenderSink {
+public:
+    CGdiRenderSink( CDC* Dc );
+
+    virtual void DrawString( int x, int y, uint32_t Color, const RenderChar* Text, int Length );
+    virtual void FillRect( int x, int y, int Width, int Height, uint32_t Color );
+    virtual void DrawIcon( int x, int y, int Index );
+
+private:
+    CDC* m_Dc;
+    uint32_t m_TextColor;   // Only changed on the DC when a run needs another color
+};
+
+class CRecordingRenderSink : public IRenderSink {
+public:
+    enum RecordType {
+        RECORD_TEXT,
+        RECORD_FILL,
+        RECORD_ICON
+    };
+
+    struct Record {
+        RecordType Type;
+        int x, y;
+        int Width, Height;      // Fills
+        uint32_t Color;         // Text and fills
+        int Index;              // Icons
+        uint32_t TextOffset;    // Text, into GetText
+        uint32_t TextLength;
+    };
+
+    virtual void DrawString( int x, int y, uint32_t Color, const RenderChar* Text, int Length );
+    virtual void FillRect( int x, int y, int Width, int Height, uint32_t Color );
+    virtual void DrawIcon( int x, int y, int Index );
+
+    // Keeps the capacity, so recording the same frame again doesn't allocate
+    void Clear( );
+
+    const std::vector<Record>& GetRecords( ) const { return m_Records; }
+    const RenderChar* GetText( const Record& Run ) const { return &m_Text[Run.TextOffset]; }
+
+    // One line per record, for comparing a frame against a saved one
+    std::basic_string<RenderChar> Dump( ) const;
+
+private:
+    std::vector<Record> m_Records;
+    std::vector<RenderChar> m_Text;
+};
@@ -0,0 +1,68 @@
+//
+// CRecordingRenderSink, see RenderSink.h. Doesn't use the precompiled header
+// so the tests build it without MFC.
+//
+#include "RenderSink.h"
+
+#include <stdio.h>
+
+void CRecordingRenderSink::DrawString( int x, int y, uint32_t Color, const RenderChar* Text, int Length )
+{
+    Record Run = { RECORD_TEXT, x, y, 0, 0, Color, 0, (uint32_t)m_Text.size( ), (uint32_t)Length };
+    m_Text.insert( m_Text.end( ), Text, Text + Length );
+    m_Text.push_back( 0 );
+    m_Records.push_back( Run );
+}
+
+void CRecordingRenderSink::FillRect( int x, int y, int Width, int Height, uint32_t Color )
+{
+    Record Fill = { RECORD_FILL, x, y, Width, Height, Color, 0, 0, 0 };
+    m_Records.push_back( Fill );
+}
+
+void CRecordingRenderSink::DrawIcon( int x, int y, int Index )
+{
+    Record Icon = { RECORD_ICON, x, y, 16, 16, 0, Index, 0, 0 };
+    m_Records.push_back( Icon );
+}
+
+void CRecordingRenderSink::Clear( )
+{
+    m_Records.clear( );
+    m_Text.clear( );
+}
+
+std::basic_string<RenderChar> CRecordingRenderSink::Dump( ) const
+{
+    std::basic_string<RenderChar> Out;
+    char Line[128];
+
+    for (const Record& Entry : m_Records)
+    {
+        switch (Entry.Type)
+        {
+        case RECORD_TEXT:
+            snprintf( Line, sizeof( Line ), "text %d,%d #%06X ", Entry.x, Entry.y, (unsigned int)Entry.Color );
+            break;
+        case RECORD_FILL:
+            snprintf( Line, sizeof( Line ), "fill %d,%d %dx%d #%06X\r\n", Entry.x, Entry.y, Entry.Width, Entry.Height, (unsigned int)Entry.Color );
+            break;
+        case RECORD_ICON:
+            snprintf( Line, sizeof( Line ), "icon %d,%d %d\r\n", Entry.x, Entry.y, Entry.Index );
+            break;
+        }
+
+        // The formatted part is ASCII, widened a character at a time for Unicode builds
+        for (const char* p = Line; *p != 0; p++)
+            Out += (RenderChar)*p;
+
+        if (Entry.Type == RECORD_TEXT)
+        {
+            Out.append( GetText( Entry ), Entry.TextLength );
+            Out += (RenderChar)'\r';
+            Out += (RenderChar)'\n';
+        }
+    }
+
+    return Out;
+}
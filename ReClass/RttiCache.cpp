@@ -0,0 +1,165 @@
+#include "stdafx.h"
+
+#include "RttiCache.h"
+
+CRttiCache g_RttiCache;
+
+//
+// RTTICompleteObjectLocator and friends. On x64 the pointers between them are
+// 32 bit offsets from the module base, on x86 they are plain 32 bit pointers,
+// so the same walk works for both with a zero base.
+//
+#if defined(_M_AMD64)
+#define RTTI_IMAGE_BASE( ModuleBase ) (ModuleBase)
+#else
+#define RTTI_IMAGE_BASE( ModuleBase ) ((ULONG_PTR)0)
+#endif
+
+#define RTTI_LOCATOR_HIERARCHY      0x10                    // RTTICompleteObjectLocator::pClassDescriptor
+#define RTTI_TYPE_DESCRIPTOR_NAME   (2 * sizeof( ULONG_PTR ))   // TypeDescriptor::name, after pVFTable and spare
+
+struct RttiClassHierarchyDescriptor {
+    ULONG Signature;
+    ULONG Attributes;
+    ULONG NumBaseClasses;
+    ULONG BaseClassArray;
+};
+
+static CString Remangle( const CStringA& Name )
+{
+    // ".?AVFoo@@" -> "??_7Foo@@6B@", the vftable symbol undecorates to the plain class name
+    return CString( "??_7" + Name.Mid( 4 ) + "6B@" );
+}
+
+const CString* CRttiCache::Find( ULONG_PTR VTable, ULONG_PTR ModuleBase )
+{
+    auto Found = m_Entries.find( VTable );
+    if (Found == m_Entries.end( ))
+    {
+        RttiEntry Entry;
+        RttiResult Result = ReadHierarchy( VTable, ModuleBase, Entry.Hierarchy );
+        if (Result == RTTI_UNREADABLE)
+            return NULL;
+
+        Entry.bFound = (Result == RTTI_FOUND);
+        Found = m_Entries.insert( std::make_pair( VTable, Entry ) ).first;
+    }
+
+    return Found->second.bFound ? &Found->second.Hierarchy : NULL;
+}
+
+void CRttiCache::Invalidate( ULONG_PTR Start, ULONG_PTR End )
+{
+    m_Entries.erase( m_Entries.lower_bound( Start ), m_Entries.upper_bound( End ) );
+}
+
+CRttiCache::RttiResult CRttiCache::ReadHierarchy( ULONG_PTR VTable, ULONG_PTR ModuleBase, CString& Hierarchy )
+{
+    ULONG_PTR ImageBase = RTTI_IMAGE_BASE( ModuleBase );
+    ULONG_PTR ObjectLocatorPtr = VTable - sizeof( ULONG_PTR ); // The locator sits right before the first virtual function
+    ULONG_PTR ObjectLocator = 0;
+    ULONG HierarchyDescriptorOffset = 0;
+    RttiClassHierarchyDescriptor HierarchyDescriptor;
+    ULONG BaseClassDescriptors[RTTI_MAX_BASE_CLASSES];
+
+    if (!IsValidPtr( ObjectLocatorPtr ))
+        return RTTI_NONE;
+
+    if (!ReClassReadMemory( (LPVOID)ObjectLocatorPtr, &ObjectLocator, sizeof( ULONG_PTR ) ))
+        return RTTI_UNREADABLE;
+
+    if (!IsValidPtr( ObjectLocator ))
+        return RTTI_NONE;
+    if (!ReClassReadMemory( (LPVOID)(ObjectLocator + RTTI_LOCATOR_HIERARCHY), &HierarchyDescriptorOffset, sizeof( ULONG ) ))
+        return RTTI_UNREADABLE;
+
+    ULONG_PTR HierarchyDescriptorPtr = ImageBase + HierarchyDescriptorOffset;
+    if (!IsValidPtr( HierarchyDescriptorPtr ) || !HierarchyDescriptorOffset)
+        return RTTI_NONE;
+    if (!ReClassReadMemory( (LPVOID)HierarchyDescriptorPtr, &HierarchyDescriptor, sizeof( HierarchyDescriptor ) ))
+        return RTTI_UNREADABLE;
+
+    ULONG NumBaseClasses = HierarchyDescriptor.NumBaseClasses;
+    if (NumBaseClasses > RTTI_MAX_BASE_CLASSES)
+        NumBaseClasses = 0;
+
+    // The whole base class array in one read
+    ULONG_PTR BaseClassArray = ImageBase + HierarchyDescriptor.BaseClassArray;
+    if (!IsValidPtr( BaseClassArray ) || !HierarchyDescriptor.BaseClassArray)
+        return RTTI_NONE;
+    if (!ReClassReadMemory( (LPVOID)BaseClassArray, BaseClassDescriptors, NumBaseClasses * sizeof( ULONG ) ))
+        return RTTI_UNREADABLE;
+
+    for (ULONG i = 0; i < NumBaseClasses; i++)
+    {
+        ULONG TypeDescriptorOffset = 0;
+        CStringA RTTIName;
+
+        if (i == 1)
+            Hierarchy += _T( ": " ); // Base class
+        else if (i > 1)
+            Hierarchy += _T( ", " ); // Parent classes
+
+        ULONG_PTR BaseClassDescriptor = ImageBase + BaseClassDescriptors[i];
+        if (!IsValidPtr( BaseClassDescriptor ) || !BaseClassDescriptors[i])
+            continue;
+        // A hierarchy with a name missing would stick, better none for now
+        if (!ReClassReadMemory( (LPVOID)BaseClassDescriptor, &TypeDescriptorOffset, sizeof( ULONG ) ))
+            return RTTI_UNREADABLE;
+
+        ULONG_PTR TypeDescriptor = ImageBase + TypeDescriptorOffset;
+        if (!IsValidPtr( TypeDescriptor ) || !TypeDescriptorOffset)
+            continue;
+
+        RttiResult NameResult = ReadTypeName( TypeDescriptor + RTTI_TYPE_DESCRIPTOR_NAME, RTTIName );
+        if (NameResult == RTTI_UNREADABLE)
+            return RTTI_UNREADABLE;
+
+        // Decorated names end with "@@", anything else isn't a type name
+        if (NameResult != RTTI_FOUND || RTTIName.GetLength( ) < 6 || RTTIName.Right( 2 ) != "@@")
+            continue;
+
+        TCHAR Demangled[MAX_PATH] = { 0 };
+        if (_UnDecorateSymbolName( Remangle( RTTIName ), Demangled, MAX_PATH, UNDNAME_NAME_ONLY ) != 0)
+        {
+            CString PostProcessing( Demangled );
+            PostProcessing.Replace( _T( "::`vftable'" ), _T( "" ) );
+            Hierarchy += PostProcessing;
+        }
+        else
+        {
+            Hierarchy += CString( RTTIName.Mid( 1 ) );
+        }
+    }
+
+    return RTTI_FOUND;
+}
+
+CRttiCache::RttiResult CRttiCache::ReadTypeName( ULONG_PTR Address, CStringA& Name )
+{
+    CHAR Buffer[RTTI_MAX_NAME_LENGTH];
+    SIZE_T Length = 0;
+
+    //
+    // Page sized chunks at most, a name ending right before an unreadable page
+    // must not fail because the read asked for bytes past it.
+    //
+    while (Length < RTTI_MAX_NAME_LENGTH)
+    {
+        SIZE_T Chunk = min( RTTI_MAX_NAME_LENGTH - Length, 0x1000 - ((Address + Length) & 0xFFF) );
+        if (!ReClassReadMemory( (LPVOID)(Address + Length), Buffer + Length, Chunk ))
+            return RTTI_UNREADABLE;
+
+        const CHAR* Terminator = (const CHAR*)memchr( Buffer + Length, 0, Chunk );
+        if (Terminator != NULL)
+        {
+            Name.SetString( Buffer, (int)(Terminator - Buffer) );
+            return RTTI_FOUND;
+        }
+
+        Length += Chunk;
+    }
+
+    // Too long for a type name
+    return RTTI_NONE;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+//
+// RTTI cache
+//
+// Class hierarchies read from MSVC RTTI, keyed by vtable address. The
+// locator, hierarchy descriptor and type names live in the module image and
+// don't change while it stays loaded, so each vtable is walked once and the
+// entries of a module are dropped when it unloads (WM_MODULEEVENT). Another
+// target has other modules at the same addresses, attaching or detaching
+// clears the whole cache. Only results of reads that succeeded are kept.
+//
+// Only used from the UI thread.
+//
+#define RTTI_MAX_BASE_CLASSES   25
+#define RTTI_MAX_NAME_LENGTH    512
+
+class CRttiCache {
+public:
+    // "Class: Base, Base", NULL if VTable has no (readable) RTTI
+    const CString* Find( ULONG_PTR VTable, ULONG_PTR ModuleBase );
+
+    // Forget every vtable in [Start, End], MemMapInfo style inclusive end
+    void Invalidate( ULONG_PTR Start, ULONG_PTR End );
+    void Clear( ) { m_Entries.clear( ); }
+
+private:
+    enum RttiResult {
+        RTTI_FOUND,
+        RTTI_NONE,          // Readable, but not RTTI
+        RTTI_UNREADABLE     // A read failed, try again next time
+    };
+
+    static RttiResult ReadHierarchy( ULONG_PTR VTable, ULONG_PTR ModuleBase, CString& Hierarchy );
+    static RttiResult ReadTypeName( ULONG_PTR Address, CStringA& Name );
+
+    struct RttiEntry {
+        BOOLEAN bFound;
+        CString Hierarchy;
+    };
+
+    std::map<ULONG_PTR, RttiEntry> m_Entries;
+};
+
+extern CRttiCache g_RttiCache;
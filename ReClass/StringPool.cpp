@@ -0,0 +1,62 @@
+#include "stdafx.h"
+
+#include "StringPool.h"
+
+CStringPool g_StringPool;
+
+static const CString s_Empty;
+
+size_t CStringPool::Hash( LPCTSTR String, int Length )
+{
+    // FNV-1a
+    size_t Value = (sizeof( size_t ) == 8) ? (size_t)14695981039346656037ULL : (size_t)2166136261U;
+    size_t Prime = (sizeof( size_t ) == 8) ? (size_t)1099511628211ULL : (size_t)16777619U;
+
+    for (int i = 0; i < Length; i++)
+    {
+        Value ^= (size_t)String[i];
+        Value *= Prime;
+    }
+    return Value;
+}
+
+const CString* CStringPool::Find( size_t Key, LPCTSTR String, int Length ) const
+{
+    auto Range = m_Strings.equal_range( Key );
+    for (auto it = Range.first; it != Range.second; ++it)
+    {
+        if (it->second.GetLength( ) == Length && memcmp( it->second.GetString( ), String, Length * sizeof( TCHAR ) ) == 0)
+            return &it->second;
+    }
+    return NULL;
+}
+
+const CString& CStringPool::Intern( LPCTSTR String )
+{
+    if (String == NULL || *String == 0)
+        return s_Empty;
+
+    int Length = (int)_tcslen( String );
+    size_t Key = Hash( String, Length );
+
+    const CString* Found = Find( Key, String, Length );
+    if (Found != NULL)
+        return *Found;
+
+    return m_Strings.insert( std::make_pair( Key, CString( String, Length ) ) )->second;
+}
+
+const CString& CStringPool::Intern( const CString& String )
+{
+    if (String.IsEmpty( ))
+        return s_Empty;
+
+    size_t Key = Hash( String.GetString( ), String.GetLength( ) );
+
+    const CString* Found = Find( Key, String.GetString( ), String.GetLength( ) );
+    if (Found != NULL)
+        return *Found;
+
+    // Pooling String itself shares its buffer instead of copying it
+    return m_Strings.insert( std::make_pair( Key, String ) )->second;
+}
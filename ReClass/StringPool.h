@@ -0,0 +1,37 @@
+#pragma once
+
+//
+// String pool
+//
+// Node names, comments and address expressions repeat a lot across a project
+// (the node type names, "0", empty comments, the same member in every copy of
+// a class). CString copies share one reference counted buffer, so a node that
+// takes its string from the pool costs a pointer instead of a heap block of
+// its own. Looking up a string that's already pooled doesn't allocate.
+//
+// The generated "N%08X" node names are unique by construction and never
+// pooled, SetName keeps them out. Clear only drops the pool's references,
+// strings nodes still hold stay valid.
+//
+// Only used from the UI thread.
+//
+#include <unordered_map>
+
+class CStringPool {
+public:
+    const CString& Intern( LPCTSTR String );
+    const CString& Intern( const CString& String );
+
+    inline void Clear( ) { m_Strings.clear( ); }
+    inline size_t size( ) const { return m_Strings.size( ); }
+
+private:
+    static size_t Hash( LPCTSTR String, int Length );
+
+    const CString* Find( size_t Key, LPCTSTR String, int Length ) const;
+
+    // Keyed by Hash, collisions share a key
+    std::unordered_multimap<size_t, CString> m_Strings;
+};
+
+extern CStringPool g_StringPool;
@@ -23,13 +23,17 @@ BOOLEAN SymbolReader::LoadSymbolData( const TCHAR* pszSearchPath )
 
     // Obtain access to the provider
     hr = CoCreateInstance( __uuidof( DiaSource ), NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS( &m_pSource ) );
+    _wsplitpath_s( m_strFilePath.GetString( ), NULL, 0, NULL, 0, NULL, 0, szExt, MAX_PATH );
     if (FAILED( hr ))
     {
         PrintOutDbg( _T( "[LoadDataFromPdb] CoCreateInstance failed - HRESULT = %08X" ), hr );
+
+        // No msdia registered, a .pdb can still be read directly
+        if (!_wcsicmp( szExt, L".pdb" ) && m_Pdb.Open( m_strFilePath.GetString( ) ))
+            return TRUE;
         return FALSE;
     }
 
-    _wsplitpath_s( m_strFilePath.GetString( ), NULL, 0, NULL, 0, NULL, 0, szExt, MAX_PATH );
     if (!_wcsicmp( szExt, L".pdb" ))
     {
         // Open and prepare a program database (.pdb) file as a debug data source
@@ -38,7 +42,9 @@ BOOLEAN SymbolReader::LoadSymbolData( const TCHAR* pszSearchPath )
         {
             _com_error err( hr );
             PrintOutDbg( _T( "[LoadDataFromPdb] loadDataFromPdb failed - %s" ), err.ErrorMessage( ) );
-            return FALSE;
+
+            // An msdia older than the PDB format, the symbols can still be read directly
+            return m_Pdb.Open( m_strFilePath.GetString( ) ) ? TRUE : FALSE;
         }
     }
     else
@@ -1009,19 +1015,119 @@ void SymbolReader::ReadSymbol( IDiaSymbol *pSymbol, CString& outString )
 
 BOOLEAN SymbolReader::GetSymbolStringFromVA( ULONG_PTR VirtualAddress, CString& outString )
 {
-    IDiaSymbol* pSymbol = NULL;
-    LONG lDisplacement = 0;
+    const CString* Name = FindSymbolName( VirtualAddress );
+    if (Name == NULL)
+        return FALSE;
 
+    outString += *Name;
+    return TRUE;
+}
+
+const CString* SymbolReader::FindSymbolName( ULONG_PTR VirtualAddress )
+{
     ULONG_PTR ModuleBase = m_ModuleBase ? m_ModuleBase : g_AttachedProcessAddress;
     ULONG SymbolRva = (ULONG)(VirtualAddress - ModuleBase);
 
-    if (FAILED( m_pSession->findSymbolByRVAEx( (ULONG)SymbolRva, SymTagNull, &pSymbol, &lDisplacement ) ))
-        return FALSE;
+    if (m_pSession == NULL)
+        return FindPdbSymbolName( SymbolRva );
 
-    ReadSymbol( pSymbol, outString );
-    pSymbol->Release( );
+    size_t Index = m_Symbols.Find( SymbolRva );
+    if (Index == SYMBOL_NONE)
+        return NULL;
 
-    return TRUE;
+    UINT& NameId = m_SymbolNameIds[Index];
+    if (NameId == SYMBOL_NO_NAME)
+    {
+        IDiaSymbol* pSymbol = NULL;
+        CString Name;
+
+        if (m_pSession->symbolById( m_Symbols.GetValue( Index ), &pSymbol ) == S_OK)
+        {
+            ReadSymbol( pSymbol, Name );
+            pSymbol->Release( );
+        }
+
+        NameId = (UINT)m_SymbolNames.size( );
+        m_SymbolNames.push_back( Name );
+    }
+
+    return &m_SymbolNames[NameId];
+}
+
+const CString* SymbolReader::FindPdbSymbolName( ULONG SymbolRva )
+{
+    uint32_t SymbolIndex = 0;
+
+    const char* SymbolName = m_Pdb.IsOpen( ) ? m_Pdb.FindSymbol( SymbolRva, &SymbolIndex ) : NULL;
+    if (SymbolName == NULL)
+        return NULL;
+
+    UINT& NameId = m_SymbolNameIds[SymbolIndex];
+    if (NameId == SYMBOL_NO_NAME)
+    {
+        NameId = (UINT)m_SymbolNames.size( );
+        m_SymbolNames.push_back( CString( SymbolName ) );
+    }
+
+    return &m_SymbolNames[NameId];
+}
+
+void SymbolReader::LoadSymbolTable( )
+{
+    IDiaEnumSymbolsByAddr* pEnumByAddr = NULL;
+    IDiaSymbol* pSymbol = NULL;
+    DWORD FirstRva = 0;
+    ULONG celt = 0;
+
+    m_Symbols.Clear( );
+    m_SymbolNames.clear( );
+    m_SymbolNameIds.clear( );
+
+    if (m_pSession == NULL)
+    {
+        // m_Pdb sorts its publics when it reads them, only the names are ours
+        if (m_Pdb.IsOpen( ))
+            m_SymbolNameIds.assign( m_Pdb.GetSymbolCount( ), SYMBOL_NO_NAME );
+        return;
+    }
+
+    if (FAILED( m_pSession->getSymbolsByAddr( &pEnumByAddr ) ))
+    {
+        PrintOutDbg( _T( "[LoadSymbolTable] getSymbolsByAddr failed" ) );
+        return;
+    }
+
+    // Position on the first symbol of the image, then walk them all in address order
+    if (pEnumByAddr->symbolByAddr( 1, 0, &pSymbol ) == S_OK)
+    {
+        if (pSymbol->get_relativeVirtualAddress( &FirstRva ) != S_OK)
+            FirstRva = 0;
+        pSymbol->Release( );
+        pSymbol = NULL;
+
+        if (pEnumByAddr->symbolByRVA( FirstRva, &pSymbol ) == S_OK)
+        {
+            do
+            {
+                DWORD Rva = 0;
+                DWORD SymTag = SymTagNull;
+                DWORD SymIndexId = 0;
+
+                if (pSymbol->get_relativeVirtualAddress( &Rva ) == S_OK && pSymbol->get_symIndexId( &SymIndexId ) == S_OK)
+                {
+                    // A function or variable describes itself better than the public at its address
+                    pSymbol->get_symTag( &SymTag );
+                    m_Symbols.Add( Rva, (SymTag == SymTagPublicSymbol) ? 0 : 1, SymIndexId );
+                }
+                pSymbol->Release( );
+            } while (SUCCEEDED( pEnumByAddr->Next( 1, &pSymbol, &celt ) ) && (celt == 1));
+        }
+    }
+
+    pEnumByAddr->Release( );
+
+    m_Symbols.Build( );
+    m_SymbolNameIds.assign( m_Symbols.GetCount( ), SYMBOL_NO_NAME );
 }
 
 BOOLEAN SymbolReader::LoadFile( CString FilePath, ULONG_PTR dwBaseAddr, DWORD dwModuleSize, const TCHAR* pszSearchPath )
@@ -1046,6 +1152,8 @@ BOOLEAN SymbolReader::LoadFile( CString FileName, CString FilePath, ULONG_PTR Mo
     m_ModuleSize = ModuleSize;
 
     m_bInitialized = LoadSymbolData( pszSearchPath );
+    if (m_bInitialized)
+        LoadSymbolTable( );
 
     return m_bInitialized;
 }
\ No newline at end of file
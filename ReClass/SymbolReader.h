@@ -3,6 +3,11 @@
 #include <dia2.h>
 #include <tchar.h>
 #include <afxstr.h>
+#include <vector>
+#include <deque>
+
+#include "PdbFile.h"
+#include "SymbolTable.h"
 
 // Basic types
 static const TCHAR* rgBaseType[] = {
@@ -152,6 +157,9 @@ static const TCHAR* const rgCallingConvention[] = {
 #define SafeDRef(a, i)  ((i < MAXELEMS(a)) ? a[i] : _T("(none)"))
 #define SAFE_RELEASE(x) if(x){ (x)->Release(); (x) = NULL; }
 
+// m_SymbolNameIds entry of a symbol whose name hasn't been formatted yet
+#define SYMBOL_NO_NAME 0xFFFFFFFF
+
 class SymbolReader {
 public:
     SymbolReader( );
@@ -164,8 +172,14 @@ public:
 
     BOOLEAN GetSymbolStringFromVA( ULONG_PTR VirtualAddress, CString& outString );
 
+    // Same as GetSymbolStringFromVA, but returns the cached string, NULL if there is no symbol
+    const CString* FindSymbolName( ULONG_PTR VirtualAddress );
+
 private:
+    const CString* FindPdbSymbolName( ULONG SymbolRva );
+
     BOOLEAN LoadSymbolData( const TCHAR* pszSearchPath = 0 );
+    void LoadSymbolTable( );
 
     void ReadSymTag( DWORD dwSymTag, CString& outString );
 
@@ -197,8 +211,20 @@ private:
     IDiaDataSource* m_pSource;
     IDiaSession*    m_pSession;
 
+    // Used for .pdb files when DIA isn't registered
+    CPdbFile        m_Pdb;
+
     CStringW        m_strFileName;
     CStringW        m_strFilePath;
     ULONG_PTR       m_ModuleBase;
     ULONG           m_ModuleSize;
+
+    //
+    // Every DIA symbol address, read once at load; a lookup is a binary search
+    // for the symbol at or before the RVA, hit or miss. m_Pdb keeps its own
+    // sorted table. Names are only formatted the first time a symbol is hit.
+    //
+    CSymbolTable m_Symbols;                     // Values are DIA symIndexIds
+    std::deque<CString> m_SymbolNames;          // Deque so returned pointers stay valid
+    std::vector<UINT> m_SymbolNameIds;          // m_Symbols (or m_Pdb symbol) index -> m_SymbolNames, SYMBOL_NO_NAME until hit
 };
@@ -0,0 +1,56 @@
+#include "SymbolTable.h"
+
+#include <algorithm>
+
+void CSymbolTable::Add( uint32_t Rva, uint32_t Priority, uint32_t Value )
+{
+    Pending Entry = { Rva, Priority, Value };
+    m_Pending.push_back( Entry );
+}
+
+void CSymbolTable::Build( )
+{
+    std::stable_sort( m_Pending.begin( ), m_Pending.end( ),
+                      [] ( const Pending& a, const Pending& b ) { return a.Rva < b.Rva || (a.Rva == b.Rva && a.Priority > b.Priority); } );
+
+    m_Rvas.clear( );
+    m_Values.clear( );
+    m_Rvas.reserve( m_Pending.size( ) );
+    m_Values.reserve( m_Pending.size( ) );
+
+    for (const Pending& Entry : m_Pending)
+    {
+        // Sorted best first within an RVA
+        if (!m_Rvas.empty( ) && m_Rvas.back( ) == Entry.Rva)
+            continue;
+        m_Rvas.push_back( Entry.Rva );
+        m_Values.push_back( Entry.Value );
+    }
+
+    std::vector<Pending>( ).swap( m_Pending );
+}
+
+void CSymbolTable::Clear( )
+{
+    m_Pending.clear( );
+    m_Rvas.clear( );
+    m_Values.clear( );
+}
+
+size_t CSymbolTable::Find( uint32_t Rva ) const
+{
+    size_t Count = m_Rvas.size( );
+    if (Count == 0 || Rva < m_Rvas[0])
+        return SYMBOL_NONE;
+
+    // Last RVA <= Rva, branchless like CIntervalIndex::Find
+    const uint32_t* Base = m_Rvas.data( );
+    while (Count > 1)
+    {
+        size_t Half = Count / 2;
+        Base = (Base[Half] <= Rva) ? Base + Half : Base;
+        Count -= Half;
+    }
+
+    return Base - m_Rvas.data( );
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+//
+// Symbol table
+//
+// Every symbol address of a module, sorted once when the symbols are loaded.
+// A lookup is a binary search for the last symbol at or before the RVA, the
+// same answer DIA's findSymbolByRVAEx gives, so nothing has to be cached per
+// address asked for. Values are whatever the reader keys its symbols by.
+//
+// Portable like the interval index, no precompiled header.
+//
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define SYMBOL_NONE ((size_t)-1)
+
+class CSymbolTable {
+public:
+    // Of several symbols at one RVA the one with the highest priority is kept,
+    // the first one added of equal priorities
+    void Add( uint32_t Rva, uint32_t Priority, uint32_t Value );
+    void Build( );
+    void Clear( );
+
+    // Index of the last symbol at or before Rva, SYMBOL_NONE if there is none
+    size_t Find( uint32_t Rva ) const;
+
+    uint32_t GetRva( size_t Index ) const { return m_Rvas[Index]; }
+    uint32_t GetValue( size_t Index ) const { return m_Values[Index]; }
+    size_t GetCount( ) const { return m_Rvas.size( ); }
+
+private:
+    struct Pending {
+        uint32_t Rva;
+        uint32_t Priority;
+        uint32_t Value;
+    };
+
+    std::vector<Pending> m_Pending;     // Until Build
+    std::vector<uint32_t> m_Rvas;       // Sorted, unique
+    std::vector<uint32_t> m_Values;
+};
@@ -3,10 +3,16 @@
 
 
 
+#include <algorithm>
 #include <fstream>
 
 Symbols::Symbols( ) :
-    m_bInitialized( FALSE )
+    m_bInitialized( FALSE ),
+    m_bStopWorkers( false ),
+    m_JobsQueued( 0 ),
+    m_JobsDone( 0 ),
+    m_Generation( 0 ),
+    m_hNotifyWnd( NULL )
 {
     ResolveSearchPath( );
 
@@ -21,9 +27,12 @@ Symbols::Symbols( ) :
 
 Symbols::~Symbols( )
 {
-    ntdll::RtlDeleteCriticalSection( &m_CriticalSection );
+    StopWorkers( );
 
     Cleanup( );
+
+    ntdll::RtlDeleteCriticalSection( &m_CriticalSection );
+
     DeleteFile( _T( "symsrv.dll" ) );
 }
 
@@ -154,13 +163,12 @@ BOOLEAN Symbols::Init( )
     return TRUE;
 }
 
-BOOLEAN Symbols::LoadSymbolsForModule( CString ModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule )
+SymbolReader* Symbols::ReadModuleSymbols( const CString& ModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule )
 {
     int idx;
     CString ModuleName;
     const TCHAR* szSearchPath;
     SymbolReader* pReader;
-    BOOLEAN bSucc;
 
     idx = ModulePath.ReverseFind( _T( '/' ) );
     if (idx == -1)
@@ -172,24 +180,245 @@ BOOLEAN Symbols::LoadSymbolsForModule( CString ModulePath, ULONG_PTR ModuleBaseA
     else 
         szSearchPath = NULL;
 
+    //
+    // Each reader has its own DIA data source, so loads don't share any state
+    // and can run on several threads at once
+    //
     pReader = new SymbolReader( );
+    if (!pReader->LoadFile( ModuleName, ModulePath, ModuleBaseAddress, SizeOfModule, szSearchPath ))
+    {
+        delete pReader;
+        return NULL;
+    }
 
+    PrintOut( _T( "[Symbols::LoadSymbolsForModule] Symbols for module %s loaded" ), ModuleName.GetString( ) );
+    return pReader;
+}
+
+void Symbols::PublishModuleSymbols( ULONG_PTR ModuleBaseAddress, SymbolReader* pReader )
+{
     ntdll::RtlEnterCriticalSection( &m_CriticalSection );
+    
+    if (!m_SymbolAddresses.insert( std::make_pair( ModuleBaseAddress, pReader ) ).second)
+        delete pReader;
+    
+    ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
+}
+
+BOOLEAN Symbols::LoadSymbolsForModule( CString ModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule )
+{
+    SymbolReader* pReader = ReadModuleSymbols( ModulePath, ModuleBaseAddress, SizeOfModule );
+    if (pReader == NULL)
+        return FALSE;
+
+    PublishModuleSymbols( ModuleBaseAddress, pReader );
+    return TRUE;
+}
+
+std::shared_future<BOOLEAN> Symbols::QueueSymbolsForModule( CString ModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule )
+{
+    std::shared_ptr<LoadJob> Job;
+    std::shared_future<BOOLEAN> Result;
+
+    std::lock_guard<std::mutex> Lock( m_JobMutex );
+
+    // Already queued or running
+    auto Pending = m_Pending.find( ModuleBaseAddress );
+    if (Pending != m_Pending.end( ))
+        return Pending->second->Future;
+
+    if (GetSymbolsForModuleAddress( ModuleBaseAddress ) != NULL)
+    {
+        std::promise<BOOLEAN> Loaded;
+        Loaded.set_value( TRUE );
+        return Loaded.get_future( ).share( );
+    }
+
+    Job = std::make_shared<LoadJob>( );
+    Job->ModulePath = ModulePath;
+    Job->ModuleBase = ModuleBaseAddress;
+    Job->ModuleSize = SizeOfModule;
+    Job->Generation = m_Generation;
+    Job->bDropped = false;
+    Result = Job->Result.get_future( ).share( );
+    Job->Future = Result;
+
+    m_Jobs.push_back( Job );
+    m_Pending[ModuleBaseAddress] = Job;
+    m_JobsQueued++;
+
+    // Workers are started on demand, most sessions never load symbols
+    if (m_Workers.size( ) < SYMBOL_LOAD_MAX_WORKERS && m_Workers.size( ) < m_Jobs.size( ))
+    {
+        UINT Cores = std::thread::hardware_concurrency( );
+        if (m_Workers.size( ) < max( Cores, 1u ))
+            m_Workers.emplace_back( &Symbols::WorkerThread, this );
+    }
+
+    m_JobReady.notify_one( );
+
+    return Result;
+}
+
+void Symbols::CancelQueuedLoads( )
+{
+    std::deque<std::shared_ptr<LoadJob>> Cancelled;
+
+    {
+        std::lock_guard<std::mutex> Lock( m_JobMutex );
+        Cancelled.swap( m_Jobs );
+        for (const auto& Job : Cancelled)
+            m_Pending.erase( Job->ModuleBase );
+        m_JobsQueued -= (ULONG)Cancelled.size( );
+        if (m_Pending.empty( ))
+            m_JobsDone = m_JobsQueued = 0;
+    }
+
+    // Loads already running can't be interrupted, they finish normally
+    for (const auto& Job : Cancelled)
+        Job->Result.set_value( FALSE );
+}
 
-    bSucc = pReader->LoadFile( ModuleName, ModulePath, ModuleBaseAddress, SizeOfModule, szSearchPath );
+void Symbols::DropProcessSymbols( )
+{
+    CancelQueuedLoads( );
 
+    {
+        std::lock_guard<std::mutex> Lock( m_JobMutex );
+        m_Generation++;
+        // Running loads belong to the old process, they don't count anymore
+        m_Pending.clear( );
+        m_JobsDone = m_JobsQueued = 0;
+    }
+
+    // A module of the new process can load at the same base as one of the old
+    ntdll::RtlEnterCriticalSection( &m_CriticalSection );
+    for (auto it = m_SymbolAddresses.begin( ); it != m_SymbolAddresses.end( ); ++it)
+        delete it->second;
+    m_SymbolAddresses.clear( );
     ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
+}
+
+void Symbols::DropModuleSymbols( ULONG_PTR ModuleBaseAddress )
+{
+    std::shared_ptr<LoadJob> Cancelled;
+    bool bDropped = false;
 
-    if (bSucc)
     {
-        PrintOut( _T( "[Symbols::LoadSymbolsForModule] Symbols for module %s loaded" ), ModuleName.GetString( ) );
-        m_SymbolAddresses.insert( std::make_pair( ModuleBaseAddress, pReader ) );
-        return TRUE;
+        std::lock_guard<std::mutex> Lock( m_JobMutex );
+
+        auto Pending = m_Pending.find( ModuleBaseAddress );
+        if (Pending != m_Pending.end( ))
+        {
+            std::shared_ptr<LoadJob> Job = Pending->second;
+            m_Pending.erase( Pending );
+
+            // A running load can't be interrupted, it is thrown away when it finishes
+            Job->bDropped = true;
+            bDropped = true;
+            m_JobsQueued--;
+
+            auto Queued = std::find( m_Jobs.begin( ), m_Jobs.end( ), Job );
+            if (Queued != m_Jobs.end( ))
+            {
+                m_Jobs.erase( Queued );
+                Cancelled = Job;
+            }
+
+            if (m_Pending.empty( ))
+                m_JobsDone = m_JobsQueued = 0;
+        }
     }
 
-    delete pReader;
+    if (Cancelled)
+        Cancelled->Result.set_value( FALSE );
 
-    return FALSE;
+    // The progress shown no longer counts this module
+    if (bDropped && m_hNotifyWnd != NULL)
+        ::PostMessage( m_hNotifyWnd, WM_SYMBOLSLOADED, FALSE, 0 );
+
+    // The next module can load at the same base
+    ntdll::RtlEnterCriticalSection( &m_CriticalSection );
+    auto Loaded = m_SymbolAddresses.find( ModuleBaseAddress );
+    if (Loaded != m_SymbolAddresses.end( ))
+    {
+        delete Loaded->second;
+        m_SymbolAddresses.erase( Loaded );
+    }
+    ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
+}
+
+void Symbols::GetLoadProgress( ULONG* Done, ULONG* Total )
+{
+    std::lock_guard<std::mutex> Lock( m_JobMutex );
+    *Done = m_JobsDone;
+    *Total = m_JobsQueued;
+}
+
+void Symbols::StopWorkers( )
+{
+    CancelQueuedLoads( );
+
+    {
+        std::lock_guard<std::mutex> Lock( m_JobMutex );
+        m_bStopWorkers = true;
+    }
+    m_JobReady.notify_all( );
+
+    for (std::thread& Worker : m_Workers)
+        Worker.join( );
+    m_Workers.clear( );
+}
+
+void Symbols::WorkerThread( )
+{
+    CoInitializeEx( NULL, COINIT_MULTITHREADED );
+
+    for (;;)
+    {
+        std::shared_ptr<LoadJob> Job;
+
+        {
+            std::unique_lock<std::mutex> Lock( m_JobMutex );
+            m_JobReady.wait( Lock, [this] { return m_bStopWorkers || !m_Jobs.empty( ); } );
+            if (m_Jobs.empty( ))
+                break;
+            Job = m_Jobs.front( );
+            m_Jobs.pop_front( );
+        }
+
+        SymbolReader* pReader = ReadModuleSymbols( Job->ModulePath, Job->ModuleBase, Job->ModuleSize );
+        bool bCurrent;
+
+        {
+            // Published under the job lock so a new attach can't slip in between
+            std::lock_guard<std::mutex> Lock( m_JobMutex );
+            bCurrent = (Job->Generation == m_Generation && !Job->bDropped);
+            if (bCurrent)
+            {
+                if (pReader != NULL)
+                    PublishModuleSymbols( Job->ModuleBase, pReader );
+
+                m_Pending.erase( Job->ModuleBase );
+                m_JobsDone++;
+                // Start counting from zero again once a batch is through
+                if (m_JobsDone == m_JobsQueued && m_Jobs.empty( ) && m_Pending.empty( ))
+                    m_JobsDone = m_JobsQueued = 0;
+            }
+            else
+            {
+                delete pReader;
+                pReader = NULL;
+            }
+        }
+
+        Job->Result.set_value( pReader != NULL ? TRUE : FALSE );
+
+        if (bCurrent && m_hNotifyWnd != NULL)
+            ::PostMessage( m_hNotifyWnd, WM_SYMBOLSLOADED, (WPARAM)(pReader != NULL), 0 );
+    }
+
+    CoUninitialize( );
 }
 
 BOOLEAN Symbols::LoadSymbolsForPdb( CString PdbPath )
@@ -210,16 +439,15 @@ BOOLEAN Symbols::LoadSymbolsForPdb( CString PdbPath )
 
     reader = new SymbolReader( );
 
-    ntdll::RtlEnterCriticalSection( &m_CriticalSection );
-
     bSucc = reader->LoadFile( PdbFileName, PdbPath, 0, 0, szSearchPath );
 
-    ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
-
     if (bSucc)
     {
         PrintOut( _T( "[Symbols::LoadSymbolsForPdb] Symbols for module %s loaded" ), PdbFileName.GetString( ) );
-        m_SymbolNames.insert( std::make_pair( PdbFileName, reader ) );
+        ntdll::RtlEnterCriticalSection( &m_CriticalSection );
+        if (!m_SymbolNames.insert( std::make_pair( PdbFileName, reader ) ).second)
+            delete reader;
+        ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
         return TRUE;
     }
 
@@ -321,18 +549,22 @@ BOOLEAN Symbols::LoadSymbolsForPdb( CString PdbPath )
 SymbolReader* Symbols::GetSymbolsForModuleAddress( ULONG_PTR ModuleAddress )
 {
     SymbolReader* script = NULL;
+    ntdll::RtlEnterCriticalSection( &m_CriticalSection );
     auto iter = m_SymbolAddresses.find( ModuleAddress );
     if (iter != m_SymbolAddresses.end( ))
         script = iter->second;
+    ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
     return script;
 }
 
 SymbolReader* Symbols::GetSymbolsForModuleName( CString ModuleName )
 {
     SymbolReader* script = NULL;
+    ntdll::RtlEnterCriticalSection( &m_CriticalSection );
     auto iter = m_SymbolNames.find( ModuleName );
     if (iter != m_SymbolNames.end( ))
         script = iter->second;
+    ntdll::RtlLeaveCriticalSection( &m_CriticalSection );
     return script;
 }
 
@@ -2,6 +2,26 @@
 
 #include "SymbolReader.h"
 #include <map>
+#include <deque>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//
+// Symbol loading runs on a small pool of worker threads. Each queued module
+// gets a future; when its PDB is loaded the SymbolReader is inserted into the
+// lookup maps under the lock, so nodes simply render without symbols until
+// then. Every finished job posts WM_SYMBOLSLOADED to the notify window with
+// wParam = success.
+//
+// Jobs carry the attach generation they were queued in. DropProcessSymbols
+// starts a new one when another process is attached, loads of the old
+// process that are still running are thrown away when they finish.
+// DropModuleSymbols does the same for one module that was unloaded.
+//
+#define SYMBOL_LOAD_MAX_WORKERS 4
 
 class Symbols
 {
@@ -19,11 +39,35 @@ public:
     BOOLEAN LoadSymbolsForModule( CString szModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule );
     BOOLEAN LoadSymbolsForPdb( CString szPdbPath );
 
+    std::shared_future<BOOLEAN> QueueSymbolsForModule( CString szModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule );
+    void CancelQueuedLoads( );
+    void DropProcessSymbols( );
+    // UI thread, the module at ModuleBaseAddress was unloaded
+    void DropModuleSymbols( ULONG_PTR ModuleBaseAddress );
+    void GetLoadProgress( ULONG* Done, ULONG* Total );
+    void SetNotifyWindow( HWND hWnd ) { m_hNotifyWnd = hWnd; }
+
     SymbolReader* GetSymbolsForModuleAddress( ULONG_PTR ModuleAddress );
     SymbolReader* GetSymbolsForModuleName( CString ModuleName );
 
 private:
-    RTL_CRITICAL_SECTION m_CriticalSection;
+    struct LoadJob
+    {
+        CString ModulePath;
+        ULONG_PTR ModuleBase;
+        ULONG ModuleSize;
+        ULONG Generation;
+        bool bDropped;      // The module was unloaded while this was queued or loading
+        std::promise<BOOLEAN> Result;
+        std::shared_future<BOOLEAN> Future;
+    };
+
+    SymbolReader* ReadModuleSymbols( const CString& ModulePath, ULONG_PTR ModuleBaseAddress, ULONG SizeOfModule );
+    void PublishModuleSymbols( ULONG_PTR ModuleBaseAddress, SymbolReader* pReader );
+    void StopWorkers( );
+    void WorkerThread( );
+
+    RTL_CRITICAL_SECTION m_CriticalSection; // Guards the lookup maps
 
     std::map<CString, SymbolReader*> m_SymbolNames;
     std::map<ULONG_PTR, SymbolReader*> m_SymbolAddresses;
@@ -31,4 +75,15 @@ private:
     BOOLEAN m_bInitialized;
 
     CString m_strSearchPath;
+
+    std::vector<std::thread> m_Workers;
+    std::deque<std::shared_ptr<LoadJob>> m_Jobs;
+    std::map<ULONG_PTR, std::shared_ptr<LoadJob>> m_Pending;   // Queued or running, by module base
+    std::mutex m_JobMutex;
+    std::condition_variable m_JobReady;
+    bool m_bStopWorkers;
+    ULONG m_JobsQueued;
+    ULONG m_JobsDone;
+    ULONG m_Generation;
+    HWND m_hNotifyWnd;
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+//
+// Text formatting
+//
+// The fixed formats every row draws (hex bytes, offsets, addresses and the
+// printable preview of memory) written straight into a caller's buffer
+// instead of going through the CRT's printf parser. Each helper produces
+// exactly what the printf format it is named after would, and NUL
+// terminates the output.
+//
+// Header only and free of Windows types so the benchmarks build it on Linux.
+//
+#include "PrintableText.h"
+
+#include <stdint.h>
+
+#if !defined(FORCEINLINE)
+#if defined(_MSC_VER)
+#define FORCEINLINE __forceinline
+#else
+#define FORCEINLINE inline __attribute__((always_inline))
+#endif
+#endif
+
+#define TEXT_FORMAT_MAX 1024
+
+// "%0.<MinDigits>X" / "%0.<MinDigits>I64X", Out needs room for 17 characters
+template<int MinDigits, typename CharT>
+FORCEINLINE int FormatHex( CharT* Out, uint64_t Value )
+{
+    static_assert(MinDigits >= 1 && MinDigits <= 16, "FormatHex: 1 to 16 digits");
+    static const char HexDigits[] = "0123456789ABCDEF";
+
+    int Length = MinDigits;
+    while (Length < 16 && (Value >> (Length * 4)) != 0)
+        Length++;
+
+    for (int i = Length - 1; i >= 0; i--)
+    {
+        Out[i] = (CharT)HexDigits[Value & 0xF];
+        Value >>= 4;
+    }
+
+    Out[Length] = 0;
+    return Length;
+}
+
+//
+// Memory as text, '.' for anything that isn't printable (PrintableText.h).
+// Out needs room for Length + 1.
+//
+template<typename CharT, typename OutT>
+FORCEINLINE int FormatPrintable( OutT* Out, const CharT* pMemory, int Length )
+{
+    SanitizePrintable( Out, pMemory, (size_t)Length );
+    Out[Length] = 0;
+    return Length;
+}
@@ -0,0 +1,399 @@
+//
+// XML pull reader. Deliberately free of MFC and the precompiled header so it
+// builds on the Linux analysis hosts as well.
+//
+#include "XmlPullReader.h"
+
+#include <string.h>
+
+static inline bool IsWhitespace( char c )
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Same name rules as tinyxml2, anything outside ASCII is a letter
+static inline bool IsNameStartChar( char c )
+{
+    return (unsigned char)c >= 0x80 || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+}
+
+static inline bool IsNameChar( char c )
+{
+    return IsNameStartChar( c ) || (c >= '0' && c <= '9') || c == '.' || c == '-';
+}
+
+static bool StartsWith( const char* Data, size_t Size, size_t Position, const char* Prefix )
+{
+    size_t Length = strlen( Prefix );
+    return Position <= Size && Length <= Size - Position && memcmp( Data + Position, Prefix, Length ) == 0;
+}
+
+// Position just past Pattern, std::string::npos if it doesn't occur
+static size_t SkipPast( const char* Data, size_t Size, size_t Position, const char* Pattern )
+{
+    size_t Length = strlen( Pattern );
+    for (; Position < Size && Length <= Size - Position; Position++)
+    {
+        if (Data[Position] == Pattern[0] && memcmp( Data + Position, Pattern, Length ) == 0)
+            return Position + Length;
+    }
+    return std::string::npos;
+}
+
+static void AppendUtf8( std::string& Out, uint32_t CodePoint )
+{
+    if (CodePoint < 0x80)
+    {
+        Out.push_back( (char)CodePoint );
+    }
+    else if (CodePoint < 0x800)
+    {
+        Out.push_back( (char)(0xC0 | (CodePoint >> 6)) );
+        Out.push_back( (char)(0x80 | (CodePoint & 0x3F)) );
+    }
+    else if (CodePoint < 0x10000)
+    {
+        Out.push_back( (char)(0xE0 | (CodePoint >> 12)) );
+        Out.push_back( (char)(0x80 | ((CodePoint >> 6) & 0x3F)) );
+        Out.push_back( (char)(0x80 | (CodePoint & 0x3F)) );
+    }
+    else
+    {
+        Out.push_back( (char)(0xF0 | (CodePoint >> 18)) );
+        Out.push_back( (char)(0x80 | ((CodePoint >> 12) & 0x3F)) );
+        Out.push_back( (char)(0x80 | ((CodePoint >> 6) & 0x3F)) );
+        Out.push_back( (char)(0x80 | (CodePoint & 0x3F)) );
+    }
+}
+
+//
+// Entity at Data[0] ('&'), Length bytes up to and including the ';'. Unknown
+// entities are kept as they are, like tinyxml2 does.
+//
+static bool DecodeEntity( std::string& Out, const char* Data, size_t Length )
+{
+    static const struct { const char* Name; char Value; } Named[] = {
+        { "&lt;", '<' }, { "&gt;", '>' }, { "&amp;", '&' }, { "&quot;", '"' }, { "&apos;", '\'' }
+    };
+
+    for (size_t i = 0; i < sizeof( Named ) / sizeof( Named[0] ); i++)
+    {
+        if (strlen( Named[i].Name ) == Length && memcmp( Data, Named[i].Name, Length ) == 0)
+        {
+            Out.push_back( Named[i].Value );
+            return true;
+        }
+    }
+
+    if (Length < 4 || Data[1] != '#')
+        return false;
+
+    bool bHex = (Data[2] == 'x' || Data[2] == 'X');
+    size_t First = bHex ? 3 : 2;
+    uint32_t CodePoint = 0;
+
+    if (First >= Length - 1)
+        return false;
+
+    for (size_t i = First; i < Length - 1; i++)
+    {
+        char c = Data[i];
+        uint32_t Digit;
+
+        if (c >= '0' && c <= '9')
+            Digit = c - '0';
+        else if (bHex && c >= 'a' && c <= 'f')
+            Digit = c - 'a' + 10;
+        else if (bHex && c >= 'A' && c <= 'F')
+            Digit = c - 'A' + 10;
+        else
+            return false;
+
+        CodePoint = CodePoint * (bHex ? 16 : 10) + Digit;
+        if (CodePoint > 0x10FFFF)
+            return false;
+    }
+
+    AppendUtf8( Out, CodePoint );
+    return true;
+}
+
+CXmlPullReader::CXmlPullReader( const char* Data, size_t Size )
+    : m_Data( Data )
+    , m_Size( Data != NULL ? Size : 0 )
+    , m_Position( 0 )
+    , m_ErrorPosition( 0 )
+    , m_Depth( 0 )
+    , m_bPendingEnd( false )
+    , m_bRootClosed( false )
+    , m_bDone( false )
+    , m_bFailed( false )
+{
+    m_Decoded.push_back( '\0' );
+
+    // UTF-8 byte order mark
+    if (StartsWith( m_Data, m_Size, 0, "\xEF\xBB\xBF" ))
+        m_Position = 3;
+}
+
+CXmlPullReader::Token CXmlPullReader::Fail( size_t Position )
+{
+    m_bFailed = true;
+    m_ErrorPosition = Position;
+    return XML_ERROR;
+}
+
+uint32_t CXmlPullReader::GetErrorLine( ) const
+{
+    uint32_t Line = 1;
+    for (size_t i = 0; i < m_ErrorPosition && i < m_Size; i++)
+    {
+        if (m_Data[i] == '\n')
+            Line++;
+    }
+    return Line;
+}
+
+void CXmlPullReader::SkipWhitespace( )
+{
+    while (m_Position < m_Size && IsWhitespace( m_Data[m_Position] ))
+        m_Position++;
+}
+
+const char* CXmlPullReader::GetAttribute( const char* Name ) const
+{
+    for (size_t Offset : m_Attributes)
+    {
+        const char* AttributeName = m_Decoded.data( ) + Offset;
+        if (strcmp( AttributeName, Name ) == 0)
+            return AttributeName + strlen( AttributeName ) + 1;
+    }
+    return NULL;
+}
+
+CXmlPullReader::Token CXmlPullReader::Next( )
+{
+    if (m_bFailed)
+        return XML_ERROR;
+    if (m_bDone)
+        return XML_DONE;
+
+    if (m_bPendingEnd)
+    {
+        // Same name and depth as the start that closed itself
+        m_bPendingEnd = false;
+        m_Attributes.clear( );
+        m_bRootClosed = m_Open.empty( );
+        return XML_END;
+    }
+
+    for (;;)
+    {
+        // Text between tags isn't used by anything reading this
+        while (m_Position < m_Size && m_Data[m_Position] != '<')
+            m_Position++;
+
+        if (m_Position >= m_Size)
+        {
+            if (!m_bRootClosed)
+                return Fail( m_Size );
+            m_bDone = true;
+            return XML_DONE;
+        }
+
+        if (!SkipMarkup( ))
+        {
+            if (m_bFailed)
+                return XML_ERROR;
+            break;
+        }
+    }
+
+    // Only the first root element is read
+    if (m_bRootClosed)
+    {
+        m_bDone = true;
+        return XML_DONE;
+    }
+
+    if (StartsWith( m_Data, m_Size, m_Position, "</" ))
+        return ReadEndTag( );
+    return ReadStartTag( );
+}
+
+//
+// Comments, processing instructions, CDATA and the doctype. False if
+// m_Position is on a tag instead.
+//
+bool CXmlPullReader::SkipMarkup( )
+{
+    static const struct { const char* Open; const char* Close; } Markup[] = {
+        { "<?", "?>" }, { "<!--", "-->" }, { "<![CDATA[", "]]>" }, { "<!", ">" }
+    };
+
+    for (size_t i = 0; i < sizeof( Markup ) / sizeof( Markup[0] ); i++)
+    {
+        if (StartsWith( m_Data, m_Size, m_Position, Markup[i].Open ))
+        {
+            size_t End = SkipPast( m_Data, m_Size, m_Position + strlen( Markup[i].Open ), Markup[i].Close );
+            if (End == std::string::npos)
+            {
+                Fail( m_Position );
+                return false;
+            }
+            m_Position = End;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CXmlPullReader::ReadName( size_t& Start, size_t& Length )
+{
+    Start = m_Position;
+    if (m_Position >= m_Size || !IsNameStartChar( m_Data[m_Position] ))
+        return false;
+
+    while (m_Position < m_Size && IsNameChar( m_Data[m_Position] ))
+        m_Position++;
+
+    Length = m_Position - Start;
+    return true;
+}
+
+bool CXmlPullReader::ReadValue( char Quote )
+{
+    while (m_Position < m_Size)
+    {
+        char c = m_Data[m_Position];
+
+        if (c == Quote)
+        {
+            m_Position++;
+            m_Decoded.push_back( '\0' );
+            return true;
+        }
+
+        if (c == '&')
+        {
+            size_t End = m_Position + 1;
+            while (End < m_Size && End - m_Position < 12 && m_Data[End] != ';' && m_Data[End] != Quote)
+                End++;
+
+            if (End < m_Size && m_Data[End] == ';' && DecodeEntity( m_Decoded, m_Data + m_Position, End - m_Position + 1 ))
+            {
+                m_Position = End + 1;
+                continue;
+            }
+        }
+
+        // "\r\n", "\n\r" and a lone '\r' all become '\n'
+        if (c == '\r' || c == '\n')
+        {
+            m_Decoded.push_back( '\n' );
+            m_Position++;
+            if (m_Position < m_Size && m_Data[m_Position] == (c == '\r' ? '\n' : '\r'))
+                m_Position++;
+            continue;
+        }
+
+        m_Decoded.push_back( c );
+        m_Position++;
+    }
+
+    return false;
+}
+
+CXmlPullReader::Token CXmlPullReader::ReadStartTag( )
+{
+    size_t TagStart = m_Position;
+    size_t NameStart, NameLength;
+
+    m_Position++;
+    if (!ReadName( NameStart, NameLength ))
+        return Fail( TagStart );
+
+    m_Decoded.assign( m_Data + NameStart, NameLength );
+    m_Decoded.push_back( '\0' );
+    m_Attributes.clear( );
+
+    for (;;)
+    {
+        SkipWhitespace( );
+        if (m_Position >= m_Size)
+            return Fail( TagStart );
+
+        if (m_Data[m_Position] == '>' || m_Data[m_Position] == '/')
+            break;
+
+        size_t AttributeStart, AttributeLength;
+        if (!ReadName( AttributeStart, AttributeLength ))
+            return Fail( m_Position );
+
+        SkipWhitespace( );
+        if (m_Position >= m_Size || m_Data[m_Position] != '=')
+            return Fail( m_Position );
+        m_Position++;
+
+        SkipWhitespace( );
+        if (m_Position >= m_Size || (m_Data[m_Position] != '"' && m_Data[m_Position] != '\''))
+            return Fail( m_Position );
+
+        char Quote = m_Data[m_Position++];
+
+        m_Attributes.push_back( m_Decoded.size( ) );
+        m_Decoded.append( m_Data + AttributeStart, AttributeLength );
+        m_Decoded.push_back( '\0' );
+
+        if (!ReadValue( Quote ))
+            return Fail( AttributeStart );
+    }
+
+    m_Depth = (uint32_t)m_Open.size( ) + 1;
+
+    if (m_Data[m_Position] == '/')
+    {
+        if (!StartsWith( m_Data, m_Size, m_Position, "/>" ))
+            return Fail( m_Position );
+        m_Position += 2;
+        m_bPendingEnd = true;
+        return XML_START;
+    }
+
+    m_Position++;
+
+    OpenElement Element;
+    Element.Offset = NameStart;
+    Element.Length = NameLength;
+    m_Open.push_back( Element );
+    return XML_START;
+}
+
+CXmlPullReader::Token CXmlPullReader::ReadEndTag( )
+{
+    size_t TagStart = m_Position;
+    size_t NameStart, NameLength;
+
+    m_Position += 2;
+    if (!ReadName( NameStart, NameLength ))
+        return Fail( TagStart );
+
+    SkipWhitespace( );
+    if (m_Position >= m_Size || m_Data[m_Position] != '>')
+        return Fail( TagStart );
+    m_Position++;
+
+    if (m_Open.empty( ) ||
+        m_Open.back( ).Length != NameLength ||
+        memcmp( m_Data + m_Open.back( ).Offset, m_Data + NameStart, NameLength ) != 0)
+        return Fail( TagStart );
+
+    m_Decoded.assign( m_Data + NameStart, NameLength );
+    m_Decoded.push_back( '\0' );
+    m_Attributes.clear( );
+
+    m_Depth = (uint32_t)m_Open.size( );
+    m_Open.pop_back( );
+    m_bRootClosed = m_Open.empty( );
+    return XML_END;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+//
+// XML pull reader
+//
+// Walks an XML document that is already in memory (mapped) one tag at a time,
+// without building a DOM. Next( ) returns the next start or end tag; a
+// self-closing <Tag/> is reported as a start followed by its end. Text,
+// comments, processing instructions and the doctype are skipped.
+//
+// Only the current tag's name and attributes are decoded (entities expanded,
+// line endings normalized the way tinyxml2 does), into a buffer that is reused
+// for every tag. Memory stays at the size of the largest tag plus the open
+// element stack, whatever the size of the document.
+//
+// Portable like the memory sources, no precompiled header.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class CXmlPullReader {
+public:
+    enum Token {
+        XML_START,
+        XML_END,
+        XML_DONE,       // The root element was closed, nothing but comments after it
+        XML_ERROR
+    };
+
+    // Data has to stay valid while the reader is used
+    CXmlPullReader( const char* Data, size_t Size );
+
+    Token Next( );
+
+    // Current tag, valid until the next call to Next( )
+    inline const char* GetName( ) const { return m_Decoded.data( ); }
+
+    // 1 for the root element, the same for a tag's start and end
+    inline uint32_t GetDepth( ) const { return m_Depth; }
+
+    // NULL if the current start tag doesn't have the attribute
+    const char* GetAttribute( const char* Name ) const;
+
+    // 1 based line of the first error
+    uint32_t GetErrorLine( ) const;
+
+private:
+    struct OpenElement {
+        size_t Offset;      // Of the name in the document
+        size_t Length;
+    };
+
+    Token Fail( size_t Position );
+
+    bool SkipMarkup( );
+    Token ReadStartTag( );
+    Token ReadEndTag( );
+    bool ReadName( size_t& Start, size_t& Length );
+    bool ReadValue( char Quote );
+    void SkipWhitespace( );
+
+    const char* m_Data;
+    size_t m_Size;
+    size_t m_Position;
+    size_t m_ErrorPosition;
+
+    uint32_t m_Depth;
+    bool m_bPendingEnd;     // The last start tag closed itself
+    bool m_bRootClosed;
+    bool m_bDone;
+    bool m_bFailed;
+
+    std::vector<OpenElement> m_Open;
+
+    // Name, then name/value pairs, all NUL terminated
+    std::string m_Decoded;
+    std::vector<size_t> m_Attributes;   // Offsets of the attribute names
+};
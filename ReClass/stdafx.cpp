@@ -12,6 +12,8 @@ DWORD g_AttachedProcessSize = NULL;
 CString g_ProcessName;
 CString g_ProcessPath;
 
+HWND g_hPrintOutWnd = NULL;
+
 bool IsProcessExists()
 {
     if (g_ProcessName.IsEmpty()) return false;
@@ -58,41 +60,12 @@ void CReattachButton::ResetIcon()
     reattach_button->m_hIcon = nullptr;
 }
 
-/*
-    Memory and module map info
-        
-    ReClass makes it easy to tell at a glance whether a value could be a pointer.
-    When a node is drawn and it hasn't been assigned a type, it will show an extra
-    tag at the end ( e.g. '-> 0x0BADF00D') in red if the data can be interpreted 
-    as a pointer to a mapped portion of memory.  
-
-    To know whether a value is a valid address in the target process' memory space,
-    we maintain a copy of the meta data of the target process' memory map.  This is
-    represented by a map keyed on the last byte of each memory region, with the value
-    at each key being a MemMapInfo class containing the start, end, and size of the 
-    memory region.  The regions are keyed by last byte so that map->lower_bound(addr)
-    will return an iterator to the region thst starts *BEFORE* addr, and then the
-    addr need only be checked to come before the regions last byte to confirm that the
-    addr is within the region.
-
-    We use a map because we have to find what region things are in a *LOT*, and we 
-    typically have a *LOT* of regions.  In my testing, I ended up with ~280,000 regions
-    in our MemMap.  If we had to iterate through that list to find the region containing
-    an address every time we drew a default node, ReClass's performance would slow to a
-    crawl.
-*/
-std::map<ULONG_PTR, MemMapInfo>     g_MemMap;
-std::vector<MemMapInfo>             g_MemMapCode;
-std::vector<MemMapInfo>             g_MemMapData;
-std::map<ULONG_PTR, MemMapInfo>     g_MemMapModules;
-std::vector<AddressName>            g_Exports;
-std::vector<AddressName>            g_CustomNames;
-
 std::vector<HICON> g_Icons;
 
 COLORREF g_clrBackground = RGB(30, 30, 30);         // dark background
 COLORREF g_clrSelect = RGB(45, 45, 48);         // VS selection background
 COLORREF g_clrHidden = RGB(30, 30, 30);         // same as background
+COLORREF g_clrChanged = RGB(90, 70, 30);        // dim amber (just changed values)
 
 COLORREF g_clrOffset = RGB(255, 128, 128);      // reddish (addresses, e.g., line numbers)
 COLORREF g_clrAddress = RGB(220, 220, 220);      // neutral gray (default text color)
@@ -129,6 +102,8 @@ bool g_bInt = true;
 bool g_bString = true;
 bool g_bPointers = true;
 bool g_bUnsignedHex = true;
+bool g_bHighlightChanges = true;
+DWORD g_ChangeFadeFrames = 8;
 
 bool g_bTop = true;
 bool g_bClassBrowser = true;
@@ -136,31 +111,54 @@ bool g_bFilterProcesses = false;
 bool g_bPrivatePadding = false;
 bool g_bClipboardCopy = false;
 
+DWORD g_ReadCacheBudget = 16 * 1024 * 1024;
+DWORD g_ReadCacheCodeTtl = 5000;
+DWORD g_ReadCacheDataTtl = 50;
+
+DWORD g_RefreshFocused = 250;
+DWORD g_RefreshBackground = 1000;
+
+DWORD g_ViewGeneration = 1;
+
 RCTYPEDEFS g_Typedefs;
 
 DWORD g_NodeCreateIndex = 0;
 
 BOOL ReClassReadMemory( LPVOID Address, LPVOID Buffer, SIZE_T Size, PSIZE_T BytesRead )
 {
-    if (g_PluginOverrideReadMemoryOperation != NULL)
-        return g_PluginOverrideReadMemoryOperation( Address, Buffer, Size, BytesRead );
-
-    SecureZeroMemory(Buffer, Size);
-    BOOL return_val = ReadProcessMemory( g_hProcess, (LPVOID)Address, Buffer, Size, BytesRead );
-    //if (!return_val) SecureZeroMemory( Buffer, Size );
-    return return_val;
+    CReadPlanner* pPlanner = CReadPlanner::GetActive( );
+    if (pPlanner != NULL)
+        return pPlanner->Read( (ULONG_PTR)Address, Buffer, Size, BytesRead );
+
+    SIZE_T Read = 0;
+    BOOL bResult = ReClassGetMemorySource( )->Read( (ULONG_PTR)Address, Buffer, Size, &Read ) ? TRUE : FALSE;
+    if (BytesRead)
+        *BytesRead = Read;
+    return bResult;
 }
 
 BOOL ReClassWriteMemory( LPVOID Address, LPVOID Buffer, SIZE_T Size, PSIZE_T BytesWritten )
 {
-    if (g_PluginOverrideWriteMemoryOperation != NULL)
-        return g_PluginOverrideWriteMemoryOperation( Address, Buffer, Size, BytesWritten );
-
-    DWORD OldProtect;
-    VirtualProtectEx( g_hProcess, (void*)Address, Size, PAGE_EXECUTE_READWRITE, &OldProtect );
-    BOOL ret = WriteProcessMemory( g_hProcess, (PVOID)Address, Buffer, Size, BytesWritten );
-    VirtualProtectEx( g_hProcess, (void*)Address, Size, OldProtect, NULL );
-    return ret;
+    SIZE_T Written = 0;
+    BOOL bResult = ReClassGetMemorySource( )->Write( (ULONG_PTR)Address, Buffer, Size, &Written ) ? TRUE : FALSE;
+    if (BytesWritten)
+        *BytesWritten = Written;
+    return bResult;
+}
+
+void ReClassPrintText( const TCHAR* Text )
+{
+    if (GetCurrentThreadId( ) == g_ReClassApp.m_nThreadID)
+    {
+        if (g_ReClassApp.m_pConsole != NULL)
+            g_ReClassApp.m_pConsole->PrintText( Text );
+        return;
+    }
+
+    // The console is a window of the UI thread, the main frame prints it there
+    CString* Line = new CString( Text );
+    if (g_hPrintOutWnd == NULL || !::PostMessage( g_hPrintOutWnd, WM_PRINTOUT, 0, (LPARAM)Line ))
+        delete Line;
 }
 
 HANDLE ReClassOpenProcess( DWORD dwDesiredAccess, BOOL bInheritHandle, DWORD dwProcessID )
@@ -184,13 +182,10 @@ CStringA ReadMemoryStringA( ULONG_PTR address, SIZE_T max )
 
     if (ReClassReadMemory( (PVOID)address, (LPVOID)buffer.get( ), max, &bytesRead ) != 0)
     {
-        for (size_t i = 0; i < bytesRead; i++)
-        {
-            if (!(buffer[i] > 0x1F && buffer[i] < 0xFF && buffer[i] != 0x7F) && buffer[i] != '\0')
-                buffer[i] = '.';
-        }
-        buffer[bytesRead] = '\0';
-        return CStringA( buffer.get( ) );
+        // The string ends at the first NUL, only what comes before it is shown
+        size_t length = strnlen( buffer.get( ), bytesRead );
+        SanitizePrintable( buffer.get( ), buffer.get( ), length );
+        return CStringA( buffer.get( ), (int)length );
     }
     else
     {
@@ -208,15 +203,9 @@ CStringW ReadMemoryStringW( ULONG_PTR address, SIZE_T max )
 
     if (ReClassReadMemory( (PVOID)address, (LPVOID)buffer.get( ), max * sizeof( wchar_t ), &bytesRead ) != 0)
     {
-        bytesRead /= sizeof( wchar_t );
-
-        for (size_t i = 0; i < bytesRead; i++)
-        {
-            if (!(buffer[i] > 0x1F && buffer[i] < 0xFF && buffer[i] != 0x7F) && buffer[i] != '\0')
-                buffer[i] = '.';
-        }
-        buffer[bytesRead] = '\0';
-        return CStringW( buffer.get( ) );
+        size_t length = wcsnlen( buffer.get( ), bytesRead / sizeof( wchar_t ) );
+        SanitizePrintable( buffer.get( ), buffer.get( ), length );
+        return CStringW( buffer.get( ), (int)length );
     }
     else
     {
@@ -323,7 +312,7 @@ BOOLEAN PauseResumeThreadList( BOOL bResumeThread )
 
 ULONG_PTR GetBaseAddress( )
 {
-    if (g_MemMap.size( ) > 1)
+    if (GetMemoryMap( )->Regions.size( ) > 1)
         return g_AttachedProcessAddress;
     #ifdef _WIN64
     return (ULONG_PTR)0x140000000;
@@ -333,29 +322,20 @@ ULONG_PTR GetBaseAddress( )
 }
 
 BOOLEAN IsCode( ULONG_PTR Address )
-{    
-    for (size_t i = 0; i < g_MemMapCode.size( ); i++)
-    {
-        if ((Address >= g_MemMapCode[i].Start) && (Address <= g_MemMapCode[i].End))
-            return TRUE;
-    }
-    return FALSE;
+{
+    return GetMemoryMap( )->Index.FindCode( Address ) != NULL;
 }
 
 BOOLEAN IsData( ULONG_PTR Address )
 {
-    for (size_t i = 0; i < g_MemMapData.size( ); i++)
-    {
-        if ((Address >= g_MemMapData[i].Start) && (Address <= g_MemMapData[i].End))
-            return true;
-    }
-    return false;
+    return GetMemoryMap( )->Index.FindData( Address ) != NULL;
 }
 
 BOOLEAN IsMemory( ULONG_PTR Address )
 {
-    auto containingBlock = g_MemMap.lower_bound(Address);
-    if (containingBlock != g_MemMap.end()
+    MemoryMapPtr Map = GetMemoryMap( );
+    auto containingBlock = Map->Regions.lower_bound(Address);
+    if (containingBlock != Map->Regions.end()
         && containingBlock->second.Start <= Address) {
         return true;
     }
@@ -364,26 +344,15 @@ BOOLEAN IsMemory( ULONG_PTR Address )
 
 BOOLEAN IsModule( ULONG_PTR Address )
 {
-    return GetModule(Address) != nullptr;
-}
-
-const MemMapInfo* GetModule(ULONG_PTR Address)
-{
-    auto containingModule = g_MemMapModules.lower_bound(Address);
-    if (containingModule != g_MemMapModules.end()
-        && containingModule->second.Start <= Address) {
-        return &containingModule->second;
-    }    
-    return nullptr;
+    return GetModule(*GetMemoryMap( ), Address) != nullptr;
 }
 
 ULONG_PTR GetModuleBaseFromAddress( ULONG_PTR Address )
 {
-    auto containingModule = g_MemMapModules.lower_bound(Address);
-    if (containingModule != g_MemMapModules.end()
-        && containingModule->second.Start <= Address) {
-        return containingModule->second.Start;
-    }
+    MemoryMapPtr Map = GetMemoryMap( );
+    const MemMapInfo* module = GetModule(*Map, Address);
+    if (module != nullptr)
+        return module->Start;
     
     return 0;
 }
@@ -391,61 +360,43 @@ ULONG_PTR GetModuleBaseFromAddress( ULONG_PTR Address )
 CString GetAddressName( ULONG_PTR Address, BOOLEAN bJustAddress )
 {
     CString txt;
-    size_t i = 0;
+    const CString* Name;
+    MemoryMapPtr Map = GetMemoryMap( );
 
-    for (i = 0; i < g_CustomNames.size( ); i++)
+    Name = Map->Index.FindName( Address );
+    if (Name != NULL)
     {
-        if (Address == g_CustomNames[i].Address)
-        {
-            #ifdef _WIN64
-            txt.Format( _T( "%s.%IX" ), g_CustomNames[i].Name, Address );
-            #else
-            txt.Format( _T( "%s.%X" ), g_CustomNames[i].Name, Address );
-            #endif
-            return txt;
-        }
-    }
-
-    for (i = 0; i < g_Exports.size( ); i++)
-    {
-        if (Address == g_Exports[i].Address)
-        {
-            #ifdef _WIN64
-            txt.Format( _T( "%s.%IX" ), g_Exports[i].Name, Address );
-            #else
-            txt.Format( _T( "%s.%X" ), g_Exports[i].Name, Address );
-            #endif
-            return txt;
-        }
+        #ifdef _WIN64
+        txt.Format( _T( "%s.%IX" ), Name->GetString( ), Address );
+        #else
+        txt.Format( _T( "%s.%X" ), Name->GetString( ), Address );
+        #endif
+        return txt;
     }
 
-    for (i = 0; i < g_MemMapCode.size( ); i++)
+    Name = Map->Index.FindCode( Address );
+    if (Name != NULL)
     {
-        if ((Address >= g_MemMapCode[i].Start) && (Address <= g_MemMapCode[i].End))
-        {
-            #ifdef _WIN64
-            txt.Format( _T( "<CODE>%s.%IX" ), g_MemMapCode[i].Name, Address );
-            #else
-            txt.Format( _T( "<CODE>%s.%X" ), g_MemMapCode[i].Name, Address );
-            #endif
-            return txt;
-        }
+        #ifdef _WIN64
+        txt.Format( _T( "<CODE>%s.%IX" ), Name->GetString( ), Address );
+        #else
+        txt.Format( _T( "<CODE>%s.%X" ), Name->GetString( ), Address );
+        #endif
+        return txt;
     }
 
-    for (i = 0; i < g_MemMapData.size( ); i++)
+    Name = Map->Index.FindData( Address );
+    if (Name != NULL)
     {
-        if ((Address >= g_MemMapData[i].Start) && (Address <= g_MemMapData[i].End))
-        {
-            #ifdef _WIN64
-            txt.Format( _T( "<DATA>%s.%IX" ), g_MemMapData[i].Name, Address );
-            #else
-            txt.Format( _T( "<DATA>%s.%X" ), g_MemMapData[i].Name, Address );
-            #endif
-            return txt;
-        }
+        #ifdef _WIN64
+        txt.Format( _T( "<DATA>%s.%IX" ), Name->GetString( ), Address );
+        #else
+        txt.Format( _T( "<DATA>%s.%X" ), Name->GetString( ), Address );
+        #endif
+        return txt;
     }
 
-    const MemMapInfo *module = GetModule(Address);
+    const MemMapInfo *module = GetModule(*Map, Address);
     if (module != nullptr) {
         #ifdef _WIN64
         txt.Format( _T( "%s.%IX" ), module->Name, Address );
@@ -479,7 +430,8 @@ CString GetAddressName( ULONG_PTR Address, BOOLEAN bJustAddress )
 
 CString GetModuleName( ULONG_PTR Address )
 {
-    const MemMapInfo* module = GetModule(Address);    
+    MemoryMapPtr Map = GetMemoryMap( );
+    const MemMapInfo* module = GetModule(*Map, Address);    
     if (module != nullptr)
         return module->Name;    
     return CString( "<unknown>" );
@@ -488,7 +440,8 @@ CString GetModuleName( ULONG_PTR Address )
 ULONG_PTR GetAddressFromName( CString moduleName )
 {
     ULONG_PTR moduleAddress = 0;
-    for (auto mi : g_MemMapModules)
+    MemoryMapPtr Map = GetMemoryMap( );
+    for (const auto& mi : Map->Modules)
     {
         if (mi.second.Name == moduleName)
         {
@@ -510,266 +463,9 @@ BOOLEAN IsProcessHandleValid( HANDLE hProc )
     return (RetVal == WAIT_TIMEOUT) ? TRUE : FALSE;
 }
 
-void UpdateMemoryMapIncremental() {
-    static std::map<ULONG_PTR, struct MemMapInfo> memMap;
-    static bool structsInitialized = false;
-    static bool mapInitialized = false;
-    static SYSTEM_INFO SysInfo;
-    static ULONGLONG lastExitTime = 0;
-    MEMORY_BASIC_INFORMATION MemInfo;
-    static ULONG_PTR pMemory;
-    if (!structsInitialized) {
-        structsInitialized = true;
-        GetSystemInfo(&SysInfo);
-        pMemory = (ULONG_PTR)SysInfo.lpMinimumApplicationAddress;
-    }
-
-    ULONGLONG entryTime = GetTickCount64();
-
-    // Don't fire unless there's been at least 20ms since our last iteration
-    if (lastExitTime - entryTime < 50)
-        return;
-
-    while ((GetTickCount64() - entryTime < 10 || !mapInitialized))
-    {
-        SIZE_T vqBytes = VirtualQueryEx(g_hProcess, (LPCVOID)pMemory, &MemInfo, sizeof(MEMORY_BASIC_INFORMATION));
-        if (vqBytes > 0)
-        {
-            if (MemInfo.State == MEM_COMMIT /*&& MemInfo.Type == MEM_PRIVATE*/)
-            {
-                MemMapInfo Mem;
-                Mem.Start = (ULONG_PTR)pMemory;
-                Mem.End = (ULONG_PTR)pMemory + MemInfo.RegionSize - 1;
-                const MemMapInfo* containingModule = GetModule(Mem.Start);
-                if (containingModule != nullptr)
-                    Mem.Name = containingModule->Name;
-                memMap[Mem.End] = Mem;
-            }
-            pMemory = (ULONG_PTR)MemInfo.BaseAddress + MemInfo.RegionSize;
-        }
-        else
-        {
-            // We've exhausted the memory space of the target process.  Assign our temp
-            // map to the global.  
-            g_MemMap = std::move(memMap);
-            memMap.clear();
-            pMemory = (ULONG_PTR)SysInfo.lpMinimumApplicationAddress;
-            
-            break;
-        }
-    }
-    
-    if (g_MemMap.size() > 0)
-        mapInitialized = true;
-    lastExitTime = GetTickCount64();
-}
-
-BOOLEAN UpdateMemoryMap( void )
-{    
-    g_MemMapCode.clear( );
-    g_MemMapData.clear( );
-    g_MemMapModules.clear( );
-    g_Exports.clear( );
-    g_CustomNames.clear( );
-
-    if (g_hProcess == NULL)
-        return FALSE;
-
-    if (!IsProcessHandleValid( g_hProcess ))
-    {
-        g_hProcess = NULL;
-        return FALSE;
-    }
-
-    UpdateMemoryMapIncremental();
-
-    PPROCESS_BASIC_INFORMATION ProcessInfo = NULL;
-    PEB Peb;
-    PEB_LDR_DATA LdrData;
-
-    // Try to allocate buffer 
-    DWORD dwSize = sizeof( PROCESS_BASIC_INFORMATION );
-    ProcessInfo = (PPROCESS_BASIC_INFORMATION)malloc( dwSize );
-    if (!ProcessInfo)
-    {
-        #ifdef _DEBUG
-        PrintOut( _T( "[UpdateMemoryMap]: Couldn't allocate process info buffer!" ) );
-        #endif
-        return FALSE;
-    }
-
-    ULONG dwSizeNeeded = 0;
-    NTSTATUS status = ntdll::NtQueryInformationProcess( g_hProcess, ProcessBasicInformation, ProcessInfo, dwSize, &dwSizeNeeded );
-    if (status >= 0 && dwSize < dwSizeNeeded)
-    {
-        if (ProcessInfo)
-            free( ProcessInfo );
-
-        ProcessInfo = (PPROCESS_BASIC_INFORMATION)malloc( dwSizeNeeded );
-        if (!ProcessInfo)
-        {
-            #ifdef _DEBUG
-            PrintOut( _T( "[UpdateMemoryMap]: Couldn't allocate process info buffer!" ) );
-            #endif
-            return FALSE;
-        }
-
-        status = ntdll::NtQueryInformationProcess( g_hProcess, ProcessBasicInformation, ProcessInfo, dwSizeNeeded, &dwSizeNeeded );
-    }
-
-    // Did we successfully get basic info on process
-    if (NT_SUCCESS( status ))
-    {
-        // Check for PEB
-        if (!ProcessInfo->PebBaseAddress)
-        {
-            #ifdef _DEBUG
-            PrintOut( _T( "[UpdateMemoryMap]: PEB is null! Aborting UpdateExports!" ) );
-            #endif
-            if (ProcessInfo)
-                free( ProcessInfo );
-            return false;
-        }
-
-        // Read Process Environment Block (PEB)
-        SIZE_T dwBytesRead = 0;
-        if (ReClassReadMemory( (LPVOID)ProcessInfo->PebBaseAddress, &Peb, sizeof( PEB ), &dwBytesRead ) == 0)
-        {
-            #ifdef _DEBUG
-            PrintOut( _T( "[UpdateMemoryMap]: Failed to read PEB! Aborting UpdateExports!" ) );
-            #endif
-            if (ProcessInfo)
-                free( ProcessInfo );
-            return false;
-        }
-
-        // Get Ldr
-        dwBytesRead = 0;
-        if (ReClassReadMemory( (LPVOID)Peb.Ldr, &LdrData, sizeof( LdrData ), &dwBytesRead ) == 0)
-        {
-            #ifdef _DEBUG
-            PrintOut( _T( "[UpdateMemoryMap]: Failed to read PEB Ldr Data! Aborting UpdateExports!" ) );
-            #endif
-            if (ProcessInfo)
-                free( ProcessInfo );
-            return false;
-        }
-
-        LIST_ENTRY *pLdrListHead = (LIST_ENTRY *)LdrData.InLoadOrderModuleList.Flink;
-        LIST_ENTRY *pLdrCurrentNode = LdrData.InLoadOrderModuleList.Flink;
-        do
-        {
-            LDR_DATA_TABLE_ENTRY lstEntry = { 0 };
-            dwBytesRead = 0;
-            if (!ReClassReadMemory( (LPVOID)pLdrCurrentNode, &lstEntry, sizeof( LDR_DATA_TABLE_ENTRY ), &dwBytesRead ))
-            {
-                #ifdef _DEBUG
-                PrintOut( _T( "[UpdateMemoryMap]: Could not read list entry from LDR list. Error = %s" ), Utils::GetLastErrorString( ).GetString( ) );
-                #endif
-                if (ProcessInfo)
-                    free( ProcessInfo );
-                return false;
-            }
-
-            pLdrCurrentNode = lstEntry.InLoadOrderLinks.Flink;
-
-            if (lstEntry.DllBase != NULL /*&& lstEntry.SizeOfImage != 0*/)
-            {
-                UCHAR* ModuleBase = (UCHAR*)lstEntry.DllBase;
-                DWORD ModuleSize = lstEntry.SizeOfImage;
-
-                WCHAR wcsModulePath[MAX_PATH] = { 0 };
-                WCHAR* wcsModuleName = NULL;
-
-                if (lstEntry.FullDllName.Length > 0)
-                {
-                    dwBytesRead = 0;
-                    if (ReClassReadMemory( (LPVOID)lstEntry.FullDllName.Buffer, &wcsModulePath, lstEntry.FullDllName.Length, &dwBytesRead ))
-                    {
-                        wcsModuleName = wcsrchr( wcsModulePath, L'\\' );
-                        if (!wcsModuleName)
-                            wcsModuleName = wcsrchr( wcsModulePath, L'/' );
-                        wcsModuleName++;
-
-                        if (g_AttachedProcessAddress == NULL)
-                        {
-                            WCHAR wcsModuleFilename[MAX_PATH] = { 0 };
-                            GetModuleFileNameExW( g_hProcess, NULL, wcsModuleFilename, MAX_PATH );
-                            if (_wcsicmp( wcsModuleFilename, wcsModulePath ) == 0)
-                            {
-                                g_AttachedProcessAddress = (ULONG_PTR)ModuleBase;
-                                g_AttachedProcessSize = ModuleSize;
-                            }
-                        }
-                    }
-                }
-
-                // module info
-                MemMapInfo Mem;
-                Mem.Start = (ULONG_PTR)ModuleBase;
-                Mem.End = Mem.Start + ModuleSize;
-                Mem.Size = ModuleSize;
-                #ifdef UNICODE
-                Mem.Name = wcsModuleName;
-                Mem.Path = wcsModulePath;
-                #else
-                Mem.Name = CW2A( wcsModuleName );
-                Mem.Path = CW2A( wcsModulePath );
-                #endif
-                g_MemMapModules[Mem.End] = Mem ;
-
-                // module code
-                IMAGE_DOS_HEADER DosHdr;
-                IMAGE_NT_HEADERS NtHdr;
-
-                ReClassReadMemory( ModuleBase, &DosHdr, sizeof( IMAGE_DOS_HEADER ), NULL );
-                ReClassReadMemory( ModuleBase + DosHdr.e_lfanew, &NtHdr, sizeof( IMAGE_NT_HEADERS ), NULL );
-                DWORD sectionsSize = (DWORD)NtHdr.FileHeader.NumberOfSections * sizeof( IMAGE_SECTION_HEADER );
-                PIMAGE_SECTION_HEADER sections = (PIMAGE_SECTION_HEADER)malloc( sectionsSize );
-                ReClassReadMemory( ModuleBase + DosHdr.e_lfanew + sizeof( IMAGE_NT_HEADERS ), sections, sectionsSize, NULL );
-                for (int i = 0; i < NtHdr.FileHeader.NumberOfSections; i++)
-                {
-                    CString txt;
-                    MemMapInfo Mem;
-                    txt.Format( _T( "%.8s" ), sections[i].Name ); txt.MakeLower( );
-                    if (txt == ".text" || txt == "code")
-                    {
-                        Mem.Start = (ULONG_PTR)ModuleBase + sections[i].VirtualAddress;
-                        Mem.End = Mem.Start + sections[i].Misc.VirtualSize;
-                        Mem.Name = wcsModuleName;
-                        g_MemMapCode.push_back( Mem );
-                    }
-                    else if (txt == ".data" || txt == "data" || txt == ".rdata" || txt == ".idata")
-                    {
-                        Mem.Start = (ULONG_PTR)ModuleBase + sections[i].VirtualAddress;
-                        Mem.End = Mem.Start + sections[i].Misc.VirtualSize;
-                        Mem.Name = wcsModuleName;
-                        g_MemMapData.push_back( Mem );
-                    }
-                }
-                // Free sections
-                free( sections );
-            }
-
-        } while (pLdrListHead != pLdrCurrentNode);
-    }
-    else
-    {
-        PrintOutDbg( _T( "[UpdateExports]: NtQueryInformationProcess failed! Aborting..." ) );
-        if (ProcessInfo)
-            free( ProcessInfo );
-        return 0;
-    }
-
-    if (ProcessInfo)
-        free( ProcessInfo );
-
-    return true;
-}
-
 BOOLEAN UpdateExports( )
 {
-    g_Exports.clear( );
+    std::vector<AddressName> Exports;
 
     //if (!g_bExports) 
     //	return;
@@ -896,7 +592,7 @@ BOOLEAN UpdateExports( )
                         Entry.Name.Format( _T( "%ls.%hs" ), ModuleName, ExportName );
                         Entry.Address = Address;
                         // Add export entry to array
-                        g_Exports.push_back( Entry );
+                        Exports.push_back( Entry );
                     }
 
                 }
@@ -914,6 +610,12 @@ BOOLEAN UpdateExports( )
     if (ProcessInfo)
         free( ProcessInfo );
 
+    // Publish a copy of the current map with the new exports
+    std::shared_ptr<MemoryMapSnapshot> Map = std::make_shared<MemoryMapSnapshot>( *GetMemoryMap( ) );
+    Map->Exports.swap( Exports );
+    Map->Index.Build( Map->Code, Map->Data, Map->Exports, Map->CustomNames );
+    PublishMemoryMap( Map );
+
     return 1;
 }
 
@@ -1005,7 +707,8 @@ ULONG_PTR ConvertStrToAddress( CString str )
 
         if (bMod)
         {
-            for (auto mi : g_MemMapModules)
+            MemoryMapPtr Map = GetMemoryMap( );
+            for (const auto& mi : Map->Modules)
             {
                 CString ModName = mi.second.Name;
                 ModName.MakeLower( );
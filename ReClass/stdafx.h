@@ -90,6 +90,13 @@ using namespace tinyxml2;
 //
 #include "NtDll.h"
 
+//
+// Memory sources
+//
+#include "MemorySource.h"
+#include "PageCache.h"
+#include "ReadPlanner.h"
+
 //
 // Globals
 //
@@ -100,18 +107,12 @@ extern DWORD  g_AttachedProcessSize;
 extern CString g_ProcessName;
 extern CString g_ProcessPath;
 
-extern std::map<ULONG_PTR, struct MemMapInfo> g_MemMap;
-extern std::vector<struct MemMapInfo> g_MemMapCode;
-extern std::vector<struct MemMapInfo> g_MemMapData;
-extern std::map<ULONG_PTR, MemMapInfo> g_MemMapModules;
-extern std::vector<struct AddressName> g_Exports;
-extern std::vector<struct AddressName> g_CustomNames;
-
 extern std::vector<HICON> g_Icons;
 
 extern COLORREF g_clrBackground;
 extern COLORREF g_clrSelect;
 extern COLORREF g_clrHidden;
+extern COLORREF g_clrChanged;
 extern COLORREF g_clrOffset;
 extern COLORREF g_clrAddress;
 extern COLORREF g_clrType;
@@ -148,6 +149,8 @@ extern bool g_bInt;
 extern bool g_bString;
 extern bool g_bPointers;
 extern bool g_bUnsignedHex;
+extern bool g_bHighlightChanges;
+extern DWORD g_ChangeFadeFrames;    // Paints a changed value stays highlighted
 
 extern bool g_bTop;
 extern bool g_bClassBrowser;
@@ -155,6 +158,17 @@ extern bool g_bFilterProcesses;
 extern bool g_bPrivatePadding;
 extern bool g_bClipboardCopy;
 
+extern DWORD g_ReadCacheBudget;
+extern DWORD g_ReadCacheCodeTtl;
+extern DWORD g_ReadCacheDataTtl;
+
+extern DWORD g_RefreshFocused;      // ms between change checks of the active view
+extern DWORD g_RefreshBackground;   // and of the other views on screen
+
+// Bumped by anything that changes what the views show without touching the
+// nodes or the target's memory (commands, modules, symbols)
+extern DWORD g_ViewGeneration;
+
 typedef struct _RCTYPEDEFS {
     CString Hex;
     CString Int64;
@@ -186,6 +200,10 @@ extern RCTYPEDEFS g_Typedefs;
 #define WM_PROCESSMENU (WM_USER+WM_MAXITEMS)
 #define WM_CHANGECLASSMENU (WM_USER+WM_MAXITEMS+WM_MAXITEMS)
 #define WM_DELETECLASSMENU (WM_USER+WM_MAXITEMS+WM_MAXITEMS+WM_MAXITEMS)
+#define WM_MODULEEVENT (WM_USER+WM_MAXITEMS+WM_MAXITEMS+WM_MAXITEMS+WM_MAXITEMS)
+#define WM_SYMBOLSLOADED (WM_MODULEEVENT+1)
+#define WM_PRINTOUT (WM_MODULEEVENT+2) // lParam is a CString* the receiver deletes
+#define WM_MEMORYMAP (WM_MODULEEVENT+3)
 
 
 #define ICON_OPEN 0
@@ -220,7 +238,6 @@ extern RCTYPEDEFS g_Typedefs;
 // Global functions
 //
 BOOLEAN PauseResumeThreadList( BOOL bResumeThread );
-void UpdateMemoryMapIncremental();
 BOOLEAN UpdateMemoryMap( );
 BOOLEAN UpdateExports( );
 
@@ -231,15 +248,20 @@ BOOLEAN IsData( ULONG_PTR Address );
 BOOLEAN IsMemory( ULONG_PTR Address );
 BOOLEAN IsModule( ULONG_PTR Address );
 
-const MemMapInfo* GetModule(ULONG_PTR Address);
 ULONG_PTR GetModuleBaseFromAddress( ULONG_PTR Address );
 
 CString GetAddressName( ULONG_PTR Address, BOOLEAN bJustAddress );
 CString GetModuleName( ULONG_PTR Address );
 ULONG_PTR GetAddressFromName( CString moduleName );
 
+BOOLEAN IsProcessHandleValid( HANDLE hProc );
+
 BOOL ReClassReadMemory( LPVOID Address, LPVOID Buffer, SIZE_T Size, PSIZE_T BytesRead = nullptr );
 BOOL ReClassWriteMemory( LPVOID Address, LPVOID Buffer, SIZE_T Size, PSIZE_T BytesWritten = nullptr );
+IMemorySource* ReClassGetMemorySource( ); // The page cache in front of the current source
+MemorySourcePtr ReClassAcquireMemorySource( ); // The current source itself, for worker threads to hold on to
+void ReClassSelectMemorySource( ); // UI thread, after g_hProcess or the opened snapshot changed
+void ReClassSetMemorySource( IMemorySource* Source ); // Takes ownership, NULL goes back to the process handle
 HANDLE ReClassOpenProcess( DWORD dwDesiredAccessFlags, BOOL bInheritHandle, DWORD dwProcessID );
 HANDLE ReClassOpenThread( DWORD dwDesiredAccessFlags, BOOL bInheritHandle, DWORD dwThreadID );
 
@@ -278,6 +300,11 @@ struct AddressName
     ULONG_PTR Address;
 };
 
+#include "AddressIndex.h"
+#include "MemoryMap.h"
+#include "RttiCache.h"
+#include "RefreshScheduler.h"
+
 //
 // Nodes 
 //
@@ -294,18 +321,23 @@ struct AddressName
 //
 #include "ReClassEx.h"
 extern CReClassExApp g_ReClassApp;
+#include "Autosave.h"
 
 
 //
-// Global preprocessor directive for printing to the Console
+// Global preprocessor directive for printing to the Console. Safe from any
+// thread, ReClassPrintText hands lines printed off the UI thread to the main
+// frame (WM_PRINTOUT).
 //
-static TCHAR s_ReClassLogBuf[1024]; \
+void ReClassPrintText( const TCHAR* Text );
+extern HWND g_hPrintOutWnd;
 
 #define PrintOut(fmt, ...) { \
 do { \
     if (fmt) { \
-        _sntprintf_s(s_ReClassLogBuf, 1024, fmt, ##__VA_ARGS__); \
-        g_ReClassApp.m_pConsole->PrintText(s_ReClassLogBuf); \
+        TCHAR _LogBuf[1024]; \
+        _sntprintf_s(_LogBuf, 1024, fmt, ##__VA_ARGS__); \
+        ReClassPrintText(_LogBuf); \
     } \
 } while (0);\
 }
@@ -313,8 +345,9 @@ do { \
 #define PrintOutDbg(fmt, ...) { \
 do { \
     if (fmt) { \
-        _sntprintf_s(s_ReClassLogBuf, 1024, fmt, ##__VA_ARGS__); \
-        g_ReClassApp.m_pConsole->PrintText(s_ReClassLogBuf); \
+        TCHAR _LogBuf[1024]; \
+        _sntprintf_s(_LogBuf, 1024, fmt, ##__VA_ARGS__); \
+        ReClassPrintText(_LogBuf); \
     } \
 } while (0);\
 }
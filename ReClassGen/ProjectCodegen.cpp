@@ -0,0 +1,228 @@
+//
+// Binary project to code generator input. Free of MFC like the rest of
+// ReClassGen.
+//
+#include "ProjectCodegen.h"
+#include "ClassDependencyGraph.h"
+#include "NodeType.h"
+
+#include <algorithm>
+
+// The application's g_Typedefs before the user changes them
+static const char* s_DefaultTypedefs[PROJECT_TYPEDEF_COUNT] = {
+    "char", "__int64", "__int32", "__int16", "__int8", "DWORD64", "DWORD", "WORD", "unsigned char",
+    "float", "double", "Vector2", "Vector3", "Vector4", "matrix3x4_t", "char*", "wchar_t*"
+};
+
+// The headers are for the Windows process the project describes
+#define TARGET_WCHAR_SIZE   2
+
+typedef ClassDependencyGraphT<PROJECT_BINARY_CLASS> ProjectDependencyGraph;
+
+// Typedef a plain value node is generated with, -1 for everything else
+static int GetGeneratedTypedef( int Type )
+{
+    switch (Type)
+    {
+    case nt_int64:  return TYPEDEF_INT64;
+    case nt_int32:  return TYPEDEF_INT32;
+    case nt_int16:  return TYPEDEF_INT16;
+    case nt_int8:   return TYPEDEF_INT8;
+    case nt_uint64: return TYPEDEF_QWORD;
+    case nt_uint32: return TYPEDEF_DWORD;
+    case nt_uint16: return TYPEDEF_WORD;
+    case nt_uint8:  return TYPEDEF_BYTE;
+    case nt_vec2:   return TYPEDEF_VEC2;
+    case nt_vec3:   return TYPEDEF_VEC3;
+    case nt_quat:   return TYPEDEF_QUAT;
+    case nt_matrix: return TYPEDEF_MATRIX;
+    case nt_pchar:  return TYPEDEF_PCHAR;
+    case nt_pwchar: return TYPEDEF_PWCHAR;
+    case nt_float:  return TYPEDEF_FLOAT;
+    case nt_double: return TYPEDEF_DOUBLE;
+    default:        return -1;
+    }
+}
+
+// Instances and arrays need the definition, pointers only a declaration
+static bool GetLinkType( const PROJECT_BINARY_NODE& Node, DependencyType& Type )
+{
+    if (Node.Class == PROJECT_NO_CLASS)
+        return false;
+
+    switch (Node.Type)
+    {
+    case nt_pointer:
+    case nt_ptrarray:
+        Type = DependencyType::POINTER;
+        return true;
+    case nt_instance:
+    case nt_array:
+        Type = DependencyType::INSTANCE;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void GetGenerationOrder( const CProjectImage& Image, std::vector<uint32_t>& ForwardDeclarations, std::vector<uint32_t>& ClassDefinitions )
+{
+    ProjectDependencyGraph DependencyGraph;
+    std::set<const PROJECT_BINARY_CLASS*> Forward;
+    std::vector<const PROJECT_BINARY_CLASS*> Definitions;
+
+    ForwardDeclarations.clear( );
+    ClassDefinitions.clear( );
+    if (Image.GetClassCount( ) == 0)
+        return;
+
+    const PROJECT_BINARY_CLASS* Classes = &Image.GetClass( 0 );
+
+    // Add each class as a node to the graph before adding dependency edges
+    for (uint32_t i = 0; i < Image.GetClassCount( ); i++)
+        DependencyGraph.AddNode( &Classes[i] );
+
+    for (uint32_t i = 0; i < Image.GetClassCount( ); i++)
+    {
+        for (uint32_t n = Classes[i].FirstNode; n < Classes[i].FirstNode + Classes[i].NodeCount; n++)
+        {
+            DependencyType Type;
+            if (GetLinkType( Image.GetNode( n ), Type ))
+                DependencyGraph.AddEdge( &Classes[i], &Classes[Image.GetNode( n ).Class], Type );
+        }
+    }
+
+    DependencyGraph.OrderClassesForGeneration( Forward, Definitions );
+
+    // The graph keys on addresses, the set comes out in memory order which is
+    // also the project's
+    for (const PROJECT_BINARY_CLASS* pClass : Forward)
+        ForwardDeclarations.push_back( (uint32_t)(pClass - Classes) );
+
+    for (const PROJECT_BINARY_CLASS* pClass : Definitions)
+        ClassDefinitions.push_back( (uint32_t)(pClass - Classes) );
+}
+
+std::string GetProjectTypedef( const CProjectImage& Image, uint32_t Typedef )
+{
+    uint32_t Id = Image.GetHeader( ).Typedefs[Typedef];
+    return (Id != PROJECT_NO_STRING) ? Image.GetString( Id ) : s_DefaultTypedefs[Typedef];
+}
+
+//
+// Same mapping as DescribeClass in the application
+//
+void DescribeProjectClass( const CProjectImage& Image, const CProjectLayout& Layout, uint32_t Index, CODEGEN_CLASS& Class, uint32_t& Unresolved )
+{
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Index );
+
+    Class.Name = Image.GetString( Record.Name );
+    Class.Code = Image.GetString( Record.Code );
+    Class.Size = Layout.GetClassSize( Index );
+    Class.Members.resize( Record.NodeCount );
+
+    for (uint32_t i = 0; i < Record.NodeCount; i++)
+    {
+        uint32_t n = Record.FirstNode + i;
+        const PROJECT_BINARY_NODE& Node = Image.GetNode( n );
+        CODEGEN_MEMBER& Member = Class.Members[i];
+        int Typedef = GetGeneratedTypedef( Node.Type );
+        const char* LinkName = (Node.Class != PROJECT_NO_CLASS) ? Image.GetString( Image.GetClass( Node.Class ).Name ) : NULL;
+
+        Member.Kind = CODEGEN_FIELD;
+        Member.Name = Image.GetString( Node.Name );
+        Member.Comment = Image.GetString( Node.Comment );
+        Member.Offset = Layout.GetNodeOffset( n );
+        Member.Size = 0;
+
+        if (Typedef != -1)
+        {
+            Member.Type = GetProjectTypedef( Image, Typedef );
+            continue;
+        }
+
+        if ((Node.Type == nt_pointer || Node.Type == nt_instance || Node.Type == nt_array || Node.Type == nt_ptrarray) && LinkName == NULL)
+            Unresolved++;
+
+        switch (Node.Type)
+        {
+        case nt_hex64:
+        case nt_hex32:
+        case nt_hex16:
+        case nt_hex8:
+            Member.Kind = CODEGEN_PADDING;
+            Member.Size = Layout.GetNodeSize( n );
+            break;
+        case nt_vtable:
+            Member.Kind = CODEGEN_VTABLE;
+            Member.Functions.resize( Node.ChildCount );
+            for (uint32_t f = 0; f < Node.ChildCount; f++)
+            {
+                Member.Functions[f].Name = Image.GetString( Image.GetNode( Node.FirstChild + f ).Name );
+                Member.Functions[f].Comment = Image.GetString( Image.GetNode( Node.FirstChild + f ).Comment );
+            }
+            break;
+        case nt_text:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = "char";
+            Member.Size = Layout.GetNodeSize( n );
+            break;
+        case nt_unicode:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = "wchar_t";
+            Member.Size = Layout.GetNodeSize( n ) / TARGET_WCHAR_SIZE;
+            break;
+        case nt_custom:
+        case nt_functionptr:
+            Member.Kind = CODEGEN_DECLARATION;
+            break;
+        case nt_pointer:
+            Member.Type = (LinkName != NULL) ? std::string( LinkName ) + "*" : "void*";
+            break;
+        case nt_instance:
+            // At offset 0 it is generated as the base class
+            Member.Kind = (LinkName == NULL) ? CODEGEN_NONE : (Member.Offset == 0) ? CODEGEN_BASE : CODEGEN_FIELD;
+            Member.Type = (LinkName != NULL) ? LinkName : "";
+            break;
+        case nt_array:
+            Member.Kind = (LinkName != NULL) ? CODEGEN_ARRAY : CODEGEN_NONE;
+            Member.Type = (LinkName != NULL) ? LinkName : "";
+            Member.Size = Node.Count;
+            break;
+        case nt_ptrarray:
+            Member.Kind = CODEGEN_ARRAY;
+            Member.Type = (LinkName != NULL) ? std::string( LinkName ) + "*" : "void*";
+            Member.Size = Node.Count;
+            break;
+        default:
+            Member.Kind = CODEGEN_NONE;
+            break;
+        }
+    }
+}
+
+void GetClassDependencies( const CProjectImage& Image, uint32_t Index, std::vector<uint32_t>& Includes, std::vector<uint32_t>& Pointers )
+{
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Index );
+
+    Includes.clear( );
+    Pointers.clear( );
+
+    for (uint32_t n = Record.FirstNode; n < Record.FirstNode + Record.NodeCount; n++)
+    {
+        const PROJECT_BINARY_NODE& Node = Image.GetNode( n );
+        DependencyType Type;
+
+        if (!GetLinkType( Node, Type ) || Node.Class == Index)
+            continue;
+
+        std::vector<uint32_t>& List = (Type == DependencyType::INSTANCE) ? Includes : Pointers;
+        if (std::find( List.begin( ), List.end( ), Node.Class ) == List.end( ))
+            List.push_back( Node.Class );
+    }
+
+    // A class both instanced and pointed to is defined by its include
+    Pointers.erase( std::remove_if( Pointers.begin( ), Pointers.end( ), [&Includes] ( uint32_t Class ) {
+        return std::find( Includes.begin( ), Includes.end( ), Class ) != Includes.end( );
+    } ), Pointers.end( ) );
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+//
+// Binary project to code generator input
+//
+// What OnButtonGenerate does with the application's nodes, done on a binary
+// project image: the definition order from the class dependency graph and a
+// CODEGEN_CLASS per class. Typedefs come from the project, the application's
+// defaults where it has none.
+//
+#include "ProjectFormat.h"
+#include "ProjectLayout.h"
+#include "CodeGenerator.h"
+
+// PROJECT_BINARY_HEADER::Typedefs order
+#define TYPEDEF_HEX     0
+#define TYPEDEF_INT64   1
+#define TYPEDEF_INT32   2
+#define TYPEDEF_INT16   3
+#define TYPEDEF_INT8    4
+#define TYPEDEF_QWORD   5
+#define TYPEDEF_DWORD   6
+#define TYPEDEF_WORD    7
+#define TYPEDEF_BYTE    8
+#define TYPEDEF_FLOAT   9
+#define TYPEDEF_DOUBLE  10
+#define TYPEDEF_VEC2    11
+#define TYPEDEF_VEC3    12
+#define TYPEDEF_QUAT    13
+#define TYPEDEF_MATRIX  14
+#define TYPEDEF_PCHAR   15
+#define TYPEDEF_PWCHAR  16
+
+// Class indices in definition order, and those needing a forward declaration
+void GetGenerationOrder( const CProjectImage& Image, std::vector<uint32_t>& ForwardDeclarations, std::vector<uint32_t>& ClassDefinitions );
+
+// The project's typedef, or the default if it has none
+std::string GetProjectTypedef( const CProjectImage& Image, uint32_t Typedef );
+
+// Links left unset (a pointer to a class that was deleted, a name no class
+// has) are counted in Unresolved: pointers become void*, instances and arrays
+// are left out
+void DescribeProjectClass( const CProjectImage& Image, const CProjectLayout& Layout, uint32_t Index, CODEGEN_CLASS& Class, uint32_t& Unresolved );
+
+// Classes Index instances (Includes) and points to (Pointers), each once
+void GetClassDependencies( const CProjectImage& Image, uint32_t Index, std::vector<uint32_t>& Includes, std::vector<uint32_t>& Pointers );
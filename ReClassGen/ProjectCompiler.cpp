@@ -0,0 +1,313 @@
+//
+// .nts to binary project. Free of MFC like the formats it converts between.
+//
+#include "ProjectCompiler.h"
+#include "ProjectLayout.h"
+#include "NodeType.h"
+#include "XmlPullReader.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+// PROJECT_BINARY_HEADER::Typedefs order
+static const char* s_TypedefAttributes[PROJECT_TYPEDEF_COUNT] = {
+    "tdHex", "tdInt64", "tdInt32", "tdInt16", "tdInt8", "tdQword", "tdDword", "tdWord", "tdByte",
+    "tdFloat", "tdDouble", "tdVec2", "tdVec3", "tdQuat", "tdMatrix", "tdPChar", "tdPWChar"
+};
+
+// A node of the class being read, written out when the class ends
+struct XmlProjectNode {
+    PROJECT_BINARY_NODE Node;
+    std::string Link;
+    bool bLink;
+    std::vector<PROJECT_BINARY_NODE> Functions;
+};
+
+// _stricmp, which isn't everywhere
+static bool EqualsNoCase( const char* Left, const char* Right )
+{
+    for (; *Left != '\0' && *Right != '\0'; Left++, Right++)
+    {
+        if (tolower( (unsigned char)*Left ) != tolower( (unsigned char)*Right ))
+            return false;
+    }
+    return *Left == *Right;
+}
+
+// The types CreateNewNode knows, LoadXML drops the rest
+static bool IsKnownNodeType( int Type )
+{
+    return Type >= nt_instance && Type <= nt_ptrarray &&
+        Type != nt_struct && Type != nt_hidden && Type != nt_class;
+}
+
+static void WriteClass( CProjectWriter& Writer, PROJECT_BINARY_CLASS& Class, std::vector<XmlProjectNode>& Nodes, std::vector<std::pair<std::string, uint32_t>>& Links )
+{
+    Class.NodeCount = (uint32_t)Nodes.size( );
+    Class.FirstNode = Writer.ReserveNodes( Class.NodeCount );
+
+    for (uint32_t n = 0; n < Class.NodeCount; n++)
+    {
+        XmlProjectNode& Node = Nodes[n];
+        uint32_t Index = Class.FirstNode + n;
+
+        Writer.GetNode( Index ) = Node.Node;
+        if (Node.bLink)
+            Links.emplace_back( std::move( Node.Link ), Index );
+
+        if (!Node.Functions.empty( ))
+        {
+            uint32_t FirstChild = Writer.ReserveNodes( (uint32_t)Node.Functions.size( ) );
+            for (size_t f = 0; f < Node.Functions.size( ); f++)
+                Writer.GetNode( FirstChild + (uint32_t)f ) = Node.Functions[f];
+
+            Writer.GetNode( Index ).FirstChild = FirstChild;
+            Writer.GetNode( Index ).ChildCount = (uint32_t)Node.Functions.size( );
+        }
+    }
+
+    Writer.AddClass( Class );
+    Nodes.clear( );
+}
+
+bool CompileXmlProject( const char* Data, size_t Size, uint32_t PointerSize, std::vector<uint8_t>& Image, std::string& Error )
+{
+    //
+    // Same walk as LoadXML:
+    //
+    //  <Nothin>                                    depth 1
+    //    <TypeDef/Header/Footer/Notes/>            2
+    //    <Class Name="">                           2
+    //      <Node Type="">                          3
+    //        <Array Type="" Name=""/>              4, first child of an array
+    //        <Function>                            4, vtable entries
+    //          <Code Assembly=""/>                 5
+    //
+    // A class's nodes are collected until its end tag, the node table wants
+    // them in one run with the vtable functions after them.
+    //
+    CXmlPullReader Reader( Data, Size );
+    CXmlPullReader::Token Token;
+    CProjectWriter Writer;
+
+    std::unordered_map<std::string, uint32_t> ClassNames;
+    std::vector<std::pair<std::string, uint32_t>> Links;
+    std::vector<XmlProjectNode> Nodes;
+    PROJECT_BINARY_CLASS Class;
+    uint32_t ClassCount = 0;
+
+    bool bClass = false;
+    bool bNode = false;
+    bool bFunction = false;
+    bool bRoot = false;
+    bool bArrayElement = false;
+    bool bTypedefs = false, bHeader = false, bFooter = false, bNotes = false;
+
+    auto Attribute = [&Reader] ( const char* Name ) {
+        const char* Value = Reader.GetAttribute( Name );
+        return (Value != NULL) ? Value : "";
+    };
+
+    auto IntAttribute = [&Reader] ( const char* Name, int Default ) {
+        const char* Value = Reader.GetAttribute( Name );
+        int Result = Default;
+        if (Value != NULL)
+            sscanf( Value, "%d", &Result );
+        return Result;
+    };
+
+    PROJECT_BINARY_HEADER& Header = Writer.GetHeader( );
+
+    while ((Token = Reader.Next( )) == CXmlPullReader::XML_START || Token == CXmlPullReader::XML_END)
+    {
+        uint32_t Depth = Reader.GetDepth( );
+        const char* Name = Reader.GetName( );
+
+        if (Token == CXmlPullReader::XML_END)
+        {
+            if (Depth == 2 && bClass)
+            {
+                WriteClass( Writer, Class, Nodes, Links );
+                bClass = false;
+            }
+            else if (Depth == 3)
+            {
+                bNode = false;
+            }
+            else if (Depth == 4)
+            {
+                bFunction = false;
+            }
+            continue;
+        }
+
+        if (Depth == 1)
+        {
+            if (!EqualsNoCase( Name, "Nothin" )) // The root element value is 'Nothin'
+                break; // Not a Reclass file
+            bRoot = true;
+        }
+        else if (Depth == 2)
+        {
+            if (!bTypedefs && strcmp( Name, "TypeDef" ) == 0)
+            {
+                for (uint32_t i = 0; i < PROJECT_TYPEDEF_COUNT; i++)
+                    Header.Typedefs[i] = Writer.AddString( Attribute( s_TypedefAttributes[i] ) );
+                bTypedefs = true;
+            }
+            else if (!bHeader && strcmp( Name, "Header" ) == 0)
+            {
+                Header.Header = Writer.AddString( Attribute( "Text" ) );
+                bHeader = true;
+            }
+            else if (!bFooter && strcmp( Name, "Footer" ) == 0)
+            {
+                Header.Footer = Writer.AddString( Attribute( "Text" ) );
+                bFooter = true;
+            }
+            else if (!bNotes && strcmp( Name, "Notes" ) == 0)
+            {
+                Header.Notes = Writer.AddString( Attribute( "Text" ) );
+                bNotes = true;
+            }
+            else if (strcmp( Name, "Class" ) == 0)
+            {
+                const char* OffsetString = Attribute( "strOffset" );
+
+                memset( &Class, 0, sizeof( Class ) );
+                Class.Name = Writer.AddString( Attribute( "Name" ) );
+                Class.Comment = Writer.AddString( Attribute( "Comment" ) );
+                Class.OffsetString = Writer.AddString( (*OffsetString != '\0') ? OffsetString : Attribute( "Offset" ) );
+                Class.Code = Writer.AddString( Attribute( "Code" ) );
+                Class.Offset = strtoull( Attribute( "Offset" ), NULL, 10 );
+
+                // A later class with the same name takes over its links
+                ClassNames[Attribute( "Name" )] = ClassCount++;
+                bClass = true;
+            }
+        }
+        else if (Depth == 3 && bClass)
+        {
+            int Type = IntAttribute( "Type", nt_none );
+
+            bNode = IsKnownNodeType( Type );
+            bArrayElement = false;
+            if (!bNode)
+                continue;
+
+            Nodes.emplace_back( );
+            XmlProjectNode& Node = Nodes.back( );
+
+            memset( &Node.Node, 0, sizeof( Node.Node ) );
+            Node.Node.Type = Type;
+            Node.Node.Flags = (atoi( Attribute( "bHidden" ) ) > 0) ? PROJECT_NODE_HIDDEN : 0;
+            Node.Node.Name = Writer.AddString( Attribute( "Name" ) );
+            Node.Node.Comment = Writer.AddString( Attribute( "Comment" ) );
+            Node.Node.Size = (uint32_t)IntAttribute( "Size", -1 );
+            Node.Node.Class = PROJECT_NO_CLASS;
+            Node.bLink = false;
+
+            if (Type == nt_array)
+            {
+                Node.Node.Count = (uint32_t)atoi( Attribute( "Total" ) );
+            }
+            else if (Type == nt_ptrarray)
+            {
+                Node.Node.Count = (uint32_t)atoi( Attribute( "Count" ) );
+            }
+            else if (Type == nt_pointer)
+            {
+                Node.Link = Attribute( "Pointer" );
+                Node.bLink = true;
+            }
+            else if (Type == nt_instance)
+            {
+                Node.Link = Attribute( "Instance" );
+                Node.bLink = true;
+            }
+        }
+        else if (Depth == 4 && bNode)
+        {
+            XmlProjectNode& Node = Nodes.back( );
+
+            if (Node.Node.Type == nt_vtable)
+            {
+                PROJECT_BINARY_NODE Function;
+
+                memset( &Function, 0, sizeof( Function ) );
+                Function.Type = nt_functionptr;
+                Function.Flags = (atoi( Attribute( "bHidden" ) ) > 0) ? PROJECT_NODE_HIDDEN : 0;
+                Function.Name = Writer.AddString( Attribute( "Name" ) );
+                Function.Comment = Writer.AddString( Attribute( "Comment" ) );
+                Function.Class = PROJECT_NO_CLASS;
+
+                Node.Functions.push_back( Function );
+                bFunction = true;
+            }
+            else if ((Node.Node.Type == nt_array || Node.Node.Type == nt_ptrarray) && !bArrayElement)
+            {
+                bArrayElement = true;
+                if (IntAttribute( "Type", nt_none ) == nt_class)
+                {
+                    Node.Link = Attribute( "Name" );
+                    Node.bLink = true;
+                }
+            }
+        }
+        else if (Depth == 5 && bFunction)
+        {
+            PROJECT_BINARY_NODE& Function = Nodes.back( ).Functions.back( );
+            uint32_t Line = Writer.AddLine( Writer.AddString( Attribute( "Assembly" ) ) );
+
+            if (Function.LineCount++ == 0)
+                Function.FirstLine = Line;
+        }
+    }
+
+    if (Token != CXmlPullReader::XML_DONE || !bRoot)
+    {
+        char Message[64];
+        if (Token == CXmlPullReader::XML_ERROR)
+            snprintf( Message, sizeof( Message ), "XML error on line %u", Reader.GetErrorLine( ) );
+        else
+            snprintf( Message, sizeof( Message ), "not a ReClass project" );
+        Error = Message;
+        return false;
+    }
+
+    //
+    // Links name classes anywhere in the file, resolve them once all are known
+    //
+    for (auto& Link : Links)
+    {
+        auto Found = ClassNames.find( Link.first );
+        if (Found != ClassNames.end( ))
+            Writer.GetNode( Link.second ).Class = Found->second;
+    }
+
+    Writer.Finish( Image );
+
+    CProjectImage Opened;
+    CProjectLayout Layout;
+    if (!Opened.Open( Image.data( ), Image.size( ) ) || !Layout.Compute( Opened, PointerSize, Error ))
+        return false;
+
+    StoreNodeSizes( Image, Layout );
+    return true;
+}
+
+void StoreNodeSizes( std::vector<uint8_t>& Image, const CProjectLayout& Layout )
+{
+    const PROJECT_BINARY_HEADER* Header = (const PROJECT_BINARY_HEADER*)Image.data( );
+    PROJECT_BINARY_CLASS* Classes = (PROJECT_BINARY_CLASS*)(Image.data( ) + Header->ClassTable);
+    PROJECT_BINARY_NODE* Nodes = (PROJECT_BINARY_NODE*)(Image.data( ) + Header->NodeTable);
+
+    for (uint32_t c = 0; c < Header->ClassCount; c++)
+    {
+        for (uint32_t n = Classes[c].FirstNode; n < Classes[c].FirstNode + Classes[c].NodeCount; n++)
+            Nodes[n].Size = Layout.GetNodeSize( n );
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+//
+// .nts to binary project
+//
+// Reads an XML project the way CReClassExApp::LoadXML does (same tags, same
+// defaults, links by class name with the last class of a name winning) and
+// writes it as a binary project image (ProjectFormat.h), the model the rest
+// of ReClassGen works on. Node sizes are laid out for PointerSize, like a
+// .ntsb the application saves.
+//
+// Strings are copied as they are in the file. SaveXML writes them in the
+// ANSI code page, anything outside ASCII only comes out right if that was
+// UTF-8.
+//
+#include "ProjectFormat.h"
+
+// Error says what and where if the file isn't a ReClass project
+bool CompileXmlProject( const char* Data, size_t Size, uint32_t PointerSize, std::vector<uint8_t>& Image, std::string& Error );
+
+// Sets every node's stored size to its size in Layout, like GetMemorySize.
+// The image has to have been opened.
+class CProjectLayout;
+void StoreNodeSizes( std::vector<uint8_t>& Image, const CProjectLayout& Layout );
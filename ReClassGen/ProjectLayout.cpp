@@ -0,0 +1,93 @@
+//
+// Project layout. Free of MFC like the formats it reads.
+//
+#include "ProjectLayout.h"
+#include "NodeType.h"
+
+#define LAYOUT_NOT_STARTED  0
+#define LAYOUT_IN_PROGRESS  1
+#define LAYOUT_DONE         2
+
+CProjectLayout::CProjectLayout( )
+    : m_Image( NULL )
+    , m_PointerSize( 8 )
+{
+}
+
+bool CProjectLayout::Compute( const CProjectImage& Image, uint32_t PointerSize, std::string& Error )
+{
+    m_Image = &Image;
+    m_PointerSize = PointerSize;
+    m_State.assign( Image.GetClassCount( ), LAYOUT_NOT_STARTED );
+    m_ClassSizes.assign( Image.GetClassCount( ), 0 );
+    m_NodeSizes.assign( Image.GetHeader( ).NodeCount, 0 );
+    m_NodeOffsets.assign( Image.GetHeader( ).NodeCount, 0 );
+
+    for (uint32_t i = 0; i < Image.GetClassCount( ); i++)
+    {
+        if (!ComputeClass( i, Error ))
+            return false;
+    }
+    return true;
+}
+
+bool CProjectLayout::ComputeClass( uint32_t Class, std::string& Error )
+{
+    if (m_State[Class] == LAYOUT_DONE)
+        return true;
+
+    // The app would recurse until the stack runs out
+    if (m_State[Class] == LAYOUT_IN_PROGRESS)
+    {
+        Error = "class \"";
+        Error += m_Image->GetString( m_Image->GetClass( Class ).Name );
+        Error += "\" contains itself";
+        return false;
+    }
+
+    m_State[Class] = LAYOUT_IN_PROGRESS;
+
+    const PROJECT_BINARY_CLASS& Record = m_Image->GetClass( Class );
+    uint32_t Offset = 0;
+
+    for (uint32_t n = Record.FirstNode; n < Record.FirstNode + Record.NodeCount; n++)
+    {
+        const PROJECT_BINARY_NODE& Node = m_Image->GetNode( n );
+        uint32_t Size = 0;
+
+        switch (Node.Type)
+        {
+        case nt_custom:
+        case nt_text:
+        case nt_unicode:
+        case nt_function:
+            Size = Node.Size;
+            break;
+        case nt_ptrarray:
+            Size = Node.Count * GetFixedNodeSize( nt_pointer, m_PointerSize );
+            break;
+        case nt_instance:
+        case nt_array:
+            if (Node.Class != PROJECT_NO_CLASS)
+            {
+                if (!ComputeClass( Node.Class, Error ))
+                    return false;
+                Size = m_ClassSizes[Node.Class];
+                if (Node.Type == nt_array)
+                    Size *= Node.Count;
+            }
+            break;
+        default:
+            Size = GetFixedNodeSize( (NodeType)Node.Type, m_PointerSize );
+            break;
+        }
+
+        m_NodeSizes[n] = Size;
+        m_NodeOffsets[n] = Offset;
+        Offset += Size;
+    }
+
+    m_ClassSizes[Class] = Offset;
+    m_State[Class] = LAYOUT_DONE;
+    return true;
+}
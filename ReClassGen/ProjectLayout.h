@@ -0,0 +1,36 @@
+#pragma once
+
+//
+// Project layout
+//
+// Sizes and offsets of a binary project's classes and nodes, computed the way
+// the application computes them (GetMemorySize, CalcOffsets) but for a target
+// pointer size instead of the one the tool was built with. Only custom, text,
+// unicode and function nodes keep the size stored with them; instances and
+// arrays take their class's size, every other type has the fixed one the nodes
+// take from GetFixedNodeSize.
+//
+#include "ProjectFormat.h"
+
+class CProjectLayout {
+public:
+    CProjectLayout( );
+
+    // False if a class contains itself through instances or arrays, Error
+    // names the class
+    bool Compute( const CProjectImage& Image, uint32_t PointerSize, std::string& Error );
+
+    inline uint32_t GetClassSize( uint32_t Class ) const { return m_ClassSizes[Class]; }
+    inline uint32_t GetNodeSize( uint32_t Node ) const { return m_NodeSizes[Node]; }
+    inline uint32_t GetNodeOffset( uint32_t Node ) const { return m_NodeOffsets[Node]; }
+
+private:
+    bool ComputeClass( uint32_t Class, std::string& Error );
+
+    const CProjectImage* m_Image;
+    uint32_t m_PointerSize;
+    std::vector<uint8_t> m_State;           // Per class: not started, in progress, done
+    std::vector<uint32_t> m_ClassSizes;
+    std::vector<uint32_t> m_NodeSizes;      // Class nodes only, vtable functions stay 0
+    std::vector<uint32_t> m_NodeOffsets;
+};
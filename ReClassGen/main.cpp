@@ -0,0 +1,371 @@
+//
+// ReClassGen
+//
+// Generate Class without the window: reads a .nts or .ntsb project and writes
+// the same C++ header, or one header per class, for build servers and
+// scripts. Can also compile a .nts into a .ntsb the application opens faster.
+// Each phase's time goes to stderr.
+//
+#include "ProjectCodegen.h"
+#include "ProjectCompiler.h"
+#include "ProjectLayout.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MakeDirectory(Path) _mkdir( Path )
+#else
+#include <sys/stat.h>
+#define MakeDirectory(Path) mkdir( Path, 0755 )
+#endif
+
+static const char s_Banner[] = "// Generated using ReClassEx\r\n\r\n";
+
+struct GEN_ARGUMENTS {
+    const char* Input = NULL;
+    const char* Output = NULL;         // Whole header, stdout if neither this nor Split
+    const char* Split = NULL;          // Directory for one header per class
+    const char* Compile = NULL;        // .ntsb to write
+    uint32_t PointerSize = 8;
+    bool bStaticAsserts = false;
+    bool bPrivatePadding = false;
+};
+
+class CPhaseTimer {
+public:
+    CPhaseTimer( ) : m_Start( std::chrono::steady_clock::now( ) ) { }
+
+    // Prints the time since the last phase ended
+    void End( const char* Phase )
+    {
+        auto Now = std::chrono::steady_clock::now( );
+        fprintf( stderr, "%-10s %9.2f ms\n", Phase, std::chrono::duration<double, std::milli>( Now - m_Start ).count( ) );
+        m_Start = Now;
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+static void PrintUsage( )
+{
+    fprintf( stderr,
+        "usage: ReClassGen [options] project.nts|project.ntsb\n"
+        "  -o FILE             write the header to FILE (default stdout)\n"
+        "  --split DIR         write one header per class to DIR, plus Header.h and Classes.h\n"
+        "  --asserts           static_assert every class's size and every member's offset\n"
+        "  --private-padding   generate padding as private members\n"
+        "  --pointer-size 4|8  pointer size of the target process (default 8)\n"
+        "  --compile FILE      write the project as a binary project (.ntsb)\n" );
+}
+
+static bool ParseArguments( int argc, char** argv, GEN_ARGUMENTS& Arguments )
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* Argument = argv[i];
+        bool bValue = (i + 1 < argc);
+
+        if (strcmp( Argument, "-o" ) == 0 && bValue)
+            Arguments.Output = argv[++i];
+        else if (strcmp( Argument, "--split" ) == 0 && bValue)
+            Arguments.Split = argv[++i];
+        else if (strcmp( Argument, "--compile" ) == 0 && bValue)
+            Arguments.Compile = argv[++i];
+        else if (strcmp( Argument, "--pointer-size" ) == 0 && bValue)
+            Arguments.PointerSize = (uint32_t)atoi( argv[++i] );
+        else if (strcmp( Argument, "--asserts" ) == 0)
+            Arguments.bStaticAsserts = true;
+        else if (strcmp( Argument, "--private-padding" ) == 0)
+            Arguments.bPrivatePadding = true;
+        else if (Argument[0] != '-' && Arguments.Input == NULL)
+            Arguments.Input = Argument;
+        else
+            return false;
+    }
+
+    return Arguments.Input != NULL && (Arguments.PointerSize == 4 || Arguments.PointerSize == 8);
+}
+
+static bool ReadFile( const char* Path, std::vector<uint8_t>& Data )
+{
+    FILE* fp = fopen( Path, "rb" );
+    if (fp == NULL)
+        return false;
+
+    bool bRead = fseek( fp, 0, SEEK_END ) == 0;
+    long Size = bRead ? ftell( fp ) : -1;
+    bRead = Size >= 0 && fseek( fp, 0, SEEK_SET ) == 0;
+    if (bRead)
+    {
+        Data.resize( (size_t)Size );
+        bRead = fread( Data.data( ), 1, Data.size( ), fp ) == Data.size( );
+    }
+
+    fclose( fp );
+    return bRead;
+}
+
+static bool WriteFile( const std::string& Path, const void* Data, size_t Size )
+{
+    FILE* fp = fopen( Path.c_str( ), "wb" );
+    size_t Written = (fp != NULL) ? fwrite( Data, 1, Size, fp ) : 0;
+    bool bClosed = (fp != NULL) && fclose( fp ) == 0;
+
+    if (Written != Size || !bClosed)
+    {
+        fprintf( stderr, "ReClassGen: failed to write \"%s\"\n", Path.c_str( ) );
+        return false;
+    }
+    return true;
+}
+
+//
+// Class names become file names: anything but letters, digits and '_' turns
+// into '_', and names that would land on the same file (also on a file system
+// that ignores case) get a number.
+//
+static void GetClassFileNames( const CODEGEN_PROJECT& Project, std::vector<std::string>& FileNames )
+{
+    std::unordered_set<std::string> Taken = { "header", "classes" };
+
+    FileNames.resize( Project.Classes.size( ) );
+    for (size_t i = 0; i < Project.Classes.size( ); i++)
+    {
+        std::string Base = Project.Classes[i].Name;
+        for (char& Character : Base)
+        {
+            if (!isalnum( (unsigned char)Character ) && Character != '_')
+                Character = '_';
+        }
+        if (Base.empty( ))
+            Base = "Class";
+
+        std::string Name = Base;
+        for (uint32_t Suffix = 2;; Suffix++)
+        {
+            std::string Key = Name;
+            for (char& Character : Key)
+                Character = (char)tolower( (unsigned char)Character );
+
+            if (Taken.insert( Key ).second)
+                break;
+            Name = Base + "_" + std::to_string( Suffix );
+        }
+
+        FileNames[i] = Name + ".h";
+    }
+}
+
+//
+// --split: Header.h has the project header, every class's file includes it,
+// the files of the classes it instances and declares the ones it points to.
+// Classes.h includes them all in definition order and ends with the footer.
+//
+static bool WriteSplit( const GEN_ARGUMENTS& Arguments, const CProjectImage& Image, const CODEGEN_PROJECT& Project,
+    const std::vector<uint32_t>& ClassDefinitions, CCodeGenerator& Generator )
+{
+    std::vector<std::string> FileNames;
+    std::vector<size_t> Positions( Image.GetClassCount( ) );
+    std::vector<uint32_t> Includes, Pointers;
+    std::string Directory = Arguments.Split;
+    std::string Text;
+
+    if (MakeDirectory( Arguments.Split ) != 0 && errno != EEXIST)
+    {
+        fprintf( stderr, "ReClassGen: failed to create \"%s\"\n", Arguments.Split );
+        return false;
+    }
+    if (Directory.back( ) != '/' && Directory.back( ) != '\\')
+        Directory.push_back( '/' );
+
+    GetClassFileNames( Project, FileNames );
+    for (size_t i = 0; i < ClassDefinitions.size( ); i++)
+        Positions[ClassDefinitions[i]] = i;
+
+    Text = s_Banner;
+    Text += "#pragma once\r\n\r\n";
+    Text += CCodeGenerator::GetOptionIncludes( Project.Options );
+    if (!Project.Header.empty( ))
+    {
+        Text += Project.Header;
+        Text += "\r\n";
+    }
+    if (!WriteFile( Directory + "Header.h", Text.data( ), Text.size( ) ))
+        return false;
+
+    for (size_t i = 0; i < ClassDefinitions.size( ); i++)
+    {
+        GetClassDependencies( Image, ClassDefinitions[i], Includes, Pointers );
+
+        Text = s_Banner;
+        Text += "#pragma once\r\n\r\n#include \"Header.h\"\r\n";
+        for (uint32_t Class : Includes)
+        {
+            Text += "#include \"";
+            Text += FileNames[Positions[Class]];
+            Text += "\"\r\n";
+        }
+        Text += "\r\n";
+
+        if (!Pointers.empty( ))
+        {
+            for (uint32_t Class : Pointers)
+            {
+                Text += "class ";
+                Text += Project.Classes[Positions[Class]].Name;
+                Text += ";\r\n";
+            }
+            Text += "\r\n";
+        }
+
+        Text += Generator.GetClassText( i );
+        if (!WriteFile( Directory + FileNames[i], Text.data( ), Text.size( ) ))
+            return false;
+    }
+
+    Text = s_Banner;
+    Text += "#pragma once\r\n\r\n";
+    for (const std::string& FileName : FileNames)
+    {
+        Text += "#include \"";
+        Text += FileName;
+        Text += "\"\r\n";
+    }
+    Text += "\r\n";
+    if (!Project.Footer.empty( ))
+    {
+        Text += Project.Footer;
+        Text += "\r\n";
+    }
+    return WriteFile( Directory + "Classes.h", Text.data( ), Text.size( ) );
+}
+
+int main( int argc, char** argv )
+{
+    GEN_ARGUMENTS Arguments;
+    CPhaseTimer Timer;
+    std::vector<uint8_t> Data;
+    std::string Error;
+
+    if (!ParseArguments( argc, argv, Arguments ))
+    {
+        PrintUsage( );
+        return 2;
+    }
+
+    //
+    // Load: a .ntsb is used as it is, a .nts is compiled into one first
+    //
+    if (!ReadFile( Arguments.Input, Data ))
+    {
+        fprintf( stderr, "ReClassGen: failed to read \"%s\"\n", Arguments.Input );
+        return 1;
+    }
+
+    uint64_t Magic = 0;
+    if (Data.size( ) >= sizeof( Magic ))
+        memcpy( &Magic, Data.data( ), sizeof( Magic ) );
+
+    if (Magic != PROJECT_BINARY_MAGIC)
+    {
+        std::vector<uint8_t> Image;
+        if (!CompileXmlProject( (const char*)Data.data( ), Data.size( ), Arguments.PointerSize, Image, Error ))
+        {
+            fprintf( stderr, "ReClassGen: failed to load \"%s\", %s\n", Arguments.Input, Error.c_str( ) );
+            return 1;
+        }
+        Data.swap( Image );
+    }
+
+    CProjectImage Image;
+    if (!Image.Open( Data.data( ), Data.size( ) ))
+    {
+        fprintf( stderr, "ReClassGen: \"%s\" is not a valid binary project\n", Arguments.Input );
+        return 1;
+    }
+    Timer.End( "load" );
+
+    CProjectLayout Layout;
+    if (!Layout.Compute( Image, Arguments.PointerSize, Error ))
+    {
+        fprintf( stderr, "ReClassGen: %s\n", Error.c_str( ) );
+        return 1;
+    }
+    Timer.End( "layout" );
+
+    if (Arguments.Compile != NULL)
+    {
+        StoreNodeSizes( Data, Layout );
+        if (!WriteFile( Arguments.Compile, Data.data( ), Data.size( ) ))
+            return 1;
+        Timer.End( "compile" );
+
+        if (Arguments.Output == NULL && Arguments.Split == NULL)
+            return 0;
+    }
+
+    std::vector<uint32_t> ForwardDeclarations;
+    std::vector<uint32_t> ClassDefinitions;
+    GetGenerationOrder( Image, ForwardDeclarations, ClassDefinitions );
+    Timer.End( "order" );
+
+    CODEGEN_PROJECT Project;
+    uint32_t Unresolved = 0;
+
+    Project.Header = Image.GetString( Image.GetHeader( ).Header );
+    Project.Footer = Image.GetString( Image.GetHeader( ).Footer );
+    Project.Options.HexType = GetProjectTypedef( Image, TYPEDEF_HEX );
+    Project.Options.bPrivatePadding = Arguments.bPrivatePadding;
+    Project.Options.bStaticAsserts = Arguments.bStaticAsserts;
+
+    for (uint32_t Class : ForwardDeclarations)
+        Project.ForwardDeclarations.push_back( Image.GetString( Image.GetClass( Class ).Name ) );
+
+    Project.Classes.resize( ClassDefinitions.size( ) );
+    for (size_t i = 0; i < ClassDefinitions.size( ); i++)
+        DescribeProjectClass( Image, Layout, ClassDefinitions[i], Project.Classes[i], Unresolved );
+    Timer.End( "describe" );
+
+    if (Unresolved != 0)
+        fprintf( stderr, "ReClassGen: warning: %u links to classes that aren't in the project, generated as void* or left out\n", Unresolved );
+
+    CCodeGenerator Generator;
+    std::string Text;
+
+    if (Arguments.Split != NULL)
+        Generator.FormatClasses( Project );
+    else
+        Generator.Generate( Project, Text );
+    Timer.End( "generate" );
+
+    bool bWritten = true;
+    if (Arguments.Split != NULL)
+    {
+        bWritten = WriteSplit( Arguments, Image, Project, ClassDefinitions, Generator );
+        if (bWritten && Arguments.Output != NULL)
+        {
+            Generator.Generate( Project, Text );
+            bWritten = WriteFile( Arguments.Output, Text.data( ), Text.size( ) );
+        }
+    }
+    else if (Arguments.Output != NULL)
+    {
+        bWritten = WriteFile( Arguments.Output, Text.data( ), Text.size( ) );
+    }
+    else
+    {
+        bWritten = fwrite( Text.data( ), 1, Text.size( ), stdout ) == Text.size( ) && fflush( stdout ) == 0;
+    }
+    Timer.End( "write" );
+
+    fprintf( stderr, "ReClassGen: %u classes, %u forward declarations\n", (uint32_t)Project.Classes.size( ), (uint32_t)Project.ForwardDeclarations.size( ) );
+    return bWritten ? 0 : 1;
+}
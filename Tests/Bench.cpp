@@ -0,0 +1,448 @@
+//
+// Benchmarks of the portable hot paths against what they replaced:
+//
+//   printable   SanitizePrintable / CountPrintable vs the per character loop
+//   hex         FormatHex vs snprintf
+//   interval    CIntervalIndex vs a linear scan over a large memory map
+//   symbols     CSymbolTable vs the per address range cache SymbolReader had
+//   project     opening a .ntsb image vs parsing the same .nts, into the same model
+//
+// ReClassBench [name...] runs the named ones, all of them by default.
+//
+#include "Test.h"
+#include "PrintableText.h"
+#include "TextFormat.h"
+#include "IntervalIndex.h"
+#include "SymbolTable.h"
+#include "ProjectFormat.h"
+#include "ProjectCompiler.h"
+#include "XmlPullReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keeps results alive so the loops aren't optimized away
+static volatile size_t s_Sink;
+
+template<typename Fn>
+static double Measure( size_t Iterations, Fn Function )
+{
+    auto Start = std::chrono::steady_clock::now( );
+    for (size_t i = 0; i < Iterations; i++)
+        Function( i );
+    std::chrono::duration<double, std::nano> Elapsed = std::chrono::steady_clock::now( ) - Start;
+    return Elapsed.count( ) / (double)Iterations;
+}
+
+static void Report( const char* Name, double Baseline, double Optimized, const char* Unit )
+{
+    printf( "  %-28s %10.2f -> %10.2f %s  (%.1fx)\n", Name, Baseline, Optimized, Unit, Baseline / Optimized );
+}
+
+static void BenchPrintable( )
+{
+    CTestRandom Random;
+    std::vector<char> Memory( 1 << 16 );
+    std::vector<char> Out( Memory.size( ) );
+    std::vector<wchar_t> Wide( Memory.size( ) );
+
+    // Mostly text, like the strings the preview is after
+    for (char& c : Memory)
+        c = (Random.Next( ) % 8) ? (char)('a' + Random.Next( ) % 26) : (char)Random.Next( );
+
+    printf( "printable, 64 KB buffer:\n" );
+
+    double Scalar = Measure( 2000, [&] ( size_t ) {
+        for (size_t i = 0; i < Memory.size( ); i++)
+            Out[i] = ((signed char)Memory[i] > 0x1F && Memory[i] != 0x7F) ? Memory[i] : '.';
+        s_Sink += Out[s_Sink & 0xFFFF];
+    } );
+    double Kernel = Measure( 2000, [&] ( size_t ) {
+        SanitizePrintable( Out.data( ), Memory.data( ), Memory.size( ) );
+        s_Sink += Out[s_Sink & 0xFFFF];
+    } );
+    Report( "char -> char", Scalar, Kernel, "ns" );
+
+    Scalar = Measure( 2000, [&] ( size_t ) {
+        for (size_t i = 0; i < Memory.size( ); i++)
+            Wide[i] = ((signed char)Memory[i] > 0x1F && Memory[i] != 0x7F) ? (wchar_t)Memory[i] : L'.';
+        s_Sink += Wide[s_Sink & 0xFFFF];
+    } );
+    Kernel = Measure( 2000, [&] ( size_t ) {
+        SanitizePrintable( Wide.data( ), Memory.data( ), Memory.size( ) );
+        s_Sink += Wide[s_Sink & 0xFFFF];
+    } );
+    Report( "char -> wchar_t", Scalar, Kernel, "ns" );
+
+    // A row's preview: 16 bytes of text, the length the hex nodes check
+    std::vector<char> Text( 4096, 'a' );
+    Scalar = Measure( 1000000, [&] ( size_t i ) {
+        const char* Row = Text.data( ) + (i & 0xFF) * 16;
+        size_t Run = 0;
+        while (Run < 16 && (signed char)Row[Run] > 0x1F && Row[Run] != 0x7F)
+            Run++;
+        s_Sink += Run;
+    } );
+    Kernel = Measure( 1000000, [&] ( size_t i ) {
+        s_Sink += CountPrintable( Text.data( ) + (i & 0xFF) * 16, 16 );
+    } );
+    Report( "count, 16 byte row", Scalar, Kernel, "ns" );
+}
+
+static void BenchHex( )
+{
+    CTestRandom Random;
+    std::vector<unsigned long long> Values( 4096 );
+    for (unsigned long long& Value : Values)
+        Value = Random.Next( );
+
+    printf( "hex, per value:\n" );
+
+    char Buffer[32];
+    double Printf = Measure( 2000000, [&] ( size_t i ) {
+        s_Sink += snprintf( Buffer, sizeof( Buffer ), "%.2llX", Values[i & 4095] & 0xFF );
+    } );
+    double Format = Measure( 2000000, [&] ( size_t i ) {
+        s_Sink += FormatHex<2>( Buffer, Values[i & 4095] & 0xFF );
+        s_Sink += Buffer[1];
+    } );
+    Report( "byte \"%0.2X\"", Printf, Format, "ns" );
+
+    Printf = Measure( 2000000, [&] ( size_t i ) {
+        s_Sink += snprintf( Buffer, sizeof( Buffer ), "%.16llX", Values[i & 4095] );
+    } );
+    Format = Measure( 2000000, [&] ( size_t i ) {
+        s_Sink += FormatHex<16>( Buffer, Values[i & 4095] );
+        s_Sink += Buffer[15];
+    } );
+    Report( "address \"%0.16I64X\"", Printf, Format, "ns" );
+}
+
+static void BenchInterval( )
+{
+    // Roughly a large game process: 280k sections
+    const uint32_t Count = 280000;
+    CTestRandom Random;
+    std::vector<INTERVAL> Ranges( Count );
+    std::vector<uintptr_t> Addresses( 1 << 16 );
+    uintptr_t Next = 0x10000;
+
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        uintptr_t Size = ((Random.Next( ) % 16) + 1) * 0x1000;
+        Ranges[i] = { Next, Next + Size - 1, i };
+        Next += Size + (Random.Next( ) % 2) * 0x1000;
+    }
+    for (uintptr_t& Address : Addresses)
+        Address = 0x10000 + (uintptr_t)(Random.Next( ) % (Next - 0x10000));
+
+    printf( "interval, %u sections, per lookup:\n", Count );
+
+    CIntervalIndex Index;
+    double Build = Measure( 10, [&] ( size_t ) {
+        Index.Build( Ranges );
+    } );
+    printf( "  %-28s %10.2f ms\n", "build", Build / 1e6 );
+
+    double Linear = Measure( 200, [&] ( size_t i ) {
+        uintptr_t Address = Addresses[i & 0xFFFF];
+        for (const INTERVAL& Range : Ranges)
+        {
+            if (Address >= Range.Start && Address <= Range.End)
+            {
+                s_Sink += Range.Value;
+                break;
+            }
+        }
+    } );
+    double Indexed = Measure( 2000000, [&] ( size_t i ) {
+        s_Sink += Index.Find( Addresses[i & 0xFFFF] );
+    } );
+    Report( "lookup", Linear, Indexed, "ns" );
+}
+
+//
+// What SymbolReader did before the table: a sorted vector of resolved ranges
+// filled in from lookups. Publics have no length so every address got its own
+// 1 byte range, inserted in the middle of the vector. The DIA lookup behind a
+// miss is stood in for by a binary search over the same publics, which only
+// flatters the cache.
+//
+struct BenchSymbolRange {
+    uint32_t Start;
+    uint32_t End;
+    uint32_t NameId;
+};
+
+static uint32_t FindCachedSymbol( std::vector<BenchSymbolRange>& Ranges, std::map<uint32_t, uint32_t>& NameIds,
+                                  const std::vector<uint32_t>& Publics, uint32_t Rva )
+{
+    auto Range = std::upper_bound( Ranges.begin( ), Ranges.end( ), Rva,
+                                   [] ( uint32_t Value, const BenchSymbolRange& Entry ) { return Value < Entry.Start; } );
+    if (Range != Ranges.begin( ) && Rva < (Range - 1)->End)
+        return (Range - 1)->NameId;
+
+    auto Public = std::upper_bound( Publics.begin( ), Publics.end( ), Rva );
+    if (Public == Publics.begin( ))
+        return 0xFFFFFFFF;
+    uint32_t Index = (uint32_t)(Public - Publics.begin( ) - 1);
+
+    uint32_t NameId = NameIds.insert( std::make_pair( Index, (uint32_t)NameIds.size( ) ) ).first->second;
+    BenchSymbolRange Entry = { Rva, Rva + 1, NameId };
+    Ranges.insert( Range, Entry );
+    return NameId;
+}
+
+static void BenchSymbols( )
+{
+    // A large game module: 200k publics over 64 MB
+    const uint32_t Count = 200000;
+    const uint32_t ImageSize = 64 << 20;
+    CTestRandom Random;
+    std::vector<uint32_t> Publics( Count );
+    std::vector<uint32_t> Rvas( 1 << 16 );
+
+    for (uint32_t& Rva : Publics)
+        Rva = 0x1000 + (uint32_t)(Random.Next( ) % ImageSize);
+    std::sort( Publics.begin( ), Publics.end( ) );
+    for (uint32_t& Rva : Rvas)
+        Rva = 0x1000 + (uint32_t)(Random.Next( ) % ImageSize);
+
+    printf( "symbols, %u publics, per lookup over %u random RVAs:\n", Count, (uint32_t)Rvas.size( ) );
+
+    CSymbolTable Table;
+    double Build = Measure( 10, [&] ( size_t ) {
+        Table.Clear( );
+        for (uint32_t i = 0; i < Count; i++)
+            Table.Add( Publics[i], 0, i );
+        Table.Build( );
+    } );
+    printf( "  %-28s %10.2f ms\n", "build", Build / 1e6 );
+
+    // Every RVA once, the cache misses and grows on each one
+    std::vector<BenchSymbolRange> Ranges;
+    std::map<uint32_t, uint32_t> NameIds;
+    double Cached = Measure( Rvas.size( ), [&] ( size_t i ) {
+        s_Sink += FindCachedSymbol( Ranges, NameIds, Publics, Rvas[i] );
+    } );
+
+    std::vector<uint32_t> NameIdsByIndex( Table.GetCount( ), 0xFFFFFFFF );
+    uint32_t NameCount = 0;
+    double Indexed = Measure( 4000000, [&] ( size_t i ) {
+        size_t Index = Table.Find( Rvas[i & 0xFFFF] );
+        if (Index != SYMBOL_NONE)
+        {
+            uint32_t& NameId = NameIdsByIndex[Index];
+            if (NameId == 0xFFFFFFFF)
+                NameId = NameCount++;
+            s_Sink += NameId;
+        }
+    } );
+
+    Report( "lookup", Cached, Indexed, "ns" );
+    printf( "  %-28s %10.2f -> %10.2f M/s, cache left at %u ranges\n", "lookups per second",
+            1e3 / Cached, 1e3 / Indexed, (uint32_t)Ranges.size( ) );
+}
+
+//
+// What opening a project ends with, the portable stand-in for the
+// application's classes and nodes: every string copied out, links resolved
+// to class indices
+//
+struct BenchNode {
+    int32_t Type;
+    bool bHidden;
+    std::string Name;
+    std::string Comment;
+    uint32_t Class;
+};
+
+struct BenchClass {
+    std::string Name;
+    std::string Comment;
+    std::vector<BenchNode> Nodes;
+};
+
+// LoadXML's end state: parse, create every class and node, resolve the links by name
+static void BuildXmlModel( const std::string& Xml, std::vector<BenchClass>& Classes )
+{
+    CXmlPullReader Reader( Xml.data( ), Xml.size( ) );
+    std::unordered_map<std::string, uint32_t> ClassNames;
+    std::vector<std::pair<BenchNode*, std::string>> Links;
+    CXmlPullReader::Token Token;
+
+    Classes.clear( );
+    while ((Token = Reader.Next( )) == CXmlPullReader::XML_START || Token == CXmlPullReader::XML_END)
+    {
+        if (Token == CXmlPullReader::XML_END)
+            continue;
+
+        auto Attribute = [&Reader] ( const char* Name ) {
+            const char* Value = Reader.GetAttribute( Name );
+            return (Value != NULL) ? Value : "";
+        };
+
+        if (Reader.GetDepth( ) == 2 && strcmp( Reader.GetName( ), "Class" ) == 0)
+        {
+            Classes.emplace_back( );
+            Classes.back( ).Name = Attribute( "Name" );
+            Classes.back( ).Comment = Attribute( "Comment" );
+            ClassNames[Classes.back( ).Name] = (uint32_t)Classes.size( ) - 1;
+        }
+        else if (Reader.GetDepth( ) == 3 && !Classes.empty( ))
+        {
+            BenchNode Node;
+            Node.Type = atoi( Attribute( "Type" ) );
+            Node.bHidden = atoi( Attribute( "bHidden" ) ) > 0;
+            Node.Name = Attribute( "Name" );
+            Node.Comment = Attribute( "Comment" );
+            Node.Class = PROJECT_NO_CLASS;
+            Classes.back( ).Nodes.push_back( Node );
+
+            const char* Link = Reader.GetAttribute( "Pointer" );
+            if (Link != NULL)
+                Links.emplace_back( &Classes.back( ).Nodes.back( ), Link );
+        }
+    }
+    CHECK( Token == CXmlPullReader::XML_DONE );
+
+    // Classes are done growing, the node pointers are stable now
+    for (auto& Link : Links)
+    {
+        auto Found = ClassNames.find( Link.second );
+        if (Found != ClassNames.end( ))
+            Link.first->Class = Found->second;
+    }
+}
+
+// The nodes of one class out of the mapped image
+static void MaterializeBenchClass( const CProjectImage& Image, uint32_t Index, BenchClass& Class )
+{
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Index );
+
+    Class.Nodes.resize( Record.NodeCount );
+    for (uint32_t n = 0; n < Record.NodeCount; n++)
+    {
+        const PROJECT_BINARY_NODE& NodeRecord = Image.GetNode( Record.FirstNode + n );
+        BenchNode& Node = Class.Nodes[n];
+
+        Node.Type = NodeRecord.Type;
+        Node.bHidden = (NodeRecord.Flags & PROJECT_NODE_HIDDEN) != 0;
+        Node.Name = Image.GetString( NodeRecord.Name );
+        Node.Comment = Image.GetString( NodeRecord.Comment );
+        Node.Class = NodeRecord.Class;
+    }
+}
+
+// LoadBinary's end state, Materialize false stops at the classes' own fields
+// the way the application's pending classes do
+static void BuildImageModel( const std::vector<uint8_t>& Data, bool bMaterialize, std::vector<BenchClass>& Classes )
+{
+    CProjectImage Image;
+    CHECK( Image.Open( Data.data( ), Data.size( ) ) );
+
+    Classes.resize( Image.GetClassCount( ) );
+    for (uint32_t c = 0; c < Image.GetClassCount( ); c++)
+    {
+        Classes[c].Name = Image.GetString( Image.GetClass( c ).Name );
+        Classes[c].Comment = Image.GetString( Image.GetClass( c ).Comment );
+        Classes[c].Nodes.clear( );
+        if (bMaterialize)
+            MaterializeBenchClass( Image, c, Classes[c] );
+    }
+
+    // The class the view opens on
+    if (!bMaterialize && !Classes.empty( ))
+        MaterializeBenchClass( Image, 0, Classes[0] );
+}
+
+static void BenchProject( )
+{
+    // 2000 classes of 50 nodes, a pointer to the next class in each
+    const int ClassCount = 2000;
+    std::string Xml = "<Nothin>\n<TypeDef tdHex=\"char\"/>\n";
+    char Line[256];
+
+    for (int c = 0; c < ClassCount; c++)
+    {
+        snprintf( Line, sizeof( Line ), "<Class Name=\"Class%d\" Comment=\"\" Offset=\"0\" strOffset=\"0\" Code=\"\">\n", c );
+        Xml += Line;
+        for (int n = 0; n < 49; n++)
+        {
+            snprintf( Line, sizeof( Line ), "<Node Name=\"N%08X\" Type=\"%d\" Size=\"8\" bHidden=\"0\" Comment=\"\"/>\n", c * 64 + n, (n & 1) ? 5 : 13 );
+            Xml += Line;
+        }
+        snprintf( Line, sizeof( Line ), "<Node Name=\"Next\" Type=\"8\" Size=\"8\" Pointer=\"Class%d\"/>\n</Class>\n", (c + 1) % ClassCount );
+        Xml += Line;
+    }
+    Xml += "</Nothin>\n";
+
+    std::vector<uint8_t> Image;
+    std::string Error;
+    CHECK( CompileXmlProject( Xml.data( ), Xml.size( ), 8, Image, Error ) );
+
+    // Both paths have to end with the same project
+    std::vector<BenchClass> FromXml;
+    std::vector<BenchClass> FromImage;
+    BuildXmlModel( Xml, FromXml );
+    BuildImageModel( Image, true, FromImage );
+    CHECK_EQUAL( ClassCount, FromXml.size( ) );
+    CHECK_EQUAL( FromXml.size( ), FromImage.size( ) );
+    for (size_t c = 0; c < FromXml.size( ); c++)
+    {
+        CHECK( FromXml[c].Name == FromImage[c].Name );
+        CHECK_EQUAL( FromXml[c].Nodes.size( ), FromImage[c].Nodes.size( ) );
+        for (size_t n = 0; n < FromXml[c].Nodes.size( ); n++)
+        {
+            CHECK( FromXml[c].Nodes[n].Name == FromImage[c].Nodes[n].Name );
+            CHECK_EQUAL( FromXml[c].Nodes[n].Type, FromImage[c].Nodes[n].Type );
+            CHECK_EQUAL( FromXml[c].Nodes[n].Class, FromImage[c].Nodes[n].Class );
+        }
+    }
+
+    printf( "project, %d classes (%zu KB .nts, %zu KB .ntsb):\n", ClassCount, Xml.size( ) / 1024, Image.size( ) / 1024 );
+
+    double Parse = Measure( 10, [&] ( size_t ) {
+        std::vector<BenchClass> Classes;
+        BuildXmlModel( Xml, Classes );
+        s_Sink += Classes.size( );
+    } );
+    double Open = Measure( 10, [&] ( size_t ) {
+        std::vector<BenchClass> Classes;
+        BuildImageModel( Image, true, Classes );
+        s_Sink += Classes.size( );
+    } );
+    double OpenLazy = Measure( 100, [&] ( size_t ) {
+        std::vector<BenchClass> Classes;
+        BuildImageModel( Image, false, Classes );
+        s_Sink += Classes.size( );
+    } );
+    Report( "load, every node", Parse / 1e3, Open / 1e3, "us" );
+    Report( "load, one class materialized", Parse / 1e3, OpenLazy / 1e3, "us" );
+}
+
+int main( int argc, char** argv )
+{
+    struct { const char* Name; void (*Run)( ); } Benchmarks[] = {
+        { "printable", BenchPrintable },
+        { "hex", BenchHex },
+        { "interval", BenchInterval },
+        { "symbols", BenchSymbols },
+        { "project", BenchProject },
+    };
+
+    for (auto& Benchmark : Benchmarks)
+    {
+        bool bRun = (argc < 2);
+        for (int i = 1; i < argc; i++)
+            bRun |= (strcmp( argv[i], Benchmark.Name ) == 0);
+        if (bRun)
+            Benchmark.Run( );
+    }
+    return 0;
+}
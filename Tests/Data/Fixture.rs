@@ -0,0 +1,61 @@
+// Source of Fixture.pdb, the PDB TestPdbFile reads. No C++ compiler that
+// emits CodeView was available, so it is built with a nightly rustc and the
+// lld-link that ships with it; #[repr(C)] gives the same layouts as C:
+//
+//   rustc --edition 2021 --crate-type=lib --emit=obj -g -C opt-level=0
+//         -C panic=abort --target x86_64-pc-windows-msvc Fixture.rs -o Fixture.obj
+//   lld-link /debug /pdb:Fixture.pdb /nodefaultlib /entry:mainCRTStartup
+//            /subsystem:console /out:Fixture.exe Fixture.obj
+//
+// no_core keeps the target's standard library out of it.
+#![feature(no_core, lang_items, auto_traits)]
+#![no_core]
+#![no_main]
+#![allow(internal_features, dead_code, non_upper_case_globals, non_snake_case)]
+
+#[lang = "pointee_sized"] pub trait PointeeSized {}
+#[lang = "meta_sized"] pub trait MetaSized: PointeeSized {}
+#[lang = "sized"] pub trait Sized: MetaSized {}
+#[lang = "copy"] pub trait Copy {}
+impl Copy for u8 {}
+impl Copy for i32 {}
+impl Copy for f32 {}
+impl Copy for u64 {}
+#[lang = "freeze"] pub unsafe auto trait Freeze {}
+#[lang = "sync"] pub unsafe auto trait Sync {}
+#[lang = "drop_in_place"] pub unsafe fn drop_in_place<T: PointeeSized>(_p: *mut T) {}
+
+#[repr(C)]
+pub struct Vector3 { pub x: f32, pub y: f32, pub z: f32 }
+
+#[repr(C)]
+pub union Value { pub i: i32, pub f: f32, pub q: u64 }
+
+#[repr(C)]
+pub enum Team { Red = 1, Blue = 2 }
+
+#[repr(C)]
+pub struct Player {
+    pub health: i32,
+    pub position: Vector3,
+    pub name: [u8; 16],
+    pub target: *mut Player,
+    pub value: Value,
+    pub team: Team,
+}
+
+#[no_mangle]
+pub static mut g_LocalPlayer: Player = Player {
+    health: 100,
+    position: Vector3 { x: 0.0, y: 0.0, z: 0.0 },
+    name: [0; 16],
+    target: 0 as *mut Player,
+    value: Value { q: 0 },
+    team: Team::Red,
+};
+
+#[no_mangle]
+pub extern "C" fn GetHealth(_p: *const Player) -> i32 { 100 }
+
+#[no_mangle]
+pub extern "C" fn mainCRTStartup() -> i32 { 0 }
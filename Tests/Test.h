@@ -0,0 +1,46 @@
+#pragma once
+
+//
+// Minimal checks for the test executables: print where a check failed and
+// exit non-zero, which is all ctest looks at.
+//
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(Condition) \
+    do { \
+        if (!(Condition)) \
+        { \
+            fprintf( stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #Condition ); \
+            exit( 1 ); \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL(Expected, Actual) \
+    do { \
+        unsigned long long _Expected = (unsigned long long)(Expected); \
+        unsigned long long _Actual = (unsigned long long)(Actual); \
+        if (_Expected != _Actual) \
+        { \
+            fprintf( stderr, "%s(%d): CHECK_EQUAL(%s, %s) failed, expected 0x%llX got 0x%llX\n", \
+                     __FILE__, __LINE__, #Expected, #Actual, _Expected, _Actual ); \
+            exit( 1 ); \
+        } \
+    } while (0)
+
+// Deterministic so a failure reproduces
+class CTestRandom {
+public:
+    explicit CTestRandom( unsigned long long Seed = 0x9E3779B97F4A7C15ULL ) : m_State( Seed ) { }
+
+    unsigned long long Next( )
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 7;
+        m_State ^= m_State << 17;
+        return m_State;
+    }
+
+private:
+    unsigned long long m_State;
+};
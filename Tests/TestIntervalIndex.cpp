@@ -0,0 +1,113 @@
+//
+// CIntervalIndex against a linear scan of the same ranges: module sized
+// sections that never overlap like a real memory map, and random overlapping
+// ranges for the walk back.
+//
+#include "Test.h"
+#include "IntervalIndex.h"
+
+#include <vector>
+
+// The range starting last wins, the later one of equal starts
+static uint32_t FindLinear( const std::vector<INTERVAL>& Ranges, uintptr_t Address )
+{
+    const INTERVAL* Best = NULL;
+    for (const INTERVAL& Range : Ranges)
+    {
+        if (Address >= Range.Start && Address <= Range.End && (Best == NULL || Range.Start >= Best->Start))
+            Best = &Range;
+    }
+    return (Best != NULL) ? Best->Value : INTERVAL_NO_VALUE;
+}
+
+static void CheckAround( const CIntervalIndex& Index, const std::vector<INTERVAL>& Ranges, uintptr_t Address )
+{
+    CHECK_EQUAL( FindLinear( Ranges, Address ), Index.Find( Address ) );
+    CHECK_EQUAL( FindLinear( Ranges, Address - 1 ), Index.Find( Address - 1 ) );
+    CHECK_EQUAL( FindLinear( Ranges, Address + 1 ), Index.Find( Address + 1 ) );
+}
+
+int main( )
+{
+    CTestRandom Random;
+    CIntervalIndex Index;
+
+    // Empty
+    Index.Build( std::vector<INTERVAL>( ) );
+    CHECK_EQUAL( INTERVAL_NO_VALUE, Index.Find( 0 ) );
+    CHECK_EQUAL( INTERVAL_NO_VALUE, Index.Find( (uintptr_t)-1 ) );
+
+    // One range, and the ends of the address space
+    std::vector<INTERVAL> Ranges = { { 0x1000, 0x1FFF, 7 } };
+    Index.Build( Ranges );
+    CHECK_EQUAL( INTERVAL_NO_VALUE, Index.Find( 0xFFF ) );
+    CHECK_EQUAL( 7, Index.Find( 0x1000 ) );
+    CHECK_EQUAL( 7, Index.Find( 0x1FFF ) );
+    CHECK_EQUAL( INTERVAL_NO_VALUE, Index.Find( 0x2000 ) );
+
+    Ranges = { { 0, 0, 1 }, { (uintptr_t)-1, (uintptr_t)-1, 2 } };
+    Index.Build( Ranges );
+    CHECK_EQUAL( 1, Index.Find( 0 ) );
+    CHECK_EQUAL( INTERVAL_NO_VALUE, Index.Find( 1 ) );
+    CHECK_EQUAL( 2, Index.Find( (uintptr_t)-1 ) );
+
+    // A small range inside a big one, and one behind both that only the
+    // running max end can find
+    Ranges = { { 0x1000, 0x8FFF, 1 }, { 0x2000, 0x2FFF, 2 }, { 0x3000, 0x3FFF, 3 } };
+    Index.Build( Ranges );
+    CHECK_EQUAL( 1, Index.Find( 0x1800 ) );
+    CHECK_EQUAL( 2, Index.Find( 0x2800 ) );
+    CHECK_EQUAL( 3, Index.Find( 0x3800 ) );
+    CHECK_EQUAL( 1, Index.Find( 0x4000 ) );
+    CHECK_EQUAL( 1, Index.Find( 0x8FFF ) );
+
+    // Shuffled sections, page aligned and not overlapping, with gaps
+    for (int Round = 0; Round < 20; Round++)
+    {
+        Ranges.clear( );
+        uintptr_t Next = 0x10000;
+        for (uint32_t i = 0; i < 2000; i++)
+        {
+            uintptr_t Size = ((Random.Next( ) % 64) + 1) * 0x1000;
+            Ranges.push_back( { Next, Next + Size - 1, i } );
+            Next += Size + (Random.Next( ) % 4) * 0x1000;
+        }
+        for (size_t i = Ranges.size( ) - 1; i > 0; i--)
+            std::swap( Ranges[i], Ranges[Random.Next( ) % (i + 1)] );
+
+        Index.Build( Ranges );
+        CHECK_EQUAL( Ranges.size( ), Index.GetCount( ) );
+
+        for (const INTERVAL& Range : Ranges)
+        {
+            CheckAround( Index, Ranges, Range.Start );
+            CheckAround( Index, Ranges, Range.End );
+        }
+        for (int i = 0; i < 2000; i++)
+        {
+            uintptr_t Address = 0x10000 + (uintptr_t)(Random.Next( ) % (Next - 0x10000 + 0x2000));
+            CHECK_EQUAL( FindLinear( Ranges, Address ), Index.Find( Address ) );
+        }
+    }
+
+    // Random overlapping ranges, duplicate starts included
+    for (int Round = 0; Round < 200; Round++)
+    {
+        Ranges.clear( );
+        uint32_t Count = (uint32_t)(Random.Next( ) % 64);
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            uintptr_t Start = (uintptr_t)(Random.Next( ) % 1024);
+            Ranges.push_back( { Start, Start + (uintptr_t)(Random.Next( ) % 256), i } );
+        }
+
+        Index.Build( Ranges );
+        for (uintptr_t Address = 0; Address < 1400; Address++)
+            CHECK_EQUAL( FindLinear( Ranges, Address ), Index.Find( Address ) );
+    }
+
+    Index.Clear( );
+    CHECK_EQUAL( 0, Index.GetCount( ) );
+    CHECK_EQUAL( INTERVAL_NO_VALUE, Index.Find( 0x1000 ) );
+    return 0;
+}
@@ -0,0 +1,253 @@
+//
+// The Linux /proc source on this process, and snapshots captured from it read
+// back through CSnapshotMemorySource. Damaged snapshot files have to be
+// turned down by Open before anything is sized from them.
+//
+#include "Test.h"
+#include "MemorySource.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Two regions and a module in memory, small enough to damage every byte of
+class CTestMemorySource : public IMemorySource {
+public:
+    CTestMemorySource( )
+    {
+        for (size_t i = 0; i < sizeof( m_Data ); i++)
+            m_Data[i] = (uint8_t)(i * 7);
+    }
+
+    virtual const wchar_t* GetName( ) const { return L"Test"; }
+    virtual bool IsValid( ) const { return true; }
+
+    virtual bool Read( uint64_t Address, void* Buffer, size_t Size, size_t* BytesRead )
+    {
+        size_t Total = 0;
+        memset( Buffer, 0, Size );
+        for (size_t i = 0; i < Size; i++)
+        {
+            uint64_t At = Address + i;
+            if ((At >= 0x10000 && At < 0x10000 + 0x1000) || (At >= 0x20000 && At < 0x20000 + 0x1000))
+            {
+                ((uint8_t*)Buffer)[i] = m_Data[(At & 0xFFF) ^ ((At >> 16) & 1)];
+                Total++;
+            }
+        }
+        if (BytesRead)
+            *BytesRead = Total;
+        return Total == Size;
+    }
+
+    virtual bool Write( uint64_t /*Address*/, const void* /*Buffer*/, size_t /*Size*/, size_t* BytesWritten )
+    {
+        if (BytesWritten)
+            *BytesWritten = 0;
+        return false;
+    }
+
+    virtual bool QueryRegions( std::vector<MemoryRegion>& Regions )
+    {
+        Regions = { { 0x10000, 0x1000, MEMORY_REGION_READ | MEMORY_REGION_IMAGE },
+                    { 0x18000, 0x1000, 0 },
+                    { 0x20000, 0x1000, MEMORY_REGION_READ | MEMORY_REGION_WRITE } };
+        return true;
+    }
+
+    virtual bool EnumerateModules( std::vector<MemoryModule>& Modules )
+    {
+        Modules.resize( 1 );
+        Modules[0].Base = 0x10000;
+        Modules[0].Size = 0x1000;
+        Modules[0].Name = L"test.dll";
+        Modules[0].Path = L"C:\\test.dll";
+        return true;
+    }
+
+private:
+    uint8_t m_Data[0x1000];
+};
+
+static std::vector<uint8_t> ReadFile( const char* Path )
+{
+    std::vector<uint8_t> Data;
+    FILE* File = fopen( Path, "rb" );
+    CHECK( File != NULL );
+    uint8_t Buffer[4096];
+    size_t Read;
+    while ((Read = fread( Buffer, 1, sizeof( Buffer ), File )) > 0)
+        Data.insert( Data.end( ), Buffer, Buffer + Read );
+    fclose( File );
+    return Data;
+}
+
+static void WriteFile( const char* Path, const uint8_t* Data, size_t Size )
+{
+    FILE* File = fopen( Path, "wb" );
+    CHECK( File != NULL );
+    CHECK( Size == 0 || fwrite( Data, 1, Size, File ) == Size );
+    fclose( File );
+}
+
+static void TestSnapshotFile( )
+{
+    const char* Path = "TestMemorySource.small.rcsnap";
+    const char* DamagedPath = "TestMemorySource.damaged.rcsnap";
+    CTestMemorySource Source;
+    CSnapshotMemorySource Snapshot;
+
+    CHECK( CSnapshotMemorySource::Capture( &Source, Path ) );
+    CHECK( Snapshot.Open( Path ) );
+
+    // The unreadable region is left out
+    std::vector<MemoryRegion> Regions;
+    CHECK( Snapshot.QueryRegions( Regions ) );
+    CHECK_EQUAL( 2, Regions.size( ) );
+    CHECK_EQUAL( 0x20000, Regions[1].Start );
+
+    std::vector<MemoryModule> Modules;
+    CHECK( Snapshot.EnumerateModules( Modules ) );
+    CHECK_EQUAL( 1, Modules.size( ) );
+    CHECK( Modules[0].Name == L"test.dll" );
+    CHECK( Modules[0].Path == L"C:\\test.dll" );
+
+    // Same bytes as the source, zeros and a short count across the gap
+    uint8_t Expected[0x3000], Actual[0x3000];
+    size_t ExpectedRead = 0, ActualRead = 0;
+    Source.Read( 0x10800, Expected, sizeof( Expected ), &ExpectedRead );
+    CHECK( !Snapshot.Read( 0x10800, Actual, sizeof( Actual ), &ActualRead ) );
+    CHECK_EQUAL( ExpectedRead, ActualRead );
+    CHECK( memcmp( Expected, Actual, sizeof( Actual ) ) == 0 );
+    CHECK( Snapshot.Read( 0x20000, Actual, 0x1000, NULL ) );
+    CHECK( !Snapshot.Write( 0x20000, Actual, 1, NULL ) );
+    Snapshot.Close( );
+
+    //
+    // Every truncation fails, and so do counts and offsets past the end of
+    // the file. The header is 24 bytes, a region 32, a module 24.
+    //
+    std::vector<uint8_t> File = ReadFile( Path );
+    for (size_t Size = 0; Size < 24 + 2 * 32 + 24 + (8 + 11) * 2; Size++)
+    {
+        WriteFile( DamagedPath, File.data( ), Size );
+        CHECK( !Snapshot.Open( DamagedPath ) );
+    }
+
+    struct { size_t Offset; uint32_t Value; } Damage[] = {
+        { 12, 0xFFFFFFFF },         // RegionCount
+        { 12, 0x00100000 },
+        { 16, 0xFFFFFFFF },         // ModuleCount
+        { 24 + 8, 0xFFFFFFFF },     // First region's size
+        { 24 + 24, 0xFFFFFFFF },    // First region's file offset
+        { 24 + 28, 0x1 },           // High half of it
+        { 24 + 64 + 16, 0x7FFFFFFF },// Module name length
+        { 24 + 64 + 20, 0x7FFFFFFF },// Module path length
+    };
+    for (auto& Entry : Damage)
+    {
+        std::vector<uint8_t> Damaged( File );
+        memcpy( &Damaged[Entry.Offset], &Entry.Value, sizeof( Entry.Value ) );
+        WriteFile( DamagedPath, Damaged.data( ), Damaged.size( ) );
+        CHECK( !Snapshot.Open( DamagedPath ) );
+    }
+
+    // Random damage either fails or reads within the file
+    CTestRandom Random;
+    for (int Round = 0; Round < 2000; Round++)
+    {
+        std::vector<uint8_t> Damaged( File );
+        size_t Offset = Random.Next( ) % (24 + 64 + 24 + 38);
+        Damaged[Offset] ^= (uint8_t)(1 << (Random.Next( ) & 7));
+        WriteFile( DamagedPath, Damaged.data( ), Damaged.size( ) );
+        if (Snapshot.Open( DamagedPath ))
+        {
+            CHECK( Snapshot.QueryRegions( Regions ) );
+            for (const MemoryRegion& Region : Regions)
+                Snapshot.Read( Region.Start, Actual, (size_t)(Region.Size < sizeof( Actual ) ? Region.Size : sizeof( Actual )), NULL );
+        }
+    }
+
+    Snapshot.Close( );
+    remove( Path );
+    remove( DamagedPath );
+}
+
+static void TestProcSource( )
+{
+    const char* Path = "TestMemorySource.self.rcsnap";
+    static uint8_t Pattern[0x2345];
+    for (size_t i = 0; i < sizeof( Pattern ); i++)
+        Pattern[i] = (uint8_t)(i ^ (i >> 8));
+
+    CProcMemorySource Proc;
+    CHECK( Proc.Attach( getpid( ) ) );
+    CHECK( Proc.IsValid( ) );
+
+    uint8_t Buffer[sizeof( Pattern )];
+    size_t Read = 0;
+    CHECK( Proc.Read( (uintptr_t)Pattern, Buffer, sizeof( Buffer ), &Read ) );
+    CHECK_EQUAL( sizeof( Pattern ), Read );
+    CHECK( memcmp( Buffer, Pattern, sizeof( Pattern ) ) == 0 );
+
+    // Writes land in the target
+    uint8_t Value = 0xA5;
+    if (Proc.Write( (uintptr_t)&Pattern[100], &Value, 1, NULL ))
+        CHECK_EQUAL( 0xA5, Pattern[100] );
+
+    // A read running into an unmapped page stops there, the rest is zero
+    long PageSize = sysconf( _SC_PAGESIZE );
+    uint8_t* Pages = (uint8_t*)mmap( NULL, PageSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    CHECK( Pages != MAP_FAILED );
+    memset( Pages, 0x5A, PageSize );
+    munmap( Pages + PageSize, PageSize );
+
+    std::vector<uint8_t> Straddle( PageSize * 2, 0xFF );
+    CHECK( !Proc.Read( (uintptr_t)Pages, Straddle.data( ), Straddle.size( ), &Read ) );
+    CHECK_EQUAL( PageSize, Read );
+    CHECK( Straddle[0] == 0x5A && Straddle[PageSize - 1] == 0x5A );
+    CHECK( Straddle[PageSize] == 0 && Straddle.back( ) == 0 );
+    munmap( Pages, PageSize );
+
+    // The pattern is in a readable region, this executable is a module
+    std::vector<MemoryRegion> Regions;
+    CHECK( Proc.QueryRegions( Regions ) );
+    bool bFound = false;
+    for (const MemoryRegion& Region : Regions)
+        bFound |= (uintptr_t)Pattern >= Region.Start && (uintptr_t)Pattern < Region.Start + Region.Size && (Region.Flags & MEMORY_REGION_READ);
+    CHECK( bFound );
+
+    std::vector<MemoryModule> Modules;
+    CHECK( Proc.EnumerateModules( Modules ) );
+    bFound = false;
+    for (const MemoryModule& Module : Modules)
+        bFound |= Module.Name == L"TestMemorySource";
+    CHECK( bFound );
+
+    // Captured and read back
+    CHECK( CSnapshotMemorySource::Capture( &Proc, Path ) );
+
+    CSnapshotMemorySource Snapshot;
+    CHECK( Snapshot.Open( Path ) );
+    memset( Buffer, 0, sizeof( Buffer ) );
+    CHECK( Snapshot.Read( (uintptr_t)Pattern, Buffer, sizeof( Buffer ), &Read ) );
+    CHECK( memcmp( Buffer, Pattern, sizeof( Pattern ) ) == 0 );
+
+    std::vector<MemoryModule> SnapshotModules;
+    CHECK( Snapshot.EnumerateModules( SnapshotModules ) );
+    CHECK_EQUAL( Modules.size( ), SnapshotModules.size( ) );
+    for (size_t i = 0; i < Modules.size( ); i++)
+        CHECK( Modules[i].Path == SnapshotModules[i].Path && Modules[i].Base == SnapshotModules[i].Base );
+
+    Snapshot.Close( );
+    Proc.Detach( );
+    CHECK( !Proc.IsValid( ) );
+    remove( Path );
+}
+
+int main( )
+{
+    TestSnapshotFile( );
+    TestProcSource( );
+    return 0;
+}
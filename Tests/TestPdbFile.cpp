@@ -0,0 +1,141 @@
+//
+// CPdbFile against Data/Fixture.pdb, a linker written PDB whose symbols and
+// types are known from its source, Data/Fixture.rs. Expected addresses are
+// from llvm-pdbutil dump -publics -globals -section-headers.
+//
+#include "Test.h"
+#include "PdbFile.h"
+
+#include <string.h>
+
+static const PdbMember* FindMember( const PdbUdt& Udt, const char* Name )
+{
+    for (const PdbMember& Member : Udt.Members)
+    {
+        if (Member.Name == Name)
+            return &Member;
+    }
+    return NULL;
+}
+
+static void TestSymbols( CPdbFile& Pdb )
+{
+    uint32_t Index = 0;
+    uint32_t OtherIndex = 0;
+
+    // GetHealth is .text+0, mainCRTStartup .text+0x10, .text is at 0x1000
+    CHECK( Pdb.FindSymbol( 0xFFF ) == NULL );
+    CHECK( strcmp( Pdb.FindSymbol( 0x1000, &Index ), "Fixture::GetHealth" ) == 0 );
+    CHECK( strcmp( Pdb.FindSymbol( 0x100F, &OtherIndex ), "Fixture::GetHealth" ) == 0 );
+    CHECK_EQUAL( Index, OtherIndex );
+    CHECK( strcmp( Pdb.FindSymbol( 0x1010, &OtherIndex ), "Fixture::mainCRTStartup" ) == 0 );
+    CHECK( Index != OtherIndex );
+
+    // The global's data record beats its public at the same address, the
+    // import thunk slot after it only has a public
+    CHECK( strcmp( Pdb.FindSymbol( 0x3000 ), "Fixture::g_LocalPlayer" ) == 0 );
+    CHECK( strcmp( Pdb.FindSymbol( 0x3037 ), "Fixture::g_LocalPlayer" ) == 0 );
+    CHECK( strcmp( Pdb.FindSymbol( 0x3038 ), "__imp_g_LocalPlayer" ) == 0 );
+    CHECK( strcmp( Pdb.FindSymbol( 0xFFFFFFFF ), "__imp_g_LocalPlayer" ) == 0 );
+
+    CHECK_EQUAL( 4, Pdb.GetSymbolCount( ) );
+}
+
+static void TestTypes( CPdbFile& Pdb )
+{
+    std::vector<PdbUdt> Udts;
+    PdbUdt Udt;
+
+    // Definitions only, the forward references collapse into them
+    CHECK_EQUAL( 4, Pdb.EnumerateUdts( Udts ) );
+    CHECK_EQUAL( 4, Udts.size( ) );
+    for (const PdbUdt& Entry : Udts)
+    {
+        CHECK( Entry.Members.empty( ) );
+        if (Entry.Name == "Fixture::Player")
+        {
+            CHECK_EQUAL( PDB_LF_STRUCTURE, Entry.Kind );
+            CHECK_EQUAL( 56, Entry.Size );
+        }
+        else if (Entry.Name == "Fixture::Value")
+        {
+            CHECK_EQUAL( PDB_LF_UNION, Entry.Kind );
+            CHECK_EQUAL( 8, Entry.Size );
+        }
+        else if (Entry.Name == "Fixture::Team")
+        {
+            CHECK_EQUAL( PDB_LF_ENUM, Entry.Kind );
+            CHECK_EQUAL( 4, Entry.Size );
+        }
+        else
+        {
+            CHECK( Entry.Name == "Fixture::Vector3" );
+            CHECK_EQUAL( 12, Entry.Size );
+        }
+    }
+
+    CHECK( !Pdb.FindUdt( "Player", Udt ) );
+    CHECK( Pdb.FindUdt( "Fixture::Player", Udt ) );
+    CHECK_EQUAL( PDB_LF_STRUCTURE, Udt.Kind );
+    CHECK_EQUAL( 56, Udt.Size );
+    CHECK_EQUAL( 6, Udt.Members.size( ) );
+
+    const PdbMember* Member = FindMember( Udt, "health" );
+    CHECK( Member != NULL && Member->Offset == 0 && Member->TypeName == "int" && Member->BitLength == 0 );
+    Member = FindMember( Udt, "position" );
+    CHECK( Member != NULL && Member->Offset == 4 && Member->TypeName == "Fixture::Vector3" );
+    CHECK_EQUAL( 12, Pdb.GetTypeSize( Member->TypeIndex ) );
+    Member = FindMember( Udt, "name" );
+    CHECK( Member != NULL && Member->Offset == 16 && Member->TypeName == "unsigned char[16]" );
+    CHECK_EQUAL( 16, Pdb.GetTypeSize( Member->TypeIndex ) );
+    Member = FindMember( Udt, "target" );
+    CHECK( Member != NULL && Member->Offset == 32 && Member->TypeName == "Fixture::Player*" );
+    CHECK_EQUAL( 8, Pdb.GetTypeSize( Member->TypeIndex ) );
+    Member = FindMember( Udt, "value" );
+    CHECK( Member != NULL && Member->Offset == 40 && Member->TypeName == "Fixture::Value" );
+    Member = FindMember( Udt, "team" );
+    CHECK( Member != NULL && Member->Offset == 48 && Member->TypeName == "Fixture::Team" );
+    CHECK_EQUAL( 4, Pdb.GetTypeSize( Member->TypeIndex ) );
+
+    // Members of a union all start at 0, enumerators carry their value
+    CHECK( Pdb.FindUdt( "Fixture::Value", Udt ) );
+    CHECK_EQUAL( 3, Udt.Members.size( ) );
+    CHECK( Udt.Members[2].Name == "q" && Udt.Members[2].Offset == 0 );
+    CHECK_EQUAL( 8, Pdb.GetTypeSize( Udt.Members[2].TypeIndex ) );
+
+    CHECK( Pdb.FindUdt( "Fixture::Team", Udt ) );
+    CHECK_EQUAL( 2, Udt.Members.size( ) );
+    CHECK( Udt.Members[0].Name == "Red" && Udt.Members[0].Offset == 1 );
+    CHECK( Udt.Members[1].Name == "Blue" && Udt.Members[1].Offset == 2 );
+
+    // The definition's IPI source line, rustc doesn't record the file
+    std::string File;
+    uint32_t Line = 1;
+    CHECK( Pdb.FindUdt( "Fixture::Vector3", Udt ) );
+    CHECK( Pdb.GetUdtSource( Udt.TypeIndex, File, &Line ) );
+    CHECK_EQUAL( 0, Line );
+    CHECK( !Pdb.GetUdtSource( 0x1000, File, &Line ) );
+
+    CHECK( Pdb.GetTypeName( 0x74 ) == "int" );
+    CHECK( Pdb.GetTypeName( 0xFFFFF ) == "<unknown>" );
+    CHECK_EQUAL( 0, Pdb.GetTypeSize( 0xFFFFF ) );
+}
+
+int main( )
+{
+    CPdbFile Pdb;
+
+    CHECK( !Pdb.Open( RECLASS_TEST_DATA "/Missing.pdb" ) );
+    CHECK( !Pdb.IsOpen( ) );
+    CHECK( !Pdb.Open( RECLASS_TEST_DATA "/Fixture.rs" ) );
+    CHECK( !Pdb.IsOpen( ) );
+
+    CHECK( Pdb.Open( RECLASS_TEST_DATA "/Fixture.pdb" ) );
+    CHECK( Pdb.IsOpen( ) );
+    TestSymbols( Pdb );
+    TestTypes( Pdb );
+
+    Pdb.Close( );
+    CHECK( !Pdb.IsOpen( ) );
+    return 0;
+}
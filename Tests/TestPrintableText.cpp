@@ -0,0 +1,137 @@
+//
+// SanitizePrintable and CountPrintable against the scalar rule they replaced,
+// for every byte value, random buffers and every length around the 16 byte
+// blocks so the SSE2 loops and the scalar tails are both covered.
+//
+#include "Test.h"
+#include "PrintableText.h"
+#include "TextFormat.h"
+
+#include <string.h>
+#include <vector>
+
+// The loops the kernels replaced
+static bool IsPrintableScalar( char c ) { return (signed char)c > 0x1F && c != 0x7F; }
+static bool IsPrintableScalar( wchar_t c ) { return c > 0x1F && c < 0xFF && c != 0x7F; }
+
+static void CheckNarrow( const std::vector<char>& In )
+{
+    size_t Length = In.size( );
+    std::vector<char> Out( Length + 1, 'X' );
+    std::vector<wchar_t> Wide( Length + 1, L'X' );
+
+    SanitizePrintable( Out.data( ), In.data( ), Length );
+    SanitizePrintable( Wide.data( ), In.data( ), Length );
+
+    size_t Run = 0;
+    while (Run < Length && IsPrintableScalar( In[Run] ))
+        Run++;
+    CHECK_EQUAL( Run, CountPrintable( In.data( ), Length ) );
+
+    for (size_t i = 0; i < Length; i++)
+    {
+        char Expected = IsPrintableScalar( In[i] ) ? In[i] : '.';
+        CHECK_EQUAL( (unsigned char)Expected, (unsigned char)Out[i] );
+        CHECK_EQUAL( (unsigned char)Expected, Wide[i] );
+    }
+
+    // Nothing past Length is touched
+    CHECK( Out[Length] == 'X' );
+    CHECK( Wide[Length] == L'X' );
+
+    // In place
+    std::vector<char> Copy( In );
+    SanitizePrintable( Copy.data( ), Copy.data( ), Length );
+    CHECK( Length == 0 || memcmp( Copy.data( ), Out.data( ), Length ) == 0 );
+}
+
+static void CheckWide( const std::vector<wchar_t>& In )
+{
+    size_t Length = In.size( );
+    std::vector<wchar_t> Out( Length + 1, L'X' );
+
+    SanitizePrintable( Out.data( ), In.data( ), Length );
+
+    for (size_t i = 0; i < Length; i++)
+        CHECK_EQUAL( IsPrintableScalar( In[i] ) ? In[i] : L'.', Out[i] );
+    CHECK( Out[Length] == L'X' );
+}
+
+int main( )
+{
+    CTestRandom Random;
+
+    // Every byte value, and every 16 bit unit, in one buffer each
+    std::vector<char> AllBytes( 256 );
+    for (int i = 0; i < 256; i++)
+        AllBytes[i] = (char)i;
+    CheckNarrow( AllBytes );
+
+    std::vector<wchar_t> AllUnits( 0x10000 );
+    for (int i = 0; i < 0x10000; i++)
+        AllUnits[i] = (wchar_t)i;
+    CheckWide( AllUnits );
+
+    // Every length up to a few blocks, random contents and all printable
+    for (size_t Length = 0; Length <= 80; Length++)
+    {
+        for (int Round = 0; Round < 32; Round++)
+        {
+            std::vector<char> Narrow( Length );
+            std::vector<wchar_t> Wide( Length );
+            for (size_t i = 0; i < Length; i++)
+            {
+                unsigned long long Value = Random.Next( );
+                Narrow[i] = (char)Value;
+                Wide[i] = (wchar_t)((Value >> 8) & ((Round & 1) ? 0xFFFF : 0x1FF));
+            }
+            CheckNarrow( Narrow );
+            CheckWide( Wide );
+        }
+
+        // A long printable run, then one bad byte at each position
+        std::vector<char> Text( Length, 'a' );
+        CheckNarrow( Text );
+        for (size_t Bad = 0; Bad < Length; Bad++)
+        {
+            Text[Bad] = (Bad & 1) ? (char)0x7F : (char)0x80;
+            CHECK_EQUAL( Bad, CountPrintable( Text.data( ), Length ) );
+            Text[Bad] = 'a';
+        }
+    }
+
+    // Unaligned starts
+    std::vector<char> Buffer( 4096 );
+    for (char& c : Buffer)
+        c = (char)Random.Next( );
+    for (size_t Start = 0; Start < 16; Start++)
+        CheckNarrow( std::vector<char>( Buffer.begin( ) + Start, Buffer.end( ) ) );
+
+    // FormatHex against the printf formats it stands in for
+    for (int Round = 0; Round < 100000; Round++)
+    {
+        unsigned long long Value = Random.Next( ) >> (Random.Next( ) & 63);
+        char Expected[32], Actual[32];
+
+        snprintf( Expected, sizeof( Expected ), "%.2llX", Value & 0xFF );
+        CHECK_EQUAL( strlen( Expected ), FormatHex<2>( Actual, Value & 0xFF ) );
+        CHECK( strcmp( Expected, Actual ) == 0 );
+
+        snprintf( Expected, sizeof( Expected ), "%.8llX", Value & 0xFFFFFFFF );
+        CHECK_EQUAL( strlen( Expected ), FormatHex<8>( Actual, Value & 0xFFFFFFFF ) );
+        CHECK( strcmp( Expected, Actual ) == 0 );
+
+        snprintf( Expected, sizeof( Expected ), "%.1llX", Value );
+        CHECK_EQUAL( strlen( Expected ), FormatHex<1>( Actual, Value ) );
+        CHECK( strcmp( Expected, Actual ) == 0 );
+    }
+
+    printf( "PrintableText: wchar_t is %u bytes, %s\n", (unsigned)sizeof( wchar_t ),
+    #if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_IX86)
+            "SSE2"
+    #else
+            "scalar only"
+    #endif
+    );
+    return 0;
+}
@@ -0,0 +1,276 @@
+//
+// Binary project (.ntsb) round trips: CProjectWriter images read back through
+// CProjectImage, an .nts compiled the way LoadXML reads it, and damaged
+// images that Open has to turn down without reading out of bounds.
+//
+#include "Test.h"
+#include "ProjectFormat.h"
+#include "ProjectCompiler.h"
+#include "ProjectLayout.h"
+#include "NodeType.h"
+
+#include <string.h>
+#include <string>
+
+static const char s_Project[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<Nothin>\n"
+    "  <TypeDef tdHex=\"char\" tdFloat=\"float32\"/>\n"
+    "  <Header Text=\"// header\"/>\n"
+    "  <Footer Text=\"\"/>\n"
+    "  <Notes Text=\"a &amp; b\"/>\n"
+    "  <Class Name=\"Vec\" Comment=\"\" Offset=\"4096\" strOffset=\"base+0x1000\" Code=\"\">\n"
+    "    <Node Name=\"x\" Type=\"13\" Size=\"4\" bHidden=\"0\" Comment=\"\"/>\n"
+    "    <Node Name=\"y\" Type=\"13\" Size=\"4\" bHidden=\"1\" Comment=\"hidden\"/>\n"
+    "  </Class>\n"
+    "  <Class Name=\"Player\" Comment=\"\" Offset=\"0\" strOffset=\"\" Code=\"\">\n"
+    "    <Node Name=\"vt\" Type=\"26\" Size=\"8\">\n"
+    "      <Function Name=\"f0\" Comment=\"first\"><Code Assembly=\"mov eax, 1\"/><Code Assembly=\"ret\"/></Function>\n"
+    "      <Function Name=\"f1\" Comment=\"\"/>\n"
+    "    </Node>\n"
+    "    <Node Name=\"pos\" Type=\"1\" Size=\"8\" Instance=\"Vec\"/>\n"
+    "    <Node Name=\"next\" Type=\"8\" Size=\"8\" Pointer=\"Player\"/>\n"
+    "    <Node Name=\"name\" Type=\"18\" Size=\"16\"/>\n"
+    "    <Node Name=\"items\" Type=\"27\" Total=\"3\"><Array Type=\"28\" Name=\"Vec\"/></Node>\n"
+    "    <Node Name=\"ptrs\" Type=\"34\" Count=\"2\"><Array Type=\"28\" Name=\"Vec\"/></Node>\n"
+    "    <Node Name=\"pad\" Type=\"4\" Size=\"4\"/>\n"
+    "    <Node Name=\"missing\" Type=\"8\" Size=\"8\" Pointer=\"Nope\"/>\n"
+    "    <Node Name=\"unknown\" Type=\"2\" Size=\"8\"/>\n"
+    "  </Class>\n"
+    "</Nothin>\n";
+
+static const PROJECT_BINARY_NODE& FindNode( const CProjectImage& Image, uint32_t Class, const char* Name, uint32_t* Index = NULL )
+{
+    const PROJECT_BINARY_CLASS& Record = Image.GetClass( Class );
+    for (uint32_t n = Record.FirstNode; n < Record.FirstNode + Record.NodeCount; n++)
+    {
+        if (strcmp( Image.GetString( Image.GetNode( n ).Name ), Name ) == 0)
+        {
+            if (Index)
+                *Index = n;
+            return Image.GetNode( n );
+        }
+    }
+    fprintf( stderr, "no node %s\n", Name );
+    exit( 1 );
+}
+
+// Touch everything an opened image hands out, which is what Open vouches for
+static size_t WalkImage( const CProjectImage& Image )
+{
+    size_t Total = strlen( Image.GetString( Image.GetHeader( ).Header ) );
+
+    for (uint32_t c = 0; c < Image.GetClassCount( ); c++)
+    {
+        const PROJECT_BINARY_CLASS& Class = Image.GetClass( c );
+        Total += strlen( Image.GetString( Class.Name ) );
+        for (uint32_t n = Class.FirstNode; n < Class.FirstNode + Class.NodeCount; n++)
+        {
+            const PROJECT_BINARY_NODE& Node = Image.GetNode( n );
+            Total += strlen( Image.GetString( Node.Name ) ) + strlen( Image.GetString( Node.Comment ) );
+            if (Node.Class != PROJECT_NO_CLASS)
+                Total += strlen( Image.GetString( Image.GetClass( Node.Class ).Name ) );
+            for (uint32_t f = Node.FirstChild; f < Node.FirstChild + Node.ChildCount; f++)
+                Total += strlen( Image.GetString( Image.GetNode( f ).Name ) );
+            for (uint32_t l = Node.FirstLine; l < Node.FirstLine + Node.LineCount; l++)
+                Total += strlen( Image.GetString( Image.GetLine( l ) ) );
+        }
+    }
+    return Total;
+}
+
+static void TestWriter( )
+{
+    CProjectWriter Writer;
+    std::vector<uint8_t> Image;
+
+    uint32_t Name = Writer.AddString( "Class" );
+    CHECK_EQUAL( Name, Writer.AddString( "Class" ) );
+    CHECK_EQUAL( Name, Writer.AddString( "ClassName", 5 ) );
+    uint32_t Empty = Writer.AddString( "" );
+    CHECK( Empty != Name );
+
+    Writer.GetHeader( ).Header = Writer.AddString( "#pragma once" );
+
+    PROJECT_BINARY_CLASS Class;
+    memset( &Class, 0, sizeof( Class ) );
+    Class.Name = Name;
+    Class.Comment = PROJECT_NO_STRING;
+    Class.OffsetString = PROJECT_NO_STRING;
+    Class.Code = PROJECT_NO_STRING;
+    Class.Offset = 0x140000000ULL;
+    Class.NodeCount = 2;
+    Class.FirstNode = Writer.ReserveNodes( 2 );
+
+    // Reserving nodes moves the table, so nodes are filled in by index
+    uint32_t Self = Class.FirstNode;
+    Writer.GetNode( Self ).Type = nt_pointer;
+    Writer.GetNode( Self ).Name = Writer.AddString( "Self" );
+    Writer.GetNode( Self ).Class = 0;
+
+    uint32_t VTable = Class.FirstNode + 1;
+    uint32_t Function = Writer.ReserveNodes( 1 );
+    Writer.GetNode( VTable ).Type = nt_vtable;
+    Writer.GetNode( VTable ).Name = Writer.AddString( "VTable" );
+    Writer.GetNode( VTable ).FirstChild = Function;
+    Writer.GetNode( VTable ).ChildCount = 1;
+
+    Writer.GetNode( Function ).Type = nt_functionptr;
+    Writer.GetNode( Function ).Name = Writer.AddString( "Function" );
+    Writer.GetNode( Function ).FirstLine = Writer.AddLine( Writer.AddString( "ret" ) );
+    Writer.GetNode( Function ).LineCount = 1;
+
+    Writer.AddClass( Class );
+    Writer.Finish( Image );
+
+    CProjectImage Opened;
+    CHECK( Opened.Open( Image.data( ), Image.size( ) ) );
+    CHECK_EQUAL( 1, Opened.GetClassCount( ) );
+    CHECK_EQUAL( 3, Opened.GetHeader( ).NodeCount );
+    CHECK( strcmp( Opened.GetString( Opened.GetHeader( ).Header ), "#pragma once" ) == 0 );
+    CHECK( strcmp( Opened.GetString( Opened.GetHeader( ).Footer ), "" ) == 0 );
+
+    uint32_t Length = 0;
+    CHECK( strcmp( Opened.GetString( Opened.GetClass( 0 ).Name, &Length ), "Class" ) == 0 );
+    CHECK_EQUAL( 5, Length );
+    CHECK_EQUAL( 0x140000000ULL, Opened.GetClass( 0 ).Offset );
+
+    const PROJECT_BINARY_NODE& OpenedVTable = FindNode( Opened, 0, "VTable" );
+    CHECK_EQUAL( 0, FindNode( Opened, 0, "Self" ).Class );
+    CHECK_EQUAL( 1, OpenedVTable.ChildCount );
+    const PROJECT_BINARY_NODE& OpenedFunction = Opened.GetNode( OpenedVTable.FirstChild );
+    CHECK( strcmp( Opened.GetString( OpenedFunction.Name ), "Function" ) == 0 );
+    CHECK( strcmp( Opened.GetString( Opened.GetLine( OpenedFunction.FirstLine ) ), "ret" ) == 0 );
+
+    // Every truncation is refused
+    for (size_t Size = 0; Size < Image.size( ); Size++)
+        CHECK( !Opened.Open( Image.data( ), Size ) );
+
+    // A link past the class table
+    std::vector<uint8_t> Bad( Image );
+    const PROJECT_BINARY_HEADER* Header = (const PROJECT_BINARY_HEADER*)Bad.data( );
+    PROJECT_BINARY_NODE* Nodes = (PROJECT_BINARY_NODE*)(Bad.data( ) + Header->NodeTable);
+    Nodes[0].Class = 1;
+    CHECK( !Opened.Open( Bad.data( ), Bad.size( ) ) );
+    CHECK( Opened.Open( Bad.data( ), Bad.size( ), 2 ) );
+
+    // A node that is its own child
+    Bad = Image;
+    Nodes = (PROJECT_BINARY_NODE*)(Bad.data( ) + Header->NodeTable);
+    Nodes[1].FirstChild = 1;
+    CHECK( !Opened.Open( Bad.data( ), Bad.size( ) ) );
+
+    // A string running off the string data
+    Bad = Image;
+    PROJECT_BINARY_STRING* Strings = (PROJECT_BINARY_STRING*)(Bad.data( ) + Header->StringTable);
+    Strings[0].Length = 0x7FFFFFFF;
+    CHECK( !Opened.Open( Bad.data( ), Bad.size( ) ) );
+
+    // Random damage: refused, or safe to walk
+    CTestRandom Random;
+    size_t Accepted = 0;
+    for (int Round = 0; Round < 20000; Round++)
+    {
+        Bad = Image;
+        for (int Flip = 0; Flip < 4; Flip++)
+            Bad[Random.Next( ) % Bad.size( )] ^= (uint8_t)(1 << (Random.Next( ) & 7));
+
+        if (Opened.Open( Bad.data( ), Bad.size( ) ))
+        {
+            WalkImage( Opened );
+            Accepted++;
+        }
+    }
+    printf( "ProjectFormat: %zu of 20000 damaged images opened\n", Accepted );
+}
+
+static void CheckLayout( uint32_t PointerSize, uint32_t PlayerSize )
+{
+    std::vector<uint8_t> Image;
+    std::string Error;
+
+    CHECK( CompileXmlProject( s_Project, sizeof( s_Project ) - 1, PointerSize, Image, Error ) );
+
+    CProjectImage Opened;
+    CProjectLayout Layout;
+    CHECK( Opened.Open( Image.data( ), Image.size( ) ) );
+    CHECK( Layout.Compute( Opened, PointerSize, Error ) );
+
+    CHECK_EQUAL( 2, Opened.GetClassCount( ) );
+    CHECK( strcmp( Opened.GetString( Opened.GetClass( 0 ).Name ), "Vec" ) == 0 );
+    CHECK( strcmp( Opened.GetString( Opened.GetClass( 0 ).OffsetString ), "base+0x1000" ) == 0 );
+    CHECK_EQUAL( 4096, Opened.GetClass( 0 ).Offset );
+    CHECK_EQUAL( 8, Layout.GetClassSize( 0 ) );
+    CHECK_EQUAL( PlayerSize, Layout.GetClassSize( 1 ) );
+
+    // The unknown node type is dropped like LoadXML drops it
+    CHECK_EQUAL( 8, Opened.GetClass( 1 ).NodeCount );
+
+    CHECK( strcmp( Opened.GetString( Opened.GetHeader( ).Notes ), "a & b" ) == 0 );
+    CHECK( strcmp( Opened.GetString( Opened.GetHeader( ).Typedefs[9] ), "float32" ) == 0 );
+    CHECK( FindNode( Opened, 0, "y" ).Flags & PROJECT_NODE_HIDDEN );
+    CHECK( strcmp( Opened.GetString( FindNode( Opened, 0, "y" ).Comment ), "hidden" ) == 0 );
+
+    // Links
+    CHECK_EQUAL( 0, FindNode( Opened, 1, "pos" ).Class );
+    CHECK_EQUAL( 1, FindNode( Opened, 1, "next" ).Class );
+    CHECK_EQUAL( 0, FindNode( Opened, 1, "items" ).Class );
+    CHECK_EQUAL( 0, FindNode( Opened, 1, "ptrs" ).Class );
+    CHECK_EQUAL( PROJECT_NO_CLASS, FindNode( Opened, 1, "missing" ).Class );
+    CHECK_EQUAL( 3, FindNode( Opened, 1, "items" ).Count );
+    CHECK_EQUAL( 2, FindNode( Opened, 1, "ptrs" ).Count );
+
+    // The vtable's functions and their disassembly
+    const PROJECT_BINARY_NODE& VTable = FindNode( Opened, 1, "vt" );
+    CHECK_EQUAL( 2, VTable.ChildCount );
+    const PROJECT_BINARY_NODE& First = Opened.GetNode( VTable.FirstChild );
+    CHECK( strcmp( Opened.GetString( First.Comment ), "first" ) == 0 );
+    CHECK_EQUAL( 2, First.LineCount );
+    CHECK( strcmp( Opened.GetString( Opened.GetLine( First.FirstLine + 1 ) ), "ret" ) == 0 );
+    CHECK_EQUAL( 0, Opened.GetNode( VTable.FirstChild + 1 ).LineCount );
+
+    // Sizes and offsets, which the compiler also stores in the nodes
+    struct { const char* Name; uint32_t Size; } Expected[] = {
+        { "vt", PointerSize }, { "pos", 8 }, { "next", PointerSize }, { "name", 16 },
+        { "items", 24 }, { "ptrs", 2 * PointerSize }, { "pad", 4 }, { "missing", PointerSize },
+    };
+    uint32_t Offset = 0;
+    for (auto& Entry : Expected)
+    {
+        uint32_t Index;
+        const PROJECT_BINARY_NODE& Node = FindNode( Opened, 1, Entry.Name, &Index );
+        CHECK_EQUAL( Entry.Size, Layout.GetNodeSize( Index ) );
+        CHECK_EQUAL( Entry.Size, Node.Size );
+        CHECK_EQUAL( Offset, Layout.GetNodeOffset( Index ) );
+        Offset += Entry.Size;
+    }
+    CHECK_EQUAL( PlayerSize, Offset );
+}
+
+static void TestXml( )
+{
+    CheckLayout( 8, 92 );
+    CheckLayout( 4, 72 );
+
+    std::vector<uint8_t> Image;
+    std::string Error;
+    CHECK( !CompileXmlProject( "<Project/>", 10, 8, Image, Error ) );
+    CHECK( Error == "not a ReClass project" );
+
+    std::string Broken( s_Project, sizeof( s_Project ) - 1 );
+    Broken.resize( Broken.size( ) / 2 );
+    CHECK( !CompileXmlProject( Broken.data( ), Broken.size( ), 8, Image, Error ) );
+
+    // A class containing itself has no layout
+    static const char Recursive[] =
+        "<Nothin><Class Name=\"A\"><Node Name=\"a\" Type=\"1\" Instance=\"A\"/></Class></Nothin>";
+    CHECK( !CompileXmlProject( Recursive, sizeof( Recursive ) - 1, 8, Image, Error ) );
+    CHECK( Error.find( "A" ) != std::string::npos );
+}
+
+int main( )
+{
+    TestWriter( );
+    TestXml( );
+    return 0;
+}
@@ -0,0 +1,71 @@
+//
+// CRecordingRenderSink through the IRenderSink interface the nodes draw
+// with: what it records and the text Dump compares frames by.
+//
+#include "Test.h"
+#include "RenderSink.h"
+
+#include <string.h>
+
+static void DrawRow( IRenderSink* Sink, int y )
+{
+    static const RenderChar Offset[] = "0000";
+    static const RenderChar Name[] = "Health ignored past Length";
+
+    Sink->FillRect( 0, y, 640, 16, 0xFFD0A0 );
+    Sink->DrawIcon( 16, y, 3 );
+    Sink->DrawString( 32, y, 0x00FF00, Offset, 4 );
+    Sink->DrawString( 72, y, 0x0000FF, Name, 6 );
+}
+
+int main( )
+{
+    CRecordingRenderSink Recorder;
+
+    CHECK( Recorder.Dump( ).empty( ) );
+
+    DrawRow( &Recorder, 0 );
+    DrawRow( &Recorder, 16 );
+
+    const std::vector<CRecordingRenderSink::Record>& Records = Recorder.GetRecords( );
+    CHECK_EQUAL( 8, Records.size( ) );
+    CHECK_EQUAL( CRecordingRenderSink::RECORD_FILL, Records[0].Type );
+    CHECK_EQUAL( 640, Records[0].Width );
+    CHECK_EQUAL( CRecordingRenderSink::RECORD_ICON, Records[1].Type );
+    CHECK_EQUAL( 3, Records[1].Index );
+    CHECK_EQUAL( CRecordingRenderSink::RECORD_TEXT, Records[7].Type );
+    CHECK_EQUAL( 16, Records[7].y );
+    CHECK_EQUAL( 6, Records[7].TextLength );
+
+    // Each run is copied out and NUL terminated on its own
+    CHECK( strcmp( Recorder.GetText( Records[2] ), "0000" ) == 0 );
+    CHECK( strcmp( Recorder.GetText( Records[3] ), "Health" ) == 0 );
+    CHECK( strcmp( Recorder.GetText( Records[7] ), "Health" ) == 0 );
+
+    std::string Row =
+        "fill 0,0 640x16 #FFD0A0\r\n"
+        "icon 16,0 3\r\n"
+        "text 32,0 #00FF00 0000\r\n"
+        "text 72,0 #0000FF Health\r\n";
+    std::string NextRow =
+        "fill 0,16 640x16 #FFD0A0\r\n"
+        "icon 16,16 3\r\n"
+        "text 32,16 #00FF00 0000\r\n"
+        "text 72,16 #0000FF Health\r\n";
+    CHECK( Recorder.Dump( ) == Row + NextRow );
+
+    // The same frame again after a clear records the same thing
+    Recorder.Clear( );
+    CHECK( Recorder.GetRecords( ).empty( ) );
+    CHECK( Recorder.Dump( ).empty( ) );
+
+    DrawRow( &Recorder, 0 );
+    CHECK( Recorder.Dump( ) == Row );
+
+    // Negative coordinates, scrolled above the client rect
+    Recorder.Clear( );
+    Recorder.FillRect( -4, -16, 8, 1, 0 );
+    Recorder.DrawString( 0, -16, 0xFFFFFF, "", 0 );
+    CHECK( Recorder.Dump( ) == "fill -4,-16 8x1 #000000\r\ntext 0,-16 #FFFFFF \r\n" );
+    return 0;
+}
@@ -0,0 +1,92 @@
+//
+// CSymbolTable against a linear scan of the same symbols: what a lookup
+// between, on and before symbols finds, and which of several symbols at one
+// RVA is kept.
+//
+#include "Test.h"
+#include "SymbolTable.h"
+
+#include <vector>
+
+struct Symbol {
+    uint32_t Rva;
+    uint32_t Priority;
+    uint32_t Value;
+};
+
+// Last RVA <= Rva, of those the highest priority, the first added of equal ones
+static uint32_t FindLinear( const std::vector<Symbol>& Symbols, uint32_t Rva )
+{
+    const Symbol* Best = NULL;
+    for (const Symbol& Entry : Symbols)
+    {
+        if (Entry.Rva > Rva)
+            continue;
+        if (Best == NULL || Entry.Rva > Best->Rva || (Entry.Rva == Best->Rva && Entry.Priority > Best->Priority))
+            Best = &Entry;
+    }
+    return (Best != NULL) ? Best->Value : 0xFFFFFFFF;
+}
+
+static uint32_t FindValue( const CSymbolTable& Table, uint32_t Rva )
+{
+    size_t Index = Table.Find( Rva );
+    return (Index != SYMBOL_NONE) ? Table.GetValue( Index ) : 0xFFFFFFFF;
+}
+
+int main( )
+{
+    CSymbolTable Table;
+
+    CHECK_EQUAL( SYMBOL_NONE, Table.Find( 0 ) );
+    Table.Build( );
+    CHECK_EQUAL( SYMBOL_NONE, Table.Find( 0x1000 ) );
+
+    // A function and the public at its address, added in either order
+    Table.Add( 0x3000, 1, 30 );
+    Table.Add( 0x1000, 0, 10 );
+    Table.Add( 0x1000, 1, 11 );
+    Table.Add( 0x2000, 1, 21 );
+    Table.Add( 0x2000, 0, 20 );
+    Table.Add( 0x2000, 1, 22 );
+    Table.Build( );
+
+    CHECK_EQUAL( 3, Table.GetCount( ) );
+    CHECK_EQUAL( SYMBOL_NONE, Table.Find( 0xFFF ) );
+    CHECK_EQUAL( 11, FindValue( Table, 0x1000 ) );
+    CHECK_EQUAL( 11, FindValue( Table, 0x1FFF ) );
+    CHECK_EQUAL( 21, FindValue( Table, 0x2000 ) );
+    CHECK_EQUAL( 30, FindValue( Table, 0x3000 ) );
+    CHECK_EQUAL( 30, FindValue( Table, 0xFFFFFFFF ) );
+    CHECK_EQUAL( 0x2000, Table.GetRva( Table.Find( 0x2FFF ) ) );
+
+    // Building again starts over
+    Table.Clear( );
+    CHECK_EQUAL( 0, Table.GetCount( ) );
+    Table.Add( 0, 0, 1 );
+    Table.Build( );
+    CHECK_EQUAL( 1, FindValue( Table, 0 ) );
+    CHECK_EQUAL( 1, FindValue( Table, 0x7FFFFFFF ) );
+
+    // Random symbols, many sharing an RVA, against the scan
+    CTestRandom Random;
+    for (int Round = 0; Round < 20; Round++)
+    {
+        std::vector<Symbol> Symbols( 1 + Random.Next( ) % 500 );
+        for (size_t i = 0; i < Symbols.size( ); i++)
+        {
+            Symbols[i].Rva = 0x1000 + (uint32_t)(Random.Next( ) % 64) * 0x10;
+            Symbols[i].Priority = (uint32_t)(Random.Next( ) % 3);
+            Symbols[i].Value = (uint32_t)i;
+        }
+
+        Table.Clear( );
+        for (const Symbol& Entry : Symbols)
+            Table.Add( Entry.Rva, Entry.Priority, Entry.Value );
+        Table.Build( );
+
+        for (uint32_t Rva = 0xFF0; Rva < 0x1420; Rva += 4)
+            CHECK_EQUAL( FindLinear( Symbols, Rva ), FindValue( Table, Rva ) );
+    }
+    return 0;
+}
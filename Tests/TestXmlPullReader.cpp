@@ -0,0 +1,130 @@
+//
+// CXmlPullReader on small documents: entity and line ending decoding, how a
+// self-closing root and whatever follows the root end the walk, and the
+// malformed input it has to stop at with the right line.
+//
+#include "Test.h"
+#include "XmlPullReader.h"
+
+#include <string.h>
+#include <string>
+
+static bool IsTag( CXmlPullReader& Reader, CXmlPullReader::Token Expected, const char* Name, uint32_t Depth )
+{
+    return Reader.Next( ) == Expected && strcmp( Reader.GetName( ), Name ) == 0 && Reader.GetDepth( ) == Depth;
+}
+
+static CXmlPullReader::Token ReadToEnd( const std::string& Document, uint32_t* ErrorLine = NULL )
+{
+    CXmlPullReader Reader( Document.data( ), Document.size( ) );
+    CXmlPullReader::Token Token;
+
+    do
+    {
+        Token = Reader.Next( );
+    } while (Token == CXmlPullReader::XML_START || Token == CXmlPullReader::XML_END);
+
+    if (ErrorLine != NULL)
+        *ErrorLine = Reader.GetErrorLine( );
+    return Token;
+}
+
+static void TestEntities( )
+{
+    std::string Document =
+        "<Root Named=\"&lt;&gt;&amp;&quot;&apos;\" Numeric=\"&#65;&#x42;&#X43;&#xe9;&#x20AC;&#x1F600;\""
+        " Unknown='&bogus;&#xZZ;&#;&#x110000;& ;' Quoted='say \"hi\"'/>";
+    CXmlPullReader Reader( Document.data( ), Document.size( ) );
+
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Root", 1 ) );
+    CHECK( strcmp( Reader.GetAttribute( "Named" ), "<>&\"'" ) == 0 );
+    CHECK( strcmp( Reader.GetAttribute( "Numeric" ), "ABC\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" ) == 0 );
+    // Anything that isn't a known entity is kept as written
+    CHECK( strcmp( Reader.GetAttribute( "Unknown" ), "&bogus;&#xZZ;&#;&#x110000;& ;" ) == 0 );
+    CHECK( strcmp( Reader.GetAttribute( "Quoted" ), "say \"hi\"" ) == 0 );
+    CHECK( Reader.GetAttribute( "Missing" ) == NULL );
+}
+
+static void TestLineEndings( )
+{
+    std::string Document = "<Root Text=\"a\r\nb\n\rc\rd\ne\r\n\r\nf\"></Root>";
+    CXmlPullReader Reader( Document.data( ), Document.size( ) );
+
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Root", 1 ) );
+    CHECK( strcmp( Reader.GetAttribute( "Text" ), "a\nb\nc\nd\ne\n\nf" ) == 0 );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_END, "Root", 1 ) );
+    CHECK_EQUAL( CXmlPullReader::XML_DONE, Reader.Next( ) );
+}
+
+static void TestSelfClosingRoot( )
+{
+    std::string Document = "\xEF\xBB\xBF<?xml version=\"1.0\"?>\n<!-- saved -->\n<Root Name=\"x\"/>\n";
+    CXmlPullReader Reader( Document.data( ), Document.size( ) );
+
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Root", 1 ) );
+    CHECK( strcmp( Reader.GetAttribute( "Name" ), "x" ) == 0 );
+    // The end has the start's name and depth, but no attributes
+    CHECK( IsTag( Reader, CXmlPullReader::XML_END, "Root", 1 ) );
+    CHECK( Reader.GetAttribute( "Name" ) == NULL );
+    CHECK_EQUAL( CXmlPullReader::XML_DONE, Reader.Next( ) );
+    CHECK_EQUAL( CXmlPullReader::XML_DONE, Reader.Next( ) );
+}
+
+static void TestAfterRoot( )
+{
+    // Text, comments and even another element after the root end the walk
+    CHECK_EQUAL( CXmlPullReader::XML_DONE, ReadToEnd( "<Root/>trailing text" ) );
+    CHECK_EQUAL( CXmlPullReader::XML_DONE, ReadToEnd( "<Root></Root>\n<!-- a -->\n<!-- b -->\n" ) );
+
+    std::string Document = "<Root><Child/></Root><Second><Child/></Second>";
+    CXmlPullReader Reader( Document.data( ), Document.size( ) );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Root", 1 ) );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Child", 2 ) );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_END, "Child", 2 ) );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_END, "Root", 1 ) );
+    CHECK_EQUAL( CXmlPullReader::XML_DONE, Reader.Next( ) );
+
+    // Markup after the root still has to be well formed
+    uint32_t Line = 0;
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root/>\n<!-- never closed", &Line ) );
+    CHECK_EQUAL( 2, Line );
+}
+
+static void TestMalformed( )
+{
+    uint32_t Line = 0;
+
+    std::string Document = "<Root>\n  <Class>\n  </Root>\n</Class>";
+    CXmlPullReader Reader( Document.data( ), Document.size( ) );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Root", 1 ) );
+    CHECK( IsTag( Reader, CXmlPullReader::XML_START, "Class", 2 ) );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, Reader.Next( ) );
+    CHECK_EQUAL( 3, Reader.GetErrorLine( ) );
+    // Stays failed
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, Reader.Next( ) );
+
+    // A prefix of the open name isn't a match
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root></Roo>" ) );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "</Root>" ) );
+
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root>\n<!-- never closed\n</Root>", &Line ) );
+    CHECK_EQUAL( 2, Line );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root><!-- -></Root>" ) );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<!--" ) );
+
+    // Unclosed root, unterminated tag and attribute value
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root>\n<Child/>\n" ) );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root Name=\"x\"" ) );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "<Root Name=\"x/>" ) );
+    CHECK_EQUAL( CXmlPullReader::XML_ERROR, ReadToEnd( "" ) );
+}
+
+int main( )
+{
+    TestEntities( );
+    TestLineEndings( );
+    TestSelfClosingRoot( );
+    TestAfterRoot( );
+    TestMalformed( );
+    return 0;
+}